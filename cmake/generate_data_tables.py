@@ -0,0 +1,659 @@
+import json
+import sys
+import os
+
+# Compiles embedded JSON data into const C initialisers, so the game parses
+# and copies nothing at startup and a malformed file fails the build:
+#   items     data/items.json      -> items_data.h (Item table + perfect hash)
+#                                     [+ item_ids.h (ItemID constants)]
+#   commands  data/commands.json   -> command_data.h (names + perfect hash)
+#                                     + command_ids.h (CommandID constants)
+#   character data/character.json  -> character_data.h (session template text
+#                                     + CharacterTemplate defaults)
+#   map       data/map.json        -> map_data.h (Location/POI/Connection tables
+#                                     with resolved targets + perfect hash)
+#   npc_schedules data/npc_schedules.json -> npc_schedules_data.h (per-minute
+#                                     NpcDayTables + location slot names;
+#                                     locations checked against map.json beside it)
+#
+# Limits mirror include/game_types.h and include/npc_schedule.h.
+MAX_NAME_LENGTH = 64
+MAX_DESC_LENGTH = 256
+MAX_PATH_LENGTH = 128
+MAX_ITEMS = 64
+MAX_COMMANDS = 32
+MAX_LOCATIONS = 64
+MAX_POIS = 16
+MAX_CONNECTIONS = 8
+NPC_MINUTES_PER_DAY = 1440
+NPC_MAX_STATES = 4
+NPC_MAX_LOCATIONS = 64
+NPC_OFF_MAP = 'off_map'
+
+DOLL_STATE_NORMAL = 1
+
+errors = []
+
+
+def fail(message):
+    errors.append(message)
+
+
+def fnv1a(text, seed=0):
+    h = 2166136261 ^ seed
+    for b in text.encode('utf-8'):
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def c_string(text):
+    return '"' + text.replace('\\', '\\\\').replace('"', '\\"').replace('\n', '\\n') + '"'
+
+
+def check_string(value, what, limit):
+    if not isinstance(value, str):
+        fail(f"{what} must be a string")
+        return ''
+    if len(value.encode('utf-8')) >= limit:
+        fail(f"{what} is {len(value.encode('utf-8'))} bytes, limit is {limit - 1}")
+    return value
+
+
+def check_optional_string(value, what):
+    if value is not None and not isinstance(value, str):
+        fail(f"{what} must be a string")
+        return None
+    return value
+
+
+def c_string_or_null(text):
+    return c_string(text) if text is not None else 'NULL'
+
+
+def check_keys(obj, allowed, what):
+    for key in obj:
+        if key not in allowed:
+            fail(f"{what} has unknown key '{key}'")
+
+
+def check_int(value, what):
+    if isinstance(value, bool) or not isinstance(value, int):
+        fail(f"{what} must be an integer")
+        return 0
+    return value
+
+
+def read_json(path):
+    try:
+        with open(path, 'r', encoding='utf-8') as f:
+            text = f.read()
+        return text, json.loads(text)
+    except (OSError, json.JSONDecodeError) as e:
+        print(f"Error: Could not read {path}: {e}", file=sys.stderr)
+        sys.exit(1)
+
+
+def perfect_hash(keys):
+    # Smallest power-of-two table (at least twice the key count) for which some
+    # seed maps every key to its own slot, so a lookup is one probe. The slot is
+    # taken from the top bits: FNV's low bits only see the low bits of the seed.
+    bits = 1
+    while (1 << bits) < 2 * len(keys):
+        bits += 1
+    while True:
+        for seed in range(1 << 16):
+            slots = [fnv1a(k, seed) >> (32 - bits) for k in keys]
+            if len(set(slots)) == len(slots):
+                table = [0] * (1 << bits)
+                for i, slot in enumerate(slots):
+                    table[slot] = i + 1
+                return bits, seed, table
+        bits += 1
+
+
+def c_identifier(prefix, key):
+    name = prefix + ''.join(c if c.isalnum() else '_' for c in key).upper()
+    if not name.isidentifier():
+        fail(f"'{key}' does not make a C identifier")
+    return name
+
+
+# Interned IDs are indices into the generated tables: one bit each in the
+# PlayerState bitsets, so 'limit' is the bitset width.
+def write_id_header(header_path, guard, source, prefix, keys, limit):
+    if len(keys) > limit:
+        fail(f"{len(keys)} entries, limit is {limit}")
+    names = [c_identifier(prefix, k) for k in keys]
+    if len(set(names)) != len(names):
+        fail(f"two IDs map to the same {prefix}* constant")
+    if errors:
+        return
+    body = ['enum {']
+    body.extend(f'    {n} = {i}, // {k}' for i, (n, k) in enumerate(zip(names, keys)))
+    body.append(f'    {prefix}ID_COUNT = {len(keys)}')
+    body.append('};')
+    write_header(header_path, guard, source, body)
+
+
+def write_header(header_path, guard, source, body):
+    out = [f'#ifndef {guard}', f'#define {guard}', '',
+           f'// Auto-generated from {source} by generate_data_tables.py',
+           '// DO NOT EDIT THIS FILE MANUALLY!', '']
+    out.extend(body)
+    out.extend(['', f'#endif // {guard}'])
+    os.makedirs(os.path.dirname(header_path) or '.', exist_ok=True)
+    with open(header_path, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+def generate_items(json_path, header_path, ids_path=None):
+    _, items = read_json(json_path)
+    if not isinstance(items, dict):
+        fail("top level must be an object of item ID -> item")
+        items = {}
+    if len(items) > MAX_ITEMS:
+        fail(f"{len(items)} items, limit is {MAX_ITEMS}")
+
+    rows = []
+    for item_id, item in items.items():
+        check_string(item_id, f"item ID '{item_id}'", MAX_NAME_LENGTH)
+        if not isinstance(item, dict):
+            fail(f"item '{item_id}' must be an object")
+            continue
+        for key in item:
+            if key not in ('name', 'description', 'required_credit'):
+                fail(f"item '{item_id}' has unknown key '{key}'")
+        name = check_string(item.get('name'), f"item '{item_id}' name", MAX_NAME_LENGTH)
+        desc = check_string(item.get('description'), f"item '{item_id}' description", MAX_DESC_LENGTH)
+        credit = check_int(item.get('required_credit', 0), f"item '{item_id}' required_credit")
+        rows.append((item_id, name, desc, credit))
+    if errors:
+        return
+
+    bits, seed, table = perfect_hash([r[0] for r in rows])
+
+    body = ['#include "game_types.h"', '#include <stdint.h>', '',
+            f'#define ITEM_TABLE_COUNT {len(rows)}',
+            f'#define ITEM_HASH_BITS {bits}',
+            '#define ITEM_HASH_SIZE (1 << ITEM_HASH_BITS)',
+            f'#define ITEM_HASH_SEED {seed}u', '',
+            'static const Item g_items[ITEM_TABLE_COUNT] = {']
+    body.append(',\n'.join(f'    {{ {c_string(i)}, {c_string(n)},\n      {c_string(d)}, {c} }}'
+                           for i, n, d, c in rows))
+    body.append('};')
+    body.append('')
+    body.append('// Perfect hash: the top ITEM_HASH_BITS of FNV-1a(id), with the offset basis xor')
+    body.append('// ITEM_HASH_SEED, are distinct for every ID above. Item index + 1, 0 = empty.')
+    body.append('static const int8_t g_item_hash[ITEM_HASH_SIZE] = {')
+    body.append('    ' + ', '.join(str(v) for v in table))
+    body.append('};')
+    write_header(header_path, 'GENERATED_ITEMS_DATA_H', os.path.basename(json_path), body)
+    if ids_path:
+        write_id_header(ids_path, 'GENERATED_ITEM_IDS_H', os.path.basename(json_path), 'ITEM_',
+                        [r[0] for r in rows], MAX_ITEMS)
+
+
+def generate_commands(json_path, header_path, ids_path=None):
+    _, commands = read_json(json_path)
+    if not isinstance(commands, list):
+        fail("top level must be an array of command names")
+        commands = []
+    for i, name in enumerate(commands):
+        check_string(name, f"commands[{i}]", MAX_NAME_LENGTH)
+        if commands.index(name) != i:
+            fail(f"command '{name}' is listed twice")
+    if ids_path is None:
+        fail("commands needs an ids header")
+    if errors:
+        return
+
+    bits, seed, table = perfect_hash(commands)
+    body = ['#include <stdint.h>', '',
+            f'#define COMMAND_TABLE_COUNT {len(commands)}',
+            f'#define COMMAND_HASH_BITS {bits}',
+            '#define COMMAND_HASH_SIZE (1 << COMMAND_HASH_BITS)',
+            f'#define COMMAND_HASH_SEED {seed}u', '',
+            'static const char* const g_command_names[COMMAND_TABLE_COUNT] = {']
+    body.append(',\n'.join('    ' + c_string(c) for c in commands))
+    body.append('};')
+    body.append('')
+    body.append('// Perfect hash, as for the item table. Command index + 1, 0 = empty.')
+    body.append('static const int8_t g_command_hash[COMMAND_HASH_SIZE] = {')
+    body.append('    ' + ', '.join(str(v) for v in table))
+    body.append('};')
+    write_header(header_path, 'GENERATED_COMMAND_DATA_H', os.path.basename(json_path), body)
+    write_id_header(ids_path, 'GENERATED_COMMAND_IDS_H', os.path.basename(json_path), 'COMMAND_',
+                    commands, MAX_COMMANDS)
+
+
+def generate_character(json_path, header_path):
+    text, ch = read_json(json_path)
+    if not isinstance(ch, dict):
+        fail("top level must be an object")
+        ch = {}
+
+    for key in ('credit_level', 'location', 'time_of_day', 'current_story_file', 'unlocked_commands'):
+        if key not in ch:
+            fail(f"missing required key '{key}'")
+
+    credit = check_int(ch.get('credit_level', 0), "credit_level")
+    location = check_string(ch.get('location', ''), "location", MAX_NAME_LENGTH)
+    time_of_day = check_int(ch.get('time_of_day', 0), "time_of_day")
+    if not 0 <= time_of_day <= 0xFFFFFFFF:
+        fail("time_of_day must fit in 32 bits")
+    story = check_string(ch.get('current_story_file', ''), "current_story_file", MAX_PATH_LENGTH)
+    delay = ch.get('typewriter_delay', 0.04)
+    if isinstance(delay, bool) or not isinstance(delay, (int, float)):
+        fail("typewriter_delay must be a number")
+        delay = 0.04
+    persona = check_int(ch.get('persona_permissions', 7), "persona_permissions")
+    doll_lain = check_int(ch.get('doll_state_lain_room', DOLL_STATE_NORMAL), "doll_state_lain_room")
+    doll_mika = check_int(ch.get('doll_state_mika_room', DOLL_STATE_NORMAL), "doll_state_mika_room")
+
+    mika = ch.get('mika_state', {})
+    if not isinstance(mika, dict):
+        fail("mika_state must be an object")
+        mika = {}
+    mika_location = check_string(mika.get('current_location', 'iwakura_mikas_room'),
+                                 "mika_state.current_location", MAX_NAME_LENGTH)
+    mika_manual = mika.get('is_manually_positioned', False)
+    if not isinstance(mika_manual, bool):
+        fail("mika_state.is_manually_positioned must be a boolean")
+    mika_sanity = check_int(mika.get('sanity_level', 0), "mika_state.sanity_level")
+
+    commands = ch.get('unlocked_commands', [])
+    if not isinstance(commands, list):
+        fail("unlocked_commands must be an array")
+        commands = []
+    if len(commands) > MAX_COMMANDS:
+        fail(f"{len(commands)} unlocked_commands, limit is {MAX_COMMANDS}")
+    commands = [check_string(c, f"unlocked_commands[{i}]", MAX_NAME_LENGTH) for i, c in enumerate(commands)]
+
+    inventory = ch.get('inventory', {})
+    if not isinstance(inventory, dict):
+        fail("inventory must be an object of item ID -> quantity")
+        inventory = {}
+    if len(inventory) > MAX_ITEMS:
+        fail(f"{len(inventory)} inventory entries, limit is {MAX_ITEMS}")
+    inventory = [(check_string(k, f"inventory key '{k}'", MAX_NAME_LENGTH), check_int(v, f"inventory['{k}']"))
+                 for k, v in inventory.items()]
+    if errors:
+        return
+
+    body = ['#include "data_loader.h"', '',
+            '// Written verbatim as the character file of a new session.',
+            'static const char* CHARACTER_JSON_DATA =']
+    body.append('\n'.join('    ' + c_string(line + '\n') for line in text.rstrip('\n').split('\n')) + ';')
+    body.append('')
+    body.append('static const char* const CHARACTER_TEMPLATE_COMMANDS[] = {')
+    body.append(',\n'.join('    ' + c_string(c) for c in commands) or '    NULL')
+    body.append('};')
+    body.append('')
+    if inventory:
+        body.append('static const InventoryItem CHARACTER_TEMPLATE_INVENTORY[] = {')
+        body.append(',\n'.join(f'    {{ {c_string(k)}, {v} }}' for k, v in inventory))
+        body.append('};')
+        body.append('')
+    body.append('static const CharacterTemplate CHARACTER_TEMPLATE = {')
+    body.append(f'    .credit_level = {credit},')
+    body.append(f'    .location = {c_string(location)},')
+    body.append(f'    .time_of_day = {time_of_day}u,')
+    body.append(f'    .typewriter_delay = {float(delay)!r}f,')
+    body.append(f'    .current_story_file = {c_string(story)},')
+    body.append(f'    .persona_permissions = {persona},')
+    body.append(f'    .doll_state_lain_room = {doll_lain},')
+    body.append(f'    .doll_state_mika_room = {doll_mika},')
+    body.append(f'    .mika_location = {c_string(mika_location)},')
+    body.append(f'    .mika_is_manually_positioned = {"true" if mika_manual else "false"},')
+    body.append(f'    .mika_sanity_level = {mika_sanity},')
+    body.append('    .unlocked_commands = CHARACTER_TEMPLATE_COMMANDS,')
+    body.append(f'    .unlocked_commands_count = {len(commands)},')
+    body.append(f'    .inventory = {"CHARACTER_TEMPLATE_INVENTORY" if inventory else "NULL"},')
+    body.append(f'    .inventory_count = {len(inventory)}')
+    body.append('};')
+    write_header(header_path, 'GENERATED_CHARACTER_DATA_H', os.path.basename(json_path), body)
+
+
+def read_map_pois(pois, what):
+    if not isinstance(pois, list):
+        fail(f"{what} pois must be an array")
+        return []
+    if len(pois) > MAX_POIS:
+        fail(f"{what} has {len(pois)} POIs, limit is {MAX_POIS}")
+    rows = []
+    for i, poi in enumerate(pois):
+        if not isinstance(poi, dict):
+            fail(f"{what} pois[{i}] must be an object")
+            continue
+        check_keys(poi, ('id', 'name', 'description', 'view_scene', 'action'), f"{what} pois[{i}]")
+        poi_id = check_string(poi.get('id'), f"{what} pois[{i}] id", MAX_NAME_LENGTH)
+        rows.append((poi_id,
+                     check_string(poi.get('name'), f"{what} POI '{poi_id}' name", MAX_NAME_LENGTH),
+                     check_string(poi.get('description'), f"{what} POI '{poi_id}' description", MAX_NAME_LENGTH),
+                     check_optional_string(poi.get('view_scene'), f"{what} POI '{poi_id}' view_scene"),
+                     check_optional_string(poi.get('action'), f"{what} POI '{poi_id}' action")))
+    return rows
+
+
+def read_map_connections(connections, what, gates):
+    if not isinstance(connections, list):
+        fail(f"{what} connections must be an array")
+        return []
+    if len(connections) > MAX_CONNECTIONS:
+        fail(f"{what} has {len(connections)} connections, limit is {MAX_CONNECTIONS}")
+    rows = []
+    for i, conn in enumerate(connections):
+        if not isinstance(conn, dict):
+            fail(f"{what} connections[{i}] must be an object")
+            continue
+        check_keys(conn, ('action', 'to', 'scene', 'gate', 'denied_scene'), f"{what} connections[{i}]")
+        action = check_string(conn.get('action'), f"{what} connections[{i}] action", MAX_NAME_LENGTH)
+        target = check_string(conn.get('to'), f"{what} connection '{action}' to", MAX_NAME_LENGTH)
+        gate = check_optional_string(conn.get('gate'), f"{what} connection '{action}' gate")
+        denied = check_optional_string(conn.get('denied_scene'), f"{what} connection '{action}' denied_scene")
+        if gate is not None and gate not in gates:
+            fail(f"{what} connection '{action}' uses undeclared gate '{gate}'")
+        if (gate is None) != (denied is None):
+            fail(f"{what} connection '{action}' needs both gate and denied_scene, or neither")
+        rows.append((action, target, check_optional_string(conn.get('scene'), f"{what} connection '{action}' scene"),
+                     gate, denied))
+    return rows
+
+
+def generate_map(json_path, header_path):
+    _, data = read_json(json_path)
+    if not isinstance(data, dict):
+        fail("top level must be an object")
+        data = {}
+    check_keys(data, ('gates', 'locations', 'stations'), "top level")
+
+    gates = data.get('gates', [])
+    if not isinstance(gates, list) or not all(isinstance(g, str) and g.isidentifier() for g in gates):
+        fail("gates must be an array of identifiers")
+        gates = []
+
+    # (id, name StringID, name literal, description StringID, pois, connections)
+    locations = []
+    for i, loc in enumerate(data.get('locations', [])):
+        if not isinstance(loc, dict):
+            fail(f"locations[{i}] must be an object")
+            continue
+        check_keys(loc, ('id', 'name', 'description', 'pois', 'connections'), f"locations[{i}]")
+        loc_id = check_string(loc.get('id'), f"locations[{i}] id", MAX_NAME_LENGTH)
+        what = f"location '{loc_id}'"
+        locations.append((loc_id, check_string(loc.get('name'), f"{what} name", MAX_NAME_LENGTH), None,
+                          check_string(loc.get('description'), f"{what} description", MAX_NAME_LENGTH),
+                          read_map_pois(loc.get('pois', []), what),
+                          read_map_connections(loc.get('connections', []), what, gates)))
+
+    # Every station on the loop is the same kind of place: its name comes from
+    # the station table, and it links to its neighbours in both directions,
+    # arriving on the neighbour's scene (data/scenes/map/<id>.ssl).
+    stations = data.get('stations')
+    if stations is not None:
+        if not isinstance(stations, dict):
+            fail("stations must be an object")
+            stations = {}
+        check_keys(stations, ('source', 'description', 'pois', 'next_action', 'prev_action'), "stations")
+        source = check_string(stations.get('source'), "stations source", MAX_PATH_LENGTH)
+        _, table = read_json(os.path.join(os.path.dirname(json_path), source))
+        description = check_string(stations.get('description'), "stations description", MAX_NAME_LENGTH)
+        pois = read_map_pois(stations.get('pois', []), "stations")
+        next_action = check_string(stations.get('next_action'), "stations next_action", MAX_NAME_LENGTH)
+        prev_action = check_string(stations.get('prev_action'), "stations prev_action", MAX_NAME_LENGTH)
+        if not isinstance(table, list) or not table:
+            fail(f"{source} must be a non-empty array of stations")
+            table = []
+        n = len(table)
+        for i, station in enumerate(table):
+            neighbours = [(next_action, table[(i + 1) % n].get('id')), (prev_action, table[(i - 1) % n].get('id'))]
+            links = [(action, to, 'SCENE_' + to.upper() if isinstance(to, str) else None, None, None)
+                     for action, to in neighbours]
+            locations.append((check_string(station.get('id'), f"{source}[{i}] id", MAX_NAME_LENGTH), 'TEXT_INVALID',
+                              check_string(station.get('name'), f"{source}[{i}] name", MAX_NAME_LENGTH),
+                              description, pois, links))
+
+    if len(locations) > MAX_LOCATIONS:
+        fail(f"{len(locations)} locations, limit is {MAX_LOCATIONS}")
+    index = {}
+    for i, loc in enumerate(locations):
+        if loc[0] in index:
+            fail(f"location '{loc[0]}' is defined twice")
+        index.setdefault(loc[0], i)
+    for loc in locations:
+        for action, target, _, _, _ in loc[5]:
+            if target not in index:
+                fail(f"location '{loc[0]}' connection '{action}' leads to unknown location '{target}'")
+    if errors:
+        return
+
+    bits, seed, table = perfect_hash([loc[0] for loc in locations])
+
+    body = ['#include "game_types.h"', '#include <stdint.h>', '',
+            f'#define MAP_LOCATION_COUNT {len(locations)}',
+            f'#define MAP_POI_COUNT {sum(len(loc[4]) for loc in locations)}',
+            f'#define MAP_CONNECTION_COUNT {sum(len(loc[5]) for loc in locations)}',
+            f'#define MAP_HASH_BITS {bits}',
+            '#define MAP_HASH_SIZE (1 << MAP_HASH_BITS)',
+            f'#define MAP_HASH_SEED {seed}u', '']
+    body.append('enum {')
+    body.extend(f'    MAP_GATE_{g.upper()},' for g in gates)
+    body.append('    MAP_GATE_COUNT')
+    body.append('};')
+    body.append('')
+    body.append('static const char* const g_map_gate_names[MAP_GATE_COUNT + 1] = {')
+    body.append(''.join(f'    {c_string(g)},\n' for g in gates) + '    NULL')
+    body.append('};')
+    body.append('')
+
+    loc_rows, poi_rows, conn_rows = [], [], []
+    for loc_id, name, name_text, desc, pois, conns in locations:
+        loc_rows.append(f'    {{ {c_string(loc_id)}, {name}, {c_string_or_null(name_text)}, {desc}, '
+                        f'{len(poi_rows)}, {len(pois)}, {len(conn_rows)}, {len(conns)} }}')
+        for poi_id, poi_name, poi_desc, view_scene, action in pois:
+            poi_rows.append(f'    {{ {c_string(poi_id)}, {poi_name}, {poi_desc}, '
+                            f'{c_string_or_null(view_scene)}, {c_string_or_null(action)} }}')
+        for action, target, scene, gate, denied in conns:
+            gate_value = f'MAP_GATE_{gate.upper()}' if gate is not None else 'MAP_GATE_NONE'
+            conn_rows.append(f'    {{ {c_string(target)}, {index[target]}, {c_string(action)}, {gate_value}, '
+                             f'{c_string_or_null(denied)}, {c_string_or_null(scene)} }}')
+
+    body.append('static const Location g_locations[MAP_LOCATION_COUNT] = {')
+    body.append(',\n'.join(loc_rows))
+    body.append('};')
+    body.append('')
+    body.append('static const POI g_pois[MAP_POI_COUNT] = {')
+    body.append(',\n'.join(poi_rows))
+    body.append('};')
+    body.append('')
+    body.append('static const Connection g_connections[MAP_CONNECTION_COUNT] = {')
+    body.append(',\n'.join(conn_rows))
+    body.append('};')
+    body.append('')
+    body.append('// Perfect hash: the top MAP_HASH_BITS of FNV-1a(id), with the offset basis xor')
+    body.append('// MAP_HASH_SEED, are distinct for every ID above. Location index + 1, 0 = empty.')
+    body.append('static const uint8_t g_location_hash[MAP_HASH_SIZE] = {')
+    body.append('    ' + ', '.join(str(v) for v in table))
+    body.append('};')
+    write_header(header_path, 'GENERATED_MAP_DATA_H', os.path.basename(json_path), body)
+
+
+# "HH:MM" -> minute of day (24:00 allowed as the end of a window), or None.
+def parse_minute(value, what):
+    try:
+        hour, minute = (int(part) for part in value.split(':'))
+    except (AttributeError, ValueError):
+        hour = minute = -1
+    if not (0 <= hour <= 24 and 0 <= minute <= 59 and hour * 60 + minute <= NPC_MINUTES_PER_DAY):
+        fail(f"{what} must be a time \"HH:MM\"")
+        return None
+    return hour * 60 + minute
+
+
+def map_location_ids(map_path):
+    # Every location ID map.json defines, stations included. Its own errors are
+    # left to the map generator.
+    _, data = read_json(map_path)
+    ids = set()
+    if isinstance(data, dict):
+        ids.update(loc.get('id') for loc in data.get('locations', []) if isinstance(loc, dict))
+        stations = data.get('stations')
+        if isinstance(stations, dict) and isinstance(stations.get('source'), str):
+            _, table = read_json(os.path.join(os.path.dirname(map_path), stations['source']))
+            if isinstance(table, list):
+                ids.update(station.get('id') for station in table if isinstance(station, dict))
+    return ids
+
+
+def compile_npc_schedule(entries, slot_of, locations, what):
+    # Entries are sorted by start time; each one runs until the next, and the
+    # last one wraps around midnight to the first.
+    starts = []
+    if not isinstance(entries, list) or not entries:
+        fail(f"{what} schedule must be a non-empty array of [\"HH:MM\", location]")
+        entries = []
+    for i, entry in enumerate(entries):
+        if not isinstance(entry, list) or len(entry) != 2:
+            fail(f"{what} schedule[{i}] must be [\"HH:MM\", location]")
+            continue
+        start = parse_minute(entry[0], f"{what} schedule[{i}] start")
+        location = check_string(entry[1], f"{what} schedule[{i}] location", MAX_NAME_LENGTH)
+        if location and location != NPC_OFF_MAP and location not in locations:
+            fail(f"{what} schedule[{i}] location '{location}' is not in map.json")
+            continue
+        if start is None:
+            continue
+        if start >= NPC_MINUTES_PER_DAY or (starts and start <= starts[-1][0]):
+            fail(f"{what} schedule[{i}] starts at {entry[0]}, after the entry before it and before 24:00")
+            continue
+        starts.append((start, slot_of(location)))
+    if not starts:
+        return [0] * NPC_MINUTES_PER_DAY, [0] * NPC_MINUTES_PER_DAY
+
+    slots = [starts[-1][1]] * NPC_MINUTES_PER_DAY
+    for i, (start, slot) in enumerate(starts):
+        end = starts[i + 1][0] if i + 1 < len(starts) else NPC_MINUTES_PER_DAY
+        slots[start:end] = [slot] * (end - start)
+
+    # Minutes until the slot next differs, wrapping past midnight; 0 if it never does.
+    until = [0] * NPC_MINUTES_PER_DAY
+    if len(set(slots)) > 1:
+        distance = 0
+        for _ in range(2):
+            for m in range(NPC_MINUTES_PER_DAY - 1, -1, -1):
+                distance = 1 if slots[(m + 1) % NPC_MINUTES_PER_DAY] != slots[m] else distance + 1
+                until[m] = distance
+    return slots, until
+
+
+def compile_npc_room_open(windows, what):
+    bits = [0] * (NPC_MINUTES_PER_DAY // 8)
+    if not isinstance(windows, list):
+        fail(f"{what} room_open must be an array of [\"HH:MM\", \"HH:MM\"]")
+        windows = []
+    for i, window in enumerate(windows):
+        if not isinstance(window, list) or len(window) != 2:
+            fail(f"{what} room_open[{i}] must be [\"HH:MM\", \"HH:MM\"]")
+            continue
+        start = parse_minute(window[0], f"{what} room_open[{i}] start")
+        end = parse_minute(window[1], f"{what} room_open[{i}] end")
+        if start is None or end is None:
+            continue
+        m = start % NPC_MINUTES_PER_DAY
+        while m != end % NPC_MINUTES_PER_DAY:
+            bits[m // 8] |= 1 << (m % 8)
+            m = (m + 1) % NPC_MINUTES_PER_DAY
+    return bits
+
+
+def c_array_rows(values, per_line=32):
+    return ',\n'.join('        ' + ', '.join(str(v) for v in values[i:i + per_line])
+                      for i in range(0, len(values), per_line))
+
+
+def generate_npc_schedules(json_path, header_path):
+    _, data = read_json(json_path)
+    if not isinstance(data, dict):
+        fail("top level must be an object of NPC key -> NPC")
+        data = {}
+
+    # Locations are interned into the slots the tables hold; slot 0 is off_map.
+    # Anything else must be a place in map.json, so a typo cannot strand an NPC.
+    locations = map_location_ids(os.path.join(os.path.dirname(json_path), 'map.json'))
+    slot_names = [NPC_OFF_MAP]
+
+    def slot_of(location):
+        if location not in slot_names:
+            slot_names.append(location)
+        return slot_names.index(location)
+
+    npcs, tables = [], []
+    for key, npc in data.items():
+        check_string(key, f"NPC key '{key}'", MAX_NAME_LENGTH)
+        if not isinstance(npc, dict):
+            fail(f"NPC '{key}' must be an object")
+            continue
+        check_keys(npc, ('name', 'states'), f"NPC '{key}'")
+        name = check_string(npc.get('name', key), f"NPC '{key}' name", MAX_NAME_LENGTH)
+        states = npc.get('states', [])
+        if not isinstance(states, list) or len(states) > NPC_MAX_STATES:
+            fail(f"NPC '{key}' states must be an array of at most {NPC_MAX_STATES}")
+            states = []
+        npcs.append((key, name, len(tables), len(states)))
+        for i, state in enumerate(states):
+            what = f"NPC '{key}' states[{i}]"
+            if not isinstance(state, dict):
+                fail(f"{what} must be an object")
+                state = {}
+            check_keys(state, ('state', 'schedule', 'room_open'), what)
+            check_optional_string(state.get('state'), f"{what} state")
+            slots, until = compile_npc_schedule(state.get('schedule'), slot_of, locations, what)
+            tables.append((f"{key}: {state.get('state', i)}", slots, until,
+                           compile_npc_room_open(state.get('room_open', []), what)))
+    if len(slot_names) > NPC_MAX_LOCATIONS:
+        fail(f"{len(slot_names)} locations, limit is {NPC_MAX_LOCATIONS}")
+    if errors:
+        return
+
+    body = ['#include "npc_schedule.h"', '',
+            f'#define NPC_SCHEDULE_COUNT {len(npcs)}',
+            f'#define NPC_SCHEDULE_TABLE_COUNT {len(tables)}',
+            f'#define NPC_SCHEDULE_SLOT_COUNT {len(slot_names)}', '',
+            '// Location slot -> location ID; the tables below hold slots.',
+            'static const char* const g_npc_schedule_slots[NPC_SCHEDULE_SLOT_COUNT] = {']
+    body.append(',\n'.join('    ' + c_string(s) for s in slot_names))
+    body.append('};')
+    body.append('')
+    body.append('static const NpcDayTable g_npc_day_tables[NPC_SCHEDULE_TABLE_COUNT] = {')
+    rows = []
+    for label, slots, until, room_open in tables:
+        rows.append(f'    {{ // {label}\n'
+                    f'      .slot = {{\n{c_array_rows(slots)} }},\n'
+                    f'      .until_change = {{\n{c_array_rows(until, 24)} }},\n'
+                    f'      .room_open = {{\n{c_array_rows(room_open)} }} }}')
+    body.append(',\n'.join(rows))
+    body.append('};')
+    body.append('')
+    body.append('static const NpcSchedule g_npc_schedules[NPC_SCHEDULE_COUNT] = {')
+    body.append(',\n'.join(f'    {{ {c_string(k)}, {c_string(n)}, &g_npc_day_tables[{first}], {count} }}'
+                           for k, n, first, count in npcs))
+    body.append('};')
+    write_header(header_path, 'GENERATED_NPC_SCHEDULES_DATA_H', os.path.basename(json_path), body)
+
+
+GENERATORS = {'items': generate_items, 'commands': generate_commands, 'character': generate_character,
+              'map': generate_map, 'npc_schedules': generate_npc_schedules}
+
+if __name__ == '__main__':
+    if len(sys.argv) not in (4, 5) or sys.argv[1] not in GENERATORS:
+        print("Usage: generate_data_tables.py items|commands|character|map|npc_schedules <input.json> <output.h> [<ids.h>]",
+              file=sys.stderr)
+        sys.exit(1)
+    if len(sys.argv) == 5 and sys.argv[1] not in ('items', 'commands'):
+        print(f"Error: {sys.argv[1]} writes no ids header", file=sys.stderr)
+        sys.exit(1)
+    GENERATORS[sys.argv[1]](*sys.argv[2:])
+    if errors:
+        for message in errors:
+            print(f"Error: {sys.argv[2]}: {message}", file=sys.stderr)
+        sys.exit(1)
@@ -0,0 +1,93 @@
+import json
+import os
+import re
+import struct
+import sys
+
+# Builds a locale pack (.lpk) that the game maps with mmap at boot instead of
+# parsing anything. Layout (little-endian, see include/string_table.h):
+#   header   magic "LLPK", version, string count, STRING_IDS_HASH,
+#            blob size, locale name (12 bytes, NUL-padded)
+#   offsets  uint32 per StringID into the blob; 0xFFFFFFFF = not translated,
+#            the embedded string is used instead
+#   blob     NUL-terminated UTF-8 strings
+#
+# Usage: generate_locale_pack.py <string_ids.h> <out.lpk> <locale> <json...>
+
+MAGIC = b'LLPK'
+VERSION = 1
+MISSING = 0xFFFFFFFF
+LOCALE_NAME_SIZE = 12
+
+
+def ids_hash(names):
+    # Must match generate_string_ids.py.
+    h = 2166136261
+    for name in names:
+        for b in (name + '\n').encode('utf-8'):
+            h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def read_string_ids(header_path):
+    with open(header_path, 'r', encoding='utf-8') as f:
+        text = f.read()
+    body = text[text.index('typedef enum {'):text.index('} StringID;')]
+    names = re.findall(r'^\s+([A-Z0-9_]+)(?:\s*=\s*\d+)?,', body, re.MULTILINE)
+    declared = re.search(r'#define STRING_IDS_HASH (0x[0-9a-f]+)u', text)
+    if declared is None or int(declared.group(1), 16) != ids_hash(names):
+        print(f"Error: {header_path} does not match its STRING_IDS_HASH.", file=sys.stderr)
+        sys.exit(1)
+    return names
+
+
+def main(ids_header, pack_path, locale, json_paths):
+    names = read_string_ids(ids_header)
+    index = {name: i for i, name in enumerate(names)}
+    if len(locale.encode('utf-8')) >= LOCALE_NAME_SIZE:
+        print(f"Error: Locale name '{locale}' is too long.", file=sys.stderr)
+        sys.exit(1)
+
+    strings = {}
+    for json_path in dict.fromkeys(json_paths):
+        try:
+            with open(json_path, 'r', encoding='utf-8') as f:
+                data = json.load(f)
+        except (OSError, json.JSONDecodeError) as e:
+            print(f"Error: Could not read {json_path}: {e}", file=sys.stderr)
+            sys.exit(1)
+        for key, value in data.items():
+            if key not in index:
+                print(f"WARNING: {json_path}: '{key}' is not a known string ID; ignored.", file=sys.stderr)
+                continue
+            if not isinstance(value, str):
+                print(f"Error: {json_path}: '{key}' must be a string.", file=sys.stderr)
+                sys.exit(1)
+            strings[key] = value
+
+    offsets = [MISSING] * len(names)
+    blob = bytearray()
+    for name in names:
+        if name in strings:
+            offsets[index[name]] = len(blob)
+            blob += strings[name].encode('utf-8') + b'\0'
+    if not blob:
+        blob = bytearray(b'\0') # The loader requires a NUL-terminated blob
+
+    out = bytearray()
+    out += struct.pack('<4sIIII', MAGIC, VERSION, len(names), ids_hash(names), len(blob))
+    out += locale.encode('utf-8').ljust(LOCALE_NAME_SIZE, b'\0')
+    out += struct.pack(f'<{len(names)}I', *offsets)
+    out += blob
+
+    os.makedirs(os.path.dirname(pack_path) or '.', exist_ok=True)
+    with open(pack_path, 'wb') as f:
+        f.write(out)
+    print(f"Generated {pack_path}: {len(strings)}/{len(names)} strings, {len(out)} bytes.")
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 5:
+        print("Usage: generate_locale_pack.py <string_ids.h> <out.lpk> <locale> <json1> [json2...]", file=sys.stderr)
+        sys.exit(1)
+    main(sys.argv[1], sys.argv[2], sys.argv[3], sys.argv[4:])
@@ -0,0 +1,151 @@
+import json
+import math
+import sys
+import os
+
+# Compiles sequences/station_coordinates.json (the Yamanote loop in clockwise,
+# outer-loop (外回り) order, each station with the distance to the next one) into const tables, so
+# the game needs no JSON parsing and every lookup is an array read:
+#   - station IDs, names and scenes (data/scenes/map/<id>.ssl),
+#   - loop distance and travel time for every pair, in both directions,
+#   - the fare for every pair (charged on the shorter way round),
+#   - an FNV-1a open-addressing index from station ID to station index.
+
+# Travel time model: running time per km plus a dwell per intermediate stop.
+MINUTES_PER_KM = 1.25
+MINUTES_PER_STOP = 0.5
+
+# Fare bands by whole kilometres (rounded up), in yen.
+FARE_BANDS = [(3, 130), (6, 150), (10, 160), (15, 190), (20, 230), (25, 260), (30, 290), (35, 320)]
+
+ID_HASH_SIZE = 64
+
+
+def fnv1a(text):
+    h = 2166136261
+    for b in text.encode('utf-8'):
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def fare_for(distance_hm):
+    km = math.ceil(distance_hm / 10)
+    for limit, fare in FARE_BANDS:
+        if km <= limit:
+            return fare
+    return FARE_BANDS[-1][1]
+
+
+def c_string(text):
+    return '"' + text.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+def main(json_path, header_path):
+    try:
+        with open(json_path, 'r', encoding='utf-8') as f:
+            stations = json.load(f)
+    except (OSError, json.JSONDecodeError) as e:
+        print(f"Error: Could not read {json_path}: {e}", file=sys.stderr)
+        sys.exit(1)
+
+    n = len(stations)
+    if n == 0 or n >= ID_HASH_SIZE // 2:
+        print(f"Error: Unsupported station count {n}.", file=sys.stderr)
+        sys.exit(1)
+    # Each ID becomes one LocationID (map.json expands the loop from this
+    # file); a repeated one would leave the hash and the map to disagree.
+    ids = [s['id'] for s in stations]
+    for i, station_id in enumerate(ids):
+        if ids.index(station_id) != i:
+            print(f"Error: Station '{station_id}' is listed twice.", file=sys.stderr)
+            sys.exit(1)
+
+    # Distances in hectometres keep the arithmetic integral.
+    segment_hm = [int(round(s['km_to_next'] * 10)) for s in stations]
+    loop_hm = sum(segment_hm)
+    offset_hm = [0] * n
+    for i in range(1, n):
+        offset_hm[i] = offset_hm[i - 1] + segment_hm[i - 1]
+
+    distance = [[[0] * n for _ in range(n)] for _ in range(2)]
+    minutes = [[[0] * n for _ in range(n)] for _ in range(2)]
+    fares = [[0] * n for _ in range(n)]
+    for a in range(n):
+        for b in range(n):
+            if a == b:
+                continue
+            outer = (offset_hm[b] - offset_hm[a]) % loop_hm
+            inner = loop_hm - outer
+            outer_stops = (b - a) % n - 1
+            inner_stops = (a - b) % n - 1
+            distance[0][a][b], distance[1][a][b] = outer, inner
+            minutes[0][a][b] = max(1, round(outer / 10 * MINUTES_PER_KM + outer_stops * MINUTES_PER_STOP))
+            minutes[1][a][b] = max(1, round(inner / 10 * MINUTES_PER_KM + inner_stops * MINUTES_PER_STOP))
+            fares[a][b] = fare_for(min(outer, inner))
+
+    id_hash = [0] * ID_HASH_SIZE
+    for i, s in enumerate(stations):
+        h = fnv1a(s['id']) & (ID_HASH_SIZE - 1)
+        while id_hash[h] != 0:
+            h = (h + 1) & (ID_HASH_SIZE - 1)
+        id_hash[h] = i + 1
+
+    def matrix(rows):
+        return ',\n'.join('    { ' + ', '.join(str(v) for v in row) + ' }' for row in rows)
+
+    out = []
+    out.append('#ifndef GENERATED_STATION_TABLE_H')
+    out.append('#define GENERATED_STATION_TABLE_H')
+    out.append('')
+    out.append(f'// Auto-generated from {os.path.basename(json_path)} by generate_station_table.py')
+    out.append('// DO NOT EDIT THIS FILE MANUALLY!')
+    out.append('')
+    out.append('#include <stdint.h>')
+    out.append('')
+    out.append(f'#define YAMANOTE_STATION_COUNT {n}')
+    out.append(f'#define YAMANOTE_LOOP_HM {loop_hm}')
+    out.append(f'#define YAMANOTE_ID_HASH_SIZE {ID_HASH_SIZE}')
+    out.append('')
+    out.append('static const char* const YAMANOTE_STATION_IDS[YAMANOTE_STATION_COUNT] = {')
+    out.append(',\n'.join('    ' + c_string(s['id']) for s in stations))
+    out.append('};')
+    out.append('')
+    out.append('static const char* const YAMANOTE_STATION_NAMES[YAMANOTE_STATION_COUNT] = {')
+    out.append(',\n'.join('    ' + c_string(s['name']) for s in stations))
+    out.append('};')
+    out.append('')
+    out.append('// The scene shown on arrival, named after the station as its .ssl file is.')
+    out.append('static const char* const YAMANOTE_STATION_SCENES[YAMANOTE_STATION_COUNT] = {')
+    out.append(',\n'.join('    ' + c_string('SCENE_' + s['id'].upper()) for s in stations))
+    out.append('};')
+    out.append('')
+    out.append('// [direction][from][to]; direction 0 follows the list (outer loop, 外回り), 1 runs against it (inner loop, 内回り).')
+    out.append('static const uint16_t YAMANOTE_DISTANCE_HM[2][YAMANOTE_STATION_COUNT][YAMANOTE_STATION_COUNT] = {')
+    out.append(',\n'.join('  {\n' + matrix(distance[d]) + '\n  }' for d in range(2)))
+    out.append('};')
+    out.append('')
+    out.append('static const uint8_t YAMANOTE_MINUTES[2][YAMANOTE_STATION_COUNT][YAMANOTE_STATION_COUNT] = {')
+    out.append(',\n'.join('  {\n' + matrix(minutes[d]) + '\n  }' for d in range(2)))
+    out.append('};')
+    out.append('')
+    out.append('static const uint16_t YAMANOTE_FARE_YEN[YAMANOTE_STATION_COUNT][YAMANOTE_STATION_COUNT] = {')
+    out.append(matrix(fares))
+    out.append('};')
+    out.append('')
+    out.append('// FNV-1a(id) & (YAMANOTE_ID_HASH_SIZE - 1), linear probing; station index + 1, 0 = empty.')
+    out.append('static const int8_t YAMANOTE_ID_HASH[YAMANOTE_ID_HASH_SIZE] = {')
+    out.append('    ' + ', '.join(str(v) for v in id_hash))
+    out.append('};')
+    out.append('')
+    out.append('#endif // GENERATED_STATION_TABLE_H')
+
+    os.makedirs(os.path.dirname(header_path), exist_ok=True)
+    with open(header_path, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print("Usage: generate_station_table.py <station_coordinates.json> <station_table.h>", file=sys.stderr)
+        sys.exit(1)
+    main(sys.argv[1], sys.argv[2])
@@ -1,13 +1,68 @@
 import json
 import sys
 import os
+import zlib
+from collections import defaultdict
+
+# Story text is stored as one zlib block per source module (strings.json and
+# each strings_extra/*.json), compressed against a preset dictionary trained
+# on the whole corpus so that even small modules compress well. The game
+# inflates a module's block the first time one of its strings is used.
+# The dictionary is trimmed to whichever size gives the smallest pool.
+DICTIONARY_SIZES = [0, 256, 512, 1024, 2048, 4096, 8192]
+DICTIONARY_MIN_BYTES = 6     # Shorter phrases are cheaper as zlib literals
+DICTIONARY_MAX_CHARS = 24
+
+
+def train_dictionary(module_texts, max_size):
+    # Phrases are scored by how many modules share them times their length:
+    # text that only ever occurs in one module already compresses against
+    # itself inside that block.
+    seen_in = defaultdict(set)
+    for module, text in module_texts.items():
+        for start in range(len(text)):
+            for length in range(2, DICTIONARY_MAX_CHARS + 1):
+                if start + length > len(text):
+                    break
+                seen_in[text[start:start + length]].add(module)
+    candidates = []
+    for phrase, modules in seen_in.items():
+        size = len(phrase.encode('utf-8'))
+        if len(modules) > 1 and size >= DICTIONARY_MIN_BYTES and '\0' not in phrase:
+            candidates.append(((len(modules) - 1) * size, phrase))
+    candidates.sort(key=lambda c: (-c[0], c[1]))
+
+    chosen, used = [], 0
+    for _, phrase in candidates:
+        size = len(phrase.encode('utf-8'))
+        if used + size > max_size or any(phrase in c for c in chosen):
+            continue
+        chosen.append(phrase)
+        used += size
+    # zlib reaches the end of the dictionary most cheaply, so the best phrases go last.
+    return ''.join(reversed(chosen)).encode('utf-8')
+
+
+def ids_hash(names):
+    # FNV-1a over the ID names in enum order; locale packs carry the same value
+    # so a pack built against a different string set is rejected at load time.
+    h = 2166136261
+    for name in names:
+        for b in (name + '\n').encode('utf-8'):
+            h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def c_bytes(data, indent='    '):
+    return ',\n'.join(indent + ', '.join(f'0x{b:02x}' for b in data[i:i + 16]) for i in range(0, len(data), 16))
 
 def generate_string_ids_h(json_paths, header_path, names_header_path, names_c_path, data_c_path):
     merged_data = {}
+    module_of = {}
     
     print(f"Processing {len(json_paths)} string data files...")
 
-    for json_path in json_paths:
+    for json_path in dict.fromkeys(json_paths): # The CMake glob can list a file twice
         try:
             with open(json_path, 'r', encoding='utf-8') as f:
                 data = json.load(f)
@@ -17,6 +72,7 @@ def generate_string_ids_h(json_paths, header_path, names_header_path, names_c_pa
                         print(f"    Old value: '{merged_data[key]}'", file=sys.stderr)
                         print(f"    New value: '{value}' (Overwriting)", file=sys.stderr)
                     merged_data[key] = value
+                    module_of[key] = os.path.splitext(os.path.basename(json_path))[0]
                     
         except FileNotFoundError:
             print(f"Error: JSON file not found at {json_path}", file=sys.stderr)
@@ -53,6 +109,8 @@ def generate_string_ids_h(json_paths, header_path, names_header_path, names_c_pa
                 generated_ids_count += 1
         f.write(f"    TEXT_COUNT // Total number of strings, which is {generated_ids_count}\n")
         f.write("} StringID;\n\n")
+        enum_order = ["TEXT_INVALID", "TEXT_EMPTY_LINE"] + [i for i in ids if i not in ["TEXT_INVALID", "TEXT_EMPTY_LINE"]]
+        f.write(f"#define STRING_IDS_HASH 0x{ids_hash(enum_order):08x}u\n\n")
         f.write("#endif // STRING_IDS_H\n")
 
     print(f"Generated {header_path} with {generated_ids_count} string IDs.")
@@ -86,24 +144,65 @@ def generate_string_ids_h(json_paths, header_path, names_header_path, names_c_pa
 
     print(f"Generated {names_c_path} (definition).")
     
-    # Generate generated_string_data.c (embedded string values)
-    with open(data_c_path, 'w', encoding='utf-8') as f:
-        f.write("#include \"string_ids.h\"\n\n")
-        f.write("const char* g_embedded_strings[TEXT_COUNT] = {\n")
-        f.write("    [TEXT_INVALID] = \"ERROR: Invalid Text ID (Embedded Fallback)\",\n")
-        f.write("    [TEXT_EMPTY_LINE] = \"\",\n")
-        
-        id_to_value_map = {key: merged_data[key] for key in ids}
+    # Generate generated_string_data.c (compressed string pool)
+    modules = {}
+    for _id in ids:
+        if _id not in ["TEXT_INVALID", "TEXT_EMPTY_LINE"]:
+            modules.setdefault(module_of[_id], []).append(_id)
+    module_names = sorted(modules)
+    if len(module_names) > 255:
+        print("Error: Too many string modules for the pool (max 255).", file=sys.stderr)
+        sys.exit(1)
+
+    entries = {}
+    raw_blocks = []
+    for block, module in enumerate(module_names):
+        raw = bytearray()
+        for _id in modules[module]:
+            entries[_id] = (block, len(raw))
+            raw += merged_data[_id].encode('utf-8') + b'\0'
+        raw_blocks.append(bytes(raw))
+
+    trained = train_dictionary({m: b.decode('utf-8') for m, b in zip(module_names, raw_blocks)}, DICTIONARY_SIZES[-1])
+    best = None
+    for size in DICTIONARY_SIZES:
+        dictionary = trained[len(trained) - size:] if size else b''
+        blocks = []
+        for raw in raw_blocks:
+            z = zlib.compressobj(9, zlib.DEFLATED, 15, 9, zlib.Z_DEFAULT_STRATEGY, dictionary) if dictionary \
+                else zlib.compressobj(9)
+            blocks.append(z.compress(raw) + z.flush())
+        total = len(dictionary) + sum(len(b) for b in blocks)
+        if best is None or total < best[0]:
+            best = (total, dictionary, blocks)
+    _, dictionary, compressed_blocks = best
 
+    with open(data_c_path, 'w', encoding='utf-8') as f:
+        f.write("#include \"string_ids.h\"\n")
+        f.write("#include \"string_table.h\"\n\n")
+        f.write(f"const unsigned int g_string_pool_dictionary_size = {len(dictionary)};\n")
+        f.write(f"const unsigned char g_string_pool_dictionary[{max(len(dictionary), 1)}] = {{\n")
+        f.write((c_bytes(dictionary) or "    0x00") + "\n};\n\n")
+        for block, data in enumerate(compressed_blocks):
+            f.write(f"static const unsigned char block_{block}[] = {{ // {module_names[block]}\n")
+            f.write(c_bytes(data) + "\n};\n\n")
+        f.write(f"const int g_string_pool_block_count = {len(module_names)};\n")
+        f.write("const StringPoolBlock g_string_pool_blocks[] = {\n")
+        for block, module in enumerate(module_names):
+            f.write(f"    {{ \"{module}\", block_{block}, {len(compressed_blocks[block])}, {len(raw_blocks[block])} }},\n")
+        f.write("};\n\n")
+        f.write("const StringPoolEntry g_string_pool_entries[TEXT_COUNT] = {\n")
+        f.write("    [TEXT_INVALID] = { STRING_POOL_BUILTIN, 0 },\n")
+        f.write("    [TEXT_EMPTY_LINE] = { STRING_POOL_BUILTIN, 1 },\n")
         for _id in ids:
             if _id not in ["TEXT_INVALID", "TEXT_EMPTY_LINE"]:
-                value = id_to_value_map[_id]
-                escaped_value = value.replace('\\', '\\\\').replace('"', '\\"').replace('\n', '\\n')
-                f.write(f"    [{_id}] = \"{escaped_value}\",\n")
-        
-        f.write("};\n\n")
+                f.write(f"    [{_id}] = {{ {entries[_id][0]}, {entries[_id][1]} }},\n")
+        f.write("};\n")
 
-    print(f"Generated {data_c_path} (embedded string data).")
+    raw_total = sum(len(b) for b in raw_blocks)
+    packed_total = sum(len(b) for b in compressed_blocks) + len(dictionary)
+    print(f"String pool: {len(module_names)} blocks, {raw_total} bytes -> {packed_total} bytes (dictionary {len(dictionary)}).")
+    print(f"Generated {data_c_path} (compressed string pool).")
 
 
 if __name__ == "__main__":
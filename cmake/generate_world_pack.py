@@ -0,0 +1,109 @@
+import os
+import stat
+import struct
+import sys
+import zlib
+
+# Packs the in-game file tree (world/) into a read-only image the game maps
+# with mmap at boot (see include/world_vfs.h). Layout, little-endian:
+#   header   magic "LWPK", version, entry count, names size, data size
+#   entries  WorldPackEntry per file or directory, breadth first, so every
+#            directory's children are contiguous; siblings sorted by name bytes.
+#            Entry 0 is the root.
+#   names    NUL-terminated entry names
+#   data     file contents, zlib-compressed where that saves space, else stored
+#
+# Symlinks and anything that is not a regular file or directory are refused,
+# so the image can only ever contain what is under world/.
+#
+# Usage: generate_world_pack.py <world_dir> <out.wpk>
+
+MAGIC = b'LWPK'
+VERSION = 1
+FLAG_DIR = 0x1
+FLAG_COMPRESSED = 0x2
+FLAG_EXEC = 0x4
+NAME_MAX = 128  # VFS_NAME_MAX
+PATH_MAX = 256  # VFS_PATH_MAX
+ENTRY = struct.Struct('<6I')  # name, parent, flags, first, count, size
+
+
+def fail(message):
+    print(f"Error: {message}", file=sys.stderr)
+    sys.exit(1)
+
+
+def main(world_dir, pack_path):
+    if not os.path.isdir(world_dir):
+        fail(f"{world_dir} is not a directory")
+
+    # [name, parent, flags, first, count, size, host path]
+    entries = [[0, 0, FLAG_DIR, 0, 0, 0, world_dir]]
+    names = bytearray(b'\0')
+    data = bytearray()
+    virtual_paths = {0: ''}
+    stored_bytes = 0
+
+    queue = [0]
+    while queue:
+        index = queue.pop(0)
+        host_dir = entries[index][6]
+        children = sorted(os.listdir(host_dir), key=lambda n: n.encode('utf-8'))
+        entries[index][3] = len(entries)
+        entries[index][4] = len(children)
+        for name in children:
+            host_path = os.path.join(host_dir, name)
+            encoded = name.encode('utf-8')
+            virtual = virtual_paths[index] + '/' + name
+            if len(encoded) >= NAME_MAX:
+                fail(f"{host_path}: name is longer than {NAME_MAX - 1} bytes")
+            if len(virtual.encode('utf-8')) >= PATH_MAX:
+                fail(f"{host_path}: path is longer than {PATH_MAX - 1} bytes")
+
+            st = os.lstat(host_path)
+            child = len(entries)
+            entry = [len(names), index, 0, 0, 0, 0, host_path]
+            names += encoded + b'\0'
+            if stat.S_ISDIR(st.st_mode):
+                entry[2] = FLAG_DIR
+                queue.append(child)
+            elif stat.S_ISREG(st.st_mode):
+                with open(host_path, 'rb') as f:
+                    content = f.read()
+                packed = zlib.compress(content, 9)
+                flags = FLAG_EXEC if st.st_mode & stat.S_IXUSR else 0
+                if len(packed) < len(content) * 9 // 10:
+                    flags |= FLAG_COMPRESSED
+                else:
+                    packed = content
+                entry[2] = flags
+                entry[3] = len(data)
+                entry[4] = len(packed)
+                entry[5] = len(content)
+                data += packed
+                stored_bytes += len(content)
+            else:
+                fail(f"{host_path}: only regular files and directories can be packed")
+            virtual_paths[child] = virtual
+            entries.append(entry)
+
+    out = bytearray()
+    out += struct.pack('<4sIIII', MAGIC, VERSION, len(entries), len(names), len(data))
+    for e in entries:
+        out += ENTRY.pack(*e[:6])
+    out += names
+    out += data
+
+    os.makedirs(os.path.dirname(pack_path) or '.', exist_ok=True)
+    with open(pack_path, 'wb') as f:
+        f.write(out)
+    files = sum(1 for e in entries if not e[2] & FLAG_DIR)
+    print(f"Generated {pack_path}: {files} files, {len(entries) - files} directories, "
+          f"{stored_bytes} -> {len(out)} bytes.")
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print("Usage: generate_world_pack.py <world_dir> <out.wpk>", file=sys.stderr)
+        sys.exit(1)
+    main(sys.argv[1], sys.argv[2])
@@ -0,0 +1,62 @@
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+#include <stdatomic.h>
+#include "game_types.h"
+#include "save_state.h"
+
+// Crash-safe autosave of a session's .sav file.
+//
+// The main thread serialises the state (microseconds, under time_mutex) and
+// hands the buffer to a writer thread, so the UI never waits on storage.
+// Full snapshots replace the .sav with write_file_atomic(). Between them,
+// each player action appends a delta record (save_state_encode_delta()) to
+// "<session>.journal", which is fdatasync'd; once the journal passes
+// AUTOSAVE_JOURNAL_MAX_RECORDS or _BYTES the next save is a full snapshot
+// and the journal starts over.
+//
+// Journal layout, little-endian: "LDJN", u32 version, u32 CRC-32 of the
+// snapshot file it extends, then records of u32 size + one delta save. The
+// CRC ties the journal to its snapshot: one left behind by a crash between a
+// snapshot and the journal reset is ignored rather than replayed over newer
+// state. A torn last record fails its own checks and ends the replay.
+
+#define AUTOSAVE_JOURNAL_EXTENSION ".journal"
+#define AUTOSAVE_JOURNAL_MAGIC "LDJN"
+#define AUTOSAVE_JOURNAL_VERSION 1
+#define AUTOSAVE_JOURNAL_MAX_RECORDS 256
+#define AUTOSAVE_JOURNAL_MAX_BYTES (64 * 1024)
+#define AUTOSAVE_PERIOD_MS 30000 // Record at least this often while time passes
+
+typedef enum {
+    AUTOSAVE_FILE_REPLACE, // write_file_atomic()
+    AUTOSAVE_FILE_APPEND   // Added to the end of an existing file and fdatasync'd
+} AutosaveFileMode;
+
+// Loads the snapshot at save_path and replays its journal on top.
+// *replayed_out (may be NULL) receives the number of records applied.
+SaveStateStatus autosave_recover(const char* save_path, GameState* game_state, int* replayed_out);
+
+// Starts the writer thread and queues a snapshot of the current state as the
+// journal's base. The autosave functions below are for the main thread only,
+// with the game state held still (time_mutex).
+bool autosave_start(const char* save_path, const GameState* game_state);
+
+// Journals what changed since the last record, or snapshots when the journal
+// is full or the writer reported a failure.
+void autosave_record(const GameState* game_state);
+
+// autosave_record() if AUTOSAVE_PERIOD_MS have passed since the last record.
+void autosave_poll(const GameState* game_state);
+
+// Queues a final snapshot and waits for the writer to finish it.
+void autosave_shutdown(const GameState* game_state);
+
+// Writes another of the session's files (the world overlay) on the writer
+// thread, in order with everything queued there; snapshots never supersede
+// these. Takes ownership of 'data'. A failure sets '*failed' (may be NULL)
+// from the writer thread. Before autosave_start() and after shutdown the
+// write happens at once, on the caller's thread.
+void autosave_write_file(const char* path, AutosaveFileMode mode, unsigned char* data, size_t size, atomic_bool* failed);
+
+#endif // AUTOSAVE_H
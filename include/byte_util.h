@@ -0,0 +1,47 @@
+#ifndef BYTE_UTIL_H
+#define BYTE_UTIL_H
+
+#include <stdint.h>
+
+// Helpers shared by the binary formats (saves, the autosave journal, the
+// world overlay) and the hashed lookup tables. Internal to the engine.
+
+// --- Byte Order ---
+
+// Every on-disk integer is little-endian, whatever the host.
+static inline void store_u16(unsigned char* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static inline uint16_t load_u16(const unsigned char* p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static inline void store_u32(unsigned char* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+static inline uint32_t load_u32(const unsigned char* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// --- Hashing ---
+
+// 32-bit FNV-1a of a string. The generated tables (cmake/generate_*.py) are
+// built with the same function; a nonzero 'seed' is XORed into the offset
+// basis, as their perfect hashes are searched for.
+static inline uint32_t fnv1a_seeded(const char* s, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (; *s; s++) h = (h ^ (uint8_t)*s) * 16777619u;
+    return h;
+}
+
+static inline uint32_t fnv1a(const char* s) {
+    return fnv1a_seeded(s, 0);
+}
+
+#endif // BYTE_UTIL_H
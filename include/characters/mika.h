@@ -16,11 +16,10 @@ typedef enum {
     MIKA_SANITY_BROKEN = 3     // Routine collapsed, catatonic or erratic
 } MikaSanityLevel;
 
-// A struct to encapsulate Mika's state and behaviors
+// A struct to encapsulate Mika's behaviors. Where she is lives in the NPC
+// schedule engine (npc_schedule.h); her sanity level selects her schedule.
 typedef struct {
     // State
-    const char* current_location_id;
-    bool is_manually_positioned;
     MikaSanityLevel sanity_level;
 
     // Behaviors (function pointers)
@@ -32,12 +31,6 @@ typedef struct {
 // Provides access to the single instance of Mika's logic module.
 CharacterMika* get_mika_module(); // Changed to non-const to allow modification
 
-// Defines a single entry in a character's daily schedule
-typedef struct {
-    uint32_t start_time_units; // Time of day (in 1/16s units) this entry begins
-    const char* location_id;   // The location ID for this time block
-} ScheduleEntry;
-
 // Initializes the Mika module, setting up its function pointers.
 void init_mika_module();
 
@@ -60,4 +53,8 @@ void mika_set_sanity(MikaSanityLevel level);
 // Helper for debugging/testing: Calculates scheduled location without game state side effects
 const char* mika_calculate_scheduled_location(uint32_t time_units_in_day, MikaSanityLevel sanity);
 
+// Where Mika currently is, schedule-driven or manually placed.
+const char* mika_current_location(void);
+bool mika_is_manually_positioned(void);
+
 #endif // CHARACTER_MIKA_H
\ No newline at end of file
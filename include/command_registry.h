@@ -0,0 +1,57 @@
+#ifndef COMMAND_REGISTRY_H
+#define COMMAND_REGISTRY_H
+
+#include <stdbool.h>
+#include "command_trie.h"
+#include "line_editor.h"
+
+// A prompt's command table (the main prompt, the NAVI menus, the NAVI shell).
+// Command words are dispatched through a CommandTrie, and the same trie
+// completes them on Tab; the word after a command completes against a trie
+// the prompt supplies for the kind of argument it takes.
+
+typedef enum {
+    COMMAND_ARG_NONE,       // Nothing to complete
+    COMMAND_ARG_POI,        // POI ID at the player's location
+    COMMAND_ARG_CONNECTION, // Connection action ID at the player's location
+    COMMAND_ARG_LOCATION,   // Any location ID
+    COMMAND_ARG_PATH        // Path in the NAVI shell's file tree
+} CommandArgKind;
+
+// 'arg' is the rest of the line with surrounding spaces trimmed ("" if none).
+// What the return value means is up to the prompt (the main prompt: re-render).
+typedef bool (*CommandHandler)(void* context, const char* arg);
+
+typedef struct {
+    const char* name;
+    CommandArgKind arg;
+    CommandHandler handler;
+    bool hidden; // Dispatched, but never offered by completion or hints
+} CommandSpec;
+
+// Returns the trie the argument 'arg' (typed so far) completes against, or
+// NULL. *word_start is set to where in 'arg' its keys begin (after the last
+// '/' of a path, say). Called with the registry's caller context.
+typedef const CommandTrie* (*CommandArgTrieFunc)(void* context, CommandArgKind kind, const char* arg, size_t* word_start);
+
+typedef struct CommandRegistry CommandRegistry;
+
+// 'specs' must outlive the registry. 'arg_trie' may be NULL.
+CommandRegistry* command_registry_create(const CommandSpec* specs, int count, CommandArgTrieFunc arg_trie);
+void command_registry_free(CommandRegistry* registry);
+
+// Runs the command 'input' names. Returns false if it names none; otherwise
+// *result (if given) receives the handler's return value.
+bool command_registry_dispatch(const CommandRegistry* registry, const char* input, void* context, bool* result);
+
+// Completion for the first 'cursor' bytes of 'line'. A single match is
+// completed with a trailing space (or none after a directory's '/').
+void command_registry_complete(const CommandRegistry* registry, const char* line, size_t cursor,
+                               void* context, LineEditorCompletion* out);
+
+// For "did you mean": writes the visible commands sharing the longest prefix
+// (two bytes at least) with the first word of 'input' into 'out', comma
+// separated, or "" if there are none.
+void command_registry_hint(const CommandRegistry* registry, const char* input, char* out, size_t size);
+
+#endif // COMMAND_REGISTRY_H
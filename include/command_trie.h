@@ -0,0 +1,34 @@
+#ifndef COMMAND_TRIE_H
+#define COMMAND_TRIE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "line_editor.h"
+
+// A radix trie from short names (command words, POI and action IDs, file names)
+// to small integers. Edges carry whole runs of bytes, so a lookup compares each
+// byte of the key once however many names share its prefix, and the node a
+// prefix ends at holds everything needed to complete it.
+
+typedef struct CommandTrie CommandTrie;
+
+CommandTrie* command_trie_create(void);
+void command_trie_free(CommandTrie* trie);
+void command_trie_clear(CommandTrie* trie);
+
+// Maps 'key' (non-empty, NUL-free) to 'value' (>= 0), replacing any previous
+// value. Returns false on allocation failure.
+bool command_trie_insert(CommandTrie* trie, const char* key, int value);
+// Returns false if 'key' was not there.
+bool command_trie_remove(CommandTrie* trie, const char* key);
+
+// The value of the first 'len' bytes of 'key', or -1.
+int command_trie_find(const CommandTrie* trie, const char* key, size_t len);
+int command_trie_count(const CommandTrie* trie);
+
+// Completes the first 'len' bytes of 'prefix': out->insert receives what every
+// matching key continues with, out->matches the matching keys (up to
+// LINE_EDITOR_COMPLETION_MAX, in byte order) and out->match_count all of them.
+void command_trie_complete(const CommandTrie* trie, const char* prefix, size_t len, LineEditorCompletion* out);
+
+#endif // COMMAND_TRIE_H
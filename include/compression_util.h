@@ -21,4 +21,17 @@ int compress_string(const char* input, unsigned char** compressed_data, unsigned
 int decompress_string(const unsigned char* compressed_data, unsigned long compressed_data_len,
                       unsigned char** decompressed_data, unsigned long* decompressed_data_len);
 
+// Function to decompress a stream of known size into a caller-owned buffer
+// compressed_data: The compressed data buffer.
+// compressed_data_len: The length of the compressed data.
+// dictionary: The preset dictionary the data was compressed against, or NULL.
+// dictionary_len: The length of the dictionary.
+// out: The buffer to decompress into; it must hold exactly out_len bytes.
+// out_len: The expected length of the decompressed data.
+//
+// Returns 0 on success, non-zero on error (including a size mismatch).
+int decompress_with_dictionary(const unsigned char* compressed_data, unsigned long compressed_data_len,
+                               const unsigned char* dictionary, unsigned int dictionary_len,
+                               unsigned char* out, unsigned long out_len);
+
 #endif // COMPRESSION_UTIL_H
@@ -29,15 +29,50 @@ typedef enum {
 DataLoaderStatus read_entire_file(const char* path, char** buffer_ptr, long* length_ptr);
 
 /**
- * @brief Loads the initial game state, including items and player data.
+ * @brief Looks up an item in the table compiled from data/items.json.
  *
- * @param game_state A pointer to the main GameState struct to be populated.
- * @return 1 on success, 0 on failure.
+ * The table and its perfect hash are generated at build time
+ * (cmake/generate_data_tables.py), so this is one probe and one strcmp.
+ *
+ * @param item_id The item ID, e.g. "screwdriver".
+ * @return The item, or NULL if no item has that ID.
  */
-int load_items_data(GameState* game_state);
+const Item* find_item_by_id(const char* item_id);
+// An item's ItemID is its index in the compiled table (ITEM_* in item_ids.h).
+ItemID item_id_from_string(const char* item_id); // ITEM_NONE if unknown
+const Item* item_by_id(ItemID item); // NULL if out of range
+
+// Defaults for a new character, compiled from data/character.json. Fields
+// missing from a session's character file fall back to these.
+typedef struct {
+    int credit_level;
+    const char* location;
+    uint32_t time_of_day;
+    float typewriter_delay;
+    const char* current_story_file;
+    uint8_t persona_permissions;
+    int8_t doll_state_lain_room;
+    int8_t doll_state_mika_room;
+    const char* mika_location;
+    bool mika_is_manually_positioned;
+    int mika_sanity_level;
+    const char* const* unlocked_commands;
+    int unlocked_commands_count;
+    const InventoryItem* inventory;
+    int inventory_count;
+} CharacterTemplate;
+
+const CharacterTemplate* character_template(void);
+
+// The text of data/character.json, written as a new session's character file.
+const char* character_template_json(void);
 
 int load_player_state(const char* path, GameState* game_state);
-int save_game_state(const char* path, const GameState* game_state);
+
+// Writes the game state as character.json-style JSON, with the flag store and
+// every NPC added. Sessions are saved in the binary format (save_state.h);
+// this is the readable form for debugging, and load_player_state() reads it back.
+int export_game_state_json(const char* path, const GameState* game_state);
 void cleanup_game_state(GameState* game_state);
 int load_string_table();
 
@@ -2,38 +2,63 @@
 #define EVENT_SYSTEM_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 // Enum to define all possible event types in the game
 typedef enum {
     EVENT_TYPE_NONE,
-    TIME_TICK_EVENT,      // Fired every in-game second
-    // Add other event types here in the future, e.g.,
-    // INPUT_RECEIVED_EVENT,
-    // SCENE_LOADED_EVENT,
+    TIME_TICK_EVENT,        // Fired every in-game second; coalesced, see data.tick.count
+    INPUT_EVENT,            // Terminal input became readable
+    RESIZE_EVENT,           // SIGWINCH
+    TIMER_EVENT,            // A scheduled timer expired
+    SCENE_DEADLINE_EVENT,   // A scene-level deadline (auto event, takeover line) is due
+    WORKER_DONE_EVENT,      // A background worker finished a job
+    WORLD_FILE_EVENT,       // A file was delivered into or removed from the world (world_watch.h)
+    EVENT_TYPE_COUNT
 } EventType;
 
-// A generic Event structure. 
-// It can be extended with a union to hold different data for different event types.
+// A generic Event structure; 'data' is interpreted according to 'type'.
 typedef struct {
     EventType type;
-    // Example of event-specific data:
-    // union {
-    //     struct { int seconds_passed; } time_tick_data;
-    //     struct { char* input; } input_received_data;
-    // } data;
+    union {
+        struct { uint32_t count; } tick;                      // Ticks folded into this event
+        struct { int fd; } input;
+        struct { int rows; int cols; } resize;                // 0 if unknown
+        struct { uint32_t timer_id; uint64_t due_ms; } timer;
+        struct { uint32_t deadline_id; uint64_t due_ms; } scene_deadline;
+        struct { int worker_id; int status; } worker;
+        struct { uint32_t change_id; } world_file;           // See world_watch_change()
+    } data;
 } Event;
 
-#define MAX_EVENTS 100
+// Ring capacity; must be a power of two.
+#define MAX_EVENTS 256
 
-// Initializes the event queue.
+// Counters since init_event_queue(); all monotonic.
+typedef struct {
+    uint64_t pushed;                       // Events accepted into the ring
+    uint64_t polled;                       // Events handed to the consumer
+    uint64_t dropped[EVENT_TYPE_COUNT];    // Pushes rejected because the ring was full
+    uint64_t ticks_produced;               // push_tick_event() calls
+    uint64_t tick_events;                  // Tick events delivered (ticks_produced / tick_events = coalescing ratio)
+} EventQueueStats;
+
+// Initializes the event queue. Not thread-safe; call before any producer starts.
 void init_event_queue(void);
 
-// Pushes a new event to the queue.
-// Returns true on success, false if the queue is full.
+// Pushes a new event to the queue. Lock-free and safe from any thread and from
+// signal handlers. Returns true on success, false if the queue is full.
 bool push_event(Event e);
 
-// Polls for the next event from the queue.
+// Records one time tick. Ticks that pile up before the consumer polls are
+// delivered as a single TIME_TICK_EVENT whose data.tick.count says how many.
+// Never fails: if the ring is full the count is kept and delivered later.
+void push_tick_event(void);
+
+// Polls for the next event from the queue. Single consumer only (the main loop).
 // Returns true if an event was retrieved, false if the queue is empty.
 bool poll_event(Event *e);
 
+void get_event_queue_stats(EventQueueStats* out_stats);
+
 #endif // EVENT_SYSTEM_H
@@ -2,16 +2,29 @@
 #define EXECUTOR_H
 
 #include "game_types.h"
+#include "line_editor.h"
 
 // Executes an action based on its ID
 // Returns 1 if the action caused a scene change, 0 otherwise.
 int execute_action(const char* action_id, GameState* game_state);
 
+// Resolves the scene IDs an action may lead to from the player's current location,
+// without executing it. Writes up to max_ids pointers into out_ids and returns the count.
+// Actions with dynamic outcomes (NAVI apps, conditional branches) yield no candidates.
+int get_action_scene_candidates(const char* action_id, const GameState* game_state, const char** out_ids, int max_ids);
+
+// Minutes the clock advances when the action is executed (0 for most actions).
+int get_action_time_cost(const char* action_id);
+
 // Executes a text-based command
 bool execute_command(const char* input, GameState* game_state);
+// Tab completion for the main prompt: command words, then POI, connection or
+// location IDs depending on the command.
+void complete_command(const char* line, size_t cursor, LineEditorCompletion* out, GameState* game_state);
 
-// Checks for auto-triggered events in the current scene
-// Returns true if an event was triggered and the scene changed
-bool check_and_trigger_auto_events(GameState* game_state, StoryScene* current_scene, uint32_t scene_entry_time);
+// Registers the auto-events of a freshly entered scene with the game-time wheel,
+// each due once the game clock has moved on by its wait. When one fires it sets current_story_file and the tick reports a redraw.
+// 'scene' must stay valid while the scene is current.
+void arm_scene_auto_events(GameState* game_state, StoryScene* scene);
 
 #endif // EXECUTOR_H
@@ -6,6 +6,7 @@ typedef struct FlagNode {
     char* key;
     char* value;
     struct FlagNode* next;
+    int refs; // Head nodes only: tables sharing this chain (see hash_table_share)
 } FlagNode;
 
 // The hash table structure
@@ -29,6 +30,17 @@ HashTable* create_hash_table(int size);
  */
 void free_hash_table(HashTable* table);
 
+/**
+ * @brief Creates a table that shares every bucket chain with 'table'.
+ *        Costs one bucket array; a chain is copied only when either table
+ *        next writes to that bucket, so a copy that is only read (a snapshot)
+ *        costs memory in proportion to what the other one changes.
+ *
+ * @param table The hash table to share.
+ * @return The new table, freed with free_hash_table(), or NULL on failure.
+ */
+HashTable* hash_table_share(const HashTable* table);
+
 /**
  * @brief Sets a key-value pair in the hash table.
  *        If the key already exists, its value is updated.
@@ -49,4 +61,21 @@ void hash_table_set(HashTable* table, const char* key, const char* value);
  */
 const char* hash_table_get(HashTable* table, const char* key);
 
+/**
+ * @brief Calls 'visit' for every key-value pair, in bucket order.
+ *
+ * @param table The hash table.
+ * @param visit Called once per pair; must not modify the table.
+ * @param context Passed through to 'visit'.
+ */
+void hash_table_foreach(const HashTable* table, void (*visit)(const char* key, const char* value, void* context), void* context);
+
+/**
+ * @brief Counts the key-value pairs in the hash table.
+ *
+ * @param table The hash table.
+ * @return The number of pairs, or 0 for a NULL table.
+ */
+int hash_table_count(const HashTable* table);
+
 #endif // FLAG_SYSTEM_H
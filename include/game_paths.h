@@ -14,6 +14,17 @@ void get_base_path(char* exe_path, char* base_path, size_t size);
 int copy_file(const char *src_path, const char *dest_path);
 int write_string_to_file(const char* str, const char* dest_path);
 
+// Writes all of 'data' to fd, retrying short writes and EINTR.
+bool write_fully(int fd, const void* data, size_t size);
+
+// fsyncs the directory holding 'path', so a rename or create in it is durable.
+bool sync_parent_directory(const char* path);
+
+// Replaces 'path' with 'data' so that a crash leaves either the old file or
+// the new one, never a mix: writes "<path>.tmp", fsyncs it, renames it over
+// 'path' and fsyncs the directory.
+bool write_file_atomic(const char* path, const void* data, size_t size);
+
 // Ensures a directory exists, creating parent directories as needed.
 // Returns true on success, false on failure (e.g., permissions).
 bool ensure_directory_exists_recursive(const char* path, mode_t mode);
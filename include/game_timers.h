@@ -0,0 +1,56 @@
+#ifndef GAME_TIMERS_H
+#define GAME_TIMERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_types.h"
+#include "timer_wheel.h"
+
+// The game's two timer wheels:
+//  - game time, one tick per in-game second, advanced by TIME_TICK_EVENTs
+//    (auto-events, NPC schedules);
+//  - real time in 10 ms steps, advanced by the main loop (dialogue and choice
+//    reveals, which are authored in milliseconds since scene entry).
+// Anything that must happen at a known moment registers an expiry here once
+// instead of being re-checked on every tick or render.
+
+#define GAME_TIMER_REALTIME_STEP_MS 10
+
+typedef enum {
+    TIMER_GROUP_NONE,
+    TIMER_GROUP_SCENE,  // Cancelled on every scene transition
+    TIMER_GROUP_NPC
+} TimerGroup;
+
+// Records the current clock as the baseline for jump detection.
+void game_timers_init(const GameState* game_state);
+
+TimerId game_timer_after_seconds(uint32_t seconds, TimerCallback callback, void* context, int arg, TimerGroup group);
+TimerId realtime_timer_after_ms(uint32_t ms, TimerCallback callback, void* context, int arg, TimerGroup group);
+bool game_timer_cancel(TimerId id);
+void game_timers_cancel_group(TimerGroup group);
+
+// The game clock (time_of_day's data bits) in GAME_TIME_UNITS; false if it
+// cannot be read.
+bool game_clock_read(const GameState* game_state, uint32_t* out_units);
+// The clock reading 'seconds' after 'units', and the game seconds from 'now'
+// until 'due' (rounded up; 0 once it has passed). Readings wrap, so a 'due'
+// behind 'now' counts as passed.
+uint32_t game_clock_after(uint32_t units, uint32_t seconds);
+uint32_t game_clock_seconds_until(uint32_t now, uint32_t due);
+
+// Called when time_of_day moved by anything other than regular ticks (an
+// action set the clock, a save was loaded), so absolute-time schedules resync.
+void game_timers_add_clock_jump_listener(void (*listener)(GameState* game_state));
+
+// Advances the game-time wheel by 'tick_count' seconds. Returns true if a
+// timer changed something that needs a redraw. Call with time_mutex held.
+bool game_timers_on_tick(GameState* game_state, uint32_t tick_count);
+
+// Advances the real-time wheel to now. Returns true if a redraw is needed.
+bool game_timers_poll_realtime(void);
+
+// Milliseconds until the next real-time timer may be due, or -1 if none.
+long game_timers_next_realtime_ms(void);
+
+#endif // GAME_TIMERS_H
@@ -6,23 +6,21 @@
 #include "string_ids.h" // For StringID
 #include "flag_system.h" // For HashTable
 #include "cJSON.h"
-#include "cmap.h" // For CMap*
 #include <pthread.h>
 
 // --- Defines ---
 #define MAX_NAME_LENGTH 64
 #define MAX_DESC_LENGTH 256
 #define MAX_PATH_LENGTH 128
-#define MAX_INVENTORY_ITEMS 32
 #define MAX_POIS 16
 #define MAX_CONNECTIONS 8
-#define MAX_COMMANDS 32
+#define MAX_COMMANDS 32 // Width of PlayerState.commands
 #define MAX_FLAGS 8
 #define MAX_TEXT_LINES_PER_SCENE 256
 #define MAX_CHOICES_PER_SCENE 8
 #define MAX_LINE_LENGTH 512
 #define MAX_LOCATIONS 64
-#define MAX_ITEMS 64
+#define MAX_ITEMS 64 // Width of PlayerState.items
 #define MAX_ACTIONS 128
 
 // --- Doll States ---
@@ -41,18 +39,31 @@ struct Location_struct;
 
 // --- Primitive Structs (no major dependencies) ---
 
+// An item and how many of it, by name (character.json, the compiled template).
 typedef struct {
     char name[MAX_NAME_LENGTH];
     int quantity;
 } InventoryItem;
 
+// Items and commands are interned at build time: an ItemID indexes the item
+// table (data/items.json, ITEM_* in item_ids.h), a CommandID the command
+// table (data/commands.json, COMMAND_* in command_ids.h). The player's items
+// and unlocked commands are bitsets over those IDs (player_items.h).
+typedef uint8_t ItemID;
+typedef uint8_t CommandID;
+#define ITEM_NONE ((ItemID)0xFF)
+#define COMMAND_NONE ((CommandID)0xFF)
+
+// Dense index of a location in the map tables (map_loader.h).
+typedef int16_t LocationID;
+#define LOCATION_NONE ((LocationID)-1)
+
 typedef struct {
-    char location[MAX_NAME_LENGTH];
+    LocationID location; // Saves and debug output use the string ID
     int credit_level;
-    InventoryItem inventory[MAX_INVENTORY_ITEMS];
-    int inventory_count;
-    char unlocked_commands[MAX_COMMANDS][MAX_NAME_LENGTH];
-    int unlocked_commands_count;
+    uint64_t items;                      // Bit per ItemID held
+    uint16_t item_quantity[MAX_ITEMS];   // Meaningful for held items only
+    uint32_t commands;                   // Bit per CommandID unlocked
     
     // Persona Permissions (RWX Model)
     // Bits 0-2: Lain (Read, Write, Execute)
@@ -79,9 +90,9 @@ typedef struct {
 } Item;
 
 typedef struct {
-    char id[MAX_NAME_LENGTH];
-    char name[MAX_NAME_LENGTH];
-    char description[MAX_DESC_LENGTH * 2];
+    const char* id;
+    StringID name;
+    StringID description;
     const char* view_scene_id;      // For 'arls': Scene to transition to for viewing contents (e.g., a fridge).
     const char* examine_action_id;  // For 'exper': Action to trigger on interaction (e.g., opening NAVI).
 } POI;
@@ -143,6 +154,7 @@ typedef struct {
     char scene_id[MAX_NAME_LENGTH];
     char name[MAX_NAME_LENGTH];
     char location_id[MAX_NAME_LENGTH];
+    LocationID location; // location_id resolved at load, LOCATION_NONE if unset
     DialogueLine dialogue_lines[MAX_TEXT_LINES_PER_SCENE];
     int dialogue_line_count;
     StoryChoice choices[MAX_CHOICES_PER_SCENE];
@@ -155,28 +167,35 @@ typedef struct {
 
 // --- Main Structs with Interdependencies ---
 
-// Typedef for the accessibility check function pointer
-// Uses forward-declared types, which is why we use 'struct GameState'
+// Accessibility predicate behind a gated connection, registered by name
+// (map_register_gate() in map_loader.h).
 typedef bool (*is_accessible_func)(struct GameState*, const struct Connection*);
 
+#define MAP_GATE_NONE (-1)
+
 // Connection Struct
 typedef struct Connection {
     const char* target_location_id;
+    LocationID target; // Index of target_location_id
     const char* action_id;
-    is_accessible_func is_accessible;
+    int8_t gate; // Gate index (MAP_GATE_* in map_data.h), MAP_GATE_NONE if always open
     const char* access_denied_scene_id;
     const char* target_scene_id; // Added: The scene to transition to upon successful connection
 } Connection;
 
 // Location Struct (depends on POI and Connection)
+// Locations are compiled from data/map.json into const tables shared by every
+// session; text is referenced, not copied, and POIs and connections are ranges
+// of shared pools (location_pois(), location_connections() in map_loader.h).
 typedef struct Location_struct {
-    char id[MAX_NAME_LENGTH];
-    char name[MAX_NAME_LENGTH];
-    char description[MAX_DESC_LENGTH * 4];
-    POI pois[MAX_POIS];
-    int pois_count;
-    Connection connections[MAX_CONNECTIONS];
-    int connection_count;
+    const char* id;
+    StringID name;
+    const char* name_text; // Replaces 'name' for names outside the string table (stations)
+    StringID description;
+    uint16_t first_poi;
+    uint16_t pois_count;
+    uint16_t first_connection;
+    uint16_t connection_count;
 } Location;
 
 // GameState Struct (depends on PlayerState, Location, Item)
@@ -186,17 +205,15 @@ typedef struct GamePaths {
     char actions_file[MAX_PATH_LENGTH];
     char map_dir[MAX_PATH_LENGTH];
     char session_root_dir[MAX_PATH_LENGTH];
+    char locale_dir[MAX_PATH_LENGTH]; // Locale packs, next to the executable
+    char world_pack[MAX_PATH_LENGTH]; // The in-game file tree's image, likewise
 } GamePaths;
 
 typedef struct GameState {
     PlayerState player_state;
-    char current_story_file[MAX_PATH_LENGTH];
+    char current_story_file[MAX_PATH_LENGTH]; // Pending scene transition, cleared once taken
+    char current_scene_id[MAX_NAME_LENGTH];   // Scene on screen, for saves
     uint32_t time_of_day;
-    Location all_locations[MAX_LOCATIONS];
-    int location_count;
-    CMap* location_map;
-    Item all_items[MAX_ITEMS];
-    int item_count;
     HashTable* flags;
     float typewriter_delay;
     int navi_progress_style;
@@ -0,0 +1,113 @@
+#ifndef LINE_EDITOR_H
+#define LINE_EDITOR_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// A non-blocking line editor. Unlike linenoise(), it never reads the terminal itself:
+// the main loop feeds it whatever bytes select() reported and polls it for events,
+// so ticks, auto-events and takeover pacing keep running while a command is half typed.
+// Editing is UTF-8 aware (cursor and deletion move by code point, width by wcwidth),
+// supports history and Tab completion, and parses SGR (1006) mouse reports.
+
+#define LINE_EDITOR_MAX_LENGTH 512
+#define LINE_EDITOR_HISTORY_MAX 100
+#define LINE_EDITOR_PENDING_SIZE 4096
+#define LINE_EDITOR_COMPLETION_MAX 32
+#define LINE_EDITOR_COMPLETION_NAME 64
+#define LINE_EDITOR_ESC_TIMEOUT_MS 50 // An ESC nothing followed within this was the key alone
+
+typedef enum {
+    LINE_EDITOR_EVENT_NONE,
+    LINE_EDITOR_EVENT_LINE,   // Enter pressed; 'line' holds the submitted text
+    LINE_EDITOR_EVENT_MOUSE,  // SGR mouse report
+    LINE_EDITOR_EVENT_EOF     // Ctrl-D on an empty line
+} LineEditorEventType;
+
+typedef struct {
+    LineEditorEventType type;
+    const char* line;   // Valid until the next poll
+    int mouse_x;
+    int mouse_y;
+    int mouse_button;   // 0-2 buttons, 64/65 wheel up/down
+    char mouse_event;   // 'M' press, 'm' release
+} LineEditorEvent;
+
+// What Tab offers for the text before the cursor.
+typedef struct {
+    char insert[LINE_EDITOR_COMPLETION_NAME]; // Inserted at the cursor; empty if no continuation is certain
+    int match_count;                          // Candidates in all; only the first ones are listed
+    char matches[LINE_EDITOR_COMPLETION_MAX][LINE_EDITOR_COMPLETION_NAME];
+} LineEditorCompletion;
+
+// Fills 'out' for the first 'cursor' bytes of 'line'. 'out' arrives empty.
+typedef void (*LineEditorCompleter)(const char* line, size_t cursor, LineEditorCompletion* out, void* context);
+
+typedef enum {
+    LE_STATE_NORMAL,
+    LE_STATE_ESC,
+    LE_STATE_CSI,
+    LE_STATE_SS3
+} LineEditorParseState;
+
+typedef struct {
+    char prompt[128];
+    int prompt_width;       // Visible width of the prompt (escape sequences excluded)
+
+    char buf[LINE_EDITOR_MAX_LENGTH];
+    size_t len;             // Bytes in buf
+    size_t pos;             // Cursor as byte offset, always on a code point boundary
+    char submitted[LINE_EDITOR_MAX_LENGTH];
+
+    // Raw bytes fed but not yet consumed
+    unsigned char pending[LINE_EDITOR_PENDING_SIZE];
+    size_t pending_len;
+
+    LineEditorParseState state;
+    uint64_t fed_ms;        // When the last batch of bytes was fed
+    uint64_t esc_ms;        // When the ESC being parsed arrived
+    char seq[32];           // CSI parameter bytes collected so far
+    size_t seq_len;
+    char utf8[4];           // Partial multi-byte character
+    size_t utf8_len;
+    size_t utf8_need;
+    bool last_was_cr;       // Swallow the '\n' of a "\r\n" pair
+
+    char* history[LINE_EDITOR_HISTORY_MAX];
+    int history_len;
+    int history_index;      // 0 = the line being edited, 1 = newest entry, ...
+    char saved_line[LINE_EDITOR_MAX_LENGTH];
+
+    LineEditorCompleter completer;
+    void* completer_context;
+
+    bool needs_refresh;
+} LineEditor;
+
+void line_editor_init(LineEditor* ed, const char* prompt);
+void line_editor_free(LineEditor* ed);
+void line_editor_set_prompt(LineEditor* ed, const char* prompt);
+
+// Queues raw input bytes. Returns how many were accepted (less than len if the
+// pending buffer is full; feed the rest after polling). Bytes fed more than
+// LINE_EDITOR_ESC_TIMEOUT_MS after an ESC that ended the input are not read
+// as the rest of an escape sequence.
+size_t line_editor_feed(LineEditor* ed, const char* bytes, size_t len);
+size_t line_editor_pending_space(const LineEditor* ed);
+bool line_editor_has_pending(const LineEditor* ed);
+
+// Consumes queued bytes until one event is complete. Returns false when the queue
+// ran dry without an event. Redraws the prompt line if the edit buffer changed.
+bool line_editor_poll(LineEditor* ed, LineEditorEvent* out_event);
+
+// Redraws only the prompt line ("\r", prompt, visible part of the buffer, cursor).
+void line_editor_refresh(LineEditor* ed);
+
+void line_editor_history_add(LineEditor* ed, const char* line);
+
+// Tab inserts what the completer is sure of; if that is nothing and several
+// candidates remain, they are listed under the prompt. NULL turns Tab off.
+void line_editor_set_completer(LineEditor* ed, LineEditorCompleter completer, void* context);
+
+#endif // LINE_EDITOR_H
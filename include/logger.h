@@ -14,23 +14,25 @@ void logger_log(const char* format, ...);
 void logger_close();
 
 // --- Debug Macros ---
+// Each expands to a single statement, enabled or not, so it can stand alone
+// as the body of an if or else.
 
 #ifdef USE_DEBUG_LOGGING
-    #define LOG_DEBUG(fmt, ...) { fprintf(stderr, "DEBUG: " fmt "\n", ##__VA_ARGS__); logger_log("DEBUG: " fmt, ##__VA_ARGS__); }
+    #define LOG_DEBUG(fmt, ...) do { fprintf(stderr, "DEBUG: " fmt "\n", ##__VA_ARGS__); logger_log("DEBUG: " fmt, ##__VA_ARGS__); } while (0)
 #else
-    #define LOG_DEBUG(fmt, ...)
+    #define LOG_DEBUG(fmt, ...) do {} while (0)
 #endif
 
 #ifdef USE_STRING_DEBUG_LOGGING
-    #define LOG_STRING_DEBUG(fmt, ...) { fprintf(stderr, "DEBUG [STRING]: " fmt "\n", ##__VA_ARGS__); logger_log("DEBUG [STRING]: " fmt, ##__VA_ARGS__); }
+    #define LOG_STRING_DEBUG(fmt, ...) do { fprintf(stderr, "DEBUG [STRING]: " fmt "\n", ##__VA_ARGS__); logger_log("DEBUG [STRING]: " fmt, ##__VA_ARGS__); } while (0)
 #else
-    #define LOG_STRING_DEBUG(fmt, ...)
+    #define LOG_STRING_DEBUG(fmt, ...) do {} while (0)
 #endif
 
 #ifdef USE_MAP_DEBUG_LOGGING
-    #define LOG_MAP_DEBUG(fmt, ...) { fprintf(stderr, "DEBUG [MAP]: " fmt "\n", ##__VA_ARGS__); logger_log("DEBUG [MAP]: " fmt, ##__VA_ARGS__); }
+    #define LOG_MAP_DEBUG(fmt, ...) do { fprintf(stderr, "DEBUG [MAP]: " fmt "\n", ##__VA_ARGS__); logger_log("DEBUG [MAP]: " fmt, ##__VA_ARGS__); } while (0)
 #else
-    #define LOG_MAP_DEBUG(fmt, ...)
+    #define LOG_MAP_DEBUG(fmt, ...) do {} while (0)
 #endif
 
 #endif // LOGGER_H
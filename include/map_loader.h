@@ -3,15 +3,40 @@
 
 #include "game_types.h"
 
-// Loads all map data from the specified directory into the GameState.
-// Returns 1 on success, 0 on failure.
+// The map is compiled from data/map.json at build time (generate_data_tables.py
+// map) into const tables: a Location array and pools of POIs and connections
+// that each location indexes by range, with every connection's target already
+// resolved. A dangling target or an overfull location fails the build. Names
+// and descriptions stay StringIDs, resolved when shown, so the tables follow
+// the language chosen at boot. What a session changes about a place (doll
+// states, who is there) lives in the GameState.
+
+// Builds the route matrix for the GameState; the tables themselves need no
+// setup. Returns 1 on success, 0 on failure.
 int load_map_data(const char* map_dir_path, GameState* game_state);
 
-// Helper functions for programmatic map definition
-void init_location(Location* loc, const char* id, const char* name, const char* description);
-void add_poi_to_location(Location* loc, const char* id, const char* name, const char* description, const char* examine_action_id);
-void add_connection_to_location(Location* loc, const char* action_id, const char* target_location_id, is_accessible_func is_accessible, const char* access_denied_scene_id, const char* target_scene_id);
-Location* get_location_by_id(const char* location_id); // Added for external use
+// Gated connections name an accessibility predicate ("gate" in map.json); the
+// code behind each one registers it here. A gate nobody registered stays shut.
+// Returns false if map.json declares no gate by that name.
+bool map_register_gate(const char* name, is_accessible_func is_accessible);
+bool connection_is_gated(const Connection* conn);
+bool connection_is_open(GameState* game_state, const Connection* conn);
+const char* connection_gate_name(const Connection* conn); // NULL if not gated
+
+// Location IDs are dense LocationIDs, numbered in map.json order; a connection
+// carries its target's index and the player state holds one. Strings (saves,
+// scene files, debug commands) go through the generated perfect hash: one
+// probe, one strcmp.
+LocationID location_id_from_string(const char* location_id); // LOCATION_NONE if unknown
+const char* location_id_to_string(LocationID location); // "" for LOCATION_NONE
+const Location* get_location_by_id(const char* location_id); // Added for external use
+
+int map_location_count(void);
+const Location* map_location_at(int index); // NULL out of range, LOCATION_NONE included
 
+const POI* location_pois(const Location* loc);
+const Connection* location_connections(const Location* loc);
+const char* location_name(const Location* loc);
+const char* location_description(const Location* loc);
 
 #endif // MAP_LOADER_H
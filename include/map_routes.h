@@ -0,0 +1,25 @@
+#ifndef MAP_ROUTES_H
+#define MAP_ROUTES_H
+
+#include "game_types.h"
+
+// All-pairs shortest routes over the location graph, weighted by the minutes
+// each movement action costs (ties go to fewer hops). Built once the map is
+// loaded as a next-hop matrix, so planning a route is a walk of table reads.
+//
+// Gated connections (map_loader.h) are only part of the graph while the
+// gate is open; gates are re-evaluated on every plan and the matrix is rebuilt
+// only when one of them changed state.
+
+#define MAP_ROUTE_MAX_HOPS MAX_LOCATIONS
+
+// Rebuilds the matrix from the map tables (map_loader.h). Called by load_map_data().
+void map_routes_build(GameState* game_state);
+
+// Fills out_actions with the connection action IDs leading from 'from' to
+// 'to' and returns the hop count: 0 if they are the same location, -1 if
+// there is no open route. out_minutes receives the summed time cost.
+int map_routes_plan(GameState* game_state, LocationID from, LocationID to,
+                    const char** out_actions, int max_actions, int* out_minutes);
+
+#endif // MAP_ROUTES_H
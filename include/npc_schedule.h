@@ -0,0 +1,88 @@
+#ifndef NPC_SCHEDULE_H
+#define NPC_SCHEDULE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_types.h"
+
+// Data-driven NPC schedules (data/npc_schedules.json). Each NPC state (Mika's
+// sanity level, ...) is expanded at build time by generate_data_tables.py
+// into a dense per-minute table of location slots, so "where is X now" and
+// "is X's room open" are array reads. A reverse index (location -> NPCs
+// present) is kept up to date as NPCs move, so "who is here" is one lookup
+// as well.
+
+typedef enum {
+    NPC_MIKA,
+    NPC_DAD,
+    NPC_MOM,
+    NPC_ALICE,
+    NPC_CHISA,
+    NPC_DOCTOR,
+    NPC_COUNT
+} NpcId;
+
+#define NPC_MINUTES_PER_DAY 1440
+#define NPC_MAX_STATES 4
+#define NPC_MAX_LOCATIONS 64
+#define NPC_OFF_MAP "off_map"
+
+// One NPC state expanded to per-minute form. Slots index the generated
+// location names; slot 0 is NPC_OFF_MAP.
+typedef struct {
+    uint8_t slot[NPC_MINUTES_PER_DAY];          // Location slot for each minute
+    uint16_t until_change[NPC_MINUTES_PER_DAY]; // Minutes until 'slot' next differs; 0: never
+    uint8_t room_open[NPC_MINUTES_PER_DAY / 8]; // One bit per minute
+} NpcDayTable;
+
+typedef struct {
+    const char* key;           // Key in npc_schedules.json
+    const char* name;
+    const NpcDayTable* states; // One table per state, in order
+    int state_count;
+} NpcSchedule;
+
+// Matches the generated schedules to the NPCs compiled in. Called lazily by
+// every other function.
+void npc_schedule_init(void);
+
+// False if the NPC was compiled out (CHARACTER_*_ALIVE) or has no schedule.
+bool npc_is_active(NpcId npc);
+const char* npc_display_name(NpcId npc);
+
+// Stable key of the NPC in npc_schedules.json and in save files ("mika", ...).
+const char* npc_key(NpcId npc);
+// NPC_COUNT if no NPC has that key.
+NpcId npc_from_key(const char* key);
+
+// Minute of the in-game day, or -1 if the clock is unreadable.
+int npc_minute_of_day(const struct GameState* game_state);
+
+// Pure table lookups, no side effects.
+const char* npc_scheduled_location(NpcId npc, int state, int minute_of_day);
+bool npc_room_open(NpcId npc, int state, int minute_of_day);
+
+// Moves every schedule-driven NPC to where its table says for the current
+// time, and registers a game-time timer for the next change of any table,
+// which re-arms itself. Also re-armed on state changes and clock jumps.
+void npc_schedule_arm(struct GameState* game_state);
+
+// Moves every schedule-driven NPC to where its table says for the current time.
+void npc_schedule_update(const struct GameState* game_state);
+
+void npc_set_state(NpcId npc, int state);
+int npc_get_state(NpcId npc);
+
+// Manual positioning for script-driven events; the schedule resumes on return.
+void npc_move_to(NpcId npc, const char* location_id);
+void npc_return_to_schedule(NpcId npc);
+bool npc_is_manually_positioned(NpcId npc);
+void npc_restore(NpcId npc, const char* location_id, bool is_manual, int state);
+
+const char* npc_current_location(NpcId npc);
+bool npc_is_at(NpcId npc, const char* location_id);
+
+// Bit (1u << NpcId) is set for every NPC currently at the location.
+uint32_t npc_present_mask(const char* location_id);
+
+#endif // NPC_SCHEDULE_H
@@ -0,0 +1,34 @@
+#ifndef PLAYER_ITEMS_H
+#define PLAYER_ITEMS_H
+
+#include "game_types.h"
+#include "item_ids.h"    // ITEM_* (generated from items.json)
+#include "command_ids.h" // COMMAND_* (generated from commands.json)
+
+// The player's items and unlocked commands, as bitsets over the interned
+// ItemIDs and CommandIDs (game_types.h). Checks are single-bit tests; names
+// only come into it at the edges (commands typed, saves, character.json).
+
+// Unknown names give COMMAND_NONE. Item names: item_id_from_string() in data_loader.h.
+CommandID command_id_from_string(const char* command);
+const char* command_name(CommandID command); // NULL if out of range
+
+bool player_has_item(const PlayerState* ps, ItemID item);
+int player_item_quantity(const PlayerState* ps, ItemID item); // 0 if not held
+// Adds to what the player holds; a quantity of 0 or less leaves nothing held.
+void player_add_item(PlayerState* ps, ItemID item, int quantity);
+void player_set_item_quantity(PlayerState* ps, ItemID item, int quantity);
+int player_item_count(const PlayerState* ps);
+
+bool player_command_unlocked(const PlayerState* ps, CommandID command);
+void player_unlock_command(PlayerState* ps, CommandID command);
+int player_command_count(const PlayerState* ps);
+
+// First held item / unlocked command with an ID >= 'from', in ID order; -1
+// past the last. for (int i = player_next_item(ps, 0); i >= 0; i = player_next_item(ps, i + 1))
+int player_next_item(const PlayerState* ps, int from);
+int player_next_command(const PlayerState* ps, int from);
+
+void player_clear_items(PlayerState* ps);
+
+#endif // PLAYER_ITEMS_H
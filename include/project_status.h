@@ -37,11 +37,15 @@
 
 //  [✓] 4. 数据加载模块 (Data Loading Module)
 //      - 已实现从 'character.json' 加载玩家和初始游戏状态，以及从 'items.json' 加载所有物品定义。
+//      - 物品与命令名在构建时编号 (item_ids.h, command_ids.h)；玩家的物品与已解锁命令是位集加数量数组 (player_items.c)，未知名称在加载时丢弃。
 //      - `actions.json` 文件已废弃，所有动作逻辑已迁移至 C 引擎代码中。
 
 //  [✓] 5. 地图系统加载 (Map System Loading)
 //      - 实现了遍历 'map/' 目录并加载每个地点的详细信息 (name, description, poi, connections)。
 //      - 能够处理不同地点 .json 文件中的数据结构差异 (例如 poi 是对象数组或字符串数组)。
+//      - 地点表 (map_loader.c) 每个进程只构建一次，所有会话共享：名称/描述只存 StringID，POI 与连接存放在共享池中按区间引用；GameState 不再内嵌地点数组（约 773 KB -> 6 KB）。
+//      - 地点 ID 在构建地点表时解析为连续整数索引 (LocationID)，连接直接保存目标索引；字符串 -> 索引走完美哈希（一次探测 + 一次 strcmp），取代了每会话的 CMap。
+//      - 地图改为数据驱动：data/map.json 描述地点、POI、连接和门禁引用，构建时由 generate_data_tables.py 编译为 const 表（含已解析的目标索引与生成的完美哈希），启动时零构建开销；悬空目标、重复 ID、超出 MAX_CONNECTIONS/MAX_POIS 在构建期报错。自定义可达性判断按名称注册 (map_register_gate)，取代了 sequences/ 下手写的 create_*_layout 函数。
 
 //  [✓] 6. 故事解析器 (Story Parser)
 //      - 实现了 'story_parser.c'，能够读取 .md 格式的故事文件。
@@ -57,9 +61,13 @@
 //  [✓] 8. 动作与命令执行器 (Action & Command Executor)
 //      - 已实现基础的动作类型和命令 (例如 `story_change`, `location_change`, `acquire_item`, `arls`, `inventory`, `help`)。
 //      - `arls` 命令已增强，支持中文字符的正确显示。
+//      - 命令表 (command_registry.c)：主提示符、NAVI 菜单、邮件和 NAVI shell 共用，命令名经基数树 (command_trie.c) 分派；Tab 补全命令名及参数（POI、连接动作、地点 ID、shell 路径），未知命令给出“Did you mean”提示。
 
 //  [✓] 9. 状态保存 (State Saving)
-//      - 实现了 'save_game_state' 函数，可在游戏退出时将玩家位置、物品、命令等状态写回 'character.json'。
+//      - 自动存档 (autosave.c)：每次操作追加增量记录到 'character.journal'，由后台线程 fsync 写入；快照经临时文件 + rename 原子替换，崩溃后启动时重放日志恢复。
+//      - 二进制存档 'character.sav' (save_state.c)：带版本号和分段 CRC，覆盖玩家状态、物品、命令、ECC 时间码、人偶状态、全部 NPC 与完整 flag 表；启动时优先从它恢复。
+//      - 'character.json' 仅作为新会话模板；'save_tool' 可在存档与 JSON 之间互相转换以便调试。
+//      - 场景历史 (state_snapshot.c)：每次进入场景在内存中保存一个快照（最近 32 个），flag 表按桶写时复制共享，物品/命令为位集直接复制，单个快照约 1.6 KB；隐藏命令 'debug_rewind <n>' 回到第 n 个场景并从那里分支。
 
 //  [✓] 10. 角色生命周期控制 (Character Life Cycle Control)
 //      - 通过 CMake 选项实现了角色的编译时“生死”控制 (CHARACTER_NAME_ALIVE)。
@@ -88,7 +96,13 @@
 //  [✓] 14. 嵌入式NAVI邮件系统 (Embedded NAVI Mail System)
 //      - 实现了邮件数据结构 (`Email`, `Mailbox`) 和相关功能，包括加载、列出、显示和标记邮件为已读。
 //      - 邮件系统集成到 `embedded_navi.c`，允许玩家在NAVI界面中查看邮件。
-//      - **新增邮件删除功能**: 实现 `delete <id>` 命令，支持在内存中标记邮件为已删除，并通过文件重命名（例如，将后缀从 `,U`/`,R` 改为 `,D`）实现删除状态的持久化。列表显示已过滤掉已删除邮件。
+//      - **新增邮件删除功能**: 实现 `delete <id>` 命令，将邮件标记为已删除，状态以 `mail_status.<路径>` 记入存档的 flag 表（见下条），邮件文件本身不动。列表显示已过滤掉已删除邮件。
+//      - **邮箱索引**: `Mailbox` 只保存邮件头（ID、发件人、主题、状态、正文偏移），数组可增长，不再有 20 封上限；正文在 `read` 时才从 world 镜像读取。邮箱在 NAVI 会话间保留，按 `vfs_generation()` 判断是否需要重新列目录，且只解析新出现的文件。已读/删除不再重命名文件，而是以 `mail_status.<路径>` 记入存档的 flag 表，由自动存档随日志写盘。
+//      - **实时投递**: 会话目录下的 `world/` 是投递目录，其层级对应虚拟路径（如 `world/home/lain/Maildir/`）。主循环用 inotify 监视它，文件写完或移入后即导入 overlay 并从投递目录删除；空文件 `.wh.<名字>` 表示删除该文件。每次改动推送 `WORLD_FILE_EVENT`，邮箱据此增量更新，不重新列目录；新邮件在提示符上方显示 `[NAVI] New mail ...`。未运行时投递的文件在下次启动时导入（见 `world_watch.h`）。
+
+//  [✓] 14b. NAVI 推理应用 (Mystery App)
+//      - 案件不再写死在 `mystery_system.c`：每个案件是 world 镜像中 `/usr/share/mystery/*.json` 的一个文件（格式见 `mystery_case.h`），加入新案件无需重新编译，也可在游戏运行时投递。
+//      - 加载时编译：关键词转为整数 ID，问题按无序关键词对 (min_id, max_id) 存入开放寻址哈希表，`touch` 两个词只需一次探查；隐藏关键词由 `reveals` 规则揭示；结案问答题数与选项数不限。案件文件有误时在案件列表中显示原因。
 
 //  [✓] 15. 强化 UI 渲染与终端兼容性 (Advanced UI Rendering & Terminal Compatibility)
 //      - **强制清屏机制**: 实现了 `\033[H\033[2J\033[3J` 序列，在换场时彻底清除可见屏幕及滚动回溯缓冲区（Scrollback Buffer）。
@@ -116,7 +130,8 @@
 
 //  [ ] 3. 高级模拟终端命令 (Advanced Terminal Commands)
 //      - `examine <poi>`: 查看兴趣点的详细描述。
-//      - `ls`, `cd`, `cat`: 与 `world/` 模拟文件系统交互的命令。 (已在 `navi_shell.c` 中初步集成框架)
+//      - `ls`, `cd`, `cat`: 与 `world/` 模拟文件系统交互的命令。 (`navi_shell.c` 已实现；`world/` 构建时打包为 `world.wpk`，启动时 mmap 挂载，会话内的改动以日志追加方式写入存档旁的 `.overlay`（由自动存档线程写盘，定期压缩；重命名镜像内文件只记录别名），见 `world_vfs.h`。`vfs_rename` 目前没有调用者，保留给 shell 的 `mv` 命令)
+//      - `grep`, `find`, `search`: 基于倒排索引 (`text_index.h`，英文按词、中日文按单字与双字切分，支持 "短语" 查询) 的全文检索；首次检索时建立索引。`/etc/fs_access.json` 的 `list_level`/`read_level` 与玩家 `credit_level` 比较，决定 `ls`/`cd`/`cat` 及检索能看到的内容。
 
 
 // =====================================================================================
@@ -9,6 +9,10 @@
 void print_game_time(uint32_t time_of_day);
 void print_colored_line(SpeakerID speaker_id, StringID text_id, const GameState* game_state);
 void print_raw_text(const char* text);
+
+// Renders all dialogue lines of a scene, exactly as print_colored_line would print them
+// without the typewriter effect, into a newly malloc'd buffer. Caller frees. NULL on failure.
+char* render_dialogue_block(const StoryScene* scene, size_t* out_len);
 void clear_screen();
 
 void render_scene_description(const char* description); // Added
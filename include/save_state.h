@@ -0,0 +1,68 @@
+#ifndef SAVE_STATE_H
+#define SAVE_STATE_H
+
+#include "game_types.h"
+#include <stddef.h>
+
+// Binary save files (.sav), written next to a session's character.json.
+// Everything a resume needs is in one small buffer: player state, the raw
+// ECC time codeword, doll states, every NPC, and the whole flag store.
+//
+// Layout, little-endian:
+//   header    "LDSV", u16 version, u16 section count, u32 file size
+//   sections  u32 tag, u32 payload size, u32 CRC-32 of the payload, payload
+//
+// Every string (locations, item and command IDs, flag keys and values) is
+// stored once in the STRS section; the other sections refer to it by u16
+// index. Readers skip sections with unknown tags and ignore bytes past the
+// fields they know, so a later version can append sections or fields without
+// breaking older saves; anything a save does not carry is left as it was.
+
+#define SAVE_STATE_MAGIC "LDSV"
+#define SAVE_STATE_VERSION 1
+#define SAVE_STATE_EXTENSION ".sav"
+
+typedef enum {
+    SAVE_STATE_OK,
+    SAVE_STATE_ERROR_IO,
+    SAVE_STATE_ERROR_MEMORY,
+    SAVE_STATE_ERROR_FORMAT,    // Bad magic, truncated, or a section out of bounds
+    SAVE_STATE_ERROR_VERSION,   // Written by a newer build
+    SAVE_STATE_ERROR_CHECKSUM   // A section failed its CRC
+} SaveStateStatus;
+
+const char* save_state_status_string(SaveStateStatus status);
+
+// Serializes the game state into a malloc'd buffer the caller frees.
+SaveStateStatus save_state_encode(const GameState* game_state, unsigned char** data_out, size_t* size_out);
+
+// Journal records are saves that carry only what changed since the previous
+// record: always PLYR, then INVT/CMDS if they differ, the NPCs that moved,
+// and an FDLT section with the flags that were set (a full FLAG section if
+// any were removed, as by a rewind). Decoding one on top of the state it was
+// made against gives the state it was made from. The shadow tracks what has
+// been recorded so far.
+typedef struct SaveStateShadow SaveStateShadow;
+
+SaveStateShadow* save_state_shadow_create(const GameState* game_state);
+// Makes the shadow match the game state, after a full save.
+bool save_state_shadow_sync(SaveStateShadow* shadow, const GameState* game_state);
+void save_state_shadow_free(SaveStateShadow* shadow);
+
+// Encodes a journal record and advances the shadow past it.
+SaveStateStatus save_state_encode_delta(const GameState* game_state, SaveStateShadow* shadow,
+                                        unsigned char** data_out, size_t* size_out);
+
+// Validates the whole buffer (header, bounds, every CRC) before touching the
+// game state, so a damaged save leaves it as it was. Replaces the flag store
+// and restores NPC positions.
+SaveStateStatus save_state_decode(const unsigned char* data, size_t size, GameState* game_state);
+
+// Writes a full save atomically (write_file_atomic()).
+SaveStateStatus save_state_write(const char* path, const GameState* game_state);
+SaveStateStatus save_state_read(const char* path, GameState* game_state);
+
+// Swaps the extension: ("session/x/character.json", ".sav") -> "session/x/character.sav".
+void save_state_sibling_path(const char* path, const char* extension, char* out, size_t out_size);
+
+#endif // SAVE_STATE_H
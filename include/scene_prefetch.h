@@ -0,0 +1,42 @@
+#ifndef SCENE_PREFETCH_H
+#define SCENE_PREFETCH_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "game_types.h"
+
+// From any scene the next one is drawn from a small known set: choice targets,
+// connection target scenes and auto-event targets. After every transition these
+// candidates are handed to a low-priority worker thread, which initializes each
+// StoryScene and pre-renders its dialogue block so the following transition only
+// has to copy a struct and write one buffer.
+
+typedef struct {
+    unsigned long hits;      // Transitions served from the prefetch cache
+    unsigned long misses;    // Transitions that had to initialize the scene inline
+    unsigned long prepared;  // Scenes prepared by the worker in total
+} ScenePrefetchStats;
+
+// Starts the worker thread. Safe to skip (e.g. in debug tools): every other call
+// then degrades to a no-op and transitions behave exactly as without prefetching.
+void scene_prefetch_init(void);
+
+// Stops and joins the worker and releases all cached scenes. Must run before the
+// string table is released, since prepared frames reference resolved strings.
+void scene_prefetch_shutdown(void);
+
+// Resolves the candidate next scenes of 'scene' and queues them for preparation.
+// Cached scenes that are no longer candidates are evicted.
+void scene_prefetch_schedule(const StoryScene* scene, const GameState* game_state);
+
+// If 'scene_id' has been prepared, copies it into 'out_scene', makes its frame the
+// current one and returns true. Otherwise records a miss and returns false.
+bool scene_prefetch_take(const char* scene_id, StoryScene* out_scene);
+
+// Returns the pre-rendered dialogue block of the scene taken last, or NULL if that
+// scene was not served from the cache or 'scene_id' does not match it.
+const char* scene_prefetch_current_frame(const char* scene_id, size_t* out_len);
+
+void scene_prefetch_get_stats(ScenePrefetchStats* out_stats);
+
+#endif // SCENE_PREFETCH_H
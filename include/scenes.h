@@ -6,6 +6,10 @@
 
 #include "game_types.h"
 
+// Initializes 'scene' from the registration table without touching game state.
+// Returns false if the scene ID is not registered.
+bool load_scene_data(const char* scene_id, StoryScene* scene);
+
 // Transitions the game to the specified scene by its ID.
 // Returns true on success, false if the scene ID is not found.
 bool transition_to_scene(const char* target_story_file, StoryScene* scene, GameState* game_state);
@@ -0,0 +1,54 @@
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include "game_types.h"
+#include <stddef.h>
+
+// In-memory snapshots of what play changes in a GameState, for rewinding to
+// an earlier scene.
+//
+// Most of what the game knows never changes after load (the map tables are
+// shared by every session), so a snapshot keeps only the player state (items
+// and commands are bitsets, so it is small), clock, doll states, NPC
+// positions and flags. The flag store is shared with the live one bucket by
+// bucket (hash_table_share()), so only chains written since are ever copied.
+// A snapshot costs a couple of KB plus what changed.
+//
+// Snapshots are taken and restored on the main thread, with the game state
+// held still (time_mutex).
+
+#define STATE_HISTORY_CAPACITY 32
+
+typedef struct StateSnapshot StateSnapshot;
+
+StateSnapshot* state_snapshot_take(const GameState* game_state);
+
+// Puts the game state back as it was and queues a re-entry of the snapshot's
+// scene in current_story_file. The typewriter speed, a setting, is kept.
+bool state_snapshot_restore(const StateSnapshot* snapshot, GameState* game_state);
+
+void state_snapshot_free(StateSnapshot* snapshot);
+
+const char* state_snapshot_scene(const StateSnapshot* snapshot);
+uint32_t state_snapshot_time(const StateSnapshot* snapshot);
+
+// Bytes this snapshot added when it was taken, beyond what it shares.
+size_t state_snapshot_size(const StateSnapshot* snapshot);
+
+// --- Scene History ---
+// A ring of the last STATE_HISTORY_CAPACITY scene entries, oldest first.
+
+// Called by transition_to_scene() once the scene is entered.
+void state_history_record(const GameState* game_state);
+
+int state_history_count(void);
+// NULL if 'index' is out of range.
+const StateSnapshot* state_history_get(int index);
+
+// Restores entry 'index' and forgets it and everything after it; entering
+// the scene again records it anew, so play branches from there.
+bool state_history_rewind(int index, GameState* game_state);
+
+void state_history_clear(void);
+
+#endif // STATE_SNAPSHOT_H
@@ -2,9 +2,69 @@
 #define STRING_TABLE_H
 
 #include "string_ids.h" // Includes StringID and TEXT_COUNT
+#include <stdbool.h>
+#include <stdint.h>
 
-// Function to initialize the string table, called by data_loader
-void init_string_table(const char** strings, int count);
+// The embedded strings are stored as one zlib block per source module
+// (data/strings_extra/*.json), compressed against a shared preset dictionary
+// by cmake/generate_string_ids.py. A block is inflated the first time one of
+// its strings is asked for and kept in a small LRU pool, so resident text
+// follows the chapter being played rather than the whole script.
+//
+// Strings returned by get_string_by_id() stay valid until the next
+// string_table_trim(), which the main loop calls once per iteration. Do not
+// keep one across a main-loop iteration or a task yield (task_read_line() and
+// friends suspend the task until a later iteration); copy it instead. Debug
+// builds (USE_STRING_DEBUG_LOGGING) overwrite evicted text with '~' and free
+// it one trim later, so a stale pointer shows up on screen.
+
+#define STRING_POOL_BUILTIN 0xFFFF      // Entry block for strings not in any module
+#define STRING_POOL_BUDGET_BYTES 16384  // Inflated text kept across trims
+
+typedef struct {
+    const char* module;             // Source module, e.g. "strings_map"
+    const unsigned char* data;      // zlib stream
+    unsigned int compressed_size;
+    unsigned int size;              // Inflated size: NUL-terminated strings back to back
+} StringPoolBlock;
+
+typedef struct {
+    uint16_t block;   // Index into g_string_pool_blocks, or STRING_POOL_BUILTIN
+    uint32_t offset;  // Byte offset of the string in the inflated block
+} StringPoolEntry;
+
+// Generated pool (generated_string_data.c)
+extern const unsigned int g_string_pool_dictionary_size;
+extern const unsigned char g_string_pool_dictionary[];
+extern const int g_string_pool_block_count;
+extern const StringPoolBlock g_string_pool_blocks[];
+extern const StringPoolEntry g_string_pool_entries[TEXT_COUNT];
+
+// Locale packs (.lpk, built by cmake/generate_locale_pack.py) are mapped
+// read-only and shared, so sessions in the same locale share their pages.
+// Little-endian: a LocalePackHeader, a uint32 blob offset per StringID
+// (LOCALE_PACK_MISSING falls back to the embedded string), then the blob of
+// NUL-terminated UTF-8 strings.
+#define LOCALE_PACK_MAGIC "LLPK"
+#define LOCALE_PACK_VERSION 1
+#define LOCALE_PACK_MISSING 0xFFFFFFFFu
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t string_count;  // Must equal TEXT_COUNT
+    uint32_t ids_hash;      // Must equal STRING_IDS_HASH
+    uint32_t blob_size;
+    char locale[12];        // e.g. "en", NUL-padded
+} LocalePackHeader;
+
+// Function to initialize the string table, called by data_loader.
+// Drops any overrides and inflated blocks from a previous table.
+void init_string_table(void);
+
+// Overrides one string with a heap copy of 'text' that the table owns.
+// Returns 1 on success, 0 on an invalid ID or allocation failure.
+int set_string_by_id(StringID id, const char* text);
 
 // Function to clean up the string table
 void cleanup_string_table();
@@ -12,7 +72,24 @@ void cleanup_string_table();
 // Declare the public function to access strings by ID
 const char* get_string_by_id(StringID id);
 
-// Declare the global string table
-extern const char* g_string_table[TEXT_COUNT];
+// Maps a locale pack over the embedded strings, replacing any pack mapped
+// before. Returns false (and keeps the current table) if the file is missing
+// or was built for a different string set. Call from the main thread with
+// no string pointers held, like string_table_trim().
+bool string_table_load_locale(const char* path);
+void string_table_unload_locale(void);
+
+// Name of the mapped locale pack, or NULL when only embedded strings are used.
+const char* string_table_locale(void);
+
+// Evicts least recently used blocks until the pool is within
+// STRING_POOL_BUDGET_BYTES. Call only where no string pointers are held: from
+// the main loop, never from a task (debug builds refuse and say so).
+void string_table_trim(void);
+
+// Threads other than the main loop bracket their lookups with these, so a
+// trim cannot free a block while they are still reading from it.
+void string_table_begin_read(void);
+void string_table_end_read(void);
 
-#endif // STRING_TABLE_H
\ No newline at end of file
+#endif // STRING_TABLE_H
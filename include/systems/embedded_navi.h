@@ -3,7 +3,10 @@
 
 // This system is for the mobile phone's embedded NAVI interface.
 
+#include <stdbool.h>
+#include <stddef.h>
 #include "game_types.h"
+#include "world_watch.h"
 
 /**
  * @brief Enter the Embedded NAVI interface.
@@ -16,4 +19,16 @@
  */
 void enter_embedded_navi(GameState* game_state);
 
+/**
+ * @brief Tell the NAVI about a file delivered into or removed from the world.
+ *
+ * Keeps Lain's mailbox in step with the change.
+ *
+ * @param game_state The game state, whose flag store holds the mail's marks.
+ * @param change The change, from world_watch_change().
+ * @param notice Receives a one-line notice when the change is new mail.
+ * @return true if 'notice' was filled and should be shown to the player.
+ */
+bool embedded_navi_world_changed(GameState* game_state, const WorldFileChange* change, char* notice, size_t notice_size);
+
 #endif // EMBEDDED_NAVI_H
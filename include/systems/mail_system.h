@@ -1,36 +1,66 @@
 #ifndef MAIL_SYSTEM_H
 #define MAIL_SYSTEM_H
 
+#include <stdint.h>
 #include "game_types.h" // For StringID and MAX_..._LENGTH
+#include "flag_system.h"
+#include "world_vfs.h"
+#include "world_watch.h"
+#include "command_trie.h"
 
-#define MAX_EMAIL_BODY_LINES 20 // Increased to allow more lines for email body
-#define MAX_EMAIL_BODY_LINE_LENGTH MAX_LINE_LENGTH
+// A Maildir in the world image: one file per message, named
+// "NNN_sender.eml,S" where S is the status it arrives with (U unread, R read,
+// D deleted). A Mailbox keeps only each message's headers; a body is read
+// from its file when the message is opened.
+//
+// What the player does to a message afterwards is not written into its name:
+// the mark ("R" or "D") goes in the session's flag store, under
+// MAIL_STATUS_FLAG_PREFIX + the message's path without the status suffix, and
+// is saved and journaled with the rest of the session by the autosave.
+
+#define MAIL_STATUS_FLAG_PREFIX "mail_status."
 
 typedef struct {
     int id;
-    char filename[MAX_PATH_LENGTH]; // e.g., "001_chisa.eml,U"
+    char filename[VFS_NAME_MAX]; // e.g., "001_chisa.eml,U"
     char sender[MAX_NAME_LENGTH];
     char subject[MAX_DESC_LENGTH];
-    char body[MAX_EMAIL_BODY_LINES][MAX_EMAIL_BODY_LINE_LENGTH];
-    int body_line_count;
+    size_t body_offset;          // Where the body starts in the file
     bool is_read;
-    bool is_deleted; // New field
+    bool is_deleted;
 } Email;
 
-#define MAX_EMAILS 20 // Increased max emails to 20
-
 typedef struct {
-    Email emails[MAX_EMAILS];
+    char maildir_path[VFS_PATH_MAX];
+    Email* emails;       // Messages not deleted, by ID
     int email_count;
+    int capacity;
+    CommandTrie* by_name; // Filename without status -> index into 'emails'
+    uint32_t generation;  // vfs_generation() the list was last checked at
+    HashTable** marks;    // The flag store holding the player's marks (&game_state->flags);
+                          // NULL keeps them in memory only
 } Mailbox;
 
-// Function declarations (to be implemented)
 void mail_system_init(Mailbox* mailbox);
+
+// Brings the mailbox up to date with 'maildir_path'. Costs nothing if the
+// world has not changed since the last call; otherwise the directory is
+// listed again but only files not seen before have their headers parsed.
 void mail_system_load_emails(Mailbox* mailbox, const char* maildir_path);
+
+// Applies one change made to the world from outside (world_watch.h) without
+// listing the Maildir, if the mailbox was current just before it; otherwise
+// loads it as above. Returns the message the change put in the list (valid
+// until the mailbox next changes), or NULL if it put none there.
+const Email* mail_system_apply_change(Mailbox* mailbox, const WorldFileChange* change);
+
 void mail_system_display_list(const Mailbox* mailbox);
 void mail_system_display_email(const Mailbox* mailbox, int email_index);
+
+// Status changes are marks in the flag store; a deleted message leaves the list.
 void mail_system_mark_as_read(Mailbox* mailbox, int email_id);
-void mail_system_delete_email(Mailbox* mailbox, const char* maildir_path, int email_id); // New function
-void mail_system_cleanup(Mailbox* mailbox); // To save state or free resources if needed
+void mail_system_delete_email(Mailbox* mailbox, int email_id);
+
+void mail_system_cleanup(Mailbox* mailbox);
 
 #endif // MAIL_SYSTEM_H
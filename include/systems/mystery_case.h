@@ -0,0 +1,102 @@
+#ifndef MYSTERY_CASE_H
+#define MYSTERY_CASE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "command_trie.h"
+
+// A Mystery App case. Cases are JSON files in the world image under
+// MYSTERY_CASE_DIR, so new ones need no rebuild of the game (and can be
+// dropped into a running session, see world_watch.h):
+//
+//   {
+//     "title": "The Barman's Gun",
+//     "story": "A man walks into a bar and asks for a glass of [water]...",
+//     "keywords": [
+//       { "id": "water", "name": "Water" },
+//       { "id": "hiccups", "name": "Hiccups", "hidden": true }
+//     ],
+//     "combinations": [
+//       { "keywords": ["water"], "question": "...", "answer": "NO" },
+//       { "keywords": ["water", "thank_you"], "question": "...", "answer": "...",
+//         "reveals": ["hiccups"] }
+//     ],
+//     "quiz": [
+//       { "question": "...", "options": ["...", "...", "..."], "correct": 1 }
+//     ]
+//   }
+//
+// A hidden keyword cannot be touched until a combination naming it in
+// "reveals" has been asked. "correct" counts options from 0.
+//
+// Loading compiles the case: keywords become IDs (their index), and each
+// combination is filed in a hash table under its unordered pair of IDs, so
+// asking about two keywords is one probe however many the case has.
+
+#define MYSTERY_CASE_DIR "/usr/share/mystery"
+#define MYSTERY_CASE_EXTENSION ".json"
+#define MYSTERY_NO_KEYWORD UINT32_MAX
+
+typedef struct {
+    char* id;      // As the case file names it
+    char* name;    // Shown to the player; 'touch' accepts either
+    bool hidden;   // Needs revealing before it can be touched
+    bool revealed;
+} MysteryKeyword;
+
+typedef struct {
+    uint32_t first;   // Keyword IDs, first <= second;
+    uint32_t second;  // equal for a question about one keyword
+    char* question;
+    char* answer;
+    uint32_t* reveals;
+    int reveal_count;
+} MysteryCombination;
+
+typedef struct {
+    char* question;
+    char** options;
+    int option_count;
+    int correct;
+} MysteryQuizQuestion;
+
+typedef struct {
+    char* title;
+    char* story;
+    MysteryKeyword* keywords;
+    int keyword_count;
+    MysteryCombination* combinations;
+    int combination_count;
+    MysteryQuizQuestion* quiz;
+    int quiz_count;
+    CommandTrie* names;     // Lowercased id and name -> keyword ID
+    uint32_t* pair_slots;   // Combination index + 1 by pair hash; 0 is empty
+    uint32_t pair_mask;
+} MysteryCase;
+
+// Compiles a case from JSON text. Returns NULL and describes the first
+// problem in 'error' if the text is malformed or refers to keywords it lacks.
+MysteryCase* mystery_case_parse(const char* json, char* error, size_t error_size);
+// mystery_case_parse() on a file of the world image.
+MysteryCase* mystery_case_load(const char* path, char* error, size_t error_size);
+void mystery_case_free(MysteryCase* mystery);
+
+// Hides the hidden keywords again for a new attempt.
+void mystery_case_reset(MysteryCase* mystery);
+
+// The keyword whose id or name is 'word' (ASCII case folded), hidden or not,
+// or MYSTERY_NO_KEYWORD.
+uint32_t mystery_case_find_keyword(const MysteryCase* mystery, const char* word);
+bool mystery_case_keyword_visible(const MysteryCase* mystery, uint32_t keyword);
+
+// The combination asking about 'a' and 'b', in either order (pass
+// MYSTERY_NO_KEYWORD as 'b' for 'a' alone), or NULL.
+const MysteryCombination* mystery_case_lookup(const MysteryCase* mystery, uint32_t a, uint32_t b);
+
+// Reveals the keywords 'comb' names in "reveals", once it has been asked.
+// Fills 'revealed' with up to 'max' of those that were hidden until now and
+// returns how many there were.
+int mystery_case_reveal(MysteryCase* mystery, const MysteryCombination* comb, uint32_t* revealed, int max);
+
+#endif // MYSTERY_CASE_H
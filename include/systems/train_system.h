@@ -3,12 +3,44 @@
 
 #include "game_types.h"
 
+// Yamanote line travel. Station data, loop distances, travel times and fares
+// are compiled from sequences/station_coordinates.json into const tables at
+// build time (cmake/generate_station_table.py); every query is an array read.
+
+typedef enum {
+    YAMANOTE_OUTER = 0, // 外回り, clockwise: Shinagawa -> Osaki -> Shibuya -> Shinjuku -> ...
+    YAMANOTE_INNER = 1  // 内回り, anticlockwise: Shinagawa -> Tamachi -> Tokyo -> Ueno -> ...
+} YamanoteDirection;
+
+int train_station_count(void);
+const char* train_station_id(int index);
+const char* train_station_name(int index);
+
+// Index of the station with this location ID, or -1 if it is not on the loop.
+int train_station_index(const char* location_id);
+// The same for a map location (the player's position).
+int train_station_at(LocationID location);
+
+// Distance in hectometres, travel time in minutes and fare in yen between two
+// stations. Fares are charged on the shorter way round.
+int train_distance_hm(int from, int to, YamanoteDirection direction);
+int train_travel_minutes(int from, int to, YamanoteDirection direction);
+int train_fare_yen(int from, int to);
+YamanoteDirection train_fastest_direction(int from, int to);
+
+// Rides from the player's current station to 'to': advances the clock by the
+// travel time, moves the player and sets current_story_file to the
+// destination's scene. Returns scene_changed as execute_action() does: 1, or
+// 0 if the player is not at a station on the loop. Call with time_mutex held
+// (as tasks and actions are).
+int train_travel(GameState* game_state, int to, YamanoteDirection direction);
+
 /**
  * @brief Enters the ticket machine interface.
- * 
+ *
  * This function takes over the game loop to present the user with a special
  * interface for interacting with the train system, stylized as a ticket machine.
- * 
+ *
  * @param game_state A pointer to the current game state.
  */
 void enter_ticket_machine_interface(GameState* game_state);
@@ -0,0 +1,68 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "game_types.h"
+#include "line_editor.h"
+
+struct CommandRegistry;
+
+// Stackful tasks for interactive subsystems (NAVI, mail, shell, mystery app, ticket
+// machine). A subsystem keeps its plain sequential loop, but instead of blocking in
+// linenoise()/usleep() it calls task_read_line()/task_sleep_ms(), which suspend the
+// task and hand control back to the main loop. The main loop stays the only reactor:
+// it feeds finished lines to the waiting task and resumes sleeping tasks when their
+// deadline passes, so the clock and auto-events keep running in the meantime.
+//
+// Each task runs on its own thread stack, but control is passed like a baton: at
+// any moment either the main loop or exactly one task is running, never both. Tasks
+// therefore touch game state under the same time_mutex the main loop holds.
+
+#define TASK_MAX_COUNT 4
+#define TASK_PROMPT_MAX 128
+
+typedef void (*TaskEntry)(GameState* game_state);
+
+// Starts 'entry' as a task and runs it until its first yield. Called from inside a
+// task, the entry simply runs inline on the caller's stack.
+// Returns false if no task slot or thread is available (entry did not run).
+bool task_spawn(const char* name, TaskEntry entry, GameState* game_state);
+
+// True while the caller runs on a task stack.
+bool task_in_task(void);
+
+// --- Main loop side ---
+
+// True while any task is alive; it owns the screen until it finishes.
+bool task_scheduler_has_foreground(void);
+// True if the foreground task is suspended in task_read_line().
+bool task_scheduler_wants_input(void);
+// Prompt the foreground task asked for (valid while it waits for input).
+const char* task_scheduler_prompt(void);
+// Completes 'line' for the task waiting for input, against the registry it
+// passed to task_read_command(). Returns false if there is none.
+bool task_scheduler_complete(const char* line, size_t cursor, LineEditorCompletion* out);
+// Resumes the task waiting for input with 'line' (NULL means EOF).
+// Returns true if a task was resumed.
+bool task_scheduler_deliver_line(const char* line);
+// Resumes every task whose sleep deadline has passed. Returns true if any ran.
+bool task_scheduler_run_due(void);
+// Milliseconds until the earliest sleep deadline, or -1 if nothing is sleeping.
+long task_scheduler_next_timeout_ms(void);
+// Unwinds all live tasks by making their pending and further waits return at once
+// (input reads report EOF), then joins them.
+void task_scheduler_shutdown(void);
+
+// --- Task side (each falls back to the blocking call outside a task) ---
+
+// Reads one line into 'buf'. Returns false on EOF.
+bool task_read_line(const char* prompt, char* buf, size_t size);
+// task_read_line(), with Tab completing against 'commands' (called with 'context').
+bool task_read_command(const char* prompt, const struct CommandRegistry* commands, void* context, char* buf, size_t size);
+// Suspends the task for 'ms' milliseconds of real time.
+void task_sleep_ms(unsigned int ms);
+// Shows 'prompt' (e.g. "(Press ENTER to return)") and waits for Enter.
+void task_wait_enter(const char* prompt);
+
+#endif // TASK_SCHEDULER_H
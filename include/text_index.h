@@ -0,0 +1,43 @@
+#ifndef TEXT_INDEX_H
+#define TEXT_INDEX_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// An inverted index over UTF-8 documents, for the NAVI shell's search.
+// Text is split into tokens: runs of ASCII letters and digits (lowercased)
+// and other alphabetic scripts are words; CJK text, which has no spaces,
+// gives every character and every pair of adjacent characters. Each token
+// keeps a postings list of (document, position, byte offset), so a word is
+// found by one lookup and a phrase by checking its tokens sit side by side,
+// without rescanning any document.
+
+#define TEXT_INDEX_TOKEN_MAX 64 // Longer words are cut (at a character boundary)
+
+typedef struct TextIndex TextIndex;
+
+typedef struct {
+    int doc;
+    uint32_t offset;     // Byte offset in the document of the first match
+    int occurrences;     // How often the first word or phrase of the query occurs
+} TextIndexHit;
+
+TextIndex* text_index_create(void);
+void text_index_free(TextIndex* index);
+
+// Indexes 'text' as document 'doc'. Document IDs must increase from call to
+// call. Returns false on allocation failure.
+bool text_index_add(TextIndex* index, int doc, const char* text, size_t len);
+
+// Documents containing every word and every "quoted phrase" of 'query', in
+// increasing order. Fills up to 'max_hits' and returns how many there are.
+int text_index_search(const TextIndex* index, const char* query, TextIndexHit* hits, int max_hits);
+
+// Narrows a substring search for 'text' (ASCII case folded): the documents
+// holding every token any occurrence of it must contain whole, in increasing
+// order. Fills up to 'max_docs' and returns how many there are, or -1 when
+// 'text' implies no token and every document remains a candidate.
+int text_index_candidates(const TextIndex* index, const char* text, int* docs, int max_docs);
+
+#endif // TEXT_INDEX_H
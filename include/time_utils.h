@@ -5,6 +5,11 @@
 #include <stdbool.h>
 #include "game_types.h" // For GameState
 
+// Game clock resolution: time_of_day counts 1/16 s units and the time thread
+// advances it by one second per tick.
+#define GAME_TIME_UNITS_PER_SECOND 16
+#define GAME_TIME_UNITS_PER_DAY (24 * 60 * 60 * GAME_TIME_UNITS_PER_SECOND)
+
 // Mutex for protecting game_state->time_of_day
 extern pthread_mutex_t time_mutex;
 
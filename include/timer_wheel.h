@@ -0,0 +1,72 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Hashed hierarchical timer wheel. Four levels of 64 slots cover 64^4 ticks; a
+// timer is hashed into the level whose span fits its remaining delay and is
+// cascaded one level down whenever the level below wraps. Advancing one tick
+// touches a single slot (plus an occasional cascade), so the cost per tick
+// depends on what expires, not on how many timers are pending.
+//
+// The tick length is up to the owner: game_timers.c runs one wheel in game
+// seconds and one in real-time 10 ms steps.
+
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_MAX_TIMERS 256
+
+typedef uint32_t TimerId; // 0 is never a valid ID
+
+// Returns true if the callback changed something that needs a redraw.
+typedef bool (*TimerCallback)(void* context, int arg);
+
+typedef struct {
+    uint64_t due;             // Absolute tick
+    TimerCallback callback;
+    void* context;
+    int arg;
+    uint32_t group;           // Caller-defined, for bulk cancellation
+    uint16_t generation;      // Bumped on every reuse so stale IDs miss
+    int16_t list;             // List the node is linked into, -1 when free
+    int prev;
+    int next;
+} TimerNode;
+
+typedef struct {
+    uint64_t now;             // Current tick
+    // One list per (level, slot), plus the list of timers firing right now.
+    int heads[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 1];
+    int tails[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 1];
+    TimerNode nodes[TIMER_WHEEL_MAX_TIMERS];
+    int free_head;
+    int active_count;
+    bool initialized;
+
+    // Statistics
+    uint64_t fired;
+    uint64_t cascaded;
+} TimerWheel;
+
+void timer_wheel_init(TimerWheel* wheel, uint64_t now);
+
+// Fires 'callback' after 'delay' ticks (at least 1). Timers due on the same tick
+// fire in the order they were added. Returns 0 if the wheel is full.
+TimerId timer_wheel_add(TimerWheel* wheel, uint64_t delay, TimerCallback callback,
+                        void* context, int arg, uint32_t group);
+
+// Returns false if the timer already fired or was cancelled.
+bool timer_wheel_cancel(TimerWheel* wheel, TimerId id);
+void timer_wheel_cancel_group(TimerWheel* wheel, uint32_t group);
+
+// Advances to tick 'now', firing every timer due on the way. Callbacks may add
+// and cancel timers. Returns true if any callback asked for a redraw.
+bool timer_wheel_advance(TimerWheel* wheel, uint64_t now);
+
+// Ticks until the earliest pending timer is due, or -1 if none is pending. Walks
+// level 0 only and returns a lower bound for timers parked on higher levels.
+int64_t timer_wheel_next_due(const TimerWheel* wheel);
+
+#endif // TIMER_WHEEL_H
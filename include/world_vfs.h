@@ -0,0 +1,105 @@
+#ifndef WORLD_VFS_H
+#define WORLD_VFS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The in-game file tree (world/: home directories, mail, case files) as the
+// NAVI shell and mail see it. It is packed at build time by
+// cmake/generate_world_pack.py into world.wpk, next to the executable, and
+// mapped read-only once at boot.
+//
+// Paths are virtual ("/home/lain/Maildir") and resolve over the packed tree
+// alone: ".." stops at "/", and no host path can be named through this API.
+//
+// A session's changes (files written, renamed or removed) go to an overlay
+// held in memory, hashed by path, and journaled to a file beside the
+// session's save; the image itself is never modified. Each change appends
+// its records, written by the autosave thread (autosave_write_file()), and
+// the journal is compacted once it is twice the size of what it describes.
+// A rename of a packed file records the new name as an alias of the old
+// one, so no contents are copied. The overlay holds files only; the
+// directory structure is the image's.
+//
+// Main thread (or the task holding the baton) only.
+
+#define WORLD_PACK_MAGIC "LWPK"
+#define WORLD_PACK_VERSION 1
+#define WORLD_PACK_DIR 0x1u
+#define WORLD_PACK_COMPRESSED 0x2u // zlib; otherwise stored
+#define WORLD_PACK_EXEC 0x4u
+
+#define VFS_NAME_MAX 128
+#define VFS_PATH_MAX 256
+#define VFS_OVERLAY_EXTENSION ".overlay"
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t names_size;
+    uint32_t data_size;
+} WorldPackHeader;
+
+// Entries follow the header in breadth-first order, so a directory's
+// children are contiguous, sorted by name bytes. Entry 0 is "/".
+typedef struct {
+    uint32_t name;   // Offset into the name table
+    uint32_t parent; // Entry index; the root is its own parent
+    uint32_t flags;  // WORLD_PACK_*
+    uint32_t first;  // Directory: first child's index. File: offset into the data
+    uint32_t count;  // Directory: number of children. File: bytes in the data
+    uint32_t size;   // File: bytes once inflated
+} WorldPackEntry;
+
+typedef struct {
+    char name[VFS_NAME_MAX];
+    bool is_dir;
+    bool is_exec;
+    size_t size;
+} VfsEntry;
+
+// Maps the image, replacing any mapped before. Returns false (keeping the
+// current one) if the file is missing or malformed.
+bool vfs_mount(const char* pack_path);
+void vfs_unmount(void);
+bool vfs_is_mounted(void);
+
+// Loads the session overlay at 'overlay_path' if there is one; later
+// changes are written there. Without an overlay, changes last until exit.
+bool vfs_overlay_open(const char* overlay_path);
+void vfs_overlay_close(void);
+
+// Makes 'path' absolute against 'cwd' and folds ".", ".." and repeated
+// slashes. Purely lexical; returns false if the result does not fit.
+bool vfs_resolve(const char* cwd, const char* path, char* out, size_t out_size);
+
+// Changes whenever what the paths below show may have: a mount, an overlay
+// opened or closed, a write, rename or removal. Callers caching a listing
+// compare it to know when to look again.
+uint32_t vfs_generation(void);
+
+// Paths below are absolute and resolved (vfs_resolve()).
+bool vfs_stat(const char* path, VfsEntry* out);
+
+// Calls 'fn' for each entry of the directory, in name order. Returns the
+// number of entries, or -1 if 'path' is not a directory.
+typedef void (*VfsListFunc)(const VfsEntry* entry, void* context);
+int vfs_list(const char* path, VfsListFunc fn, void* context);
+
+// Reads a whole file into a NUL-terminated heap buffer the caller frees.
+bool vfs_read(const char* path, char** out_data, size_t* out_size);
+
+// Creates or replaces a file; its directory must exist.
+bool vfs_write(const char* path, const void* data, size_t size);
+// Moves a file. No caller yet; kept for a shell 'mv'.
+bool vfs_rename(const char* from, const char* to);
+bool vfs_remove(const char* path);
+
+// Changes made between these are handed to the overlay's writer as one
+// commit when the outermost batch ends, rather than one per change.
+void vfs_batch_begin(void);
+void vfs_batch_end(void);
+
+#endif // WORLD_VFS_H
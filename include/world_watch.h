@@ -0,0 +1,58 @@
+#ifndef WORLD_WATCH_H
+#define WORLD_WATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "world_vfs.h"
+
+// Delivers files from the host into a running session's world. The session
+// has a drop directory (WORLD_WATCH_DIR beside its save) whose layout
+// mirrors the virtual tree: a file closed or moved into
+// "<drop>/home/lain/Maildir/" appears in the NAVI at "/home/lain/Maildir/",
+// is written to the world overlay and removed from the drop directory. An
+// empty file named ".wh.<name>" removes "<name>" from the world instead, as
+// in overlay filesystems. Other dot files are left alone, so tools can write
+// under a temporary name and rename, as Maildir delivery does.
+//
+// The drop directory is watched with inotify; the main loop selects on
+// world_watch_fd() and calls world_watch_poll() when it is readable or
+// world_watch_pending(). Each change applied pushes a WORLD_FILE_EVENT naming
+// it (world_watch_change()). Whatever was dropped while the game was not
+// running is taken on the first poll. A poll takes at most
+// WORLD_WATCH_BATCH_MAX files, written to the overlay as one commit; the rest
+// wait in the drop directory for the next poll.
+//
+// Main thread only, like the VFS.
+
+#define WORLD_WATCH_DIR "world"
+#define WORLD_WATCH_WHITEOUT ".wh."
+#define WORLD_WATCH_FILE_MAX (1u << 20) // Larger files are left in place
+#define WORLD_WATCH_BATCH_MAX 128         // Changes per poll, all of which world_watch_change() keeps
+
+typedef struct {
+    char path[VFS_PATH_MAX];       // Virtual path that changed
+    bool removed;                  // Whiteout; otherwise created or replaced
+    uint32_t generation_before;    // vfs_generation() around the change, so a
+    uint32_t generation_after;     // cached listing can tell if it was current
+} WorldFileChange;
+
+// Watches 'drop_dir', creating it if needed; what is already there is
+// imported by the first poll (world_watch_pending()). Returns false if it cannot be watched (the game runs without it).
+bool world_watch_start(const char* drop_dir);
+void world_watch_stop(void);
+
+// Descriptor to select() on for reading, or -1 when not watching.
+int world_watch_fd(void);
+
+// Applies the next batch of pending changes. Returns how many were applied.
+int world_watch_poll(void);
+
+// Files were left for the next poll (a full batch, or lost events), which
+// should come without waiting for the descriptor.
+bool world_watch_pending(void);
+
+// The change a WORLD_FILE_EVENT refers to. Returns false once it has been
+// overwritten, by a later poll's changes.
+bool world_watch_change(uint32_t change_id, WorldFileChange* out);
+
+#endif // WORLD_WATCH_H
@@ -1,8 +0,0 @@
-#ifndef MIYANOSAKA_STATION_LAYOUT_H
-#define MIYANOSAKA_STATION_LAYOUT_H
-
-#include "game_types.h"
-
-int create_miyanosaka_station_layout(Location* all_locations, int starting_index);
-
-#endif // MIYANOSAKA_STATION_LAYOUT_H
@@ -1,8 +0,0 @@
-#ifndef MIYANOSAKA_STREET_LAYOUT_H
-#define MIYANOSAKA_STREET_LAYOUT_H
-
-#include "game_types.h"
-
-int create_miyanosaka_street_layout(Location* all_locations, int starting_index);
-
-#endif // MIYANOSAKA_STREET_LAYOUT_H
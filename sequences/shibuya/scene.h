@@ -1,10 +0,0 @@
-#ifndef SHIBUYA_LAYOUT_H
-#define SHIBUYA_LAYOUT_H
-
-#include "game_types.h"
-
-#define SHIBUYA_LAYOUT_ROOM_COUNT 1
-
-int create_shibuya_layout(Location* all_locations, int starting_index);
-
-#endif // SHIBUYA_LAYOUT_H
@@ -0,0 +1,351 @@
+#include "autosave.h"
+#include "data_loader.h"
+#include "game_paths.h"
+#include "byte_util.h"
+#include "time_utils.h"
+#include "logger.h"
+#include <zlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define JOURNAL_HEADER_SIZE 12
+
+typedef enum { JOB_SNAPSHOT, JOB_JOURNAL, JOB_FILE } AutosaveJobType;
+
+typedef struct AutosaveJob {
+    AutosaveJobType type;
+    unsigned char* data;
+    size_t size;
+    // JOB_FILE only
+    char* path;
+    AutosaveFileMode mode;
+    atomic_bool* failed;
+    struct AutosaveJob* next;
+} AutosaveJob;
+
+static char g_save_path[MAX_PATH_LENGTH];
+static char g_journal_path[MAX_PATH_LENGTH];
+static bool g_running = false;
+
+// Queue, guarded by g_queue_mutex.
+static pthread_t g_writer_thread;
+static pthread_mutex_t g_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_queue_cond = PTHREAD_COND_INITIALIZER;
+static AutosaveJob* g_queue_head = NULL;
+static AutosaveJob* g_queue_tail = NULL;
+static bool g_stopping = false;
+
+// Set by the writer when a write failed; the next record is a snapshot.
+static atomic_bool g_need_snapshot = false;
+
+// Main thread only.
+static SaveStateShadow* g_shadow = NULL;
+static int g_journal_records = 0;
+static size_t g_journal_bytes = 0;
+static uint64_t g_last_record_ms = 0;
+
+// Writer thread only.
+static int g_journal_fd = -1;
+static bool g_journal_valid = false; // A snapshot the journal can extend is on disk
+static uint32_t g_snapshot_crc = 0;
+
+static uint32_t crc_of(const unsigned char* data, size_t size) {
+    return (uint32_t)crc32(crc32(0L, Z_NULL, 0), data, (uInt)size);
+}
+
+// --- Recovery ---
+
+SaveStateStatus autosave_recover(const char* save_path, GameState* game_state, int* replayed_out) {
+    if (replayed_out) *replayed_out = 0;
+    char* snapshot = NULL;
+    long snapshot_size = 0;
+    if (read_entire_file(save_path, &snapshot, &snapshot_size) != DATA_LOADER_SUCCESS) return SAVE_STATE_ERROR_IO;
+    SaveStateStatus status = save_state_decode((const unsigned char*)snapshot, (size_t)snapshot_size, game_state);
+    uint32_t base_crc = crc_of((const unsigned char*)snapshot, (size_t)snapshot_size);
+    free(snapshot);
+    if (status != SAVE_STATE_OK) return status;
+
+    char journal_path[MAX_PATH_LENGTH];
+    save_state_sibling_path(save_path, AUTOSAVE_JOURNAL_EXTENSION, journal_path, sizeof(journal_path));
+    char* journal = NULL;
+    long journal_size = 0;
+    if (read_entire_file(journal_path, &journal, &journal_size) != DATA_LOADER_SUCCESS) return SAVE_STATE_OK;
+
+    const unsigned char* p = (const unsigned char*)journal;
+    size_t size = (size_t)journal_size;
+    if (size < JOURNAL_HEADER_SIZE || memcmp(p, AUTOSAVE_JOURNAL_MAGIC, 4) != 0 ||
+        load_u32(p + 4) != AUTOSAVE_JOURNAL_VERSION || load_u32(p + 8) != base_crc) {
+        LOG_DEBUG("Journal %s does not extend %s; ignored.", journal_path, save_path);
+        free(journal);
+        return SAVE_STATE_OK;
+    }
+
+    // Each record validates itself before it is applied, so replay stops
+    // cleanly at a torn tail.
+    int replayed = 0;
+    size_t pos = JOURNAL_HEADER_SIZE;
+    while (size - pos >= 4) {
+        uint32_t record_size = load_u32(p + pos);
+        if (record_size > size - pos - 4) break;
+        if (save_state_decode(p + pos + 4, record_size, game_state) != SAVE_STATE_OK) break;
+        pos += 4 + record_size;
+        replayed++;
+    }
+    if (pos != size) {
+        LOG_DEBUG("Journal %s: dropped %zu bytes of torn tail.", journal_path, size - pos);
+    }
+    free(journal);
+    if (replayed_out) *replayed_out = replayed;
+    return SAVE_STATE_OK;
+}
+
+// --- Writer Thread ---
+
+static void close_journal(void) {
+    if (g_journal_fd >= 0) close(g_journal_fd);
+    g_journal_fd = -1;
+}
+
+static void write_snapshot(const AutosaveJob* job) {
+    if (!write_file_atomic(g_save_path, job->data, job->size)) {
+        // Records made after this snapshot would not apply to the old one.
+        g_journal_valid = false;
+        atomic_store(&g_need_snapshot, true);
+        return;
+    }
+    g_snapshot_crc = crc_of(job->data, job->size);
+    close_journal();
+    if (unlink(g_journal_path) == 0) sync_parent_directory(g_journal_path);
+    g_journal_valid = true;
+}
+
+static void write_journal_record(const AutosaveJob* job) {
+    if (!g_journal_valid) return; // Waiting for a snapshot to extend
+    if (g_journal_fd < 0) {
+        g_journal_fd = open(g_journal_path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0600);
+        unsigned char header[JOURNAL_HEADER_SIZE];
+        memcpy(header, AUTOSAVE_JOURNAL_MAGIC, 4);
+        store_u32(header + 4, AUTOSAVE_JOURNAL_VERSION);
+        store_u32(header + 8, g_snapshot_crc);
+        if (g_journal_fd < 0 || !write_fully(g_journal_fd, header, sizeof(header)) || !sync_parent_directory(g_journal_path)) {
+            LOG_DEBUG("Could not start journal %s: %s", g_journal_path, strerror(errno));
+            close_journal();
+            g_journal_valid = false;
+            atomic_store(&g_need_snapshot, true);
+            return;
+        }
+    }
+    // One write per record, so a crash tears at most the last one.
+    unsigned char size_prefix[4];
+    store_u32(size_prefix, (uint32_t)job->size);
+    unsigned char* framed = malloc(job->size + 4);
+    bool ok = framed != NULL;
+    if (ok) {
+        memcpy(framed, size_prefix, 4);
+        memcpy(framed + 4, job->data, job->size);
+        ok = write_fully(g_journal_fd, framed, job->size + 4) && fdatasync(g_journal_fd) == 0;
+    }
+    free(framed);
+    if (!ok) {
+        LOG_DEBUG("Journal write to %s failed; falling back to a snapshot.", g_journal_path);
+        close_journal();
+        g_journal_valid = false;
+        atomic_store(&g_need_snapshot, true);
+    }
+}
+
+static bool write_session_file(const char* path, AutosaveFileMode mode, const unsigned char* data, size_t size) {
+    if (mode == AUTOSAVE_FILE_REPLACE) return write_file_atomic(path, data, size);
+    int fd = open(path, O_WRONLY | O_APPEND | O_CLOEXEC); // Never creates: a file starts with a replace
+    if (fd < 0) return false;
+    bool ok = write_fully(fd, data, size) && fdatasync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+static void write_file_job(const AutosaveJob* job) {
+    if (write_session_file(job->path, job->mode, job->data, job->size)) return;
+    LOG_DEBUG("Could not write %s: %s", job->path, strerror(errno));
+    if (job->failed) atomic_store(job->failed, true);
+}
+
+static void free_job(AutosaveJob* job) {
+    free(job->data);
+    free(job->path);
+    free(job);
+}
+
+static void* writer_thread_func(void* arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&g_queue_mutex);
+        while (g_queue_head == NULL && !g_stopping) pthread_cond_wait(&g_queue_cond, &g_queue_mutex);
+        AutosaveJob* job = g_queue_head;
+        if (job != NULL) {
+            g_queue_head = job->next;
+            if (g_queue_head == NULL) g_queue_tail = NULL;
+        }
+        pthread_mutex_unlock(&g_queue_mutex);
+        if (job == NULL) break; // Stopping, queue drained
+
+        if (job->type == JOB_SNAPSHOT) write_snapshot(job);
+        else if (job->type == JOB_JOURNAL) write_journal_record(job);
+        else write_file_job(job);
+        free_job(job);
+    }
+    close_journal();
+    return NULL;
+}
+
+static void free_jobs(AutosaveJob* job) {
+    while (job != NULL) {
+        AutosaveJob* next = job->next;
+        free_job(job);
+        job = next;
+    }
+}
+
+static void push_job(AutosaveJob* job) {
+    pthread_mutex_lock(&g_queue_mutex);
+    AutosaveJob* superseded = NULL;
+    if (job->type == JOB_SNAPSHOT) {
+        // A snapshot covers the save's records queued before it; other
+        // files' writes keep their place.
+        AutosaveJob** tail = &superseded;
+        AutosaveJob* kept = NULL;
+        AutosaveJob* kept_tail = NULL;
+        for (AutosaveJob* queued = g_queue_head; queued != NULL; ) {
+            AutosaveJob* next = queued->next;
+            queued->next = NULL;
+            if (queued->type == JOB_FILE) {
+                if (kept_tail) kept_tail->next = queued;
+                else kept = queued;
+                kept_tail = queued;
+            } else {
+                *tail = queued;
+                tail = &queued->next;
+            }
+            queued = next;
+        }
+        g_queue_head = kept;
+        g_queue_tail = kept_tail;
+    }
+    if (g_queue_tail) g_queue_tail->next = job;
+    else g_queue_head = job;
+    g_queue_tail = job;
+    pthread_cond_signal(&g_queue_cond);
+    pthread_mutex_unlock(&g_queue_mutex);
+    free_jobs(superseded);
+}
+
+// Takes ownership of 'data'.
+static void enqueue(AutosaveJobType type, unsigned char* data, size_t size) {
+    AutosaveJob* job = calloc(1, sizeof(AutosaveJob));
+    if (job == NULL) {
+        free(data);
+        atomic_store(&g_need_snapshot, true);
+        return;
+    }
+    job->type = type;
+    job->data = data;
+    job->size = size;
+    push_job(job);
+}
+
+// --- Main Thread ---
+
+static void queue_snapshot(const GameState* game_state) {
+    unsigned char* data = NULL;
+    size_t size = 0;
+    if (save_state_encode(game_state, &data, &size) != SAVE_STATE_OK || !save_state_shadow_sync(g_shadow, game_state)) {
+        free(data);
+        atomic_store(&g_need_snapshot, true);
+        return;
+    }
+    atomic_store(&g_need_snapshot, false);
+    g_journal_records = 0;
+    g_journal_bytes = 0;
+    enqueue(JOB_SNAPSHOT, data, size);
+}
+
+bool autosave_start(const char* save_path, const GameState* game_state) {
+    if (g_running || save_path == NULL || game_state == NULL) return false;
+    snprintf(g_save_path, sizeof(g_save_path), "%s", save_path);
+    save_state_sibling_path(save_path, AUTOSAVE_JOURNAL_EXTENSION, g_journal_path, sizeof(g_journal_path));
+    g_shadow = save_state_shadow_create(game_state);
+    if (g_shadow == NULL) return false;
+
+    g_stopping = false;
+    if (pthread_create(&g_writer_thread, NULL, writer_thread_func, NULL) != 0) {
+        save_state_shadow_free(g_shadow);
+        g_shadow = NULL;
+        return false;
+    }
+    g_running = true;
+    queue_snapshot(game_state);
+    g_last_record_ms = get_current_time_ms();
+    return true;
+}
+
+void autosave_record(const GameState* game_state) {
+    if (!g_running) return;
+    g_last_record_ms = get_current_time_ms();
+    if (atomic_load(&g_need_snapshot) || g_journal_records >= AUTOSAVE_JOURNAL_MAX_RECORDS ||
+        g_journal_bytes >= AUTOSAVE_JOURNAL_MAX_BYTES) {
+        queue_snapshot(game_state);
+        return;
+    }
+
+    unsigned char* data = NULL;
+    size_t size = 0;
+    if (save_state_encode_delta(game_state, g_shadow, &data, &size) != SAVE_STATE_OK) {
+        // The shadow may have moved past what was recorded.
+        atomic_store(&g_need_snapshot, true);
+        return;
+    }
+    g_journal_records++;
+    g_journal_bytes += size + 4;
+    enqueue(JOB_JOURNAL, data, size);
+}
+
+void autosave_poll(const GameState* game_state) {
+    if (g_running && get_current_time_ms() - g_last_record_ms >= AUTOSAVE_PERIOD_MS) {
+        autosave_record(game_state);
+    }
+}
+
+void autosave_shutdown(const GameState* game_state) {
+    if (!g_running) return;
+    queue_snapshot(game_state);
+    pthread_mutex_lock(&g_queue_mutex);
+    g_stopping = true;
+    pthread_cond_signal(&g_queue_cond);
+    pthread_mutex_unlock(&g_queue_mutex);
+    pthread_join(g_writer_thread, NULL);
+    save_state_shadow_free(g_shadow);
+    g_shadow = NULL;
+    g_running = false;
+}
+
+void autosave_write_file(const char* path, AutosaveFileMode mode, unsigned char* data, size_t size, atomic_bool* failed) {
+    AutosaveJob* job = g_running ? calloc(1, sizeof(AutosaveJob)) : NULL;
+    char* path_copy = job ? strdup(path) : NULL;
+    if (path_copy == NULL) { // No writer (or no memory to queue for it): write here
+        free(job);
+        if (!write_session_file(path, mode, data, size) && failed) atomic_store(failed, true);
+        free(data);
+        return;
+    }
+    job->type = JOB_FILE;
+    job->data = data;
+    job->size = size;
+    job->path = path_copy;
+    job->mode = mode;
+    job->failed = failed;
+    push_job(job);
+}
@@ -0,0 +1,134 @@
+#include "command_registry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct CommandRegistry {
+    const CommandSpec* specs;
+    CommandTrie* names;   // Every command word -> spec index
+    CommandTrie* visible; // The ones completion and hints may offer
+    CommandArgTrieFunc arg_trie;
+};
+
+CommandRegistry* command_registry_create(const CommandSpec* specs, int count, CommandArgTrieFunc arg_trie) {
+    CommandRegistry* registry = calloc(1, sizeof(CommandRegistry));
+    if (registry == NULL) return NULL;
+    registry->specs = specs;
+    registry->arg_trie = arg_trie;
+    registry->names = command_trie_create();
+    registry->visible = command_trie_create();
+    bool ok = registry->names != NULL && registry->visible != NULL;
+    for (int i = 0; ok && i < count; i++) {
+        ok = command_trie_insert(registry->names, specs[i].name, i) &&
+             (specs[i].hidden || command_trie_insert(registry->visible, specs[i].name, i));
+    }
+    if (!ok) {
+        command_registry_free(registry);
+        return NULL;
+    }
+    return registry;
+}
+
+void command_registry_free(CommandRegistry* registry) {
+    if (registry == NULL) return;
+    command_trie_free(registry->names);
+    command_trie_free(registry->visible);
+    free(registry);
+}
+
+static size_t word_length(const char* s) {
+    size_t n = 0;
+    while (s[n] != '\0' && s[n] != ' ') n++;
+    return n;
+}
+
+bool command_registry_dispatch(const CommandRegistry* registry, const char* input, void* context, bool* result) {
+    if (registry == NULL || input == NULL) return false;
+    while (*input == ' ') input++;
+    size_t name_len = word_length(input);
+    int index = command_trie_find(registry->names, input, name_len);
+    if (index < 0) return false;
+
+    char arg[LINE_EDITOR_MAX_LENGTH];
+    const char* rest = input + name_len;
+    while (*rest == ' ') rest++;
+    snprintf(arg, sizeof(arg), "%s", rest);
+    size_t arg_len = strlen(arg);
+    while (arg_len > 0 && arg[arg_len - 1] == ' ') arg[--arg_len] = '\0';
+
+    bool handled = registry->specs[index].handler(context, arg);
+    if (result) *result = handled;
+    return true;
+}
+
+void command_registry_complete(const CommandRegistry* registry, const char* line, size_t cursor,
+                               void* context, LineEditorCompletion* out) {
+    out->insert[0] = '\0';
+    out->match_count = 0;
+    if (registry == NULL || line == NULL) return;
+
+    size_t start = 0;
+    while (start < cursor && line[start] == ' ') start++;
+    size_t name_len = word_length(line + start);
+
+    const CommandTrie* trie;
+    const char* word;
+    size_t word_len;
+    if (start + name_len >= cursor) {
+        // Still on the command word.
+        trie = registry->visible;
+        word = line + start;
+        word_len = cursor - start;
+    } else {
+        int index = command_trie_find(registry->names, line + start, name_len);
+        if (index < 0 || registry->specs[index].arg == COMMAND_ARG_NONE || registry->arg_trie == NULL) return;
+
+        char arg[LINE_EDITOR_MAX_LENGTH];
+        size_t arg_start = start + name_len;
+        while (arg_start < cursor && line[arg_start] == ' ') arg_start++;
+        size_t arg_len = cursor - arg_start;
+        if (arg_len >= sizeof(arg)) return;
+        memcpy(arg, line + arg_start, arg_len);
+        arg[arg_len] = '\0';
+
+        size_t word_start = 0;
+        trie = registry->arg_trie(context, registry->specs[index].arg, arg, &word_start);
+        if (word_start > arg_len) return;
+        word = line + arg_start + word_start;
+        word_len = arg_len - word_start;
+    }
+
+    command_trie_complete(trie, word, word_len, out);
+    if (out->match_count == 1) {
+        size_t len = strlen(out->insert);
+        const char* match = out->matches[0];
+        bool is_directory = match[0] != '\0' && match[strlen(match) - 1] == '/';
+        if (!is_directory && len + 1 < sizeof(out->insert)) {
+            out->insert[len] = ' ';
+            out->insert[len + 1] = '\0';
+        }
+    }
+}
+
+void command_registry_hint(const CommandRegistry* registry, const char* input, char* out, size_t size) {
+    if (size == 0) return;
+    out[0] = '\0';
+    if (registry == NULL || input == NULL) return;
+    while (*input == ' ') input++;
+
+    LineEditorCompletion completion;
+    completion.match_count = 0;
+    for (size_t len = word_length(input); len >= 2; len--) {
+        command_trie_complete(registry->visible, input, len, &completion);
+        if (completion.match_count > 0) break;
+    }
+    if (completion.match_count == 0) return;
+
+    size_t used = 0;
+    int listed = completion.match_count < LINE_EDITOR_COMPLETION_MAX ? completion.match_count : LINE_EDITOR_COMPLETION_MAX;
+    for (int i = 0; i < listed && used < size; i++) {
+        int n = snprintf(out + used, size - used, "%s%s", i > 0 ? ", " : "", completion.matches[i]);
+        if (n < 0) break;
+        used += (size_t)n;
+    }
+}
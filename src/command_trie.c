@@ -0,0 +1,267 @@
+#include "command_trie.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct TrieNode {
+    struct TrieNode** children; // Sorted by the first byte of their labels
+    int child_count;
+    int child_capacity;
+    int value;                  // -1 if no key ends here
+    size_t label_len;
+    char label[];               // Bytes on the edge from the parent; empty at the root
+} TrieNode;
+
+struct CommandTrie {
+    TrieNode* root;
+    int count;
+};
+
+static TrieNode* node_create(const char* label, size_t label_len, int value) {
+    TrieNode* node = malloc(sizeof(TrieNode) + label_len);
+    if (node == NULL) return NULL;
+    node->children = NULL;
+    node->child_count = 0;
+    node->child_capacity = 0;
+    node->value = value;
+    node->label_len = label_len;
+    memcpy(node->label, label, label_len);
+    return node;
+}
+
+static void node_free(TrieNode* node) {
+    if (node == NULL) return;
+    for (int i = 0; i < node->child_count; i++) node_free(node->children[i]);
+    free(node->children);
+    free(node);
+}
+
+// The child whose label starts with 'c', or NULL; *index is where it is or
+// would be inserted.
+static TrieNode* find_child(const TrieNode* node, unsigned char c, int* index) {
+    int lo = 0, hi = node->child_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        unsigned char first = (unsigned char)node->children[mid]->label[0];
+        if (first == c) {
+            if (index) *index = mid;
+            return node->children[mid];
+        }
+        if (first < c) lo = mid + 1;
+        else hi = mid;
+    }
+    if (index) *index = lo;
+    return NULL;
+}
+
+static bool add_child(TrieNode* node, int index, TrieNode* child) {
+    if (node->child_count == node->child_capacity) {
+        int capacity = node->child_capacity ? node->child_capacity * 2 : 2;
+        TrieNode** children = realloc(node->children, sizeof(TrieNode*) * capacity);
+        if (children == NULL) return false;
+        node->children = children;
+        node->child_capacity = capacity;
+    }
+    memmove(node->children + index + 1, node->children + index, sizeof(TrieNode*) * (node->child_count - index));
+    node->children[index] = child;
+    node->child_count++;
+    return true;
+}
+
+static void drop_child(TrieNode* node, int index) {
+    memmove(node->children + index, node->children + index + 1, sizeof(TrieNode*) * (node->child_count - index - 1));
+    node->child_count--;
+}
+
+// Folds a keyless node with a single child into that child. Returns the node
+// now in its place (the same one if memory ran out; the trie stays valid).
+static TrieNode* merge_with_child(TrieNode* node) {
+    TrieNode* child = node->children[0];
+    TrieNode* merged = malloc(sizeof(TrieNode) + node->label_len + child->label_len);
+    if (merged == NULL) return node;
+    merged->children = child->children;
+    merged->child_count = child->child_count;
+    merged->child_capacity = child->child_capacity;
+    merged->value = child->value;
+    merged->label_len = node->label_len + child->label_len;
+    memcpy(merged->label, node->label, node->label_len);
+    memcpy(merged->label + node->label_len, child->label, child->label_len);
+    free(node->children);
+    free(node);
+    free(child);
+    return merged;
+}
+
+CommandTrie* command_trie_create(void) {
+    CommandTrie* trie = malloc(sizeof(CommandTrie));
+    if (trie == NULL) return NULL;
+    trie->root = node_create("", 0, -1);
+    if (trie->root == NULL) {
+        free(trie);
+        return NULL;
+    }
+    trie->count = 0;
+    return trie;
+}
+
+void command_trie_free(CommandTrie* trie) {
+    if (trie == NULL) return;
+    node_free(trie->root);
+    free(trie);
+}
+
+void command_trie_clear(CommandTrie* trie) {
+    if (trie == NULL) return;
+    for (int i = 0; i < trie->root->child_count; i++) node_free(trie->root->children[i]);
+    trie->root->child_count = 0;
+    trie->root->value = -1;
+    trie->count = 0;
+}
+
+bool command_trie_insert(CommandTrie* trie, const char* key, int value) {
+    if (trie == NULL || key == NULL || key[0] == '\0' || value < 0) return false;
+    size_t len = strlen(key);
+    TrieNode* node = trie->root;
+    size_t pos = 0;
+
+    while (pos < len) {
+        int index;
+        TrieNode* child = find_child(node, (unsigned char)key[pos], &index);
+        if (child == NULL) {
+            TrieNode* leaf = node_create(key + pos, len - pos, value);
+            if (leaf == NULL || !add_child(node, index, leaf)) {
+                free(leaf);
+                return false;
+            }
+            trie->count++;
+            return true;
+        }
+
+        size_t common = 1;
+        while (common < child->label_len && pos + common < len && child->label[common] == key[pos + common]) common++;
+        if (common < child->label_len) {
+            // The key leaves (or ends inside) this edge: split it where it does.
+            TrieNode* split = node_create(child->label, common, -1);
+            if (split == NULL || !add_child(split, 0, child)) {
+                free(split);
+                return false;
+            }
+            memmove(child->label, child->label + common, child->label_len - common);
+            child->label_len -= common;
+            node->children[index] = split;
+            child = split;
+        }
+        node = child;
+        pos += common;
+    }
+
+    if (node->value < 0) trie->count++;
+    node->value = value;
+    return true;
+}
+
+static bool remove_below(TrieNode* node, const char* key, size_t len) {
+    int index;
+    TrieNode* child = find_child(node, (unsigned char)key[0], &index);
+    if (child == NULL || child->label_len > len || memcmp(child->label, key, child->label_len) != 0) return false;
+
+    if (child->label_len == len) {
+        if (child->value < 0) return false;
+        child->value = -1;
+    } else if (!remove_below(child, key + child->label_len, len - child->label_len)) {
+        return false;
+    }
+
+    // Keep the trie compact: no keyless leaves, no keyless single-child links.
+    if (child->value < 0 && child->child_count == 0) {
+        node_free(child);
+        drop_child(node, index);
+    } else if (child->value < 0 && child->child_count == 1) {
+        node->children[index] = merge_with_child(child);
+    }
+    return true;
+}
+
+bool command_trie_remove(CommandTrie* trie, const char* key) {
+    if (trie == NULL || key == NULL || key[0] == '\0') return false;
+    if (!remove_below(trie->root, key, strlen(key))) return false;
+    trie->count--;
+    return true;
+}
+
+int command_trie_find(const CommandTrie* trie, const char* key, size_t len) {
+    if (trie == NULL || key == NULL || len == 0) return -1;
+    const TrieNode* node = trie->root;
+    size_t pos = 0;
+    while (pos < len) {
+        const TrieNode* child = find_child(node, (unsigned char)key[pos], NULL);
+        if (child == NULL || child->label_len > len - pos || memcmp(child->label, key + pos, child->label_len) != 0) return -1;
+        node = child;
+        pos += child->label_len;
+    }
+    return node->value;
+}
+
+int command_trie_count(const CommandTrie* trie) {
+    return trie ? trie->count : 0;
+}
+
+// --- Completion ---
+
+#define COMPLETION_PATH_MAX 256
+
+static void append_bytes(char* buf, size_t size, size_t* len, const char* bytes, size_t n) {
+    if (*len + n >= size) n = size - 1 - *len;
+    memcpy(buf + *len, bytes, n);
+    *len += n;
+    buf[*len] = '\0';
+}
+
+static void collect_matches(const TrieNode* node, char* path, size_t path_len, LineEditorCompletion* out) {
+    if (node->value >= 0) {
+        if (out->match_count < LINE_EDITOR_COMPLETION_MAX) {
+            size_t n = path_len < LINE_EDITOR_COMPLETION_NAME - 1 ? path_len : LINE_EDITOR_COMPLETION_NAME - 1;
+            memcpy(out->matches[out->match_count], path, n);
+            out->matches[out->match_count][n] = '\0';
+        }
+        out->match_count++;
+    }
+    for (int i = 0; i < node->child_count; i++) {
+        size_t len = path_len;
+        append_bytes(path, COMPLETION_PATH_MAX, &len, node->children[i]->label, node->children[i]->label_len);
+        collect_matches(node->children[i], path, len, out);
+    }
+}
+
+void command_trie_complete(const CommandTrie* trie, const char* prefix, size_t len, LineEditorCompletion* out) {
+    out->insert[0] = '\0';
+    out->match_count = 0;
+    if (trie == NULL) return;
+
+    // Walk the prefix; it may end partway along an edge.
+    const TrieNode* node = trie->root;
+    size_t pos = 0, into_label = 0;
+    while (pos < len) {
+        const TrieNode* child = find_child(node, (unsigned char)prefix[pos], NULL);
+        if (child == NULL) return;
+        size_t n = child->label_len < len - pos ? child->label_len : len - pos;
+        if (memcmp(child->label, prefix + pos, n) != 0) return;
+        node = child;
+        pos += n;
+        into_label = n;
+    }
+
+    char path[COMPLETION_PATH_MAX];
+    size_t path_len = 0;
+    path[0] = '\0';
+    append_bytes(path, sizeof(path), &path_len, prefix, len);
+    append_bytes(path, sizeof(path), &path_len, node->label + into_label, node->label_len - into_label);
+    collect_matches(node, path, path_len, out);
+
+    // Everything below shares the rest of this edge and any keyless chain after it.
+    size_t insert_len = 0;
+    append_bytes(out->insert, sizeof(out->insert), &insert_len, node->label + into_label, node->label_len - into_label);
+    while (node->value < 0 && node->child_count == 1) {
+        node = node->children[0];
+        append_bytes(out->insert, sizeof(out->insert), &insert_len, node->label, node->label_len);
+    }
+}
@@ -130,4 +130,35 @@ int decompress_string(const unsigned char* compressed_data, unsigned long compre
     // Clean up and return
     inflateEnd(&strm);
     return Z_OK;
-}
\ No newline at end of file
+}
+
+int decompress_with_dictionary(const unsigned char* compressed_data, unsigned long compressed_data_len,
+                               const unsigned char* dictionary, unsigned int dictionary_len,
+                               unsigned char* out, unsigned long out_len) {
+    int ret;
+    z_stream strm;
+
+    // Allocate inflate state
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+    strm.avail_in = compressed_data_len;
+    strm.next_in = (unsigned char*)compressed_data;
+    ret = inflateInit(&strm);
+    if (ret != Z_OK)
+        return ret;
+
+    strm.avail_out = out_len;
+    strm.next_out = out;
+    ret = inflate(&strm, Z_FINISH);
+    if (ret == Z_NEED_DICT && dictionary != NULL) {
+        ret = inflateSetDictionary(&strm, dictionary, dictionary_len);
+        if (ret == Z_OK) ret = inflate(&strm, Z_FINISH);
+    }
+
+    // The whole stream must fit the buffer exactly.
+    if (ret == Z_STREAM_END && strm.avail_out == 0) ret = Z_OK;
+    else if (ret == Z_OK || ret == Z_BUF_ERROR || ret == Z_STREAM_END) ret = Z_DATA_ERROR;
+    inflateEnd(&strm);
+    return ret;
+}
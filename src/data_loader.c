@@ -6,13 +6,17 @@
 #include "string_id_names.h"
 #include "string_table.h"
 #include "characters/mika.h"
+#include "npc_schedule.h"
 #include "logger.h"
+#include "byte_util.h"
+#include "player_items.h"
+#include "map_loader.h"
+#include "items_data.h" // Generated from items.json
+#include "character_data.h" // Generated from character.json
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-extern const char* g_embedded_strings[TEXT_COUNT];
-
 DataLoaderStatus read_entire_file(const char* path, char** buffer_ptr, long* length_ptr) {
     if (!path || !buffer_ptr || !length_ptr) {
         return DATA_LOADER_ERROR_FILE_OPEN; // Or a new status for invalid args
@@ -58,7 +62,7 @@ DataLoaderStatus read_entire_file(const char* path, char** buffer_ptr, long* len
 }
 
 int load_string_table() {
-    init_string_table(g_embedded_strings, TEXT_COUNT);
+    init_string_table();
     return 1;
 }
 
@@ -99,12 +103,16 @@ int load_player_state(const char* path, GameState* game_state) {
 
     LOG_DEBUG("JSON parsed successfully. Checking items...");
 
+    // Every field starts from the compiled-in template; the file overrides it.
+    const CharacterTemplate* defaults = &CHARACTER_TEMPLATE;
+
     cJSON* credit_level = cJSON_GetObjectItemCaseSensitive(root, "credit_level");
     if (cJSON_IsNumber(credit_level)) {
         player_state->credit_level = credit_level->valueint;
         LOG_DEBUG("Loaded credit_level: %d", player_state->credit_level);
     } else {
-        LOG_DEBUG("Failed to load credit_level");
+        LOG_DEBUG("Failed to load credit_level (Using default)");
+        player_state->credit_level = defaults->credit_level;
     }
     
     cJSON *time_json = cJSON_GetObjectItemCaseSensitive(root, "time_of_day");
@@ -113,99 +121,111 @@ int load_player_state(const char* path, GameState* game_state) {
         LOG_DEBUG("Loaded time_of_day: %u", game_state->time_of_day);
     } else {
         LOG_DEBUG("Failed to load time_of_day (Using default)");
-        const uint32_t default_start_time_units = (2 * 24 * 60 * 60 * 16) + (20 * 60 * 60 * 16);
-        game_state->time_of_day = encode_time_with_ecc(default_start_time_units);
+        game_state->time_of_day = defaults->time_of_day;
     }
     cJSON* persona_perm = cJSON_GetObjectItemCaseSensitive(root, "persona_permissions");
     if (cJSON_IsNumber(persona_perm)) {
         player_state->persona_permissions = (uint8_t)persona_perm->valueint;
     } else {
         // Default: Lain has full control (RWX), Shu is dormant (0)
-        player_state->persona_permissions = 7; 
+        player_state->persona_permissions = defaults->persona_permissions;
     }
 
     cJSON* location = cJSON_GetObjectItemCaseSensitive(root, "location");
-    if (cJSON_IsString(location)) {
-        strncpy(player_state->location, location->valuestring, MAX_NAME_LENGTH - 1);
-    } else {
-        strncpy(player_state->location, "iwakura_upper_hallway", MAX_NAME_LENGTH - 1);
-    }
+    player_state->location = location_id_from_string(cJSON_IsString(location) ? location->valuestring : defaults->location);
 
     const cJSON *typewriter_delay_json = cJSON_GetObjectItemCaseSensitive(root, "typewriter_delay");
     if (cJSON_IsNumber(typewriter_delay_json)) {
         game_state->typewriter_delay = (float)typewriter_delay_json->valuedouble;
     } else {
-        game_state->typewriter_delay = 0.04f;
+        game_state->typewriter_delay = defaults->typewriter_delay;
     }
 
+    // Names are interned here; ones the tables do not know are dropped.
     const cJSON *inventory = cJSON_GetObjectItemCaseSensitive(root, "inventory");
-    player_state->inventory_count = 0;
+    player_clear_items(player_state);
     if (cJSON_IsObject(inventory)) {
         cJSON *item_json;
         cJSON_ArrayForEach(item_json, inventory) {
-            if (player_state->inventory_count < MAX_INVENTORY_ITEMS) {
-                InventoryItem *item = &player_state->inventory[player_state->inventory_count];
-                strncpy(item->name, item_json->string, MAX_NAME_LENGTH - 1);
-                item->quantity = cJSON_IsNumber(item_json) ? item_json->valueint : 0;
-                player_state->inventory_count++;
+            ItemID item = item_id_from_string(item_json->string);
+            if (item == ITEM_NONE) {
+                LOG_DEBUG("Unknown item '%s' in %s; dropped.", item_json->string, path);
+            } else {
+                player_set_item_quantity(player_state, item, cJSON_IsNumber(item_json) ? item_json->valueint : 0);
             }
         }
+    } else {
+        for (int i = 0; i < defaults->inventory_count; i++) {
+            player_set_item_quantity(player_state, item_id_from_string(defaults->inventory[i].name), defaults->inventory[i].quantity);
+        }
     }
 
     const cJSON *commands = cJSON_GetObjectItemCaseSensitive(root, "unlocked_commands");
-    player_state->unlocked_commands_count = 0;
+    player_state->commands = 0;
     if (cJSON_IsArray(commands)) {
         cJSON *command_json;
         cJSON_ArrayForEach(command_json, commands) {
-            if (cJSON_IsString(command_json) && player_state->unlocked_commands_count < MAX_COMMANDS) {
-                strncpy(player_state->unlocked_commands[player_state->unlocked_commands_count], command_json->valuestring, MAX_NAME_LENGTH - 1);
-                player_state->unlocked_commands_count++;
+            if (!cJSON_IsString(command_json)) continue;
+            CommandID command = command_id_from_string(command_json->valuestring);
+            if (command == COMMAND_NONE) {
+                LOG_DEBUG("Unknown command '%s' in %s; dropped.", command_json->valuestring, path);
+            } else {
+                player_unlock_command(player_state, command);
             }
         }
+    } else {
+        for (int i = 0; i < defaults->unlocked_commands_count; i++) {
+            player_unlock_command(player_state, command_id_from_string(defaults->unlocked_commands[i]));
+        }
     }
 
     const cJSON *story_file = cJSON_GetObjectItemCaseSensitive(root, "current_story_file");
-    if (cJSON_IsString(story_file)) strncpy(game_state->current_story_file, story_file->valuestring, MAX_PATH_LENGTH - 1);
-    else strncpy(game_state->current_story_file, "SCENE_00_ENTRY", MAX_PATH_LENGTH - 1);
-
-    // time_of_day is already loaded above for debug logging purposes.
-    // If we need to reload it or if the logic flow requires it here, we can reuse 'time_json' variable if scope allows,
-    // or just rely on the fact it was loaded.
-    // However, looking at my previous edit, I added the loading logic right after credit_level.
-    // So I should remove the DUPLICATE loading block here.
-    
-    // Removing the duplicate block...
+    strncpy(game_state->current_story_file, cJSON_IsString(story_file) ? story_file->valuestring : defaults->current_story_file, MAX_PATH_LENGTH - 1);
 
     const cJSON *doll_lain = cJSON_GetObjectItemCaseSensitive(root, "doll_state_lain_room");
     if (cJSON_IsNumber(doll_lain)) game_state->doll_state_lain_room = (int8_t)doll_lain->valueint;
-    else game_state->doll_state_lain_room = DOLL_STATE_NORMAL;
+    else game_state->doll_state_lain_room = defaults->doll_state_lain_room;
 
     const cJSON *doll_mika = cJSON_GetObjectItemCaseSensitive(root, "doll_state_mika_room");
     if (cJSON_IsNumber(doll_mika)) game_state->doll_state_mika_room = (int8_t)doll_mika->valueint;
-    else game_state->doll_state_mika_room = DOLL_STATE_NORMAL;
+    else game_state->doll_state_mika_room = defaults->doll_state_mika_room;
 
     // Load Mika State
     const cJSON *mika_state_json = cJSON_GetObjectItemCaseSensitive(root, "mika_state");
-    if (cJSON_IsObject(mika_state_json)) {
-        const cJSON *loc = cJSON_GetObjectItemCaseSensitive(mika_state_json, "current_location");
-        const cJSON *manual = cJSON_GetObjectItemCaseSensitive(mika_state_json, "is_manually_positioned");
-        const cJSON *sanity_json = cJSON_GetObjectItemCaseSensitive(mika_state_json, "sanity_level");
-        
-        int sanity_val = 0;
-        if (cJSON_IsNumber(sanity_json)) {
-            sanity_val = sanity_json->valueint;
-        }
+    const cJSON *loc = cJSON_GetObjectItemCaseSensitive(mika_state_json, "current_location");
+    const cJSON *manual = cJSON_GetObjectItemCaseSensitive(mika_state_json, "is_manually_positioned");
+    const cJSON *sanity_json = cJSON_GetObjectItemCaseSensitive(mika_state_json, "sanity_level");
+    int sanity_val = cJSON_IsNumber(sanity_json) ? sanity_json->valueint : defaults->mika_sanity_level;
+
+    if (cJSON_IsString(loc) && cJSON_IsBool(manual)) {
+        strncpy(game_state->mika_location_storage, loc->valuestring, MAX_NAME_LENGTH - 1);
+        restore_mika_state(game_state->mika_location_storage, cJSON_IsTrue(manual), sanity_val);
+    } else {
+        // Fallback if missing or partially missing
+        restore_mika_state(defaults->mika_location, defaults->mika_is_manually_positioned, sanity_val);
+    }
 
-        if (cJSON_IsString(loc) && cJSON_IsBool(manual)) {
-             strncpy(game_state->mika_location_storage, loc->valuestring, MAX_NAME_LENGTH - 1);
-             restore_mika_state(game_state->mika_location_storage, cJSON_IsTrue(manual), sanity_val);
+    // Exported saves carry every NPC; this overrides mika_state above.
+    const cJSON *npcs = cJSON_GetObjectItemCaseSensitive(root, "npcs");
+    const cJSON *npc_json;
+    cJSON_ArrayForEach(npc_json, npcs) {
+        NpcId npc = npc_from_key(npc_json->string);
+        const cJSON *npc_loc = cJSON_GetObjectItemCaseSensitive(npc_json, "current_location");
+        const cJSON *npc_manual = cJSON_GetObjectItemCaseSensitive(npc_json, "is_manually_positioned");
+        const cJSON *npc_state = cJSON_GetObjectItemCaseSensitive(npc_json, "state");
+        if (npc == NPC_COUNT || !cJSON_IsString(npc_loc) || !cJSON_IsNumber(npc_state)) continue;
+        if (npc == NPC_MIKA) {
+            strncpy(game_state->mika_location_storage, npc_loc->valuestring, MAX_NAME_LENGTH - 1);
+            restore_mika_state(game_state->mika_location_storage, cJSON_IsTrue(npc_manual), npc_state->valueint);
         } else {
-             // Fallback if partially missing
-             restore_mika_state("iwakura_mikas_room", false, sanity_val);
+            npc_restore(npc, npc_loc->valuestring, cJSON_IsTrue(npc_manual), npc_state->valueint);
         }
-    } else {
-        // Default
-        restore_mika_state("iwakura_mikas_room", false, 0);
+    }
+
+    const cJSON *flags = cJSON_GetObjectItemCaseSensitive(root, "flags");
+    const cJSON *flag_json;
+    cJSON_ArrayForEach(flag_json, flags) {
+        if (cJSON_IsString(flag_json)) hash_table_set(game_state->flags, flag_json->string, flag_json->valuestring);
     }
 
     DecodedTimeResult time_check = decode_time_with_ecc(game_state->time_of_day);
@@ -219,40 +239,29 @@ int load_player_state(const char* path, GameState* game_state) {
     return 1;
 }
 
-#include "items_data.h"
-
-int load_items_data(GameState* game_state) {
-    if (game_state == NULL) return 0;
-    
-    const char *json_string = ITEMS_JSON_DATA;
-    cJSON *root = cJSON_Parse(json_string);
-    if (root == NULL) {
-        fprintf(stderr, "Error: Failed to parse embedded items.json data.\n");
-        return 0;
-    }
-
-    game_state->item_count = 0;
-    cJSON *item_json;
-    cJSON_ArrayForEach(item_json, root) {
-        if (game_state->item_count >= MAX_ITEMS) break;
-
-        Item *item = &game_state->all_items[game_state->item_count];
-        strncpy(item->id, item_json->string, MAX_NAME_LENGTH - 1);
-
-        const cJSON *name = cJSON_GetObjectItemCaseSensitive(item_json, "name");
-        if (cJSON_IsString(name)) strncpy(item->name, name->valuestring, MAX_NAME_LENGTH - 1);
+const Item* find_item_by_id(const char* item_id) {
+    if (item_id == NULL) return NULL;
+    // Same seeded FNV-1a as the generator; the hash is perfect, so one probe.
+    int entry = g_item_hash[fnv1a_seeded(item_id, ITEM_HASH_SEED) >> (32 - ITEM_HASH_BITS)];
+    if (entry == 0 || strcmp(g_items[entry - 1].id, item_id) != 0) return NULL;
+    return &g_items[entry - 1];
+}
 
-        const cJSON *desc = cJSON_GetObjectItemCaseSensitive(item_json, "description");
-        if (cJSON_IsString(desc)) strncpy(item->description, desc->valuestring, MAX_DESC_LENGTH - 1);
+ItemID item_id_from_string(const char* item_id) {
+    const Item* item = find_item_by_id(item_id);
+    return item ? (ItemID)(item - g_items) : ITEM_NONE;
+}
 
-        const cJSON *credit = cJSON_GetObjectItemCaseSensitive(item_json, "required_credit");
-        if (cJSON_IsNumber(credit)) item->required_credit = credit->valueint;
+const Item* item_by_id(ItemID item) {
+    return item < ITEM_TABLE_COUNT ? &g_items[item] : NULL;
+}
 
-        game_state->item_count++;
-    }
+const CharacterTemplate* character_template(void) {
+    return &CHARACTER_TEMPLATE;
+}
 
-    cJSON_Delete(root);
-    return 1;
+const char* character_template_json(void) {
+    return CHARACTER_JSON_DATA;
 }
 
 
@@ -265,48 +274,65 @@ void cleanup_game_state(GameState* game_state) {
     cleanup_string_table();
 }
 
-int save_game_state(const char* path, const GameState* game_state) {
+// --- JSON Export ---
+
+static void export_flag(const char* key, const char* value, void* context) {
+    cJSON_AddStringToObject((cJSON*)context, key, value);
+}
+
+int export_game_state_json(const char* path, const GameState* game_state) {
     if (game_state == NULL) return 0;
 
     const PlayerState* p_state = &game_state->player_state;
     cJSON *root = cJSON_CreateObject();
     if (!root) return 0;
 
-    cJSON_AddStringToObject(root, "location", p_state->location);
+    cJSON_AddStringToObject(root, "location", location_id_to_string(p_state->location));
     cJSON_AddNumberToObject(root, "credit_level", p_state->credit_level);
     cJSON_AddNumberToObject(root, "persona_permissions", p_state->persona_permissions);
     cJSON_AddStringToObject(root, "current_story_file", game_state->current_story_file);
     cJSON_AddNumberToObject(root, "time_of_day", game_state->time_of_day);
+    cJSON_AddNumberToObject(root, "typewriter_delay", game_state->typewriter_delay);
     cJSON_AddNumberToObject(root, "doll_state_lain_room", game_state->doll_state_lain_room);
     cJSON_AddNumberToObject(root, "doll_state_mika_room", game_state->doll_state_mika_room);
 
-    // Save Mika State
-    const CharacterMika* mika = get_mika_module();
-    if (mika) {
-        cJSON *mika_obj = cJSON_CreateObject();
-        cJSON_AddStringToObject(mika_obj, "current_location", mika->current_location_id ? mika->current_location_id : "unknown");
-        cJSON_AddBoolToObject(mika_obj, "is_manually_positioned", mika->is_manually_positioned);
-        cJSON_AddNumberToObject(mika_obj, "sanity_level", mika->sanity_level);
-        cJSON_AddItemToObject(root, "mika_state", mika_obj);
+    // Every NPC, Mika included (her state is her sanity level).
+    cJSON *npcs = cJSON_CreateObject();
+    if (npcs) {
+        cJSON_AddItemToObject(root, "npcs", npcs);
+        for (int npc = 0; npc < NPC_COUNT; npc++) {
+            cJSON *npc_obj = cJSON_CreateObject();
+            if (!npc_obj) continue;
+            cJSON_AddStringToObject(npc_obj, "current_location", npc_current_location((NpcId)npc));
+            cJSON_AddBoolToObject(npc_obj, "is_manually_positioned", npc_is_manually_positioned((NpcId)npc));
+            cJSON_AddNumberToObject(npc_obj, "state", npc_get_state((NpcId)npc));
+            cJSON_AddItemToObject(npcs, npc_key((NpcId)npc), npc_obj);
+        }
     }
 
     cJSON *inv = cJSON_CreateObject();
     if (inv) {
         cJSON_AddItemToObject(root, "inventory", inv);
-        for (int i = 0; i < p_state->inventory_count; i++) {
-            cJSON_AddNumberToObject(inv, p_state->inventory[i].name, p_state->inventory[i].quantity);
+        for (int i = player_next_item(p_state, 0); i >= 0; i = player_next_item(p_state, i + 1)) {
+            cJSON_AddNumberToObject(inv, item_by_id((ItemID)i)->id, player_item_quantity(p_state, (ItemID)i));
         }
     }
 
     cJSON *cmds = cJSON_CreateArray();
     if (cmds) {
         cJSON_AddItemToObject(root, "unlocked_commands", cmds);
-        for (int i = 0; i < p_state->unlocked_commands_count; i++) {
-            cJSON *cmd_str = cJSON_CreateString(p_state->unlocked_commands[i]);
+        for (int i = player_next_command(p_state, 0); i >= 0; i = player_next_command(p_state, i + 1)) {
+            cJSON *cmd_str = cJSON_CreateString(command_name((CommandID)i));
             if (cmd_str) cJSON_AddItemToArray(cmds, cmd_str);
         }
     }
-    
+
+    cJSON *flags = cJSON_CreateObject();
+    if (flags) {
+        cJSON_AddItemToObject(root, "flags", flags);
+        hash_table_foreach(game_state->flags, export_flag, flags);
+    }
+
     char *json_string = cJSON_Print(root);
     cJSON_Delete(root);
     if (!json_string) return 0;
@@ -317,9 +343,9 @@ int save_game_state(const char* path, const GameState* game_state) {
         return 0;
     }
 
-    fprintf(file, "%s", json_string);
+    fprintf(file, "%s\n", json_string);
     fclose(file);
     free(json_string);
 
     return 1;
-}
\ No newline at end of file
+}
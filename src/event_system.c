@@ -1,52 +1,149 @@
 #include "event_system.h"
-#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
-// A simple circular queue for events
-static Event event_queue[MAX_EVENTS];
-static int queue_head = 0;
-static int queue_tail = 0;
-static int event_count = 0;
+// Bounded MPSC ring (Vyukov-style): every cell carries a sequence number that
+// tells producers whether it is free for lap 'pos' and the consumer whether it
+// has been published. Producers claim cells with one CAS on the tail; the single
+// consumer owns the head outright, so neither side ever takes a lock and
+// push_event() can be called from a signal handler.
 
-// Mutex to make the event queue thread-safe
-static pthread_mutex_t queue_mutex;
+#define EVENT_CACHE_LINE 64
+#define EVENT_RING_MASK (MAX_EVENTS - 1)
+
+_Static_assert((MAX_EVENTS & EVENT_RING_MASK) == 0, "MAX_EVENTS must be a power of two");
+
+typedef struct {
+    _Alignas(EVENT_CACHE_LINE) atomic_size_t sequence;
+    Event event;
+} EventCell;
+
+// Producer and consumer indices live on separate cache lines so a busy
+// producer does not keep invalidating the consumer's line and vice versa.
+static EventCell g_cells[MAX_EVENTS];
+static _Alignas(EVENT_CACHE_LINE) atomic_size_t g_enqueue_pos;
+static _Alignas(EVENT_CACHE_LINE) size_t g_dequeue_pos;
+static _Alignas(EVENT_CACHE_LINE) atomic_uint g_pending_ticks;
+
+static _Alignas(EVENT_CACHE_LINE) atomic_uint_fast64_t g_pushed;
+static atomic_uint_fast64_t g_polled;
+static atomic_uint_fast64_t g_dropped[EVENT_TYPE_COUNT];
+static atomic_uint_fast64_t g_ticks_produced;
+static atomic_uint_fast64_t g_tick_events;
 
 void init_event_queue(void) {
-    pthread_mutex_init(&queue_mutex, NULL);
-    queue_head = 0;
-    queue_tail = 0;
-    event_count = 0;
+    for (size_t i = 0; i < MAX_EVENTS; i++) {
+        atomic_init(&g_cells[i].sequence, i);
+        memset(&g_cells[i].event, 0, sizeof(Event));
+    }
+    atomic_init(&g_enqueue_pos, 0);
+    g_dequeue_pos = 0;
+    atomic_init(&g_pending_ticks, 0);
+
+    atomic_init(&g_pushed, 0);
+    atomic_init(&g_polled, 0);
+    for (int i = 0; i < EVENT_TYPE_COUNT; i++) atomic_init(&g_dropped[i], 0);
+    atomic_init(&g_ticks_produced, 0);
+    atomic_init(&g_tick_events, 0);
+}
+
+static bool try_push(const Event* e) {
+    size_t pos = atomic_load_explicit(&g_enqueue_pos, memory_order_relaxed);
+    EventCell* cell;
+    for (;;) {
+        cell = &g_cells[pos & EVENT_RING_MASK];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&g_enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // Full: the consumer has not released this cell yet
+        } else {
+            pos = atomic_load_explicit(&g_enqueue_pos, memory_order_relaxed);
+        }
+    }
+    cell->event = *e;
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    atomic_fetch_add_explicit(&g_pushed, 1, memory_order_relaxed);
+    return true;
+}
+
+static bool try_pop(Event* e) {
+    EventCell* cell = &g_cells[g_dequeue_pos & EVENT_RING_MASK];
+    size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    if ((intptr_t)seq - (intptr_t)(g_dequeue_pos + 1) < 0) {
+        return false; // Empty, or the next producer has not published yet
+    }
+    *e = cell->event;
+    atomic_store_explicit(&cell->sequence, g_dequeue_pos + MAX_EVENTS, memory_order_release);
+    g_dequeue_pos++;
+    return true;
 }
 
 bool push_event(Event e) {
-    pthread_mutex_lock(&queue_mutex);
-    
-    if (event_count >= MAX_EVENTS) {
-        // Queue is full
-        pthread_mutex_unlock(&queue_mutex);
+    if (e.type <= EVENT_TYPE_NONE || e.type >= EVENT_TYPE_COUNT) return false;
+    if (e.type == TIME_TICK_EVENT) {
+        push_tick_event();
+        return true;
+    }
+    if (!try_push(&e)) {
+        atomic_fetch_add_explicit(&g_dropped[e.type], 1, memory_order_relaxed);
         return false;
     }
-    
-    event_queue[queue_tail] = e;
-    queue_tail = (queue_tail + 1) % MAX_EVENTS;
-    event_count++;
-    
-    pthread_mutex_unlock(&queue_mutex);
     return true;
 }
 
-bool poll_event(Event *e) {
-    pthread_mutex_lock(&queue_mutex);
-    
-    if (event_count == 0) {
-        // Queue is empty
-        pthread_mutex_unlock(&queue_mutex);
-        return false;
+void push_tick_event(void) {
+    atomic_fetch_add_explicit(&g_ticks_produced, 1, memory_order_relaxed);
+    // Only the tick that finds the counter at zero enqueues a marker; later ones
+    // just bump the count until the consumer collects it.
+    if (atomic_fetch_add_explicit(&g_pending_ticks, 1, memory_order_acq_rel) == 0) {
+        Event marker;
+        memset(&marker, 0, sizeof(marker));
+        marker.type = TIME_TICK_EVENT;
+        // If the ring is full the count stays pending; poll_event() picks it up
+        // once the ring drains, so no tick is ever lost.
+        (void)try_push(&marker);
     }
-    
-    *e = event_queue[queue_head];
-    queue_head = (queue_head + 1) % MAX_EVENTS;
-    event_count--;
-    
-    pthread_mutex_unlock(&queue_mutex);
+}
+
+static bool collect_ticks(Event* e) {
+    unsigned int count = atomic_exchange_explicit(&g_pending_ticks, 0, memory_order_acq_rel);
+    if (count == 0) return false;
+    memset(e, 0, sizeof(*e));
+    e->type = TIME_TICK_EVENT;
+    e->data.tick.count = count;
+    atomic_fetch_add_explicit(&g_tick_events, 1, memory_order_relaxed);
     return true;
 }
+
+bool poll_event(Event *e) {
+    for (;;) {
+        if (!try_pop(e)) {
+            // A tick marker may have been rejected by a full ring.
+            if (!collect_ticks(e)) return false;
+            atomic_fetch_add_explicit(&g_polled, 1, memory_order_relaxed);
+            return true;
+        }
+        // A marker whose count was already collected above carries nothing.
+        if (e->type == TIME_TICK_EVENT && !collect_ticks(e)) continue;
+        atomic_fetch_add_explicit(&g_polled, 1, memory_order_relaxed);
+        return true;
+    }
+}
+
+void get_event_queue_stats(EventQueueStats* out_stats) {
+    if (out_stats == NULL) return;
+    out_stats->pushed = atomic_load_explicit(&g_pushed, memory_order_relaxed);
+    out_stats->polled = atomic_load_explicit(&g_polled, memory_order_relaxed);
+    for (int i = 0; i < EVENT_TYPE_COUNT; i++) {
+        out_stats->dropped[i] = atomic_load_explicit(&g_dropped[i], memory_order_relaxed);
+    }
+    out_stats->ticks_produced = atomic_load_explicit(&g_ticks_produced, memory_order_relaxed);
+    out_stats->tick_events = atomic_load_explicit(&g_tick_events, memory_order_relaxed);
+}
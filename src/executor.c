@@ -3,12 +3,20 @@
 #include "map_loader.h" // Added for get_location_by_id
 #include "render_utils.h"
 #include "flag_system.h"
-#include "cmap.h" // Use the new CMap module
 #include "game_types.h" // For struct GameState definition
 #include "ecc_time.h"
 #include "characters/mika.h"
 #include "string_table.h" // For get_string_by_id
 #include "logger.h"
+#include "scene_prefetch.h"
+#include "task_scheduler.h"
+#include "game_timers.h"
+#include "npc_schedule.h"
+#include "map_routes.h"
+#include "data_loader.h" // For item_by_id
+#include "player_items.h"
+#include "state_snapshot.h"
+#include "command_registry.h"
 #include "systems/embedded_navi.h" // Include the new Embedded NAVI system
 #include "systems/navi_mini.h"
 #include "systems/navi_pro.h"
@@ -18,66 +26,33 @@
 #include <string.h>
 #include <stdlib.h> // For atoi
 
-// Helper to find an item by its ID
-static const Item* find_item_by_id(const char* item_id, const struct GameState* game_state) {
-    for (int i = 0; i < game_state->item_count; i++) {
-        if (strcmp(game_state->all_items[i].id, item_id) == 0) {
-            return &game_state->all_items[i];
-        }
-    }
-    return NULL;
-}
-
 // Helper to set flags
 static void set_flag(struct GameState* game_state, const char* name, const char* value) {
     hash_table_set(game_state->flags, name, value);
 }
 
 // Helper to unlock commands
-static void unlock_command(struct GameState* game_state, const char* command) {
-    int found = 0;
-    for (int i = 0; i < game_state->player_state.unlocked_commands_count; i++) {
-        if (strcmp(game_state->player_state.unlocked_commands[i], command) == 0) {
-            found = 1;
-            break;
-        }
-    }
-    if (!found && game_state->player_state.unlocked_commands_count < MAX_COMMANDS) {
-        strncpy(game_state->player_state.unlocked_commands[game_state->player_state.unlocked_commands_count], command, MAX_NAME_LENGTH - 1);
-        game_state->player_state.unlocked_commands_count++;
-    }
+static void unlock_command(struct GameState* game_state, CommandID command) {
+    player_unlock_command(&game_state->player_state, command);
 }
 
 // Helper to acquire item
-static void acquire_item_logic(struct GameState* game_state, const char* item_id) {
-    const Item* item_def = find_item_by_id(item_id, game_state);
+static void acquire_item_logic(struct GameState* game_state, ItemID item) {
+    const Item* item_def = item_by_id(item);
     if (item_def != NULL) {
         if (game_state->player_state.credit_level >= item_def->required_credit) {
-            int found = 0;
-            for (int i = 0; i < game_state->player_state.inventory_count; i++) {
-                if (strcmp(game_state->player_state.inventory[i].name, item_def->id) == 0) {
-                    game_state->player_state.inventory[i].quantity++;
-                    found = 1;
-                    break;
-                }
-            }
-            if (!found && game_state->player_state.inventory_count < MAX_INVENTORY_ITEMS) {
-                InventoryItem* new_inv_item = &game_state->player_state.inventory[game_state->player_state.inventory_count];
-                strncpy(new_inv_item->name, item_def->id, MAX_NAME_LENGTH - 1);
-                new_inv_item->quantity = 1;
-                game_state->player_state.inventory_count++;
-            }
+            player_add_item(&game_state->player_state, item, 1);
         } else {
-            fprintf(stderr, "INFO: Not enough credit to acquire item '%s'. Required: %d, Current: %d\n", item_id, item_def->required_credit, game_state->player_state.credit_level);
+            fprintf(stderr, "INFO: Not enough credit to acquire item '%s'. Required: %d, Current: %d\n", item_def->id, item_def->required_credit, game_state->player_state.credit_level);
         }
     } else {
-        fprintf(stderr, "WARNING: Item definition not found for '%s'.\n", item_id);
+        fprintf(stderr, "WARNING: Item definition not found for ID %d.\n", item);
     }
 }
 
 
 // Helper to get time cost for an action (in minutes)
-static int get_action_time_cost(const char* action_id) {
+int get_action_time_cost(const char* action_id) {
     // --- General Actions ---
     if (strcmp(action_id, "wait_one_minute") == 0) return 1;
     if (strcmp(action_id, "talk_to_dad") == 0) return 5;
@@ -125,6 +100,87 @@ static void apply_time_cost(struct GameState* game_state, const char* action_id)
     }
 }
 
+// --- Story Scene Actions ---
+// Actions whose only effect is switching to a fixed scene, optionally setting one flag.
+// Kept as data so the scene an action leads to can be resolved without executing it.
+typedef struct {
+    const char* action_id;
+    const char* scene_id;
+    const char* flag_name;  // NULL if the action sets no flag
+    const char* flag_value;
+} StorySceneAction;
+
+static const StorySceneAction story_scene_actions[] = {
+    {"prologue_go_downstairs", "SCENE_02_DOWNSTAIRS", NULL, NULL},
+    {"open_door_broken", "SCENE_01_LAIN_ROOM_BROKEN", NULL, NULL},
+    {"upstairs", "SCENE_IWAKURA_UPPER_HALLWAY", NULL, NULL},
+    {"lains_room", "SCENE_IWAKURA_LAINS_ROOM", NULL, NULL},
+    {"talk_to_figure", "SCENE_01C_TALK_TO_FIGURE_ENDPROLOGUE", "sister_mood", "cold"},
+    {"navi_shutdown", "SCENE_01B_NAVI_SHUTDOWN", "sister_mood", "curious"},
+    {"navi_reboot", "SCENE_01D_NAVI_REBOOT_ENDPROLOGUE", "sister_mood", "curious"},
+    {"navi_connect", "SCENE_01E_NAVI_CONNECT_ENDPROLOGUE", "sister_mood", "curious"},
+    {"dad_reply_no", "SCENE_02B_DAD_REPLY_NO", NULL, NULL},
+    {"dad_ask_help", "SCENE_02C_DAD_ASK_HELP", NULL, NULL},
+    {"start_chapter_one", "SCENE_03_CHAPTER_ONE_INTRO", NULL, NULL},
+    {"talk_to_dad", "SCENE_DAD_HUB", NULL, NULL},
+    {"get_milk", "SCENE_02J_GET_MILK_ENDPROLOGUE", "sister_mood", "normal"},
+    {"mom_reply_fine", "SCENE_02F_MOM_REPLY_FINE_ENDPROLOGUE", "sister_mood", "normal"},
+    {"mom_reply_silent", "SCENE_02G_MOM_REPLY_SILENT_ENDPROLOGUE", "sister_mood", "cold"},
+    {"mom_deny_vision", "SCENE_02H_MOM_DENY_VISION_ENDPROLOGUE", "sister_mood", "normal"},
+    {"mom_agree_doctor", "SCENE_02I_MOM_AGREE_DOCTOR_ENDPROLOGUE", "sister_mood", "normal"},
+    {"mom_reply_silent_vision", "SCENE_02K_MOM_SILENT_VISION_ENDPROLOGUE", "sister_mood", "normal"},
+    {"talk_to_sister_cold", "SCENE_04A_TALK_TO_SISTER_COLD", NULL, NULL},
+    {"talk_to_sister_curious", "SCENE_04B_TALK_TO_SISTER_CURIOUS", NULL, NULL},
+    {"talk_to_sister_default", "SCENE_04C_TALK_TO_SISTER_DEFAULT", NULL, NULL},
+    {"trigger_shutdown_story", "SCENE_01B_NAVI_SHUTDOWN", NULL, NULL},
+    {"go_to_classroom", "SCENE_07_CLASSROOM", NULL, NULL},
+    {"ask_teacher_knows", "SCENE_08B_ASK_TEACHER", "asked_teacher", "1"},
+    {"ask_about_proxy", "SCENE_08C_ASK_PROXY", "asked_proxy", "1"},
+    {"ask_about_chisa", "SCENE_08D_ASK_CHISA", "asked_chisa", "1"},
+    {"go_to_bar", "SCENE_09_CYBERIA", NULL, NULL},
+    {"persuade_to_bar", "SCENE_09A_PERSUASION", NULL, NULL},
+    {"ask_alice_scared", "SCENE_08E_ASK_ALICE_SCARED", NULL, NULL},
+    {"active_overload", "SCENE_06Z_TRAIN_EVENT_RESULT", "overload_result", "active"},
+    {"passive_overload", "SCENE_06Z_TRAIN_EVENT_RESULT", "overload_result", "passive"},
+    {"trigger_ch2_cold_open", "SCENE_19_COLD_OPEN_CH2", NULL, NULL},
+    {"start_chapter_two", "SCENE_20_CHAPTER_TWO_INTRO", NULL, NULL},
+    {"ch2_hug_alice", "SCENE_21A_HUG_ALICE", NULL, NULL},
+    {"ch2_reply_nothing", "SCENE_21B_REPLY_FINE", NULL, NULL},
+    {"ch2_ask_who", "SCENE_CH2_ASK_WHO", NULL, NULL},
+    {"ch2_hug_alice_continue", "SCENE_21C_ALICE_COMFORTS_LAIN", NULL, NULL},
+    {"ch2_bar_music_interrupt", "SCENE_22_CYBERIA_FLASHBACK", NULL, NULL},
+    {"reply_is_me", "SCENE_22D_REPLY_IS_ME", NULL, NULL},
+    {"boss_invites_lain_to_sing", "SCENE_22B_BOSS_INVITES_LAIN_TO_SING", NULL, NULL},
+    {"step_on_stage", "SCENE_SIDE_STORIES_OLD_MIC", NULL, NULL},
+    {"trigger_echo", "SCENE_SIDE_STORIES_SINGING_RESULT_ECHO", NULL, NULL},
+    {"gunshot_stare", "SCENE_GUNSHOT_ADVANCE", NULL, NULL},
+    {"sing_plastic_love", "SCENE_SIDE_STORIES_SINGING_RESULT_ECHO", NULL, NULL},
+    {"sing_op", "SCENE_SIDE_STORIES_SINGING_RESULT_ECHO", NULL, NULL},
+    {"sing_ed", "SCENE_SIDE_STORIES_SINGING_RESULT_ECHO", NULL, NULL},
+    {"gunshot", "SCENE_SINGING_RESULT_GUNSHOT", NULL, NULL},
+    {"examine_old_mic", "SCENE_SIDE_STORIES_OLD_MIC", NULL, NULL},
+    {"gunshot_advance", "SCENE_GUNSHOT_ADVANCE", NULL, NULL},
+    {"end_chapter_two", "SCENE_CHAPTER_THREE_INTRO", NULL, NULL},
+    {"examine_bookshelf", "SCENE_EXAMINE_BOOKSHELF", NULL, NULL},
+    {"examine_mika_wardrobe", "SCENE_EXAMINE_MIKA_WARDROBE", NULL, NULL},
+    {"set_font_speed_fast", "SCENE_SIDE_STORIES_ADJUST_FONT_INTERVAL", "typewriter_delay", "0.02"},
+    {"set_font_speed_normal", "SCENE_SIDE_STORIES_ADJUST_FONT_INTERVAL", "typewriter_delay", "0.04"},
+    {"set_font_speed_slow", "SCENE_SIDE_STORIES_ADJUST_FONT_INTERVAL", "typewriter_delay", "0.07"},
+    {"connect_to_regional", "SCENE_SIDE_STORIES_NETWORK_STATUS", "network_status.scope", "地区局域网"},
+    {"connect_to_national", "SCENE_SIDE_STORIES_NETWORK_STATUS", "network_status.scope", "全国互联网"},
+};
+
+static const int num_story_scene_actions = sizeof(story_scene_actions) / sizeof(story_scene_actions[0]);
+
+static const StorySceneAction* find_story_scene_action(const char* action_id) {
+    for (int i = 0; i < num_story_scene_actions; i++) {
+        if (strcmp(story_scene_actions[i].action_id, action_id) == 0) {
+            return &story_scene_actions[i];
+        }
+    }
+    return NULL;
+}
+
 // Returns 1 if scene changed, 0 otherwise
 int execute_action(const char* action_id, struct GameState* game_state) {
     LOG_DEBUG("execute_action received action_id: '%s'", action_id);
@@ -133,37 +189,35 @@ int execute_action(const char* action_id, struct GameState* game_state) {
     }
 
     int scene_changed = 0;
+    const StorySceneAction* story_action = NULL;
 
     // Apply time cost for the action
     apply_time_cost(game_state, action_id);
 
 
     // --- Refactored: Generic Connection Handling ---
-    const Location* current_loc = (const Location*)cmap_get(game_state->location_map, game_state->player_state.location);
+    const Location* current_loc = map_location_at(game_state->player_state.location);
     if (current_loc != NULL) {
         LOG_DEBUG("Current location is '%s', connection_count: %d", current_loc->id, current_loc->connection_count);
         for (int i = 0; i < current_loc->connection_count; i++) {
-            const Connection* conn = &current_loc->connections[i];
+            const Connection* conn = &location_connections(current_loc)[i];
             LOG_DEBUG("  Checking connection %d: action_id='%s', target_location_id='%s'", i, conn->action_id, conn->target_location_id);
             if (strcmp(conn->action_id, action_id) == 0) {
                 // This action corresponds to a map connection. Check for conditions.
                 LOG_DEBUG("  Match found for connection: '%s'", conn->action_id);
-                if (conn->is_accessible != NULL) {
-                    if (!conn->is_accessible(game_state, conn)) {
-                        // Access is denied.
-                        strncpy(game_state->current_story_file, conn->access_denied_scene_id, MAX_PATH_LENGTH - 1);
-                        LOG_DEBUG("  Access denied. Transitioning to scene: '%s'", game_state->current_story_file);
-                        return 1; // Scene changed to "access denied" scene.
-                    }
+                if (!connection_is_open(game_state, conn)) {
+                    // Access is denied.
+                    strncpy(game_state->current_story_file, conn->access_denied_scene_id, MAX_PATH_LENGTH - 1);
+                    LOG_DEBUG("  Access denied. Transitioning to scene: '%s'", game_state->current_story_file);
+                    return 1; // Scene changed to "access denied" scene.
                 }
                 // If we are here, access is granted.
                 mika_return_to_schedule(); // Mika's schedule might change upon player movement
-                strncpy(game_state->player_state.location, conn->target_location_id, MAX_NAME_LENGTH - 1);
+                game_state->player_state.location = conn->target;
                 
                 // Special handling for Mika's room to support dynamic scene based on her presence
                 if (strcmp(action_id, "enter_mika_room") == 0) {
-                     const CharacterMika* mika = get_mika_module();
-                     if (mika->current_location_id != NULL && strcmp(mika->current_location_id, "iwakura_mikas_room") == 0) {
+                     if (npc_is_at(NPC_MIKA, "iwakura_mikas_room")) {
                          strncpy(game_state->current_story_file, "SCENE_MIKA_ROOM_UNLOCKED", MAX_PATH_LENGTH - 1);
                      } else {
                          strncpy(game_state->current_story_file, "SCENE_MIKA_ROOM_EMPTY", MAX_PATH_LENGTH - 1);
@@ -174,12 +228,12 @@ int execute_action(const char* action_id, struct GameState* game_state) {
                 } else {
                     fprintf(stderr, "WARNING: Connection to '%s' has no target scene ID. Current scene will persist.\n", conn->target_location_id);
                 }
-                LOG_DEBUG("  Moved to location: '%s', target scene: '%s'", game_state->player_state.location, game_state->current_story_file);
+                LOG_DEBUG("  Moved to location: '%s', target scene: '%s'", conn->target_location_id, game_state->current_story_file);
                 return 1; // Scene or location has changed.
             }
         }
     } else {
-        LOG_DEBUG("current_loc is NULL for player_state.location '%s'. Map data might not be loaded correctly.", game_state->player_state.location);
+        LOG_DEBUG("current_loc is NULL for player_state.location %d. Map data might not be loaded correctly.", game_state->player_state.location);
     }
     
     // --- STORY CHANGE ACTIONS ---
@@ -189,28 +243,19 @@ int execute_action(const char* action_id, struct GameState* game_state) {
         strncpy(game_state->current_story_file, target_scene, MAX_PATH_LENGTH - 1);
         scene_changed = 1;
     }
-    else if (strcmp(action_id, "prologue_go_downstairs") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_02_DOWNSTAIRS", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    }
-    else if (strcmp(action_id, "open_door_broken") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_01_LAIN_ROOM_BROKEN", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    }
-    else if (strcmp(action_id, "upstairs") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_IWAKURA_UPPER_HALLWAY", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    }
-    else if (strcmp(action_id, "lains_room") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_IWAKURA_LAINS_ROOM", MAX_PATH_LENGTH - 1);
+    else if ((story_action = find_story_scene_action(action_id)) != NULL) {
+        strncpy(game_state->current_story_file, story_action->scene_id, MAX_PATH_LENGTH - 1);
+        if (story_action->flag_name != NULL) {
+            set_flag(game_state, story_action->flag_name, story_action->flag_value);
+        }
         scene_changed = 1;
     }
     else if (strcmp(action_id, "use_phone_navi") == 0) {
-        enter_embedded_navi(game_state);
+        task_spawn("embedded_navi", enter_embedded_navi, game_state);
         scene_changed = 1;
     } 
     else if (strcmp(action_id, "use_desktop_navi") == 0) {
-        enter_navi_mini(game_state);
+        task_spawn("navi_mini", enter_navi_mini, game_state);
         scene_changed = 1;
     }
     else if (strcmp(action_id, "use_navi_pro") == 0) {
@@ -223,12 +268,12 @@ int execute_action(const char* action_id, struct GameState* game_state) {
     } 
     else if (strcmp(action_id, "go_back_to_shibuya") == 0) {
         mika_return_to_schedule();
-        strncpy(game_state->player_state.location, "shibuya_street", MAX_NAME_LENGTH - 1);
+        game_state->player_state.location = location_id_from_string("shibuya_street");
         strncpy(game_state->current_story_file, "SCENE_09_CYBERIA", MAX_PATH_LENGTH - 1); // Placeholder scene
         scene_changed = 1;
     } else if (strcmp(action_id, "go_to_shinjuku_site") == 0) {
         mika_return_to_schedule();
-        strncpy(game_state->player_state.location, "shinjuku_abandoned_site", MAX_NAME_LENGTH - 1);
+        game_state->player_state.location = location_id_from_string("shinjuku_abandoned_site");
         strncpy(game_state->current_story_file, "SCENE_SHINJUKU_ABANDONED_SITE", MAX_PATH_LENGTH - 1);
         scene_changed = 1;
     } else if (strcmp(action_id, "explore_shinjuku_site") == 0) {
@@ -249,197 +294,46 @@ int execute_action(const char* action_id, struct GameState* game_state) {
             game_state->has_transient_message = true;
             scene_changed = 0; // Do not change scene, just re-render current scene with message
         }
-    } else if (strcmp(action_id, "talk_to_figure") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_01C_TALK_TO_FIGURE_ENDPROLOGUE", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "sister_mood", "cold");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "navi_shutdown") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_01B_NAVI_SHUTDOWN", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "sister_mood", "curious");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "navi_reboot") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_01D_NAVI_REBOOT_ENDPROLOGUE", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "sister_mood", "curious");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "navi_connect") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_01E_NAVI_CONNECT_ENDPROLOGUE", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "sister_mood", "curious");
-        scene_changed = 1;
     } else if (strcmp(action_id, "exit_story") == 0) {
         // This action type typically indicates returning to a previous context,
         // often implied by story flow without explicit current_story_file change.
         // For now, it doesn't cause a scene_changed=1 unless a story_file is explicitly set.
         scene_changed = 0; // Does not change story file by itself
-    } else if (strcmp(action_id, "dad_reply_no") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_02B_DAD_REPLY_NO", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "dad_ask_help") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_02C_DAD_ASK_HELP", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "start_chapter_one") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_03_CHAPTER_ONE_INTRO", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "talk_to_dad") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_DAD_HUB", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "get_milk") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_02J_GET_MILK_ENDPROLOGUE", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "sister_mood", "normal");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "mom_reply_fine") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_02F_MOM_REPLY_FINE_ENDPROLOGUE", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "sister_mood", "normal");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "mom_reply_silent") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_02G_MOM_REPLY_SILENT_ENDPROLOGUE", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "sister_mood", "cold");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "mom_deny_vision") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_02H_MOM_DENY_VISION_ENDPROLOGUE", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "sister_mood", "normal");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "mom_agree_doctor") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_02I_MOM_AGREE_DOCTOR_ENDPROLOGUE", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "sister_mood", "normal");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "mom_reply_silent_vision") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_02K_MOM_SILENT_VISION_ENDPROLOGUE", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "sister_mood", "normal");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "talk_to_sister_cold") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_04A_TALK_TO_SISTER_COLD", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "talk_to_sister_curious") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_04B_TALK_TO_SISTER_CURIOUS", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "talk_to_sister_default") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_04C_TALK_TO_SISTER_DEFAULT", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "trigger_shutdown_story") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_01B_NAVI_SHUTDOWN", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
     } else if (strcmp(action_id, "read_email_from_chisa") == 0) {
         strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_EMAIL_CLIENT", MAX_PATH_LENGTH - 1);
-        unlock_command(game_state, "mail");
+        unlock_command(game_state, COMMAND_MAIL);
         scene_changed = 1;
     } else if (strcmp(action_id, "go_to_school") == 0) {
         strncpy(game_state->current_story_file, "SCENE_06_TRAIN_SCENE", MAX_PATH_LENGTH - 1);
         // Assuming other commands are unlocked by default now or elsewhere
         scene_changed = 1;
-    } else if (strcmp(action_id, "go_to_classroom") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_07_CLASSROOM", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "ask_teacher_knows") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_08B_ASK_TEACHER", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "asked_teacher", "1");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "ask_about_proxy") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_08C_ASK_PROXY", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "asked_proxy", "1");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "ask_about_chisa") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_08D_ASK_CHISA", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "asked_chisa", "1");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "go_to_bar") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_09_CYBERIA", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "persuade_to_bar") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_09A_PERSUASION", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "ask_alice_scared") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_08E_ASK_ALICE_SCARED", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "active_overload") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_06Z_TRAIN_EVENT_RESULT", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "overload_result", "active");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "passive_overload") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_06Z_TRAIN_EVENT_RESULT", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "overload_result", "passive");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "trigger_ch2_cold_open") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_19_COLD_OPEN_CH2", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "start_chapter_two") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_20_CHAPTER_TWO_INTRO", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "ch2_hug_alice") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_21A_HUG_ALICE", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "ch2_reply_nothing") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_21B_REPLY_FINE", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "ch2_ask_who") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_CH2_ASK_WHO", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "ch2_hug_alice_continue") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_21C_ALICE_COMFORTS_LAIN", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "ch2_bar_music_interrupt") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_22_CYBERIA_FLASHBACK", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "reply_is_me") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_22D_REPLY_IS_ME", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "boss_invites_lain_to_sing") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_22B_BOSS_INVITES_LAIN_TO_SING", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "step_on_stage") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_OLD_MIC", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "trigger_echo") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_SINGING_RESULT_ECHO", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "gunshot_stare") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_GUNSHOT_ADVANCE", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "sing_plastic_love") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_SINGING_RESULT_ECHO", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "sing_op") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_SINGING_RESULT_ECHO", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "sing_ed") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_SINGING_RESULT_ECHO", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "gunshot") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SINGING_RESULT_GUNSHOT", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "examine_old_mic") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_OLD_MIC", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    } else if (strcmp(action_id, "gunshot_advance") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_GUNSHOT_ADVANCE", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-        } else if (strcmp(action_id, "gunshot_exit") == 0) {
-            strncpy(game_state->current_story_file, "SCENE_00_ENTRY", MAX_PATH_LENGTH - 1);
-            const uint32_t default_start_time_units = 8 * 60 * 60 * 16;
-            game_state->time_of_day = encode_time_with_ecc(default_start_time_units);
-            hash_table_set(game_state->flags, "TIME_GLITCH_ACTIVE", "0");
-            scene_changed = 1;
-        } else if (strcmp(action_id, "end_chapter_two") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_CHAPTER_THREE_INTRO", MAX_PATH_LENGTH - 1);
+    } else if (strcmp(action_id, "gunshot_exit") == 0) {
+        strncpy(game_state->current_story_file, "SCENE_00_ENTRY", MAX_PATH_LENGTH - 1);
+        const uint32_t default_start_time_units = 8 * 60 * 60 * 16;
+        game_state->time_of_day = encode_time_with_ecc(default_start_time_units);
+        hash_table_set(game_state->flags, "TIME_GLITCH_ACTIVE", "0");
         scene_changed = 1;
     } else if (strcmp(action_id, "use_ticket_machine") == 0) {
-        enter_ticket_machine_interface(game_state);
-        scene_changed = 0; // Interface handles its own rendering and input
+        task_spawn("ticket_machine", enter_ticket_machine_interface, game_state);
+        // A ride sets current_story_file from the task; the main loop enters
+        // that scene once the interface exits.
+        scene_changed = 0;
     }
 
     // --- ACQUIRE ITEM ACTIONS ---
     else if (strcmp(action_id, "order_milk") == 0) {
-        acquire_item_logic(game_state, "milk");
+        acquire_item_logic(game_state, ITEM_MILK);
     } else if (strcmp(action_id, "order_coffee") == 0) {
-        acquire_item_logic(game_state, "coffee");
+        acquire_item_logic(game_state, ITEM_COFFEE);
     } else if (strcmp(action_id, "order_juice") == 0) {
-        acquire_item_logic(game_state, "juice");
+        acquire_item_logic(game_state, ITEM_JUICE);
     } else if (strcmp(action_id, "acquire_alice_hat") == 0) {
-        acquire_item_logic(game_state, "alice_hat");
+        acquire_item_logic(game_state, ITEM_ALICE_HAT);
     } else if (strcmp(action_id, "take_sand_bottle") == 0) {
-        acquire_item_logic(game_state, "sand_bottle");
+        acquire_item_logic(game_state, ITEM_SAND_BOTTLE);
         set_flag(game_state, "sand_bottle_taken", "true");
     } else if (strcmp(action_id, "take_milk_from_fridge") == 0) {
-        acquire_item_logic(game_state, "milk");
+        acquire_item_logic(game_state, ITEM_MILK);
 
         // Re-render the same scene, in case we want to make the choice conditional later
         strncpy(game_state->current_story_file, "SCENE_EXAMINE_FRIDGE", MAX_PATH_LENGTH - 1);
@@ -490,60 +384,24 @@ int execute_action(const char* action_id, struct GameState* game_state) {
         }
         scene_changed = 1;
     }
-    else if (strcmp(action_id, "examine_bookshelf") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_EXAMINE_BOOKSHELF", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    }
     else if (strcmp(action_id, "examine_hamlet") == 0) {
-        bool has_key = false;
-        for(int i=0; i<game_state->player_state.inventory_count; ++i) {
-            if(strcmp(game_state->player_state.inventory[i].name, "key_mika_room") == 0) {
-                has_key = true;
-                break;
-            }
-        }
-        
+        bool has_key = player_has_item(&game_state->player_state, ITEM_KEY_MIKA_ROOM);
+
         if (has_key) {
              strncpy(game_state->transient_message, get_string_by_id(TEXT_ALREADY_HAS_KEY_DESC), MAX_LINE_LENGTH - 1);
         } else {
-             acquire_item_logic(game_state, "key_mika_room");
+             acquire_item_logic(game_state, ITEM_KEY_MIKA_ROOM);
              strncpy(game_state->transient_message, get_string_by_id(TEXT_FOUND_KEY_DESC), MAX_LINE_LENGTH - 1);
         }
         game_state->has_transient_message = true;
         scene_changed = 0; // Stay in bookshelf scene
     }
-    else if (strcmp(action_id, "examine_mika_wardrobe") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_EXAMINE_MIKA_WARDROBE", MAX_PATH_LENGTH - 1);
-        scene_changed = 1;
-    }
     else if (strcmp(action_id, "examine_hidden_doll") == 0) {
         strncpy(game_state->transient_message, get_string_by_id(TEXT_FOUND_HIDDEN_DOLL_DESC), MAX_LINE_LENGTH - 1);
         game_state->has_transient_message = true;
         scene_changed = 0;
     }
-    
-    // --- GENERIC FLAG SETTING ACTIONS (for dynamic values like typewriter_delay, network scope) ---
-    else if (strcmp(action_id, "set_font_speed_fast") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_ADJUST_FONT_INTERVAL", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "typewriter_delay", "0.02");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "set_font_speed_normal") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_ADJUST_FONT_INTERVAL", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "typewriter_delay", "0.04");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "set_font_speed_slow") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_ADJUST_FONT_INTERVAL", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "typewriter_delay", "0.07");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "connect_to_regional") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_NETWORK_STATUS", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "network_status.scope", "地区局域网");
-        scene_changed = 1;
-    } else if (strcmp(action_id, "connect_to_national") == 0) {
-        strncpy(game_state->current_story_file, "SCENE_SIDE_STORIES_NETWORK_STATUS", MAX_PATH_LENGTH - 1);
-        set_flag(game_state, "network_status.scope", "全国互联网");
-        scene_changed = 1;
-    }
+
 
 
     // --- UNRECOGNIZED ACTION ---
@@ -562,208 +420,482 @@ int execute_action(const char* action_id, struct GameState* game_state) {
     return scene_changed;
 }
 
-bool execute_command(const char* input, GameState* game_state) {
-    if (input == NULL || game_state == NULL) {
-        return false; // No re-render for invalid input
+// Appends scene_id to out_ids unless it is empty or already present.
+static int add_scene_candidate(const char* scene_id, const char** out_ids, int count, int max_ids) {
+    if (scene_id == NULL || scene_id[0] == '\0' || count >= max_ids) return count;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(out_ids[i], scene_id) == 0) return count;
     }
+    out_ids[count] = scene_id;
+    return count + 1;
+}
+
+int get_action_scene_candidates(const char* action_id, const struct GameState* game_state, const char** out_ids, int max_ids) {
+    int count = 0;
+    if (action_id == NULL || game_state == NULL || out_ids == NULL) return 0;
+
+    // Mirrors the resolution order of execute_action: map connections win over story actions.
+    const Location* current_loc = map_location_at(game_state->player_state.location);
+    if (current_loc != NULL) {
+        for (int i = 0; i < current_loc->connection_count; i++) {
+            const Connection* conn = &location_connections(current_loc)[i];
+            if (strcmp(conn->action_id, action_id) != 0) continue;
 
-    // Command: inventory / inv
-    if (strcmp(input, "inventory") == 0 || strcmp(input, "inv") == 0) {
-        printf("\n--- Inventory ---\n");
-        if (game_state->player_state.inventory_count == 0) {
-            printf("  (empty)\n");
+            // Accessibility is decided at execution time, so both outcomes are candidates.
+            if (strcmp(action_id, "enter_mika_room") == 0) {
+                count = add_scene_candidate("SCENE_MIKA_ROOM_UNLOCKED", out_ids, count, max_ids);
+                count = add_scene_candidate("SCENE_MIKA_ROOM_EMPTY", out_ids, count, max_ids);
+            } else {
+                count = add_scene_candidate(conn->target_scene_id, out_ids, count, max_ids);
+            }
+            if (connection_is_gated(conn)) {
+                count = add_scene_candidate(conn->access_denied_scene_id, out_ids, count, max_ids);
+            }
+            return count;
         }
-        for (int i = 0; i < game_state->player_state.inventory_count; i++) {
-            printf("  - %s: %d\n", game_state->player_state.inventory[i].name, game_state->player_state.inventory[i].quantity);
+    }
+
+    if (strncmp(action_id, "SET_SCENE:", 10) == 0) {
+        return add_scene_candidate(action_id + 10, out_ids, count, max_ids);
+    }
+
+    const StorySceneAction* story_action = find_story_scene_action(action_id);
+    if (story_action != NULL) {
+        count = add_scene_candidate(story_action->scene_id, out_ids, count, max_ids);
+    }
+    return count;
+}
+
+// --- Text Commands ---
+
+// Argument tries for the player's location, kept in step with it: when the
+// player moves, only the IDs the new location does not share are swapped.
+static CommandTrie* g_poi_ids = NULL;        // POI ID -> index into location_pois()
+static CommandTrie* g_connection_ids = NULL; // Action ID -> index into location_connections()
+static CommandTrie* g_location_ids = NULL;   // Location ID -> LocationID
+static const Location* g_indexed_location = NULL;
+
+static void index_location(const Location* loc) {
+    if (loc == g_indexed_location) return;
+    const Location* old = g_indexed_location;
+    g_indexed_location = loc;
+
+    // Insert (or re-point) the new IDs, then drop old ones not shared.
+    for (int i = 0; loc != NULL && i < loc->pois_count; i++) {
+        command_trie_insert(g_poi_ids, location_pois(loc)[i].id, i);
+    }
+    for (int i = 0; loc != NULL && i < loc->connection_count; i++) {
+        command_trie_insert(g_connection_ids, location_connections(loc)[i].action_id, i);
+    }
+    for (int i = 0; old != NULL && i < old->pois_count; i++) {
+        const char* id = location_pois(old)[i].id;
+        int index = command_trie_find(g_poi_ids, id, strlen(id));
+        if (loc == NULL || index >= loc->pois_count || strcmp(location_pois(loc)[index].id, id) != 0) {
+            command_trie_remove(g_poi_ids, id);
         }
-        printf("-----------------\n");
-        return false; // No re-render needed for inventory
     }
-    // Command: arls / arls <poi_id>
-    else if (strncmp(input, "arls", 4) == 0) {
-        if (game_state->player_state.location[0] == '\0') {
-            printf("Error: Current location unknown. Systems offline.\n");
-            return false;
+    for (int i = 0; old != NULL && i < old->connection_count; i++) {
+        const char* id = location_connections(old)[i].action_id;
+        int index = command_trie_find(g_connection_ids, id, strlen(id));
+        if (loc == NULL || index >= loc->connection_count || strcmp(location_connections(loc)[index].action_id, id) != 0) {
+            command_trie_remove(g_connection_ids, id);
         }
+    }
+}
 
-        char poi_id_buffer[MAX_NAME_LENGTH];
-        int scan_result = sscanf(input, "arls %s", poi_id_buffer);
-        if (scan_result == 1) { // Command is "arls <something>"
-            const Location* current_loc = get_location_by_id(game_state->player_state.location);
-            if (current_loc) {
-                for (int i = 0; i < current_loc->pois_count; i++) {
-                    if (strcmp(current_loc->pois[i].id, poi_id_buffer) == 0) {
-                        if (current_loc->pois[i].view_scene_id != NULL) {
-                            strncpy(game_state->current_story_file, current_loc->pois[i].view_scene_id, MAX_PATH_LENGTH - 1);
-                            return true; // Re-render needed for scene change
-                        } else {
-                            printf("You examine the %s: %s\n", current_loc->pois[i].name, current_loc->pois[i].description);
-                            return false;
-                        }
-                    }
-                }
-            }
-            printf("'%s' is not a valid point of interest here.\n", poi_id_buffer);
-            return false;
-        } else { // Command is just "arls" (no specific POI ID)
-            printf("\n--- Area List Scan ---\n");
-            Location *current_loc = get_location_by_id(game_state->player_state.location);
-            if (current_loc) {
-                render_scene_description(current_loc->description);
-
-                if (current_loc->pois_count > 0) {
-                    render_text("\n\n Points of Interest: \n\n");
-                    for (int i = 0; i < current_loc->pois_count; i++) {
-                        render_poi_name(current_loc->pois[i].name);
-                        render_text("\n");
-                    }
-                }
+static const Location* current_location(const GameState* game_state) {
+    const Location* loc = map_location_at(game_state->player_state.location);
+    index_location(loc);
+    return loc;
+}
 
-                if (current_loc->connection_count > 0) {
-                    render_text("\n\nConnections:\n\n");
-                    for (int i = 0; i < current_loc->connection_count; i++) {
-                        char conn_buf[MAX_LINE_LENGTH];
-                        const Connection* conn = &current_loc->connections[i];
-                        snprintf(conn_buf, MAX_LINE_LENGTH, "  - %s -> %s\n", conn->action_id, conn->target_location_id);
-                        render_text(conn_buf);
-                    }
-                }
-            } else {
-                printf("Location Data Corruption: Unable to locate '%s' in the Wired database.\n", game_state->player_state.location);
-            }
-            printf("----------------------\n");
+static const POI* find_current_poi(const GameState* game_state, const char* poi_id) {
+    const Location* loc = current_location(game_state);
+    int index = command_trie_find(g_poi_ids, poi_id, strlen(poi_id));
+    return (loc != NULL && index >= 0) ? &location_pois(loc)[index] : NULL;
+}
+
+// Command: inventory / inv
+static bool cmd_inventory(void* context, const char* arg) {
+    GameState* game_state = context;
+    (void)arg;
+    printf("\n--- Inventory ---\n");
+    const PlayerState* ps = &game_state->player_state;
+    if (player_item_count(ps) == 0) {
+        printf("  (empty)\n");
+    }
+    for (int i = player_next_item(ps, 0); i >= 0; i = player_next_item(ps, i + 1)) {
+        printf("  - %s: %d\n", item_by_id((ItemID)i)->id, player_item_quantity(ps, (ItemID)i));
+    }
+    printf("-----------------\n");
+    return false; // No re-render needed for inventory
+}
+
+// Command: arls / arls <poi_id>
+static bool cmd_arls(void* context, const char* arg) {
+    GameState* game_state = context;
+    if (game_state->player_state.location == LOCATION_NONE) {
+        printf("Error: Current location unknown. Systems offline.\n");
+        return false;
+    }
+
+    if (arg[0] != '\0') { // Command is "arls <something>"
+        const POI* poi = find_current_poi(game_state, arg);
+        if (poi == NULL) {
+            printf("'%s' is not a valid point of interest here.\n", arg);
             return false;
         }
+        if (poi->view_scene_id != NULL) {
+            strncpy(game_state->current_story_file, poi->view_scene_id, MAX_PATH_LENGTH - 1);
+            return true; // Re-render needed for scene change
+        }
+        printf("You examine the %s: %s\n", get_string_by_id(poi->name), get_string_by_id(poi->description));
+        return false;
     }
-    // Command: navi
-    else if (strcmp(input, "navi") == 0) {
-        enter_embedded_navi(game_state);
-        return true; // Re-render needed after exiting NAVI
-    }
-    // Command: exper <poi_id>
-    else if (strncmp(input, "exper ", 6) == 0) {
-        char poi_id_buffer[MAX_NAME_LENGTH] = {0};
-        int scan_result = sscanf(input, "exper %s", poi_id_buffer);
-
-        if (scan_result == 1) {
-            const Location* current_loc = get_location_by_id(game_state->player_state.location);
-            if (current_loc) {
-                for (int i = 0; i < current_loc->pois_count; i++) {
-                    if (strcmp(current_loc->pois[i].id, poi_id_buffer) == 0) {
-                        if (current_loc->pois[i].examine_action_id != NULL) {
-                            return execute_action(current_loc->pois[i].examine_action_id, game_state);
-                        } else {
-                            printf("You can't use or interact with the %s in that way.\n", current_loc->pois[i].name);
-                            return false;
-                        }
-                    }
-                }
+
+    // Command is just "arls" (no specific POI ID)
+    printf("\n--- Area List Scan ---\n");
+    const Location* current_loc = current_location(game_state);
+    if (current_loc) {
+        render_scene_description(location_description(current_loc));
+
+        if (current_loc->pois_count > 0) {
+            render_text("\n\n Points of Interest: \n\n");
+            for (int i = 0; i < current_loc->pois_count; i++) {
+                render_poi_name(get_string_by_id(location_pois(current_loc)[i].name));
+                render_text("\n");
             }
-            printf("'%s' is not a valid point of interest here.\n", poi_id_buffer);
-            return false;
-        } else {
-            printf("Usage: exper <object_id>\n");
-            return false;
         }
-    }
-    // Command: move <destination>
-    else if (strncmp(input, "move ", 5) == 0) {
-        char destination_buffer[MAX_NAME_LENGTH] = {0};
-        sscanf(input, "move %s", destination_buffer);
-
-        if (strlen(destination_buffer) > 0) {
-            const Location* current_loc = get_location_by_id(game_state->player_state.location);
-            if (current_loc) {
-                for (int i = 0; i < current_loc->connection_count; i++) {
-                    if (strcmp(current_loc->connections[i].action_id, destination_buffer) == 0) {
-                        return execute_action(destination_buffer, game_state);
-                    }
-                }
+
+        if (current_loc->connection_count > 0) {
+            render_text("\n\nConnections:\n\n");
+            for (int i = 0; i < current_loc->connection_count; i++) {
+                char conn_buf[MAX_LINE_LENGTH];
+                const Connection* conn = &location_connections(current_loc)[i];
+                snprintf(conn_buf, MAX_LINE_LENGTH, "  - %s -> %s\n", conn->action_id, conn->target_location_id);
+                render_text(conn_buf);
             }
-            printf("You can't move to '%s' from here.\n", destination_buffer);
-            return false;
-        } else {
-            printf("Usage: move <destination>\n");
-            return false;
         }
+    } else {
+        printf("Location Data Corruption: Unable to locate #%d in the Wired database.\n", game_state->player_state.location);
     }
-    // Command: help
-    else if (strcmp(input, "help") == 0) {
-        printf("\n--- Help ---\n");
-        printf("Available commands:\n");
-        for (int i = 0; i < game_state->player_state.unlocked_commands_count; i++) {
-            printf("  - %s\n", game_state->player_state.unlocked_commands[i]);
-        }
-        printf("  - quit\n");
-        printf("-------------\n");
-        return false; // No re-render needed for help
-    }
-    // Command: time
-    else if (strcmp(input, "time") == 0) {
-        printf("\n--- Time ---\n");
-        print_game_time(game_state->time_of_day);
-        printf("-----------\n");
-        return false; // No re-render needed for time
-    }
-    // Command: debug_time (Hidden)
-    else if (strncmp(input, "debug_time", 10) == 0) {
-        // ... (existing debug_time logic) ...
+    printf("----------------------\n");
+    return false;
+}
+
+// Command: navi
+static bool cmd_navi(void* context, const char* arg) {
+    (void)arg;
+    task_spawn("embedded_navi", enter_embedded_navi, context);
+    return true; // Re-render needed after exiting NAVI
+}
+
+// Command: exper <poi_id>
+static bool cmd_exper(void* context, const char* arg) {
+    GameState* game_state = context;
+    if (arg[0] == '\0') {
+        printf("Usage: exper <object_id>\n");
+        return false;
+    }
+    const POI* poi = find_current_poi(game_state, arg);
+    if (poi == NULL) {
+        printf("'%s' is not a valid point of interest here.\n", arg);
+        return false;
+    }
+    if (poi->examine_action_id == NULL) {
+        printf("You can't use or interact with the %s in that way.\n", get_string_by_id(poi->name));
         return false;
     }
-    // Command: debug_scene (Hidden)
-    else if (strncmp(input, "debug_scene ", 12) == 0) {
-        char scene_id[MAX_NAME_LENGTH];
-        if (sscanf(input, "debug_scene %s", scene_id) == 1) {
-            strncpy(game_state->current_story_file, scene_id, MAX_PATH_LENGTH - 1);
-            return true; // Re-render needed
+    return execute_action(poi->examine_action_id, game_state);
+}
+
+// Command: move <destination>
+static bool cmd_move(void* context, const char* arg) {
+    GameState* game_state = context;
+    if (arg[0] == '\0') {
+        printf("Usage: move <destination>\n");
+        return false;
+    }
+    current_location(game_state);
+    if (command_trie_find(g_connection_ids, arg, strlen(arg)) >= 0) {
+        return execute_action(arg, game_state);
+    }
+    printf("You can't move to '%s' from here.\n", arg);
+    return false;
+}
+
+// Command: go <location_id | location name>
+// Walks the shortest open route in one command; only the last scene is rendered.
+static bool cmd_go(void* context, const char* arg) {
+    GameState* game_state = context;
+    if (arg[0] == '\0') {
+        printf("Usage: go <location>\n");
+        return false;
+    }
+
+    LocationID target = location_id_from_string(arg);
+    for (int i = 0; target == LOCATION_NONE && i < map_location_count(); i++) {
+        if (strcmp(location_name(map_location_at(i)), arg) == 0) {
+            target = (LocationID)i;
         }
+    }
+    if (target == LOCATION_NONE) {
+        printf("Unknown location: '%s'\n", arg);
         return false;
     }
-    // Unrecognized command
-    else {
-        printf("Command not recognized: %s\n", input);
-        return false; // No re-render needed for unrecognized command
+
+    const char* route[MAP_ROUTE_MAX_HOPS];
+    int minutes = 0;
+    int hops = map_routes_plan(game_state, game_state->player_state.location, target, route, MAP_ROUTE_MAX_HOPS, &minutes);
+    if (hops == 0) {
+        printf("You are already there.\n");
+        return false;
+    }
+    if (hops < 0) {
+        printf("There is no way to reach '%s' from here right now.\n", arg);
+        return false;
+    }
+
+    LOG_DEBUG("go: %d hop(s), %d minute(s) to '%s'", hops, minutes, location_id_to_string(target));
+    int scene_changed = 0;
+    for (int i = 0; i < hops; i++) {
+        LocationID before = game_state->player_state.location;
+        scene_changed |= execute_action(route[i], game_state);
+        // A gate that closed on the way (the clock moves with every hop)
+        // leaves the player where they are, on its access-denied scene.
+        if (before == game_state->player_state.location) break;
     }
+    return scene_changed;
+}
+
+// Command: help
+static bool cmd_help(void* context, const char* arg) {
+    GameState* game_state = context;
+    (void)arg;
+    printf("\n--- Help ---\n");
+    printf("Available commands:\n");
+    const PlayerState* ps = &game_state->player_state;
+    for (int i = player_next_command(ps, 0); i >= 0; i = player_next_command(ps, i + 1)) {
+        printf("  - %s\n", command_name((CommandID)i));
+    }
+    printf("  - quit\n");
+    printf("(Tab completes commands and their arguments.)\n");
+    printf("-------------\n");
+    return false; // No re-render needed for help
+}
+
+// Command: time
+static bool cmd_time(void* context, const char* arg) {
+    GameState* game_state = context;
+    (void)arg;
+    printf("\n--- Time ---\n");
+    print_game_time(game_state->time_of_day);
+    printf("-----------\n");
+    return false; // No re-render needed for time
+}
+
+// Command: debug_time (Hidden)
+static bool cmd_debug_time(void* context, const char* arg) {
+    (void)context;
+    (void)arg;
+    // ... (existing debug_time logic) ...
+    return false;
+}
+
+// Command: debug_prefetch (Hidden)
+static bool cmd_debug_prefetch(void* context, const char* arg) {
+    (void)context;
+    (void)arg;
+    ScenePrefetchStats stats;
+    scene_prefetch_get_stats(&stats);
+    unsigned long total = stats.hits + stats.misses;
+    printf("\n--- Scene Prefetch ---\n");
+    printf("  hits: %lu, misses: %lu, hit rate: %.1f%%\n", stats.hits, stats.misses, total ? 100.0 * stats.hits / total : 0.0);
+    printf("  scenes prepared: %lu\n", stats.prepared);
+    printf("----------------------\n");
+    return false;
+}
+
+// Command: debug_rewind / debug_rewind <n> (Hidden)
+static bool cmd_debug_rewind(void* context, const char* arg) {
+    GameState* game_state = context;
+    int index;
+    if (sscanf(arg, "%d", &index) == 1) {
+        if (state_history_rewind(index, game_state)) return true; // Re-enters the scene
+        printf("No scene %d in the history.\n", index);
+        return false;
+    }
+    size_t total = 0;
+    printf("\n--- Scene History ---\n");
+    for (int i = 0; i < state_history_count(); i++) {
+        const StateSnapshot* snapshot = state_history_get(i);
+        total += state_snapshot_size(snapshot);
+        printf("  [%d] %s (%zu bytes)\n", i, state_snapshot_scene(snapshot), state_snapshot_size(snapshot));
+    }
+    printf("  %d snapshots, %zu bytes; a GameState is %zu\n", state_history_count(), total, sizeof(GameState));
+    printf("---------------------\n");
+    return false;
+}
+
+// Command: debug_scene <scene_id> (Hidden)
+static bool cmd_debug_scene(void* context, const char* arg) {
+    GameState* game_state = context;
+    if (arg[0] == '\0') return false;
+    strncpy(game_state->current_story_file, arg, MAX_PATH_LENGTH - 1);
+    return true; // Re-render needed
+}
+
+static const CommandSpec g_commands[] = {
+    { "inventory",      COMMAND_ARG_NONE,       cmd_inventory,      false },
+    { "inv",            COMMAND_ARG_NONE,       cmd_inventory,      false },
+    { "arls",           COMMAND_ARG_POI,        cmd_arls,           false },
+    { "navi",           COMMAND_ARG_NONE,       cmd_navi,           false },
+    { "exper",          COMMAND_ARG_POI,        cmd_exper,          false },
+    { "move",           COMMAND_ARG_CONNECTION, cmd_move,           false },
+    { "go",             COMMAND_ARG_LOCATION,   cmd_go,             false },
+    { "help",           COMMAND_ARG_NONE,       cmd_help,           false },
+    { "time",           COMMAND_ARG_NONE,       cmd_time,           false },
+    { "debug_time",     COMMAND_ARG_NONE,       cmd_debug_time,     true },
+    { "debug_prefetch", COMMAND_ARG_NONE,       cmd_debug_prefetch, true },
+    { "debug_rewind",   COMMAND_ARG_NONE,       cmd_debug_rewind,   true },
+    { "debug_scene",    COMMAND_ARG_NONE,       cmd_debug_scene,    true },
+};
+
+static CommandRegistry* g_command_registry = NULL;
+
+static const CommandTrie* command_arg_trie(void* context, CommandArgKind kind, const char* arg, size_t* word_start) {
+    (void)arg;
+    *word_start = 0;
+    current_location(context);
+    switch (kind) {
+        case COMMAND_ARG_POI: return g_poi_ids;
+        case COMMAND_ARG_CONNECTION: return g_connection_ids;
+        case COMMAND_ARG_LOCATION: return g_location_ids;
+        default: return NULL;
+    }
+}
+
+// Built on first use; the map tables are static, so the location ID trie is too.
+static const CommandRegistry* command_registry(void) {
+    if (g_command_registry != NULL) return g_command_registry;
+    g_poi_ids = command_trie_create();
+    g_connection_ids = command_trie_create();
+    g_location_ids = command_trie_create();
+    for (int i = 0; g_location_ids != NULL && i < map_location_count(); i++) {
+        command_trie_insert(g_location_ids, map_location_at(i)->id, i);
+    }
+    g_command_registry = command_registry_create(g_commands, (int)(sizeof(g_commands) / sizeof(g_commands[0])), command_arg_trie);
+    return g_command_registry;
+}
+
+bool execute_command(const char* input, GameState* game_state) {
+    if (input == NULL || game_state == NULL) {
+        return false; // No re-render for invalid input
+    }
+
+    bool rerender = false;
+    if (command_registry_dispatch(command_registry(), input, game_state, &rerender)) {
+        return rerender;
+    }
+
+    // Unrecognized command
+    char hint[MAX_LINE_LENGTH];
+    command_registry_hint(command_registry(), input, hint, sizeof(hint));
+    printf("Command not recognized: %s\n", input);
+    if (hint[0] != '\0') printf("Did you mean: %s\n", hint);
+    return false; // No re-render needed for unrecognized command
+}
+
+void complete_command(const char* line, size_t cursor, LineEditorCompletion* out, GameState* game_state) {
+    command_registry_complete(command_registry(), line, cursor, game_state, out);
 }
 
 #include "conditions.h"
 
-bool check_and_trigger_auto_events(GameState* game_state, StoryScene* current_scene, uint32_t scene_entry_time) {
-    if (!game_state || !current_scene) return false;
+// Auto-events are armed once per scene entry and fire from the game-time wheel.
+// Each is due when the game clock reaches its reading at entry plus the wait,
+// so an action or load that moves the clock moves the deadline with it: a
+// clock jump re-arms whatever is pending. An event whose flag guard or
+// conditions do not hold yet when it is due is re-checked every second, but
+// only from then on.
+static GameState* g_auto_event_state = NULL;
+static StoryScene* g_auto_event_scene = NULL;
+static bool g_auto_event_clocked = false;             // The clock was readable at entry
+static uint32_t g_auto_event_due[MAX_AUTO_EVENTS];    // Clock reading each event is due at
+static TimerId g_auto_event_timers[MAX_AUTO_EVENTS];  // Pending timer of each event, 0 if none
+
+static bool auto_event_timer_fired(void* context, int index);
+
+// Seconds until the event is due by the clock, or 0 if it is (or the clock
+// cannot tell).
+static uint32_t auto_event_seconds_left(int index) {
+    uint32_t now;
+    if (!g_auto_event_clocked || !game_clock_read(g_auto_event_state, &now)) return 0;
+    return game_clock_seconds_until(now, g_auto_event_due[index]);
+}
 
-    DecodedTimeResult current_time_decoded = decode_time_with_ecc(game_state->time_of_day);
-    if (current_time_decoded.status == DOUBLE_BIT_ERROR_DETECTED) return false;
-    
-    uint32_t current_time = current_time_decoded.data;
-    uint32_t elapsed_time = (current_time >= scene_entry_time) ? (current_time - scene_entry_time) : 0;
-    // Convert to seconds (16 units = 1 second)
-    uint32_t elapsed_seconds = elapsed_time / 16;
+static void arm_auto_event(StoryScene* scene, int index, uint32_t seconds) {
+    g_auto_event_timers[index] = game_timer_after_seconds(seconds, auto_event_timer_fired, scene, index, TIMER_GROUP_SCENE);
+}
 
-    for (int i = 0; i < current_scene->auto_event_count; i++) {
-        AutoEvent* event = &current_scene->auto_events[i];
-        
-        // Prevent looping: if this event sets a flag, and that flag is ALREADY set, skip it.
-        if (strlen(event->flag_to_set) > 0) {
-             const char* val = hash_table_get(game_state->flags, event->flag_to_set);
-             if (val != NULL && strcmp(val, "1") == 0) {
-                 continue; 
-             }
-        }
+static bool auto_event_timer_fired(void* context, int index) {
+    StoryScene* scene = (StoryScene*)context;
+    GameState* game_state = g_auto_event_state;
+    if (!game_state || !scene || index < 0 || index >= scene->auto_event_count) return false;
+    AutoEvent* event = &scene->auto_events[index];
+    g_auto_event_timers[index] = 0;
+
+    // The clock may have been set back since this was armed.
+    uint32_t seconds = auto_event_seconds_left(index);
+    if (seconds > 0) {
+        arm_auto_event(scene, index, seconds);
+        return false;
+    }
 
-        // Check wait time
-        if (elapsed_seconds < (uint32_t)event->wait_time) {
-            continue; 
-        }
+    // Prevent looping: if this event sets a flag, and that flag is ALREADY set, skip it.
+    bool guarded = false;
+    if (strlen(event->flag_to_set) > 0) {
+        const char* val = hash_table_get(game_state->flags, event->flag_to_set);
+        guarded = (val != NULL && strcmp(val, "1") == 0);
+    }
 
-        // Check conditions
-        if (check_conditions(game_state, event->conditions, event->condition_count)) {
-            // Trigger!
-            if (strlen(event->flag_to_set) > 0) {
-                 hash_table_set(game_state->flags, event->flag_to_set, "1");
-            }
-            strncpy(game_state->current_story_file, event->target_scene_id, MAX_PATH_LENGTH - 1);
-            return true;
-        }
+    if (guarded || !check_conditions(game_state, event->conditions, event->condition_count)) {
+        arm_auto_event(scene, index, 1);
+        return false;
     }
-    return false;
-}
\ No newline at end of file
+
+    // Trigger!
+    if (strlen(event->flag_to_set) > 0) {
+        hash_table_set(game_state->flags, event->flag_to_set, "1");
+    }
+    strncpy(game_state->current_story_file, event->target_scene_id, MAX_PATH_LENGTH - 1);
+    // The scene is leaving; nothing else of it may fire.
+    game_timers_cancel_group(TIMER_GROUP_SCENE);
+    return true;
+}
+
+// Re-arms the pending events against the clock's new reading. Timers of a
+// scene already left were cancelled with it and stay so.
+static void auto_events_clock_jumped(GameState* game_state) {
+    (void)game_state;
+    for (int i = 0; i < MAX_AUTO_EVENTS; i++) {
+        if (g_auto_event_timers[i] == 0 || !game_timer_cancel(g_auto_event_timers[i])) continue;
+        arm_auto_event(g_auto_event_scene, i, auto_event_seconds_left(i));
+    }
+}
+
+void arm_scene_auto_events(GameState* game_state, StoryScene* scene) {
+    if (!game_state || !scene) return;
+    if (g_auto_event_state == NULL) game_timers_add_clock_jump_listener(auto_events_clock_jumped);
+    g_auto_event_state = game_state;
+    g_auto_event_scene = scene;
+    uint32_t now;
+    g_auto_event_clocked = game_clock_read(game_state, &now);
+    for (int i = 0; i < MAX_AUTO_EVENTS; i++) g_auto_event_timers[i] = 0;
+    // Armed in index order so events due on the same tick keep their priority.
+    for (int i = 0; i < scene->auto_event_count && i < MAX_AUTO_EVENTS; i++) {
+        uint32_t wait = scene->auto_events[i].wait_time > 0 ? (uint32_t)scene->auto_events[i].wait_time : 0;
+        if (g_auto_event_clocked) g_auto_event_due[i] = game_clock_after(now, wait);
+        arm_auto_event(scene, i, wait);
+    }
+}
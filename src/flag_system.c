@@ -1,4 +1,5 @@
 #include "flag_system.h"
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -25,6 +26,7 @@ static FlagNode* create_flag_node(const char* key, const char* value) {
     new_node->key = strdup(key);
     new_node->value = strdup(value);
     new_node->next = NULL;
+    new_node->refs = 1;
 
     if (!new_node->key || !new_node->value) {
         // Handle strdup allocation failure
@@ -57,32 +59,89 @@ HashTable* create_hash_table(int size) {
     return table;
 }
 
+// Drops one table's hold on a bucket chain; the last one frees it.
+static void release_chain(FlagNode* head) {
+    if (!head || --head->refs > 0) {
+        return;
+    }
+
+    FlagNode* current = head;
+    while (current) {
+        FlagNode* to_free = current;
+        current = current->next;
+        free(to_free->key);
+        free(to_free->value);
+        free(to_free);
+    }
+}
+
+// Gives the table its own copy of a bucket chain it shares, before a write.
+static bool unshare_bucket(HashTable* table, unsigned int index) {
+    FlagNode* head = table->buckets[index];
+    if (!head || head->refs == 1) {
+        return true;
+    }
+
+    FlagNode* copy = NULL;
+    FlagNode** tail = &copy;
+    for (const FlagNode* node = head; node; node = node->next) {
+        FlagNode* new_node = create_flag_node(node->key, node->value);
+        if (!new_node) {
+            release_chain(copy);
+            return false;
+        }
+        *tail = new_node;
+        tail = &new_node->next;
+    }
+
+    release_chain(head);
+    table->buckets[index] = copy;
+    return true;
+}
+
 void free_hash_table(HashTable* table) {
     if (!table) {
         return;
     }
 
     for (int i = 0; i < table->size; i++) {
-        FlagNode* current = table->buckets[i];
-        while (current) {
-            FlagNode* to_free = current;
-            current = current->next;
-            free(to_free->key);
-            free(to_free->value);
-            free(to_free);
-        }
+        release_chain(table->buckets[i]);
     }
 
     free(table->buckets);
     free(table);
 }
 
+HashTable* hash_table_share(const HashTable* table) {
+    if (!table) {
+        return NULL;
+    }
+
+    HashTable* copy = create_hash_table(table->size);
+    if (!copy) {
+        return NULL;
+    }
+
+    for (int i = 0; i < table->size; i++) {
+        copy->buckets[i] = table->buckets[i];
+        if (copy->buckets[i]) {
+            copy->buckets[i]->refs++;
+        }
+    }
+
+    return copy;
+}
+
 void hash_table_set(HashTable* table, const char* key, const char* value) {
     if (!table || !key || !value) {
         return;
     }
 
     unsigned int index = hash_function(key, table->size);
+    if (!unshare_bucket(table, index)) {
+        // Handle allocation failure
+        return;
+    }
 
     FlagNode* current = table->buckets[index];
     FlagNode* prev = NULL;
@@ -135,3 +194,29 @@ const char* hash_table_get(HashTable* table, const char* key) {
 
     return NULL; // Key not found
 }
+
+void hash_table_foreach(const HashTable* table, void (*visit)(const char* key, const char* value, void* context), void* context) {
+    if (!table || !visit) {
+        return;
+    }
+
+    for (int i = 0; i < table->size; i++) {
+        for (const FlagNode* node = table->buckets[i]; node; node = node->next) {
+            visit(node->key, node->value, context);
+        }
+    }
+}
+
+int hash_table_count(const HashTable* table) {
+    if (!table) {
+        return 0;
+    }
+
+    int count = 0;
+    for (int i = 0; i < table->size; i++) {
+        for (const FlagNode* node = table->buckets[i]; node; node = node->next) {
+            count++;
+        }
+    }
+    return count;
+}
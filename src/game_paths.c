@@ -4,6 +4,7 @@
 #include <string.h>
 #include <libgen.h> // For dirname
 #include <errno.h>  // Required for errno and strerror
+#include <fcntl.h>  // For open
 #include <sys/stat.h> // For stat and S_ISDIR, mkdir
 #include <unistd.h> // For realpath, geteuid, getegid
 #include <pwd.h>    // For getpwuid
@@ -65,6 +66,10 @@ void init_paths(char* argv0, GamePaths* paths) {
     char current_path[MAX_PATH_LENGTH];
     strncpy(current_path, dirname(resolved_path), MAX_PATH_LENGTH - 1);
 
+    // Locale packs and the world image are build outputs, so they sit next to the executable in both modes.
+    snprintf(paths->locale_dir, sizeof(paths->locale_dir), "%s/locale", current_path);
+    snprintf(paths->world_pack, sizeof(paths->world_pack), "%s/world.wpk", current_path);
+
     struct passwd *pw = getpwuid(geteuid());
     if (pw) {
         LOG_DEBUG("Effective User ID (EUID): %d (%s)", geteuid(), pw->pw_name);
@@ -164,3 +169,52 @@ int write_string_to_file(const char* str, const char* dest_path) {
     return 1;
 }
 
+bool write_fully(int fd, const void* data, size_t size) {
+    const char* p = data;
+    while (size > 0) {
+        ssize_t written = write(fd, p, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+bool sync_parent_directory(const char* path) {
+    char dir[MAX_PATH_LENGTH];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char* slash = strrchr(dir, '/');
+    if (slash == NULL) strcpy(dir, ".");
+    else if (slash == dir) slash[1] = '\0'; // "/file" lives in "/"
+    else *slash = '\0';
+
+    int fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+bool write_file_atomic(const char* path, const void* data, size_t size) {
+    char tmp_path[MAX_PATH_LENGTH + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        LOG_DEBUG("Could not create %s: %s", tmp_path, strerror(errno));
+        return false;
+    }
+    bool ok = write_fully(fd, data, size) && fsync(fd) == 0;
+    if (close(fd) != 0) ok = false;
+    if (!ok || rename(tmp_path, path) != 0) {
+        LOG_DEBUG("Could not replace %s: %s", path, strerror(errno));
+        unlink(tmp_path);
+        return false;
+    }
+    // The rename is only durable once the directory entry is.
+    sync_parent_directory(path);
+    return true;
+}
@@ -0,0 +1,113 @@
+#include "game_timers.h"
+#include "time_utils.h"
+#include "ecc_time.h"
+#include "logger.h"
+#include <stdio.h>
+
+#define MAX_CLOCK_JUMP_LISTENERS 8
+#define GAME_TIME_DATA_MASK 0xFFFFFFu // time_of_day carries 24 data bits
+
+static TimerWheel g_game_wheel;      // 1 tick = 1 game second
+static TimerWheel g_realtime_wheel;  // 1 tick = GAME_TIMER_REALTIME_STEP_MS
+static uint64_t g_game_ticks = 0;    // Monotonic, unlike time_of_day
+
+static uint32_t g_last_clock_units = 0;
+static bool g_clock_known = false;
+static void (*g_clock_jump_listeners[MAX_CLOCK_JUMP_LISTENERS])(GameState*);
+static int g_clock_jump_listener_count = 0;
+
+static uint64_t realtime_now_ticks(void) {
+    return get_current_time_ms() / GAME_TIMER_REALTIME_STEP_MS;
+}
+
+static bool read_clock_units(const GameState* game_state, uint32_t* out_units) {
+    DecodedTimeResult decoded = decode_time_with_ecc(game_state->time_of_day);
+    if (decoded.status == DOUBLE_BIT_ERROR_DETECTED) return false;
+    *out_units = decoded.data & GAME_TIME_DATA_MASK;
+    return true;
+}
+
+void game_timers_init(const GameState* game_state) {
+    timer_wheel_init(&g_game_wheel, g_game_ticks);
+    timer_wheel_init(&g_realtime_wheel, realtime_now_ticks());
+    g_clock_known = game_state != NULL && read_clock_units(game_state, &g_last_clock_units);
+}
+
+TimerId game_timer_after_seconds(uint32_t seconds, TimerCallback callback, void* context, int arg, TimerGroup group) {
+    TimerId id = timer_wheel_add(&g_game_wheel, seconds, callback, context, arg, group);
+    if (id == 0) fprintf(stderr, "WARNING: Game timer wheel is full.\n");
+    return id;
+}
+
+TimerId realtime_timer_after_ms(uint32_t ms, TimerCallback callback, void* context, int arg, TimerGroup group) {
+    if (!g_realtime_wheel.initialized) timer_wheel_init(&g_realtime_wheel, realtime_now_ticks());
+    // Round up, plus one step for the part of the current step already gone, so a
+    // reveal never fires before its delay has fully passed.
+    uint64_t steps = (ms + GAME_TIMER_REALTIME_STEP_MS - 1) / GAME_TIMER_REALTIME_STEP_MS + 1;
+    TimerId id = timer_wheel_add(&g_realtime_wheel, steps, callback, context, arg, group);
+    if (id == 0) fprintf(stderr, "WARNING: Real-time timer wheel is full.\n");
+    return id;
+}
+
+bool game_timer_cancel(TimerId id) {
+    return timer_wheel_cancel(&g_game_wheel, id);
+}
+
+void game_timers_cancel_group(TimerGroup group) {
+    timer_wheel_cancel_group(&g_game_wheel, group);
+    timer_wheel_cancel_group(&g_realtime_wheel, group);
+}
+
+bool game_clock_read(const GameState* game_state, uint32_t* out_units) {
+    return game_state != NULL && read_clock_units(game_state, out_units);
+}
+
+uint32_t game_clock_after(uint32_t units, uint32_t seconds) {
+    return (units + seconds * GAME_TIME_UNITS_PER_SECOND) & GAME_TIME_DATA_MASK;
+}
+
+uint32_t game_clock_seconds_until(uint32_t now, uint32_t due) {
+    uint32_t ahead = (due - now) & GAME_TIME_DATA_MASK;
+    if (ahead > GAME_TIME_DATA_MASK / 2) return 0; // Behind: passed
+    return (ahead + GAME_TIME_UNITS_PER_SECOND - 1) / GAME_TIME_UNITS_PER_SECOND;
+}
+
+void game_timers_add_clock_jump_listener(void (*listener)(GameState* game_state)) {
+    if (listener == NULL) return;
+    for (int i = 0; i < g_clock_jump_listener_count; i++) {
+        if (g_clock_jump_listeners[i] == listener) return;
+    }
+    if (g_clock_jump_listener_count < MAX_CLOCK_JUMP_LISTENERS) {
+        g_clock_jump_listeners[g_clock_jump_listener_count++] = listener;
+    }
+}
+
+bool game_timers_on_tick(GameState* game_state, uint32_t tick_count) {
+    // Regular ticks move the clock by exactly one second each; anything else
+    // means an action or load moved it and absolute schedules are stale.
+    uint32_t units;
+    if (game_state != NULL && read_clock_units(game_state, &units)) {
+        uint32_t expected = (g_last_clock_units + tick_count * GAME_TIME_UNITS_PER_SECOND) & GAME_TIME_DATA_MASK;
+        if (g_clock_known && units != expected) {
+            LOG_DEBUG("Game clock jumped (expected %u, got %u); resyncing schedules.", expected, units);
+            for (int i = 0; i < g_clock_jump_listener_count; i++) g_clock_jump_listeners[i](game_state);
+        }
+        g_last_clock_units = units;
+        g_clock_known = true;
+    }
+
+    g_game_ticks += tick_count;
+    return timer_wheel_advance(&g_game_wheel, g_game_ticks);
+}
+
+bool game_timers_poll_realtime(void) {
+    return timer_wheel_advance(&g_realtime_wheel, realtime_now_ticks());
+}
+
+long game_timers_next_realtime_ms(void) {
+    int64_t steps = timer_wheel_next_due(&g_realtime_wheel);
+    if (steps < 0) return -1;
+    // The next step boundary may be closer than a full step away.
+    uint64_t into_step = get_current_time_ms() % GAME_TIMER_REALTIME_STEP_MS;
+    return (long)(steps * GAME_TIMER_REALTIME_STEP_MS - (int64_t)into_step);
+}
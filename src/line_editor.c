@@ -0,0 +1,417 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // For wcwidth
+#endif
+
+#include "line_editor.h"
+#include "time_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+// --- UTF-8 Helpers ---
+
+static bool is_continuation(unsigned char c) { return (c & 0xC0) == 0x80; }
+
+static size_t utf8_sequence_length(unsigned char lead) {
+    if (lead < 0x80) return 1;
+    if ((lead & 0xE0) == 0xC0) return 2;
+    if ((lead & 0xF0) == 0xE0) return 3;
+    if ((lead & 0xF8) == 0xF0) return 4;
+    return 1; // Invalid lead byte; treat as a single byte
+}
+
+static size_t prev_boundary(const char* s, size_t pos) {
+    if (pos == 0) return 0;
+    pos--;
+    while (pos > 0 && is_continuation((unsigned char)s[pos])) pos--;
+    return pos;
+}
+
+static size_t next_boundary(const char* s, size_t len, size_t pos) {
+    if (pos >= len) return len;
+    pos++;
+    while (pos < len && is_continuation((unsigned char)s[pos])) pos++;
+    return pos;
+}
+
+// Terminal column width of s[from, to). CJK and other wide characters count as 2.
+static int display_width(const char* s, size_t from, size_t to) {
+    int width = 0;
+    mbstate_t st;
+    memset(&st, 0, sizeof(st));
+    while (from < to) {
+        wchar_t wc;
+        size_t n = mbrtowc(&wc, s + from, to - from, &st);
+        if (n == (size_t)-1 || n == (size_t)-2 || n == 0) {
+            memset(&st, 0, sizeof(st));
+            width++;
+            from++;
+            continue;
+        }
+        int w = wcwidth(wc);
+        width += (w < 0) ? 1 : w;
+        from += n;
+    }
+    return width;
+}
+
+// Visible width of a prompt that may contain ANSI escape sequences.
+static int prompt_display_width(const char* prompt) {
+    char plain[sizeof(((LineEditor*)0)->prompt)];
+    size_t n = 0;
+    for (size_t i = 0; prompt[i] != '\0' && n < sizeof(plain) - 1; i++) {
+        if (prompt[i] == '\x1b' && prompt[i + 1] == '[') {
+            i += 2;
+            while (prompt[i] != '\0' && !(prompt[i] >= 0x40 && prompt[i] <= 0x7E)) i++;
+            if (prompt[i] == '\0') break;
+            continue;
+        }
+        plain[n++] = prompt[i];
+    }
+    plain[n] = '\0';
+    return display_width(plain, 0, n);
+}
+
+static int terminal_columns(void) {
+    struct winsize w;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0 && w.ws_col > 0) return w.ws_col;
+    return 80;
+}
+
+// --- Lifecycle ---
+
+void line_editor_init(LineEditor* ed, const char* prompt) {
+    memset(ed, 0, sizeof(*ed));
+    line_editor_set_prompt(ed, prompt);
+}
+
+void line_editor_free(LineEditor* ed) {
+    for (int i = 0; i < ed->history_len; i++) free(ed->history[i]);
+    ed->history_len = 0;
+}
+
+void line_editor_set_prompt(LineEditor* ed, const char* prompt) {
+    strncpy(ed->prompt, prompt ? prompt : "", sizeof(ed->prompt) - 1);
+    ed->prompt[sizeof(ed->prompt) - 1] = '\0';
+    ed->prompt_width = prompt_display_width(ed->prompt);
+}
+
+// --- Rendering ---
+
+void line_editor_refresh(LineEditor* ed) {
+    // Keep the cursor visible on narrow terminals by scrolling the buffer horizontally.
+    int avail = terminal_columns() - ed->prompt_width - 1;
+    if (avail < 1) avail = 1;
+
+    size_t start = 0;
+    while (start < ed->pos && display_width(ed->buf, start, ed->pos) > avail) {
+        start = next_boundary(ed->buf, ed->len, start);
+    }
+    size_t end = ed->pos;
+    while (end < ed->len) {
+        size_t next = next_boundary(ed->buf, ed->len, end);
+        if (display_width(ed->buf, start, next) > avail) break;
+        end = next;
+    }
+
+    printf("\r%s", ed->prompt);
+    fwrite(ed->buf + start, 1, end - start, stdout);
+    printf("\033[K");
+    int tail = display_width(ed->buf, ed->pos, end);
+    if (tail > 0) printf("\033[%dD", tail);
+    fflush(stdout);
+    ed->needs_refresh = false;
+}
+
+// --- Editing Primitives ---
+
+static void set_buffer(LineEditor* ed, const char* text) {
+    strncpy(ed->buf, text, LINE_EDITOR_MAX_LENGTH - 1);
+    ed->buf[LINE_EDITOR_MAX_LENGTH - 1] = '\0';
+    ed->len = strlen(ed->buf);
+    ed->pos = ed->len;
+    ed->needs_refresh = true;
+}
+
+static void insert_bytes(LineEditor* ed, const char* bytes, size_t n) {
+    if (ed->len + n >= LINE_EDITOR_MAX_LENGTH) return;
+    memmove(ed->buf + ed->pos + n, ed->buf + ed->pos, ed->len - ed->pos);
+    memcpy(ed->buf + ed->pos, bytes, n);
+    ed->len += n;
+    ed->pos += n;
+    ed->buf[ed->len] = '\0';
+    ed->needs_refresh = true;
+}
+
+static void delete_range(LineEditor* ed, size_t from, size_t to) {
+    if (from >= to) return;
+    memmove(ed->buf + from, ed->buf + to, ed->len - to);
+    ed->len -= (to - from);
+    ed->buf[ed->len] = '\0';
+    if (ed->pos > to) ed->pos -= (to - from);
+    else if (ed->pos > from) ed->pos = from;
+    ed->needs_refresh = true;
+}
+
+static void move_cursor_to(LineEditor* ed, size_t pos) {
+    if (pos != ed->pos) {
+        ed->pos = pos;
+        ed->needs_refresh = true;
+    }
+}
+
+static void delete_prev_word(LineEditor* ed) {
+    size_t from = ed->pos;
+    while (from > 0 && ed->buf[from - 1] == ' ') from--;
+    while (from > 0 && ed->buf[from - 1] != ' ') from--;
+    delete_range(ed, from, ed->pos);
+}
+
+// --- History ---
+
+void line_editor_history_add(LineEditor* ed, const char* line) {
+    if (line == NULL || line[0] == '\0') return;
+    if (ed->history_len > 0 && strcmp(ed->history[ed->history_len - 1], line) == 0) return;
+
+    if (ed->history_len == LINE_EDITOR_HISTORY_MAX) {
+        free(ed->history[0]);
+        memmove(ed->history, ed->history + 1, sizeof(char*) * (LINE_EDITOR_HISTORY_MAX - 1));
+        ed->history_len--;
+    }
+    ed->history[ed->history_len++] = strdup(line);
+}
+
+static void history_step(LineEditor* ed, int direction) {
+    int target = ed->history_index + direction;
+    if (target < 0 || target > ed->history_len) return;
+
+    if (ed->history_index == 0) {
+        strncpy(ed->saved_line, ed->buf, LINE_EDITOR_MAX_LENGTH - 1);
+        ed->saved_line[LINE_EDITOR_MAX_LENGTH - 1] = '\0';
+    }
+    ed->history_index = target;
+    set_buffer(ed, target == 0 ? ed->saved_line : ed->history[ed->history_len - target]);
+}
+
+// --- Completion ---
+
+void line_editor_set_completer(LineEditor* ed, LineEditorCompleter completer, void* context) {
+    ed->completer = completer;
+    ed->completer_context = context;
+}
+
+static void complete_at_cursor(LineEditor* ed) {
+    if (ed->completer == NULL) return;
+    LineEditorCompletion completion;
+    completion.insert[0] = '\0';
+    completion.match_count = 0;
+    ed->completer(ed->buf, ed->pos, &completion, ed->completer_context);
+
+    if (completion.insert[0] != '\0') {
+        insert_bytes(ed, completion.insert, strlen(completion.insert));
+        return;
+    }
+    if (completion.match_count < 2) {
+        printf("\a");
+        fflush(stdout);
+        return;
+    }
+    // The list goes under the prompt line, which is redrawn below it.
+    printf("\r\n");
+    int listed = completion.match_count < LINE_EDITOR_COMPLETION_MAX ? completion.match_count : LINE_EDITOR_COMPLETION_MAX;
+    for (int i = 0; i < listed; i++) printf("%s  ", completion.matches[i]);
+    if (completion.match_count > listed) printf("(+%d)", completion.match_count - listed);
+    printf("\r\n");
+    ed->needs_refresh = true;
+}
+
+// --- Input State Machine ---
+
+static bool submit_line(LineEditor* ed, LineEditorEvent* out) {
+    memcpy(ed->submitted, ed->buf, ed->len + 1);
+    ed->len = 0;
+    ed->pos = 0;
+    ed->buf[0] = '\0';
+    ed->history_index = 0;
+    ed->needs_refresh = false;
+    printf("\r\n");
+    fflush(stdout);
+
+    out->type = LINE_EDITOR_EVENT_LINE;
+    out->line = ed->submitted;
+    return true;
+}
+
+// Handles a complete CSI sequence (parameters in ed->seq, final byte 'final').
+static bool handle_csi(LineEditor* ed, char final, LineEditorEvent* out) {
+    ed->seq[ed->seq_len] = '\0';
+
+    if (ed->seq[0] == '<' && (final == 'M' || final == 'm')) {
+        int b, x, y;
+        if (sscanf(ed->seq + 1, "%d;%d;%d", &b, &x, &y) == 3) {
+            out->type = LINE_EDITOR_EVENT_MOUSE;
+            out->mouse_button = b;
+            out->mouse_x = x;
+            out->mouse_y = y;
+            out->mouse_event = final;
+            return true;
+        }
+        return false;
+    }
+
+    switch (final) {
+        case 'A': history_step(ed, 1); break;
+        case 'B': history_step(ed, -1); break;
+        case 'C': move_cursor_to(ed, next_boundary(ed->buf, ed->len, ed->pos)); break;
+        case 'D': move_cursor_to(ed, prev_boundary(ed->buf, ed->pos)); break;
+        case 'H': move_cursor_to(ed, 0); break;
+        case 'F': move_cursor_to(ed, ed->len); break;
+        case '~': {
+            int code = atoi(ed->seq);
+            if (code == 1 || code == 7) move_cursor_to(ed, 0);
+            else if (code == 4 || code == 8) move_cursor_to(ed, ed->len);
+            else if (code == 3) delete_range(ed, ed->pos, next_boundary(ed->buf, ed->len, ed->pos));
+            break;
+        }
+        default: break;
+    }
+    return false;
+}
+
+// Feeds one byte through the state machine. Returns true if it completed an event.
+static bool process_byte(LineEditor* ed, unsigned char c, LineEditorEvent* out) {
+    bool was_cr = ed->last_was_cr;
+    ed->last_was_cr = false;
+
+    switch (ed->state) {
+        case LE_STATE_ESC:
+            if (c == '[') { ed->state = LE_STATE_CSI; ed->seq_len = 0; return false; }
+            if (c == 'O') { ed->state = LE_STATE_SS3; return false; }
+            // A lone ESC (or Alt+key): the byte after it is ordinary input.
+            ed->state = LE_STATE_NORMAL;
+            break;
+
+        case LE_STATE_SS3:
+            ed->state = LE_STATE_NORMAL;
+            if (c == 'H') move_cursor_to(ed, 0);
+            else if (c == 'F') move_cursor_to(ed, ed->len);
+            return false;
+
+        case LE_STATE_CSI:
+            if (c >= 0x40 && c <= 0x7E) {
+                ed->state = LE_STATE_NORMAL;
+                return handle_csi(ed, (char)c, out);
+            }
+            if (ed->seq_len < sizeof(ed->seq) - 1) ed->seq[ed->seq_len++] = (char)c;
+            return false;
+
+        case LE_STATE_NORMAL:
+            break;
+    }
+
+    // Complete a pending multi-byte character before anything else.
+    if (ed->utf8_need > 0) {
+        if (is_continuation(c)) {
+            ed->utf8[ed->utf8_len++] = (char)c;
+            if (ed->utf8_len == ed->utf8_need) {
+                insert_bytes(ed, ed->utf8, ed->utf8_len);
+                ed->utf8_need = 0;
+            }
+            return false;
+        }
+        ed->utf8_need = 0; // Malformed; drop the partial character
+    }
+
+    switch (c) {
+        case '\r':
+            ed->last_was_cr = true;
+            return submit_line(ed, out);
+        case '\n':
+            if (was_cr) return false;
+            return submit_line(ed, out);
+        case 0x1b: ed->state = LE_STATE_ESC; ed->esc_ms = ed->fed_ms; return false;
+        case '\t': complete_at_cursor(ed); return false;
+        case 0x7f:
+        case 0x08: delete_range(ed, prev_boundary(ed->buf, ed->pos), ed->pos); return false;
+        case 0x01: move_cursor_to(ed, 0); return false;                                      // Ctrl-A
+        case 0x05: move_cursor_to(ed, ed->len); return false;                                // Ctrl-E
+        case 0x02: move_cursor_to(ed, prev_boundary(ed->buf, ed->pos)); return false;        // Ctrl-B
+        case 0x06: move_cursor_to(ed, next_boundary(ed->buf, ed->len, ed->pos)); return false; // Ctrl-F
+        case 0x0b: delete_range(ed, ed->pos, ed->len); return false;                         // Ctrl-K
+        case 0x15: delete_range(ed, 0, ed->pos); return false;                               // Ctrl-U
+        case 0x17: delete_prev_word(ed); return false;                                       // Ctrl-W
+        case 0x10: history_step(ed, 1); return false;                                        // Ctrl-P
+        case 0x0e: history_step(ed, -1); return false;                                       // Ctrl-N
+        case 0x0c: ed->needs_refresh = true; return false;                                   // Ctrl-L
+        case 0x04:                                                                           // Ctrl-D
+            if (ed->len == 0) {
+                out->type = LINE_EDITOR_EVENT_EOF;
+                return true;
+            }
+            delete_range(ed, ed->pos, next_boundary(ed->buf, ed->len, ed->pos));
+            return false;
+        default:
+            break;
+    }
+
+    if (c < 0x20) return false; // Other control characters are ignored
+
+    size_t need = utf8_sequence_length(c);
+    if (need > 1) {
+        ed->utf8[0] = (char)c;
+        ed->utf8_len = 1;
+        ed->utf8_need = need;
+        return false;
+    }
+    char ch = (char)c;
+    insert_bytes(ed, &ch, 1);
+    return false;
+}
+
+// --- Public Feeding API ---
+
+size_t line_editor_feed(LineEditor* ed, const char* bytes, size_t len) {
+    uint64_t now = get_current_time_ms();
+    // An escape sequence arrives in one burst. If the input ended on an ESC
+    // and nothing came within the timeout, that was the key on its own, and
+    // these bytes start afresh: "[" or "O" typed next is just text.
+    if (ed->state == LE_STATE_ESC && ed->pending_len == 0 && now - ed->esc_ms >= LINE_EDITOR_ESC_TIMEOUT_MS) {
+        ed->state = LE_STATE_NORMAL;
+    }
+    ed->fed_ms = now;
+    size_t space = line_editor_pending_space(ed);
+    if (len > space) len = space;
+    memcpy(ed->pending + ed->pending_len, bytes, len);
+    ed->pending_len += len;
+    return len;
+}
+
+size_t line_editor_pending_space(const LineEditor* ed) {
+    return LINE_EDITOR_PENDING_SIZE - ed->pending_len;
+}
+
+bool line_editor_has_pending(const LineEditor* ed) {
+    return ed->pending_len > 0;
+}
+
+bool line_editor_poll(LineEditor* ed, LineEditorEvent* out_event) {
+    LineEditorEvent ev;
+    memset(&ev, 0, sizeof(ev));
+    bool got_event = false;
+    size_t consumed = 0;
+
+    while (consumed < ed->pending_len && !got_event) {
+        got_event = process_byte(ed, ed->pending[consumed++], &ev);
+    }
+    memmove(ed->pending, ed->pending + consumed, ed->pending_len - consumed);
+    ed->pending_len -= consumed;
+
+    // One redraw per batch of keystrokes, not per byte (pastes stay cheap).
+    if (ed->needs_refresh) line_editor_refresh(ed);
+
+    if (out_event) *out_event = ev;
+    return got_event;
+}
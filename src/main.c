@@ -23,33 +23,52 @@
 #include "characters/mika.h"
 #include "ecc_time.h"
 #include "linenoise.h"
+#include "line_editor.h"
 #include "string_id_names.h"
 #include "systems/boot_system.h"
 #include "logger.h"
+#include "scene_prefetch.h"
+#include "world_vfs.h"
+#include "world_watch.h"
+#include "systems/embedded_navi.h"
+#include "task_scheduler.h"
+#include "game_timers.h"
+#include "npc_schedule.h"
+#include "save_state.h"
+#include "autosave.h"
+#include "state_snapshot.h"
 
-static uint32_t scene_entry_time = 0;
 volatile sig_atomic_t g_needs_redraw = 0;
 
 extern volatile bool game_is_running;
 extern pthread_mutex_t time_mutex;
 
 void handle_signal(int sig) { (void)sig; g_needs_redraw = 1; }
-void handle_sigwinch(int sig) { (void)sig; g_needs_redraw = 1; }
-
-extern const char* g_embedded_strings[TEXT_COUNT];
+void handle_sigwinch(int sig) {
+    (void)sig;
+    Event resize_event;
+    memset(&resize_event, 0, sizeof(resize_event));
+    resize_event.type = RESIZE_EVENT;
+    if (!push_event(resize_event)) g_needs_redraw = 1; // Ring full: fall back to the flag
+}
 
 int is_numeric(const char* str);
 int handle_key_event(int key, void* userdata);
 
-static bool process_events(GameState* gs, StoryScene* scene) {
-    return check_and_trigger_auto_events(gs, scene, scene_entry_time);
+// Tab completes for whoever reads the line: the task waiting for input, or the main prompt.
+static void complete_input(const char* line, size_t cursor, LineEditorCompletion* out, void* context) {
+    if (task_scheduler_has_foreground()) {
+        task_scheduler_complete(line, cursor, out);
+        return;
+    }
+    complete_command(line, cursor, out, (GameState*)context);
 }
 
 int main(int argc, char *argv[]) {
     setlocale(LC_ALL, "");
     logger_init("game_debug.log");
     init_terminal_state();
-    init_string_table(g_embedded_strings, TEXT_COUNT);
+    init_string_table();
     
     enter_fullscreen_mode();
 
@@ -74,6 +93,7 @@ int main(int argc, char *argv[]) {
 
     char character_file_path[MAX_PATH_LENGTH] = {0};
     int arg_index = 1;
+    g_arg_index_ptr = &arg_index; // NAVI consumes leftover argv entries as scripted input
     if (!perform_boot_sequence(game_state, argc, argv, &arg_index, character_file_path)) {
         restore_terminal_state();
         return 0;
@@ -81,38 +101,73 @@ int main(int argc, char *argv[]) {
 
     LOG_DEBUG("Boot sequence complete. Character file path: %s", character_file_path);
 
-    if (!load_player_state(character_file_path, game_state)) {
-        fprintf(stderr, "ERROR: Failed to load player state from %s\n", character_file_path);
-        restore_terminal_state();
-        return 1;
+    // A session that has been played resumes from its binary save; the JSON
+    // file is only the starting template.
+    char save_file_path[MAX_PATH_LENGTH] = {0};
+    save_state_sibling_path(character_file_path, SAVE_STATE_EXTENSION, save_file_path, sizeof(save_file_path));
+    int replayed = 0;
+    SaveStateStatus save_status = autosave_recover(save_file_path, game_state, &replayed);
+    if (save_status == SAVE_STATE_OK && replayed > 0) {
+        logger_log("Recovered %s with %d journal records.", save_file_path, replayed);
     }
-    
-    if (!load_items_data(game_state)) {
-        fprintf(stderr, "ERROR: Failed to load items data.\n");
-        restore_terminal_state();
-        return 1;
+    if (save_status != SAVE_STATE_OK) {
+        if (save_status != SAVE_STATE_ERROR_IO) {
+            logger_log("Ignoring save %s (%s); starting from %s.", save_file_path, save_state_status_string(save_status), character_file_path);
+        }
+        if (!load_player_state(character_file_path, game_state)) {
+            fprintf(stderr, "ERROR: Failed to load player state from %s\n", character_file_path);
+            restore_terminal_state();
+            return 1;
+        }
     }
-
+    
     load_map_data(NULL, game_state);
+    scene_prefetch_init();
+
+    // The NAVI's file tree; what this session changes in it lives beside its save.
+    if (!vfs_mount(game_state->paths.world_pack)) {
+        logger_log("World image %s could not be mapped; the NAVI shell and mail are unavailable.", game_state->paths.world_pack);
+    }
+    char overlay_path[MAX_PATH_LENGTH] = {0};
+    save_state_sibling_path(character_file_path, VFS_OVERLAY_EXTENSION, overlay_path, sizeof(overlay_path));
+    if (!vfs_overlay_open(overlay_path)) {
+        logger_log("Ignoring unreadable world overlay %s.", overlay_path);
+    }
+    // Files dropped into the session's world/ directory arrive while playing.
+    char drop_dir[MAX_PATH_LENGTH] = {0};
+    const char* session_end = strrchr(character_file_path, '/');
+    snprintf(drop_dir, sizeof(drop_dir), "%.*s%s", session_end ? (int)(session_end - character_file_path + 1) : 0, character_file_path, WORLD_WATCH_DIR);
+    if (vfs_is_mounted() && !world_watch_start(drop_dir)) {
+        logger_log("Not watching %s; files dropped there wait for the next start.", drop_dir);
+    }
 
     if (game_state->current_story_file[0] == '\0') {
         strncpy(game_state->current_story_file, "SCENE_00_ENTRY", MAX_PATH_LENGTH - 1);
     }
 
     enable_raw_mode();
-    linenoiseSetKeyCallback(handle_key_event, game_state);
     
     if (is_mouse_supported()) linenoiseSetMouseSupport(2);
     
     // Removed timeout to allow proper blocking input in raw mode
     // linenoiseSetTimeout(10); 
 
+    // Timers count from here; NPC schedules arm against the loaded clock.
+    game_timers_init(game_state);
+    npc_schedule_arm(game_state);
+    if (!autosave_start(save_file_path, game_state)) {
+        logger_log("Autosave could not start; progress will not be saved.");
+    }
+
     game_is_running = true; 
     pthread_t time_thread_id;
     pthread_create(&time_thread_id, NULL, time_thread_func, (void*)game_state);
 
     char prompt[128];
     snprintf(prompt, sizeof(prompt), "\x1b[1;32m%s@wired_navi\x1b[0m:\x1b[1;34m~\x1b[0m$ ", game_state->session_name);
+    LineEditor editor;
+    line_editor_init(&editor, prompt);
+    line_editor_set_completer(&editor, complete_input, game_state);
 
     StoryScene current_scene;
     bool dirty = true;
@@ -122,67 +177,95 @@ int main(int argc, char *argv[]) {
     if (game_state->current_story_file[0] != '\0') {
         transition_to_scene(game_state->current_story_file, &current_scene, game_state);
         game_state->current_story_file[0] = '\0';
-        scene_entry_time = decode_time_with_ecc(game_state->time_of_day).data;
     }
     render_current_scene(&current_scene, game_state);
-    printf("%s", prompt); 
-    fflush(stdout);
+    line_editor_refresh(&editor);
     pthread_mutex_unlock(&time_mutex);
 
     while (game_is_running) {
+        // While a subsystem task (NAVI, mail, shell...) is sleeping, typed bytes stay
+        // queued in the editor until it asks for input again, as they did in the tty.
+        bool accepting_input = !task_scheduler_has_foreground() || task_scheduler_wants_input();
+
         fd_set readfds;
         struct timeval tv;
         FD_ZERO(&readfds);
-        FD_SET(STDIN_FILENO, &readfds);
+        if (line_editor_pending_space(&editor) > 0) FD_SET(STDIN_FILENO, &readfds);
+        int watch_fd = world_watch_fd();
+        if (watch_fd >= 0) FD_SET(watch_fd, &readfds);
+        bool watch_pending = world_watch_pending();
         tv.tv_sec = 0;
-        tv.tv_usec = 50000; // 50ms
-
-        int retval = select(STDIN_FILENO + 1, &readfds, NULL, NULL, &tv);
+        // Bytes left over from a paste or piped input (or files from a full
+        // delivery batch) are taken without waiting.
+        long timeout_ms = ((accepting_input && line_editor_has_pending(&editor)) || watch_pending) ? 0 : 50; // 50ms
+        long task_timeout_ms = task_scheduler_next_timeout_ms();
+        if (task_timeout_ms >= 0 && task_timeout_ms < timeout_ms) timeout_ms = task_timeout_ms;
+        long timer_timeout_ms = game_timers_next_realtime_ms();
+        if (timer_timeout_ms >= 0 && timer_timeout_ms < timeout_ms) timeout_ms = timer_timeout_ms;
+        tv.tv_usec = timeout_ms * 1000;
+
+        int retval = select((watch_fd > STDIN_FILENO ? watch_fd : STDIN_FILENO) + 1, &readfds, NULL, NULL, &tv);
         
-        char *line = NULL;
         char input_buffer[MAX_LINE_LENGTH] = {0};
         bool input_handled = false;
-
-        if (retval > 0) {
-            // Clear prompt line before input
-            printf("\r\033[K");
-            fflush(stdout);
-            
-            line = linenoise(prompt);
-            if (line) logger_log("Raw input from linenoise: '%s' (len: %lu)", line, (unsigned long)strlen(line));
-            else logger_log("linenoise returned NULL");
-
-            if (line == NULL && errno != EAGAIN) {
-                game_is_running = false; 
+        bool task_input = false;   // Line (or EOF) goes to the waiting task
+        bool task_eof = false;
+
+        // Never block on the terminal: take what is there and let the editor
+        // assemble lines across iterations, so ticks and rendering keep going.
+        if (retval > 0 && FD_ISSET(STDIN_FILENO, &readfds)) {
+            char raw[256];
+            size_t want = line_editor_pending_space(&editor);
+            ssize_t n = read(STDIN_FILENO, raw, want < sizeof(raw) ? want : sizeof(raw));
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                logger_log("stdin closed");
+                game_is_running = false;
                 break;
             }
-            
-            int mx, my, mbtn, mevt;
-            if (is_mouse_supported() && linenoiseGetLastMouse(&mx, &my, &mbtn, &mevt)) {
-                logger_log("Mouse event detected: x=%d, y=%d, btn=%d, evt=%c", mx, my, mbtn, mevt);
-                // Currently we just use any click to advance if in a state that waits for input
-                // or handle specific UI element clicks here.
-                input_handled = true;
-                input_buffer[0] = '\0'; // Treat click as empty input/advance
-                if (line) { free(line); line = NULL; }
-            } 
-            else if (line != NULL) {
-                strncpy(input_buffer, line, sizeof(input_buffer)-1);
-                free(line);
-                input_handled = true;
-            }
+            if (n > 0) line_editor_feed(&editor, raw, (size_t)n);
+        }
 
-            // Prevent prompt sinking on empty input
-            if (input_buffer[0] == '\0') {
-                printf("\033[A");
-                fflush(stdout);
+        LineEditorEvent input_event;
+        if (accepting_input && line_editor_poll(&editor, &input_event)) {
+            if (input_event.type == LINE_EDITOR_EVENT_EOF && task_scheduler_wants_input()) {
+                task_input = true;
+                task_eof = true;
+            } else if (input_event.type == LINE_EDITOR_EVENT_EOF) {
+                game_is_running = false;
+                break;
+            } else if (input_event.type == LINE_EDITOR_EVENT_MOUSE) {
+                logger_log("Mouse event detected: x=%d, y=%d, btn=%d, evt=%c", input_event.mouse_x, input_event.mouse_y, input_event.mouse_button, input_event.mouse_event);
+                // Wheel scrolls the scene; clicks are not bound to anything yet.
+                if (input_event.mouse_event == 'M' && input_event.mouse_button == 64) handle_key_event(3000, game_state);
+                else if (input_event.mouse_event == 'M' && input_event.mouse_button == 65) handle_key_event(3001, game_state);
+            } else if (input_event.type == LINE_EDITOR_EVENT_LINE) {
+                logger_log("Raw input from line editor: '%s' (len: %lu)", input_event.line, (unsigned long)strlen(input_event.line));
+                strncpy(input_buffer, input_event.line, sizeof(input_buffer)-1);
+                line_editor_history_add(&editor, input_buffer);
+                if (task_scheduler_wants_input()) {
+                    task_input = true;
+                } else {
+                    input_handled = true;
+                }
+
+                // Prevent prompt sinking on empty input
+                if (input_handled && input_buffer[0] == '\0') {
+                    printf("\033[A");
+                    fflush(stdout);
+                }
             }
         }
 
         pthread_mutex_lock(&time_mutex);
-        
+        bool task_was_live = task_scheduler_has_foreground();
+        bool task_resumed = false;
+        bool player_acted = task_input || (input_handled && input_buffer[0] != '\0');
+
+        if (task_input) {
+            task_resumed = task_scheduler_deliver_line(task_eof ? NULL : input_buffer);
+        }
         // Input processing
-        if (input_handled && input_buffer[0] != '\0') {
+        else if (input_handled && input_buffer[0] != '\0') {
             logger_log("Processing input_buffer: '%s'", input_buffer);
             if (strcmp(input_buffer, "quit") == 0) game_is_running = false;
             else if (is_numeric(input_buffer)) {
@@ -204,44 +287,103 @@ int main(int argc, char *argv[]) {
                 logger_log("Input identified as command.");
                 if (execute_command(input_buffer, game_state)) dirty = true;
             }
+            // Command output scrolled the prompt away; bring it back right below.
+            if (!dirty) line_editor_refresh(&editor);
+        }
+        if (task_scheduler_run_due()) task_resumed = true;
+
+        // A task owns the screen until it exits: show its prompt whenever it
+        // stops to read, and redraw the scene once it is gone.
+        bool task_live = task_scheduler_has_foreground();
+        if (task_live && (task_resumed || !task_was_live) && task_scheduler_wants_input()) {
+            line_editor_set_prompt(&editor, task_scheduler_prompt());
+            line_editor_refresh(&editor);
         }
+        if (task_was_live && !task_live) {
+            line_editor_set_prompt(&editor, prompt);
+            dirty = true;
+        }
+
+        // Delivered files come back below as WORLD_FILE_EVENTs.
+        if (watch_pending || (retval > 0 && watch_fd >= 0 && FD_ISSET(watch_fd, &readfds))) world_watch_poll();
 
         Event ev;
         bool time_ticked = false;
         while (poll_event(&ev)) {
             if (ev.type == TIME_TICK_EVENT) {
+                // Ticks that piled up arrive as one event carrying their count.
                 time_ticked = true;
-                if (process_events(game_state, &current_scene)) dirty = true;
+                if (game_timers_on_tick(game_state, ev.data.tick.count)) dirty = true;
+            } else if (ev.type == RESIZE_EVENT) {
+                dirty = true;
+            } else if (ev.type == WORLD_FILE_EVENT) {
+                WorldFileChange change;
+                char notice[MAX_LINE_LENGTH];
+                if (world_watch_change(ev.data.world_file.change_id, &change) &&
+                    embedded_navi_world_changed(game_state, &change, notice, sizeof(notice))) {
+                    // Above the prompt, whoever owns the screen.
+                    printf("\r\033[K%s\n", notice);
+                    line_editor_refresh(&editor);
+                }
             }
         }
-        if (current_scene.is_takeover) dirty = true;
+        // Delayed dialogue lines and choices come due on the real-time wheel.
+        if (game_timers_poll_realtime()) dirty = true;
         if (g_needs_redraw) { dirty = true; g_needs_redraw = 0; }
 
-        if (dirty) {
+        if (task_live) {
+            // Time and auto-events keep running; a pending redraw waits for the task.
+        } else if (dirty) {
             printf("\r\033[K");
             if (game_state->current_story_file[0] != '\0') {
                 transition_to_scene(game_state->current_story_file, &current_scene, game_state);
                 game_state->current_story_file[0] = '\0';
-                scene_entry_time = decode_time_with_ecc(game_state->time_of_day).data;
             }
             render_current_scene(&current_scene, game_state);
             
             if (current_scene.is_takeover) {
                 update_time_display_inplace(game_state->time_of_day);
-                printf("\r%s", prompt);
             } else {
-                printf("\n%s", prompt);
+                printf("\n");
             }
-            fflush(stdout);
+            // Redraws the prompt together with any half-typed command.
+            line_editor_refresh(&editor);
             dirty = false;
         } else if (time_ticked) {
             update_time_display_inplace(game_state->time_of_day);
         }
 
+        // Every action is journaled; otherwise time is, now and then.
+        if (player_acted) autosave_record(game_state);
+        else autosave_poll(game_state);
+
+        // Nothing holds a string pointer here; drop blocks from scenes left behind.
+        string_table_trim();
         pthread_mutex_unlock(&time_mutex);
     }
 
+    // Let suspended subsystem tasks unwind (their reads see EOF) before teardown.
+    pthread_mutex_lock(&time_mutex);
+    task_scheduler_shutdown();
+    autosave_shutdown(game_state);
+    state_history_clear();
+    pthread_mutex_unlock(&time_mutex);
     restore_terminal_state();
+    line_editor_free(&editor);
+    scene_prefetch_shutdown();
+    world_watch_stop();
+    vfs_overlay_close();
+    vfs_unmount();
+
+    EventQueueStats queue_stats;
+    get_event_queue_stats(&queue_stats);
+    uint64_t dropped = 0;
+    for (int i = 0; i < EVENT_TYPE_COUNT; i++) dropped += queue_stats.dropped[i];
+    logger_log("Event queue: %llu pushed, %llu polled, %llu dropped, %llu ticks in %llu tick events.",
+               (unsigned long long)queue_stats.pushed, (unsigned long long)queue_stats.polled,
+               (unsigned long long)dropped, (unsigned long long)queue_stats.ticks_produced,
+               (unsigned long long)queue_stats.tick_events);
+
     cleanup_game_state(game_state);
     logger_close();
     return 0;
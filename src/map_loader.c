@@ -1,238 +1,104 @@
 #include "map_loader.h"
 #include "string_table.h"
-#include "cJSON.h" // Still needed for other uses potentially, keep for now
-#include "cmap.h" // Include our new CMap header
 #include "logger.h"
+#include "byte_util.h"
+#include "map_routes.h"
+#include "map_data.h" // Generated from data/map.json
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-// #include <dirent.h> // No longer needed for file system traversal
-// #include <sys/stat.h> // No longer needed for file system checks
-// #include <ctype.h> // No longer directly used for map loading
-
-#include "../sequences/miyanosaka/iwakura_house/scene.h" // For dynamic layout
-#include "../sequences/miyanosaka/street/scene.h" // For dynamic layout
-#include "../sequences/miyanosaka/station/scene.h" // For dynamic layout
-#include "../sequences/shibuya/cyberia_club/scene.h" // For dynamic layout
-#include "../sequences/shibuya/scene.h" // For dynamic layout in Shibuya area
-#include "../sequences/shinjuku/chisa_home/scene.h" // For dynamic layout
-#include "../sequences/shinjuku/scene.h" // For dynamic layout in Shinjuku area
-#include "../sequences/train_station/scene.h" // For dynamic layout
-#include "../sequences/roppongi/scene.h" // For dynamic layout
-
-// --- Helper Functions for Programmatic Map Definition ---
-
-void init_location(Location* loc, const char* id, const char* name, const char* description) {
-    memset(loc, 0, sizeof(Location));
-    strncpy(loc->id, id, MAX_NAME_LENGTH - 1);
-    loc->id[MAX_NAME_LENGTH - 1] = '\0';
-    strncpy(loc->name, name, MAX_NAME_LENGTH - 1);
-    loc->name[MAX_NAME_LENGTH - 1] = '\0';
-    strncpy(loc->description, description, (MAX_DESC_LENGTH * 4) - 1);
-    loc->description[(MAX_DESC_LENGTH * 4) - 1] = '\0';
-}
 
-void add_poi_to_location(Location* loc, const char* id, const char* name, const char* description, const char* examine_action_id) {
-    if (loc->pois_count >= MAX_POIS) {
-        fprintf(stderr, "WARNING: Max POIs reached for location %s. Cannot add %s.\n", loc->id, id);
-        return;
-    }
-    POI* poi = &loc->pois[loc->pois_count];
-    strncpy(poi->id, id, MAX_NAME_LENGTH - 1);
-    strncpy(poi->name, name, MAX_NAME_LENGTH - 1);
-    strncpy(poi->description, description, MAX_DESC_LENGTH - 1);
-    
-    // Assign the provided examine action ID
-    poi->examine_action_id = examine_action_id; 
-
-    loc->pois_count++;
-}
+// --- Gates ---
 
-void add_connection_to_location(Location* loc, const char* action_id, const char* target_location_id, is_accessible_func is_accessible, const char* access_denied_scene_id, const char* target_scene_id) {
-    if (loc->connection_count >= MAX_CONNECTIONS) {
-        fprintf(stderr, "WARNING: Max connections reached for location %s. Cannot add connection to %s.\n", loc->id, target_location_id);
-        return;
-    }
-    Connection* conn = &loc->connections[loc->connection_count];
-    conn->action_id = action_id;
-    conn->target_location_id = target_location_id;
-    conn->is_accessible = is_accessible;
-    conn->access_denied_scene_id = access_denied_scene_id;
-    conn->target_scene_id = target_scene_id; // Store the new scene ID
-    loc->connection_count++;
-}
-
-// --- Programmatic Map Data Definition ---
+static is_accessible_func g_gates[MAP_GATE_COUNT + 1]; // +1 keeps the array non-empty
 
-static int load_programmatic_map_data(GameState* game_state) {
-    if (game_state->location_count >= MAX_LOCATIONS) {
-        fprintf(stderr, "WARNING: Max locations reached. Cannot add more programmatic locations.\n");
-        return 0;
+bool map_register_gate(const char* name, is_accessible_func is_accessible) {
+    for (int g = 0; g < MAP_GATE_COUNT; g++) {
+        if (strcmp(g_map_gate_names[g], name) == 0) {
+            g_gates[g] = is_accessible;
+            return true;
+        }
     }
+    fprintf(stderr, "WARNING: map.json declares no gate named '%s'.\n", name);
+    return false;
+}
 
-    // All programmatic locations are now deprecated and have been moved to
-    // dynamic layout creation in the /sequences directory.
-    // This function remains as a stub.
-
-    return 1; // Success
+bool connection_is_gated(const Connection* conn) {
+    return conn->gate != MAP_GATE_NONE;
 }
 
-// --- Public API Implementation ---
+bool connection_is_open(GameState* game_state, const Connection* conn) {
+    if (!connection_is_gated(conn)) return true;
+    is_accessible_func is_accessible = g_gates[conn->gate];
+    return is_accessible != NULL && is_accessible(game_state, conn);
+}
 
-// Helper function to get a location by its ID from the GameState's map
-Location* get_location_by_id(const char* location_id) {
-    if (game_state == NULL || game_state->location_map == NULL || location_id == NULL) {
-        return NULL;
-    }
-    return (Location*)cmap_get(game_state->location_map, location_id);
+const char* connection_gate_name(const Connection* conn) {
+    return connection_is_gated(conn) ? g_map_gate_names[conn->gate] : NULL;
 }
 
-int load_map_data(const char* map_dir_path, GameState* game_state) {
-    LOG_MAP_DEBUG("Entering load_map_data (programmatic) for path: %s", map_dir_path); // Path is ignored now
+// --- Location Index ---
 
-    if (game_state == NULL) {
-        fprintf(stderr, "ERROR: GameState is NULL in load_map_data.\n");
-        return 0;
-    }
+LocationID location_id_from_string(const char* location_id) {
+    if (location_id == NULL) return LOCATION_NONE;
+    int entry = g_location_hash[fnv1a_seeded(location_id, MAP_HASH_SEED) >> (32 - MAP_HASH_BITS)];
+    if (entry == 0 || strcmp(g_locations[entry - 1].id, location_id) != 0) return LOCATION_NONE;
+    return (LocationID)(entry - 1);
+}
 
-    // --- CMap Integration: Create the hash map ---
-    game_state->location_map = cmap_create(MAX_LOCATIONS);
-    if (game_state->location_map == NULL) {
-        fprintf(stderr, "ERROR: Failed to create location map hash table.\n");
-        return 0;
-    }
+const char* location_id_to_string(LocationID location) {
+    const Location* loc = map_location_at(location);
+    return loc != NULL ? loc->id : "";
+}
 
-    LOG_MAP_DEBUG("CMap created with size %d.", MAX_LOCATIONS);
+// --- Public API Implementation ---
 
-    // Load locations programmatically
-    if (!load_programmatic_map_data(game_state)) {
-        fprintf(stderr, "ERROR: Failed to load programmatic map data.\n");
-        cmap_destroy(game_state->location_map);
-        return 0;
-    }
+const Location* get_location_by_id(const char* location_id) {
+    return map_location_at(location_id_from_string(location_id));
+}
 
-    // --- Dynamically add Iwakura House layout ---
-    int prev_location_count = game_state->location_count; 
-    int rooms_added = create_iwakura_house_layout(game_state->all_locations, game_state->location_count);
-    if (rooms_added > 0) {
-        // Update total count *before* inserting to cmap, so new_loc points to correct place
-        game_state->location_count += rooms_added; 
-
-        // Need to insert newly added locations into the cmap as well.
-        for (int i = 0; i < rooms_added; ++i) {
-            // new_loc should point to the location that was just added starting from prev_location_count
-            Location* new_loc = &game_state->all_locations[prev_location_count + i]; 
-            cmap_insert(game_state->location_map, new_loc);
-            LOG_MAP_DEBUG("Inserted dynamic location '%s' into CMap.", new_loc->id);
-        }
-        // DEBUG: Verify POI counts for newly added locations
-        LOG_MAP_DEBUG("Verifying POIs for dynamically added locations:");
-        for (int i = 0; i < rooms_added; ++i) {
-            Location* loc = &game_state->all_locations[game_state->location_count - rooms_added + i];
-            LOG_MAP_DEBUG("  Location '%s' (pois_count: %d)", loc->id, loc->pois_count);
-            if (loc->pois_count > 0) {
-                LOG_MAP_DEBUG("    First POI: '%s' ('%s')", loc->pois[0].id, loc->pois[0].name);
-            }
-        }
-    }
+int map_location_count(void) {
+    return MAP_LOCATION_COUNT;
+}
 
-    // --- Dynamically add Shibuya Street layout ---
-    prev_location_count = game_state->location_count; // Capture current count
-    rooms_added = create_shibuya_layout(game_state->all_locations, game_state->location_count);
-    if (rooms_added > 0) {
-        game_state->location_count += rooms_added; // Update total count
-        for (int i = 0; i < rooms_added; ++i) {
-            Location* new_loc = &game_state->all_locations[prev_location_count + i];
-            cmap_insert(game_state->location_map, new_loc);
-            LOG_MAP_DEBUG("Inserted dynamic location '%s' into CMap.", new_loc->id);
-        }
-    }
+const Location* map_location_at(int index) {
+    return (index >= 0 && index < MAP_LOCATION_COUNT) ? &g_locations[index] : NULL;
+}
 
-    // --- Dynamically add Cyberia Club layout ---
-    prev_location_count = game_state->location_count; // Capture current count
-    rooms_added = create_cyberia_club_layout(game_state->all_locations, game_state->location_count);
-    if (rooms_added > 0) {
-        game_state->location_count += rooms_added; // Update total count
-        for (int i = 0; i < rooms_added; ++i) {
-            Location* new_loc = &game_state->all_locations[prev_location_count + i];
-            cmap_insert(game_state->location_map, new_loc);
-            LOG_MAP_DEBUG("Inserted dynamic location '%s' into CMap.", new_loc->id);
-        }
-        // ... (debug code) ...
-    }
+const POI* location_pois(const Location* loc) {
+    return &g_pois[loc->first_poi];
+}
 
-    // --- Dynamically add Chisa Home layout ---
-    prev_location_count = game_state->location_count; // Capture current count
-    rooms_added = create_chisa_home_layout(game_state->all_locations, game_state->location_count);
-    if (rooms_added > 0) {
-        game_state->location_count += rooms_added; // Update total count
-        for (int i = 0; i < rooms_added; ++i) {
-            Location* new_loc = &game_state->all_locations[prev_location_count + i];
-            cmap_insert(game_state->location_map, new_loc);
-            LOG_MAP_DEBUG("Inserted dynamic location '%s' into CMap.", new_loc->id);
-        }
-        // ... (debug code) ...
-    }
+const Connection* location_connections(const Location* loc) {
+    return &g_connections[loc->first_connection];
+}
 
-    // --- Dynamically add Shinjuku layout ---
-    prev_location_count = game_state->location_count; // Capture current count
-    rooms_added = create_shinjuku_layout(game_state->all_locations, game_state->location_count);
-    if (rooms_added > 0) {
-        game_state->location_count += rooms_added; // Update total count
-        for (int i = 0; i < rooms_added; ++i) {
-            Location* new_loc = &game_state->all_locations[prev_location_count + i];
-            cmap_insert(game_state->location_map, new_loc);
-            LOG_MAP_DEBUG("Inserted dynamic location '%s' into CMap.", new_loc->id);
-        }
-        // ... (debug code) ...
-    }
+const char* location_name(const Location* loc) {
+    return loc->name_text ? loc->name_text : get_string_by_id(loc->name);
+}
 
-    // --- Dynamically add Miyanosaka Street layout ---
-    prev_location_count = game_state->location_count; // Capture current count
-    rooms_added = create_miyanosaka_street_layout(game_state->all_locations, game_state->location_count);
-    if (rooms_added > 0) {
-        game_state->location_count += rooms_added; // Update total count
-        for (int i = 0; i < rooms_added; ++i) {
-            Location* new_loc = &game_state->all_locations[prev_location_count + i];
-            cmap_insert(game_state->location_map, new_loc);
-        }
-    }
+const char* location_description(const Location* loc) {
+    return get_string_by_id(loc->description);
+}
 
-    // --- Dynamically add Miyanosaka Station layout ---
-    prev_location_count = game_state->location_count; // Capture current count
-    rooms_added = create_miyanosaka_station_layout(game_state->all_locations, game_state->location_count);
-    if (rooms_added > 0) {
-        game_state->location_count += rooms_added; // Update total count
-        for (int i = 0; i < rooms_added; ++i) {
-            Location* new_loc = &game_state->all_locations[prev_location_count + i];
-            cmap_insert(game_state->location_map, new_loc);
-        }
-    }
+int load_map_data(const char* map_dir_path, GameState* game_state) {
+    (void)map_dir_path; // The map is compiled in
 
-    // --- Dynamically add Train Station layout ---
-    prev_location_count = game_state->location_count; // Capture current count
-    rooms_added = create_train_station_layout(game_state->all_locations, game_state->location_count);
-    if (rooms_added > 0) {
-        game_state->location_count += rooms_added; // Update total count
-        for (int i = 0; i < rooms_added; ++i) {
-            Location* new_loc = &game_state->all_locations[prev_location_count + i];
-            cmap_insert(game_state->location_map, new_loc);
-        }
+    if (game_state == NULL) {
+        fprintf(stderr, "ERROR: GameState is NULL in load_map_data.\n");
+        return 0;
     }
 
-    // --- Dynamically add Roppongi layout ---
-    prev_location_count = game_state->location_count; // Capture current count
-    rooms_added = create_roppongi_layout(game_state->all_locations, game_state->location_count);
-    if (rooms_added > 0) {
-        game_state->location_count += rooms_added; // Update total count
-        for (int i = 0; i < rooms_added; ++i) {
-            Location* new_loc = &game_state->all_locations[prev_location_count + i];
-            cmap_insert(game_state->location_map, new_loc);
+    for (int g = 0; g < MAP_GATE_COUNT; g++) {
+        if (g_gates[g] == NULL) {
+            LOG_MAP_DEBUG("Gate '%s' has no predicate registered; it stays shut.", g_map_gate_names[g]);
         }
     }
+    LOG_MAP_DEBUG("Map tables: %d locations, %d POIs, %d connections, %zu bytes.", MAP_LOCATION_COUNT, MAP_POI_COUNT,
+                  MAP_CONNECTION_COUNT, sizeof(g_locations) + sizeof(g_pois) + sizeof(g_connections));
 
-
-    LOG_MAP_DEBUG("Successfully loaded %d locations (programmatic + dynamic) .", game_state->location_count);
+    // Routes depend on the gates above being registered.
+    map_routes_build(game_state);
 
     return 1;
-}
\ No newline at end of file
+}
@@ -0,0 +1,113 @@
+#include "map_routes.h"
+#include "executor.h"
+#include "map_loader.h"
+#include "logger.h"
+#include <limits.h>
+#include <string.h>
+
+// A minute of travel outweighs any number of zero-cost hops, and among routes
+// of equal duration the one with fewer hops wins.
+#define HOP_WEIGHT 1
+#define MINUTE_WEIGHT (MAX_LOCATIONS * HOP_WEIGHT)
+#define UNREACHABLE (INT_MAX / 4)
+
+typedef struct {
+    int8_t from;         // Location index
+    int8_t connection;   // Index into that location's connections
+    bool open;           // Gate state the matrix was built with
+} GatedEdge;
+
+static int g_location_count = 0;
+static int g_cost[MAX_LOCATIONS][MAX_LOCATIONS];
+static int8_t g_next_connection[MAX_LOCATIONS][MAX_LOCATIONS]; // First hop, -1 if none
+static GatedEdge g_gated[MAX_LOCATIONS * MAX_CONNECTIONS];
+static int g_gated_count = 0;
+
+// Floyd-Warshall over the currently open connections.
+static void compute_matrix(GameState* game_state) {
+    int n = g_location_count;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            g_cost[i][j] = (i == j) ? 0 : UNREACHABLE;
+            g_next_connection[i][j] = -1;
+        }
+    }
+
+    int gated = 0;
+    for (int i = 0; i < n; i++) {
+        const Location* loc = map_location_at(i);
+        for (int c = 0; c < loc->connection_count; c++) {
+            const Connection* conn = &location_connections(loc)[c];
+            int target = conn->target;
+            if (target == i) continue;
+            if (connection_is_gated(conn)) {
+                bool open = connection_is_open(game_state, conn);
+                g_gated[gated++] = (GatedEdge){ (int8_t)i, (int8_t)c, open };
+                if (!open) continue;
+            }
+            int cost = get_action_time_cost(conn->action_id) * MINUTE_WEIGHT + HOP_WEIGHT;
+            if (cost < g_cost[i][target]) {
+                g_cost[i][target] = cost;
+                g_next_connection[i][target] = (int8_t)c;
+            }
+        }
+    }
+    g_gated_count = gated;
+
+    for (int k = 0; k < n; k++) {
+        for (int i = 0; i < n; i++) {
+            if (g_cost[i][k] >= UNREACHABLE) continue;
+            for (int j = 0; j < n; j++) {
+                int through = g_cost[i][k] + g_cost[k][j];
+                if (through < g_cost[i][j]) {
+                    g_cost[i][j] = through;
+                    g_next_connection[i][j] = g_next_connection[i][k];
+                }
+            }
+        }
+    }
+}
+
+void map_routes_build(GameState* game_state) {
+    if (game_state == NULL) return;
+    g_location_count = map_location_count();
+    compute_matrix(game_state);
+    LOG_MAP_DEBUG("Route matrix built for %d locations (%d gated connections).", g_location_count, g_gated_count);
+}
+
+// Rebuilds only if a gate opened or closed since the matrix was computed.
+static void refresh_gates(GameState* game_state) {
+    for (int i = 0; i < g_gated_count; i++) {
+        const GatedEdge* edge = &g_gated[i];
+        const Connection* conn = &location_connections(map_location_at(edge->from))[edge->connection];
+        if (connection_is_open(game_state, conn) != edge->open) {
+            LOG_DEBUG("Gate '%s' changed state; rebuilding routes.", conn->action_id);
+            compute_matrix(game_state);
+            return;
+        }
+    }
+}
+
+int map_routes_plan(GameState* game_state, LocationID from, LocationID to,
+                    const char** out_actions, int max_actions, int* out_minutes) {
+    if (out_minutes) *out_minutes = 0;
+    if (game_state == NULL) return -1;
+    if (g_location_count != map_location_count()) map_routes_build(game_state);
+
+    if (from < 0 || to < 0 || from >= g_location_count || to >= g_location_count) return -1;
+    if (from == to) return 0;
+
+    refresh_gates(game_state);
+    if (g_cost[from][to] >= UNREACHABLE) return -1;
+
+    int hops = 0;
+    int minutes = 0;
+    for (int at = from; at != to && hops < max_actions; hops++) {
+        const Connection* conn = &location_connections(map_location_at(at))[g_next_connection[at][to]];
+        out_actions[hops] = conn->action_id;
+        minutes += get_action_time_cost(conn->action_id);
+        at = conn->target;
+    }
+    if (out_minutes) *out_minutes = minutes;
+    return hops;
+}
@@ -0,0 +1,297 @@
+#include "npc_schedule.h"
+#include "npc_schedules_data.h"
+#include "game_timers.h"
+#include "time_utils.h"
+#include "ecc_time.h"
+#include "byte_util.h"
+#include "logger.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SLOT_OFF_MAP 0
+#define SLOT_HASH_SIZE (NPC_MAX_LOCATIONS * 2) // Power of two, kept half empty
+#define NO_CHANGE 0                           // until_change value: table is constant
+
+typedef struct {
+    const char* key;    // JSON key
+    bool compiled_in;
+    const char* name;
+    const NpcDayTable* tables; // Generated, one per state
+    int state_count;
+    int state;
+    uint8_t slot;       // Current location slot
+    bool is_manual;
+} Npc;
+
+static Npc g_npcs[NPC_COUNT] = {
+    [NPC_MIKA]   = { "mika",   true },
+#ifdef CHARACTER_FATHER_ALIVE
+    [NPC_DAD]    = { "dad",    true },
+#else
+    [NPC_DAD]    = { "dad",    false },
+#endif
+    [NPC_MOM]    = { "mom",    true },
+#ifdef CHARACTER_ALICE_ALIVE
+    [NPC_ALICE]  = { "alice",  true },
+#else
+    [NPC_ALICE]  = { "alice",  false },
+#endif
+#ifdef CHARACTER_CHISA_ALIVE
+    [NPC_CHISA]  = { "chisa",  true },
+#else
+    [NPC_CHISA]  = { "chisa",  false },
+#endif
+#ifdef CHARACTER_FUYUKO_MIRA_ALIVE
+    [NPC_DOCTOR] = { "doctor", true },
+#else
+    [NPC_DOCTOR] = { "doctor", false },
+#endif
+};
+
+static bool g_initialized = false;
+
+// Game state the schedule timer was armed with; NULL until npc_schedule_arm().
+static struct GameState* g_schedule_state = NULL;
+
+// --- Location Slots ---
+// Schedules name a handful of locations (some, like "off_map", are not on the
+// map at all), so they are interned into small integers: first the generated
+// slots the tables hold, in order, then any an event moves an NPC to.
+
+static char g_slot_names[NPC_MAX_LOCATIONS][MAX_NAME_LENGTH];
+static int g_slot_count = 0;
+static int8_t g_slot_hash[SLOT_HASH_SIZE]; // slot + 1, 0 = empty
+static uint32_t g_present[NPC_MAX_LOCATIONS]; // Reverse index: slot -> NPC mask
+
+static int find_slot(const char* location_id) {
+    uint32_t h = fnv1a(location_id);
+    for (int i = 0; i < SLOT_HASH_SIZE; i++) {
+        int entry = g_slot_hash[(h + i) & (SLOT_HASH_SIZE - 1)];
+        if (entry == 0) return -1;
+        if (strcmp(g_slot_names[entry - 1], location_id) == 0) return entry - 1;
+    }
+    return -1;
+}
+
+static int intern_slot(const char* location_id) {
+    if (location_id == NULL || location_id[0] == '\0') return SLOT_OFF_MAP;
+    int slot = find_slot(location_id);
+    if (slot >= 0) return slot;
+    if (g_slot_count >= NPC_MAX_LOCATIONS) {
+        fprintf(stderr, "WARNING: Too many NPC locations; '%s' treated as off_map.\n", location_id);
+        return SLOT_OFF_MAP;
+    }
+    slot = g_slot_count++;
+    strncpy(g_slot_names[slot], location_id, MAX_NAME_LENGTH - 1);
+    uint32_t h = fnv1a(location_id);
+    for (int i = 0; i < SLOT_HASH_SIZE; i++) {
+        int8_t* entry = &g_slot_hash[(h + i) & (SLOT_HASH_SIZE - 1)];
+        if (*entry == 0) {
+            *entry = (int8_t)(slot + 1);
+            break;
+        }
+    }
+    return slot;
+}
+
+// Moves an NPC between slots, keeping the reverse index in step.
+static void place_npc(NpcId npc, int slot) {
+    Npc* n = &g_npcs[npc];
+    if (n->slot == slot) return;
+    g_present[n->slot] &= ~(1u << npc);
+    n->slot = (uint8_t)slot;
+    if (slot != SLOT_OFF_MAP) g_present[slot] |= 1u << npc;
+    LOG_DEBUG("NPC %s moved to %s (state %d)", n->key, g_slot_names[slot], n->state);
+}
+
+// --- Generated Tables ---
+
+void npc_schedule_init(void) {
+    if (g_initialized) return;
+    g_initialized = true;
+
+    memset(g_slot_hash, 0, sizeof(g_slot_hash));
+    memset(g_present, 0, sizeof(g_present));
+    g_slot_count = 0;
+    // The generator puts off_map first and checks the count fits.
+    for (int i = 0; i < NPC_SCHEDULE_SLOT_COUNT; i++) intern_slot(g_npc_schedule_slots[i]);
+
+    for (int npc = 0; npc < NPC_COUNT; npc++) {
+        Npc* n = &g_npcs[npc];
+        n->slot = SLOT_OFF_MAP;
+        n->state = 0;
+        n->is_manual = false;
+        n->state_count = 0;
+        n->name = NULL;
+        for (int i = 0; i < NPC_SCHEDULE_COUNT; i++) {
+            const NpcSchedule* schedule = &g_npc_schedules[i];
+            if (strcmp(schedule->key, n->key) != 0) continue;
+            n->name = schedule->name;
+            if (n->compiled_in) {
+                n->tables = schedule->states;
+                n->state_count = schedule->state_count;
+            }
+            break;
+        }
+    }
+}
+
+// --- Queries ---
+
+bool npc_is_active(NpcId npc) {
+    npc_schedule_init();
+    return npc >= 0 && npc < NPC_COUNT && g_npcs[npc].state_count > 0;
+}
+
+const char* npc_display_name(NpcId npc) {
+    npc_schedule_init();
+    if (npc < 0 || npc >= NPC_COUNT) return "";
+    return g_npcs[npc].name ? g_npcs[npc].name : g_npcs[npc].key;
+}
+
+const char* npc_key(NpcId npc) {
+    return (npc >= 0 && npc < NPC_COUNT) ? g_npcs[npc].key : "";
+}
+
+NpcId npc_from_key(const char* key) {
+    if (key == NULL) return NPC_COUNT;
+    for (int npc = 0; npc < NPC_COUNT; npc++) {
+        if (strcmp(g_npcs[npc].key, key) == 0) return (NpcId)npc;
+    }
+    return NPC_COUNT;
+}
+
+int npc_minute_of_day(const struct GameState* game_state) {
+    if (game_state == NULL) return -1;
+    DecodedTimeResult decoded = decode_time_with_ecc(game_state->time_of_day);
+    if (decoded.status == DOUBLE_BIT_ERROR_DETECTED) return -1;
+    return (int)((decoded.data % GAME_TIME_UNITS_PER_DAY) / (GAME_TIME_UNITS_PER_SECOND * 60));
+}
+
+static const NpcDayTable* table_for(NpcId npc, int state) {
+    if (!npc_is_active(npc)) return NULL;
+    if (state < 0) state = 0;
+    if (state >= g_npcs[npc].state_count) state = g_npcs[npc].state_count - 1;
+    return &g_npcs[npc].tables[state];
+}
+
+const char* npc_scheduled_location(NpcId npc, int state, int minute_of_day) {
+    const NpcDayTable* table = table_for(npc, state);
+    if (table == NULL || minute_of_day < 0) return NPC_OFF_MAP;
+    return g_slot_names[table->slot[minute_of_day % NPC_MINUTES_PER_DAY]];
+}
+
+bool npc_room_open(NpcId npc, int state, int minute_of_day) {
+    const NpcDayTable* table = table_for(npc, state);
+    if (table == NULL || minute_of_day < 0) return false;
+    minute_of_day %= NPC_MINUTES_PER_DAY;
+    return (table->room_open[minute_of_day / 8] >> (minute_of_day % 8)) & 1u;
+}
+
+const char* npc_current_location(NpcId npc) {
+    npc_schedule_init();
+    if (npc < 0 || npc >= NPC_COUNT) return NPC_OFF_MAP;
+    return g_slot_names[g_npcs[npc].slot];
+}
+
+bool npc_is_at(NpcId npc, const char* location_id) {
+    return location_id != NULL && strcmp(npc_current_location(npc), location_id) == 0;
+}
+
+uint32_t npc_present_mask(const char* location_id) {
+    npc_schedule_init();
+    if (location_id == NULL) return 0;
+    int slot = find_slot(location_id);
+    return slot > SLOT_OFF_MAP ? g_present[slot] : 0;
+}
+
+// --- Movement ---
+
+void npc_schedule_update(const struct GameState* game_state) {
+    npc_schedule_init();
+    int minute = npc_minute_of_day(game_state);
+    for (int npc = 0; npc < NPC_COUNT; npc++) {
+        const Npc* n = &g_npcs[npc];
+        if (n->is_manual || n->state_count == 0) continue;
+        // An unreadable clock puts everyone off the map, as before.
+        place_npc((NpcId)npc, minute < 0 ? SLOT_OFF_MAP : table_for((NpcId)npc, n->state)->slot[minute]);
+    }
+}
+
+static bool npc_schedule_timer_fired(void* context, int arg) {
+    (void)arg;
+    npc_schedule_arm((struct GameState*)context);
+    return false; // Presence is drawn on the next full render
+}
+
+void npc_schedule_arm(struct GameState* game_state) {
+    if (game_state == NULL) return;
+    if (g_schedule_state == NULL) game_timers_add_clock_jump_listener(npc_schedule_arm);
+    g_schedule_state = game_state;
+    game_timers_cancel_group(TIMER_GROUP_NPC);
+
+    npc_schedule_update(game_state);
+
+    DecodedTimeResult decoded = decode_time_with_ecc(game_state->time_of_day);
+    if (decoded.status == DOUBLE_BIT_ERROR_DETECTED) return;
+    uint32_t units_in_day = decoded.data % GAME_TIME_UNITS_PER_DAY;
+    int minute = (int)(units_in_day / (GAME_TIME_UNITS_PER_SECOND * 60));
+
+    // One timer for the earliest change across all schedule-driven NPCs.
+    int soonest = 0;
+    for (int npc = 0; npc < NPC_COUNT; npc++) {
+        const Npc* n = &g_npcs[npc];
+        if (n->is_manual || n->state_count == 0) continue;
+        int until = table_for((NpcId)npc, n->state)->until_change[minute];
+        if (until != NO_CHANGE && (soonest == 0 || until < soonest)) soonest = until;
+    }
+    if (soonest == 0) return;
+
+    uint32_t boundary = (uint32_t)(minute + soonest) * 60 * GAME_TIME_UNITS_PER_SECOND;
+    uint32_t units = boundary - units_in_day;
+    // Round up so the timer never fires before the boundary is reached.
+    uint32_t seconds = (units + GAME_TIME_UNITS_PER_SECOND - 1) / GAME_TIME_UNITS_PER_SECOND;
+    game_timer_after_seconds(seconds, npc_schedule_timer_fired, game_state, 0, TIMER_GROUP_NPC);
+}
+
+void npc_set_state(NpcId npc, int state) {
+    npc_schedule_init();
+    if (npc < 0 || npc >= NPC_COUNT) return;
+    g_npcs[npc].state = state;
+    // Each state follows its own table.
+    if (g_schedule_state) npc_schedule_arm(g_schedule_state);
+}
+
+int npc_get_state(NpcId npc) {
+    npc_schedule_init();
+    return (npc >= 0 && npc < NPC_COUNT) ? g_npcs[npc].state : 0;
+}
+
+void npc_move_to(NpcId npc, const char* location_id) {
+    npc_schedule_init();
+    if (npc < 0 || npc >= NPC_COUNT || location_id == NULL) return;
+    g_npcs[npc].is_manual = true;
+    place_npc(npc, intern_slot(location_id));
+}
+
+void npc_return_to_schedule(NpcId npc) {
+    npc_schedule_init();
+    if (npc < 0 || npc >= NPC_COUNT || !g_npcs[npc].is_manual) return;
+    g_npcs[npc].is_manual = false;
+    // It was left out of the pending timer while manual.
+    if (g_schedule_state) npc_schedule_arm(g_schedule_state);
+}
+
+bool npc_is_manually_positioned(NpcId npc) {
+    npc_schedule_init();
+    return npc >= 0 && npc < NPC_COUNT && g_npcs[npc].is_manual;
+}
+
+void npc_restore(NpcId npc, const char* location_id, bool is_manual, int state) {
+    npc_schedule_init();
+    if (npc < 0 || npc >= NPC_COUNT) return;
+    g_npcs[npc].state = state;
+    g_npcs[npc].is_manual = is_manual;
+    if (location_id) place_npc(npc, intern_slot(location_id));
+    if (g_schedule_state) npc_schedule_arm(g_schedule_state);
+}
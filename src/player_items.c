@@ -0,0 +1,78 @@
+#include "player_items.h"
+#include "command_data.h" // Generated from commands.json
+#include "byte_util.h"
+#include <string.h>
+
+#define ITEM_QUANTITY_MAX UINT16_MAX
+
+CommandID command_id_from_string(const char* command) {
+    if (command == NULL) return COMMAND_NONE;
+    // Same seeded FNV-1a as the generator; the hash is perfect, so one probe.
+    int entry = g_command_hash[fnv1a_seeded(command, COMMAND_HASH_SEED) >> (32 - COMMAND_HASH_BITS)];
+    if (entry == 0 || strcmp(g_command_names[entry - 1], command) != 0) return COMMAND_NONE;
+    return (CommandID)(entry - 1);
+}
+
+const char* command_name(CommandID command) {
+    return command < COMMAND_TABLE_COUNT ? g_command_names[command] : NULL;
+}
+
+// --- Items ---
+
+bool player_has_item(const PlayerState* ps, ItemID item) {
+    return item < MAX_ITEMS && (ps->items >> item & 1);
+}
+
+int player_item_quantity(const PlayerState* ps, ItemID item) {
+    return player_has_item(ps, item) ? ps->item_quantity[item] : 0;
+}
+
+void player_set_item_quantity(PlayerState* ps, ItemID item, int quantity) {
+    if (item >= MAX_ITEMS) return;
+    if (quantity <= 0) {
+        ps->items &= ~((uint64_t)1 << item);
+        ps->item_quantity[item] = 0;
+        return;
+    }
+    ps->items |= (uint64_t)1 << item;
+    ps->item_quantity[item] = (uint16_t)(quantity > ITEM_QUANTITY_MAX ? ITEM_QUANTITY_MAX : quantity);
+}
+
+void player_add_item(PlayerState* ps, ItemID item, int quantity) {
+    player_set_item_quantity(ps, item, player_item_quantity(ps, item) + quantity);
+}
+
+int player_item_count(const PlayerState* ps) {
+    return __builtin_popcountll(ps->items);
+}
+
+int player_next_item(const PlayerState* ps, int from) {
+    if (from < 0 || from >= MAX_ITEMS) return -1;
+    uint64_t rest = ps->items >> from;
+    return rest ? from + __builtin_ctzll(rest) : -1;
+}
+
+void player_clear_items(PlayerState* ps) {
+    ps->items = 0;
+    memset(ps->item_quantity, 0, sizeof(ps->item_quantity));
+}
+
+// --- Commands ---
+
+bool player_command_unlocked(const PlayerState* ps, CommandID command) {
+    return command < MAX_COMMANDS && (ps->commands >> command & 1);
+}
+
+void player_unlock_command(PlayerState* ps, CommandID command) {
+    if (command < MAX_COMMANDS) ps->commands |= (uint32_t)1 << command;
+}
+
+int player_command_count(const PlayerState* ps) {
+    return __builtin_popcount(ps->commands);
+}
+
+int player_next_command(const PlayerState* ps, int from) {
+    if (from < 0 || from >= MAX_COMMANDS) return -1;
+    uint32_t rest = ps->commands >> from;
+    return rest ? from + __builtin_ctz(rest) : -1;
+}
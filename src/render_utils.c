@@ -4,9 +4,11 @@
 #include "string_table.h" // Needed for get_string_by_id prototype
 #include "ecc_time.h"
 #include "characters/mika.h" // Needed for CharacterMika and get_mika_module
-#include "map_loader.h" // Needed for get_location_by_id
+#include "map_loader.h" // Needed for map_location_at
 #include "time_utils.h" // Added for get_current_time_ms
 #include "logger.h"
+#include "scene_prefetch.h"
+#include "npc_schedule.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -72,41 +74,29 @@ static int _render_choices_dynamic(const StoryScene* scene, const GameState* gam
 }
 
 // Helper to print lines with "System Self-Check" style filtering
-static void _print_formatted_system_line(const char* text) {
+static void _print_formatted_system_line(FILE* out, const char* text) {
     if (text == NULL) return;
 
     // Filter tags and apply colors matching main.c startup
     if (strncmp(text, "[OK]", 4) == 0) {
-        printf(ANSI_COLOR_BRIGHT_BLACK "   [" ANSI_COLOR_GREEN " OK " ANSI_COLOR_BRIGHT_BLACK "]     %s" ANSI_COLOR_RESET, text + 4);
+        fprintf(out, ANSI_COLOR_BRIGHT_BLACK "   [" ANSI_COLOR_GREEN " OK " ANSI_COLOR_BRIGHT_BLACK "]     %s" ANSI_COLOR_RESET, text + 4);
     } else if (strncmp(text, "[WARN]", 6) == 0) {
-        printf(ANSI_COLOR_BRIGHT_BLACK "   [" ANSI_COLOR_YELLOW " WARN " ANSI_COLOR_BRIGHT_BLACK "]   %s" ANSI_COLOR_RESET, text + 6);
+        fprintf(out, ANSI_COLOR_BRIGHT_BLACK "   [" ANSI_COLOR_YELLOW " WARN " ANSI_COLOR_BRIGHT_BLACK "]   %s" ANSI_COLOR_RESET, text + 6);
     } else if (strncmp(text, "[ERROR]", 7) == 0) {
-        printf(ANSI_COLOR_BRIGHT_BLACK "   [" ANSI_COLOR_RED " ERROR " ANSI_COLOR_BRIGHT_BLACK "]  %s" ANSI_COLOR_RESET, text + 7);
+        fprintf(out, ANSI_COLOR_BRIGHT_BLACK "   [" ANSI_COLOR_RED " ERROR " ANSI_COLOR_BRIGHT_BLACK "]  %s" ANSI_COLOR_RESET, text + 7);
     } else if (strncmp(text, "[SYSTEM]", 8) == 0) {
-        printf(ANSI_COLOR_BRIGHT_BLACK "   [" ANSI_COLOR_CYAN " SYSTEM " ANSI_COLOR_BRIGHT_BLACK "] %s" ANSI_COLOR_RESET, text + 8);
+        fprintf(out, ANSI_COLOR_BRIGHT_BLACK "   [" ANSI_COLOR_CYAN " SYSTEM " ANSI_COLOR_BRIGHT_BLACK "] %s" ANSI_COLOR_RESET, text + 8);
     } else if (strncmp(text, "[NET]", 5) == 0) {
-        printf(ANSI_COLOR_BRIGHT_BLACK "   [" ANSI_COLOR_CYAN " NET " ANSI_COLOR_BRIGHT_BLACK "]    %s" ANSI_COLOR_RESET, text + 5);
+        fprintf(out, ANSI_COLOR_BRIGHT_BLACK "   [" ANSI_COLOR_CYAN " NET " ANSI_COLOR_BRIGHT_BLACK "]    %s" ANSI_COLOR_RESET, text + 5);
     } else {
-        printf("%s", text);
+        fprintf(out, "%s", text);
     }
-    printf("\033[K\n"); // Line clearing
+    fprintf(out, "\033[K\n"); // Line clearing
 }
 
-void print_colored_line(SpeakerID speaker_id, StringID text_id, const GameState* game_state) {
-
-    const char* line_text = get_string_by_id(text_id);
-
-    if (line_text == NULL) {
-        printf("\n");
-        g_render_line_counter++;
-        fflush(stdout);
-        return;
-    }
-    
-    g_render_line_counter++;
-
-    // Map SpeakerID to name and color
-    struct {
+// Map SpeakerID to name and color
+static void _get_speaker_style(SpeakerID speaker_id, const char** name, const char** color) {
+    static const struct {
         SpeakerID id;
         const char* name;
         const char* color_code;
@@ -124,29 +114,53 @@ void print_colored_line(SpeakerID speaker_id, StringID text_id, const GameState*
         {SPEAKER_NONE, "", ANSI_COLOR_RESET}
     };
 
-    const char* speaker_name = "";
-    const char* speaker_color = ANSI_COLOR_RESET;
+    *name = "";
+    *color = ANSI_COLOR_RESET;
 
     for (int i = 0; i < SPEAKER_COUNT; i++) {
         if (speaker_info[i].id == speaker_id) {
-            speaker_name = speaker_info[i].name;
-            speaker_color = speaker_info[i].color_code;
+            *name = speaker_info[i].name;
+            *color = speaker_info[i].color_code;
             break;
         }
     }
+}
 
-    // Print directly to avoid large stack buffer
-    char speaker_prefix[MAX_NAME_LENGTH + 10]; // Buffer for speaker name and color codes
-    if (speaker_id != SPEAKER_NONE) {
-        snprintf(speaker_prefix, sizeof(speaker_prefix), "%s%s: %s", speaker_color, speaker_name, ANSI_COLOR_RESET);
+// Writes one finished dialogue line (speaker prefix, text, line clear) to 'out'.
+// Shared by the live renderer and the scene prefetcher so both produce identical bytes.
+static void _emit_colored_line(FILE* out, SpeakerID speaker_id, const char* line_text) {
+    const char* speaker_name;
+    const char* speaker_color;
+    _get_speaker_style(speaker_id, &speaker_name, &speaker_color);
+
+    if (speaker_id == SPEAKER_NONE || speaker_id == SPEAKER_NAVI) {
+        _print_formatted_system_line(out, line_text);
     } else {
-        speaker_prefix[0] = '\0'; // No prefix for SPEAKER_NONE
+        fprintf(out, "%s%s: %s%s\033[K\n", speaker_color, speaker_name, ANSI_COLOR_RESET, line_text);
     }
+}
+
+void print_colored_line(SpeakerID speaker_id, StringID text_id, const GameState* game_state) {
+
+    const char* line_text = get_string_by_id(text_id);
+
+    if (line_text == NULL) {
+        printf("\n");
+        g_render_line_counter++;
+        fflush(stdout);
+        return;
+    }
+    
+    g_render_line_counter++;
 
 #ifdef USE_TYPEWRITER_EFFECT
+    const char* speaker_name;
+    const char* speaker_color;
+    _get_speaker_style(speaker_id, &speaker_name, &speaker_color);
+
     // Print speaker prefix at once
-    if (speaker_prefix[0] != '\0') {
-        printf("%s", speaker_prefix);
+    if (speaker_id != SPEAKER_NONE) {
+        printf("%s%s: %s", speaker_color, speaker_name, ANSI_COLOR_RESET);
     }
     // Print dialogue line char by char
     for (int i = 0; line_text[i] != '\0'; i++) {
@@ -157,17 +171,35 @@ void print_colored_line(SpeakerID speaker_id, StringID text_id, const GameState*
     printf("\033[K\n"); // Erase to end of line before newline
 #else
     // Standard instant print
-    if (speaker_id == SPEAKER_NONE || speaker_id == SPEAKER_NAVI) {
-        _print_formatted_system_line(line_text);
-    } else if (speaker_prefix[0] != '\0') {
-        printf("%s%s\033[K\n", speaker_prefix, line_text);
-    } else {
-        printf("%s\033[K\n", line_text);
-    }
+    (void)game_state;
+    _emit_colored_line(stdout, speaker_id, line_text);
 #endif
     fflush(stdout);
 }
 
+char* render_dialogue_block(const StoryScene* scene, size_t* out_len) {
+    if (scene == NULL || out_len == NULL) return NULL;
+
+    char* buffer = NULL;
+    FILE* out = open_memstream(&buffer, out_len);
+    if (out == NULL) return NULL;
+
+    for (int i = 0; i < scene->dialogue_line_count; i++) {
+        const char* line_text = get_string_by_id(scene->dialogue_lines[i].text_id);
+        if (line_text == NULL) {
+            fputc('\n', out);
+            continue;
+        }
+        _emit_colored_line(out, scene->dialogue_lines[i].speaker_id, line_text);
+    }
+
+    if (fclose(out) != 0) {
+        free(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
 void clear_screen() {
     // \033[H (home) \033[2J (clear screen) \033[3J (clear scrollback)
     printf("\033[H\033[2J\033[3J");
@@ -325,6 +357,14 @@ void render_current_scene(const StoryScene* scene, const struct GameState* game_
             fflush(stdout);
             
             gs->last_printed_line_idx = scene->dialogue_line_count + 100; // Fully synced
+        } else if (all_lines_done) {
+            // A delayed choice came due after playback; the prompt row already
+            // reserves room for every choice, so just redraw the block in place.
+            printf("\033[s");
+            move_cursor(gs->current_dialogue_rows + 1, 1);
+            _render_choices_dynamic(scene, gs, elapsed_ms);
+            printf("\033[u");
+            fflush(stdout);
         }
         return;
     }
@@ -335,16 +375,44 @@ void render_current_scene(const StoryScene* scene, const struct GameState* game_
     printf("\n========================================\n");
     g_render_line_counter += 2; // \n and separator
     if (scene->location_id[0] != '\0') {
-        Location* loc = get_location_by_id(scene->location_id);
-        if (loc && loc->name[0] != '\0') printf("Location: %s\n", loc->name);
+        const Location* loc = map_location_at(scene->location);
+        if (loc && location_name(loc)[0] != '\0') printf("Location: %s\n", location_name(loc));
         else printf("Location: %s\n", scene->location_id);
         g_render_line_counter++;
+
+        // Who is here comes straight from the NPC reverse index.
+        uint32_t present = npc_present_mask(scene->location_id);
+        if (present != 0) {
+            printf(ANSI_COLOR_MID_GRAY "Here:");
+            const char* sep = " ";
+            for (int npc = 0; npc < NPC_COUNT; npc++) {
+                if (present & (1u << npc)) {
+                    printf("%s%s", sep, npc_display_name((NpcId)npc));
+                    sep = ", ";
+                }
+            }
+            printf(ANSI_COLOR_RESET "\n");
+            g_render_line_counter++;
+        }
     }
     printf("========================================\n");
     g_render_line_counter++;
 
-    for (int i = 0; i < scene->dialogue_line_count; i++) {
-        print_colored_line(scene->dialogue_lines[i].speaker_id, scene->dialogue_lines[i].text_id, gs);
+    // Dialogue is state-independent, so a block pre-rendered by the prefetcher can be
+    // written in one go. Choices below still depend on live state and are drawn fresh.
+    size_t frame_len = 0;
+    const char* frame = NULL;
+#ifndef USE_TYPEWRITER_EFFECT
+    frame = scene_prefetch_current_frame(scene->scene_id, &frame_len);
+#endif
+    if (frame != NULL) {
+        fwrite(frame, 1, frame_len, stdout);
+        fflush(stdout);
+        g_render_line_counter += scene->dialogue_line_count;
+    } else {
+        for (int i = 0; i < scene->dialogue_line_count; i++) {
+            print_colored_line(scene->dialogue_lines[i].speaker_id, scene->dialogue_lines[i].text_id, gs);
+        }
     }
 
     _render_choices_dynamic(scene, gs, elapsed_ms);
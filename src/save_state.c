@@ -0,0 +1,702 @@
+#include "save_state.h"
+#include "data_loader.h"
+#include "player_items.h"
+#include "game_paths.h"
+#include "byte_util.h"
+#include "flag_system.h"
+#include "npc_schedule.h"
+#include "characters/mika.h"
+#include "ecc_time.h"
+#include "logger.h"
+#include "map_loader.h"
+#include <zlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILE_HEADER_SIZE 12
+#define SECTION_HEADER_SIZE 12
+#define MAX_SAVE_STRINGS 0xFFFF
+
+#define SECTION_TAG(a, b, c, d) ((uint32_t)(a) | (uint32_t)(b) << 8 | (uint32_t)(c) << 16 | (uint32_t)(d) << 24)
+#define TAG_STRINGS   SECTION_TAG('S', 'T', 'R', 'S')
+#define TAG_PLAYER    SECTION_TAG('P', 'L', 'Y', 'R')
+#define TAG_INVENTORY SECTION_TAG('I', 'N', 'V', 'T')
+#define TAG_COMMANDS  SECTION_TAG('C', 'M', 'D', 'S')
+#define TAG_NPCS      SECTION_TAG('N', 'P', 'C', 'S')
+#define TAG_FLAGS     SECTION_TAG('F', 'L', 'A', 'G')
+#define TAG_FLAG_DELTA SECTION_TAG('F', 'D', 'L', 'T')
+
+#define NPC_FLAG_MANUAL 0x01
+
+// Sections this version reads, in the order it writes them.
+enum {
+    SECTION_STRINGS, SECTION_PLAYER, SECTION_INVENTORY, SECTION_COMMANDS, SECTION_NPCS, SECTION_FLAGS,
+    SECTION_FLAG_DELTA, SECTION_COUNT
+};
+static const uint32_t g_section_tags[SECTION_COUNT] = {
+    TAG_STRINGS, TAG_PLAYER, TAG_INVENTORY, TAG_COMMANDS, TAG_NPCS, TAG_FLAGS, TAG_FLAG_DELTA
+};
+
+const char* save_state_status_string(SaveStateStatus status) {
+    switch (status) {
+        case SAVE_STATE_OK: return "ok";
+        case SAVE_STATE_ERROR_IO: return "I/O error";
+        case SAVE_STATE_ERROR_MEMORY: return "out of memory";
+        case SAVE_STATE_ERROR_FORMAT: return "not a save file, or truncated";
+        case SAVE_STATE_ERROR_VERSION: return "written by a newer version";
+        case SAVE_STATE_ERROR_CHECKSUM: return "checksum mismatch";
+    }
+    return "unknown error";
+}
+
+// --- Writing ---
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+} ByteBuffer;
+
+static void put_bytes(ByteBuffer* b, const void* bytes, size_t n) {
+    if (b->failed) return;
+    if (b->size + n > b->capacity) {
+        size_t capacity = b->capacity ? b->capacity : 1024;
+        while (capacity < b->size + n) capacity *= 2;
+        unsigned char* grown = realloc(b->data, capacity);
+        if (grown == NULL) {
+            b->failed = true;
+            return;
+        }
+        b->data = grown;
+        b->capacity = capacity;
+    }
+    memcpy(b->data + b->size, bytes, n);
+    b->size += n;
+}
+
+static void put_u8(ByteBuffer* b, uint8_t v) {
+    put_bytes(b, &v, 1);
+}
+
+static void put_u16(ByteBuffer* b, uint16_t v) {
+    unsigned char bytes[2];
+    store_u16(bytes, v);
+    put_bytes(b, bytes, sizeof(bytes));
+}
+
+static void put_u32(ByteBuffer* b, uint32_t v) {
+    unsigned char bytes[4];
+    store_u32(bytes, v);
+    put_bytes(b, bytes, sizeof(bytes));
+}
+
+// Returns the offset of the section header, patched by end_section().
+static size_t begin_section(ByteBuffer* b, uint32_t tag) {
+    size_t start = b->size;
+    put_u32(b, tag);
+    put_u32(b, 0);
+    put_u32(b, 0);
+    return start;
+}
+
+static void end_section(ByteBuffer* b, size_t start) {
+    if (b->failed) return;
+    const unsigned char* payload = b->data + start + SECTION_HEADER_SIZE;
+    size_t size = b->size - start - SECTION_HEADER_SIZE;
+    store_u32(b->data + start + 4, (uint32_t)size);
+    store_u32(b->data + start + 8, (uint32_t)crc32(crc32(0L, Z_NULL, 0), payload, (uInt)size));
+}
+
+// Strings are interned while the sections are written; the pointers borrow
+// from the game state, which does not change during an encode.
+typedef struct {
+    const char** strings;
+    uint32_t* hashes;
+    int count;
+    int capacity;
+    int32_t* slots;     // String index, -1 = empty
+    uint32_t slot_mask;
+    bool failed;
+} Interner;
+
+static bool interner_init(Interner* in, int capacity) {
+    memset(in, 0, sizeof(*in));
+    if (capacity > MAX_SAVE_STRINGS) return false;
+    uint32_t slot_count = 16;
+    while (slot_count < (uint32_t)capacity * 2) slot_count *= 2;
+    in->strings = malloc(sizeof(*in->strings) * capacity);
+    in->hashes = malloc(sizeof(*in->hashes) * capacity);
+    in->slots = malloc(sizeof(*in->slots) * slot_count);
+    if (in->strings == NULL || in->hashes == NULL || in->slots == NULL) return false;
+    memset(in->slots, 0xFF, sizeof(*in->slots) * slot_count);
+    in->capacity = capacity;
+    in->slot_mask = slot_count - 1;
+    return true;
+}
+
+static void interner_free(Interner* in) {
+    free(in->strings);
+    free(in->hashes);
+    free(in->slots);
+}
+
+static uint16_t intern(Interner* in, const char* s) {
+    if (s == NULL) s = "";
+    uint32_t h = fnv1a(s);
+    for (uint32_t i = h & in->slot_mask;; i = (i + 1) & in->slot_mask) {
+        int32_t index = in->slots[i];
+        if (index < 0) break;
+        if (in->hashes[index] == h && strcmp(in->strings[index], s) == 0) return (uint16_t)index;
+    }
+    if (in->count >= in->capacity) {
+        in->failed = true;
+        return 0;
+    }
+    uint32_t i = h & in->slot_mask;
+    while (in->slots[i] >= 0) i = (i + 1) & in->slot_mask;
+    in->slots[i] = in->count;
+    in->strings[in->count] = s;
+    in->hashes[in->count] = h;
+    return (uint16_t)in->count++;
+}
+
+// What the last journal record (or snapshot) left the save at.
+struct SaveStateShadow {
+    uint64_t items;
+    uint16_t item_quantity[MAX_ITEMS];
+    uint32_t commands;
+    struct {
+        char location[MAX_NAME_LENGTH];
+        int state;
+        bool is_manual;
+    } npcs[NPC_COUNT];
+    HashTable* flags;
+};
+
+static bool inventory_matches(const PlayerState* ps, const SaveStateShadow* shadow) {
+    return ps->items == shadow->items && memcmp(ps->item_quantity, shadow->item_quantity, sizeof(ps->item_quantity)) == 0;
+}
+
+static void remember_inventory(const PlayerState* ps, SaveStateShadow* shadow) {
+    shadow->items = ps->items;
+    memcpy(shadow->item_quantity, ps->item_quantity, sizeof(shadow->item_quantity));
+}
+
+static bool npc_matches(NpcId npc, const SaveStateShadow* shadow) {
+    return npc_get_state(npc) == shadow->npcs[npc].state &&
+           npc_is_manually_positioned(npc) == shadow->npcs[npc].is_manual &&
+           strcmp(npc_current_location(npc), shadow->npcs[npc].location) == 0;
+}
+
+static void remember_npc(NpcId npc, SaveStateShadow* shadow) {
+    snprintf(shadow->npcs[npc].location, MAX_NAME_LENGTH, "%s", npc_current_location(npc));
+    shadow->npcs[npc].state = npc_get_state(npc);
+    shadow->npcs[npc].is_manual = npc_is_manually_positioned(npc);
+}
+
+static void copy_flag(const char* key, const char* value, void* context) {
+    hash_table_set((HashTable*)context, key, value);
+}
+
+SaveStateShadow* save_state_shadow_create(const GameState* game_state) {
+    SaveStateShadow* shadow = calloc(1, sizeof(SaveStateShadow));
+    if (shadow == NULL) return NULL;
+    if (!save_state_shadow_sync(shadow, game_state)) {
+        save_state_shadow_free(shadow);
+        return NULL;
+    }
+    return shadow;
+}
+
+static bool sync_shadow_flags(SaveStateShadow* shadow, const GameState* game_state) {
+    free_hash_table(shadow->flags);
+    shadow->flags = create_hash_table(game_state->flags ? game_state->flags->size : 128);
+    if (shadow->flags == NULL) return false;
+    hash_table_foreach(game_state->flags, copy_flag, shadow->flags);
+    return true;
+}
+
+bool save_state_shadow_sync(SaveStateShadow* shadow, const GameState* game_state) {
+    const PlayerState* ps = &game_state->player_state;
+    remember_inventory(ps, shadow);
+    shadow->commands = ps->commands;
+    for (int npc = 0; npc < NPC_COUNT; npc++) remember_npc((NpcId)npc, shadow);
+    return sync_shadow_flags(shadow, game_state);
+}
+
+void save_state_shadow_free(SaveStateShadow* shadow) {
+    if (shadow == NULL) return;
+    free_hash_table(shadow->flags);
+    free(shadow);
+}
+
+typedef struct {
+    Interner* interner;
+    ByteBuffer* buffer;
+    HashTable* shadow_flags; // Delta: only flags that differ from this, which is updated
+    uint32_t count;
+} FlagWriter;
+
+typedef struct {
+    HashTable* flags;
+    bool missing;
+} FlagPresence;
+
+static void note_missing_flag(const char* key, const char* value, void* context) {
+    (void)value;
+    FlagPresence* p = context;
+    if (!p->missing && hash_table_get(p->flags, key) == NULL) p->missing = true;
+}
+
+static void write_flag(const char* key, const char* value, void* context) {
+    FlagWriter* w = context;
+    if (w->shadow_flags != NULL) {
+        const char* old = hash_table_get(w->shadow_flags, key);
+        if (old != NULL && strcmp(old, value) == 0) return;
+        hash_table_set(w->shadow_flags, key, value);
+    }
+    put_u16(w->buffer, intern(w->interner, key));
+    put_u16(w->buffer, intern(w->interner, value));
+    w->count++;
+}
+
+// A full save when 'shadow' is NULL. Otherwise a journal record: PLYR, plus
+// whichever of the other sections changed since 'shadow', which it catches up.
+static SaveStateStatus encode_state(const GameState* game_state, SaveStateShadow* shadow,
+                                    unsigned char** data_out, size_t* size_out) {
+    if (game_state == NULL || data_out == NULL || size_out == NULL) return SAVE_STATE_ERROR_FORMAT;
+    *data_out = NULL;
+    *size_out = 0;
+
+    const PlayerState* ps = &game_state->player_state;
+    int flag_count = hash_table_count(game_state->flags);
+    Interner in;
+    if (!interner_init(&in, 2 + player_item_count(ps) + player_command_count(ps) + NPC_COUNT * 2 + flag_count * 2)) {
+        interner_free(&in);
+        return SAVE_STATE_ERROR_MEMORY;
+    }
+
+    ByteBuffer body = {0};
+    int section_count = 1; // STRS
+    size_t section = begin_section(&body, TAG_PLAYER);
+    uint32_t delay_bits;
+    memcpy(&delay_bits, &game_state->typewriter_delay, sizeof(delay_bits));
+    // A pending transition if there is one, else the scene on screen.
+    const char* scene = game_state->current_story_file[0] ? game_state->current_story_file : game_state->current_scene_id;
+    put_u16(&body, intern(&in, location_id_to_string(ps->location)));
+    put_u32(&body, (uint32_t)ps->credit_level);
+    put_u8(&body, ps->persona_permissions);
+    put_u16(&body, intern(&in, scene));
+    put_u32(&body, game_state->time_of_day); // Raw codeword, noise bits included
+    put_u32(&body, delay_bits);
+    put_u8(&body, (uint8_t)game_state->doll_state_lain_room);
+    put_u8(&body, (uint8_t)game_state->doll_state_mika_room);
+    end_section(&body, section);
+    section_count++;
+
+    if (shadow == NULL || !inventory_matches(ps, shadow)) {
+        section = begin_section(&body, TAG_INVENTORY);
+        // By name, so a save outlives changes to the item table.
+        put_u16(&body, (uint16_t)player_item_count(ps));
+        for (int i = player_next_item(ps, 0); i >= 0; i = player_next_item(ps, i + 1)) {
+            put_u16(&body, intern(&in, item_by_id((ItemID)i)->id));
+            put_u32(&body, (uint32_t)player_item_quantity(ps, (ItemID)i));
+        }
+        end_section(&body, section);
+        section_count++;
+        if (shadow) remember_inventory(ps, shadow);
+    }
+
+    if (shadow == NULL || ps->commands != shadow->commands) {
+        section = begin_section(&body, TAG_COMMANDS);
+        put_u16(&body, (uint16_t)player_command_count(ps));
+        for (int i = player_next_command(ps, 0); i >= 0; i = player_next_command(ps, i + 1)) {
+            put_u16(&body, intern(&in, command_name((CommandID)i)));
+        }
+        end_section(&body, section);
+        section_count++;
+        if (shadow) shadow->commands = ps->commands;
+    }
+
+    // NPCs missing from the section are left where they are, so a record
+    // lists only the ones that moved or changed state.
+    NpcId npcs[NPC_COUNT];
+    int npc_count = 0;
+    for (int npc = 0; npc < NPC_COUNT; npc++) {
+        if (shadow == NULL || !npc_matches((NpcId)npc, shadow)) npcs[npc_count++] = (NpcId)npc;
+    }
+    if (npc_count > 0) {
+        section = begin_section(&body, TAG_NPCS);
+        put_u8(&body, (uint8_t)npc_count);
+        for (int i = 0; i < npc_count; i++) {
+            put_u16(&body, intern(&in, npc_key(npcs[i])));
+            put_u16(&body, intern(&in, npc_current_location(npcs[i])));
+            put_u8(&body, (uint8_t)npc_get_state(npcs[i])); // Mika's state is her sanity level
+            put_u8(&body, npc_is_manually_positioned(npcs[i]) ? NPC_FLAG_MANUAL : 0);
+            if (shadow) remember_npc(npcs[i], shadow);
+        }
+        end_section(&body, section);
+        section_count++;
+    }
+
+    // FLAG replaces the store; FDLT sets the flags it lists on top of it. FDLT
+    // cannot unset one, so a record after flags went away (a rewind) carries
+    // the whole store.
+    bool flags_removed = false;
+    if (shadow) {
+        FlagPresence presence = { game_state->flags, false };
+        hash_table_foreach(shadow->flags, note_missing_flag, &presence);
+        flags_removed = presence.missing;
+        if (flags_removed && !sync_shadow_flags(shadow, game_state)) body.failed = true;
+    }
+    bool flag_delta = shadow && !flags_removed;
+    size_t flags_start = body.size;
+    section = begin_section(&body, flag_delta ? TAG_FLAG_DELTA : TAG_FLAGS);
+    size_t count_at = body.size;
+    put_u32(&body, 0); // Patched below
+    FlagWriter flag_writer = { &in, &body, flag_delta ? shadow->flags : NULL, 0 };
+    hash_table_foreach(game_state->flags, write_flag, &flag_writer);
+    if (!body.failed) store_u32(body.data + count_at, flag_writer.count);
+    if (flag_delta && flag_writer.count == 0) {
+        body.size = flags_start;
+    } else {
+        end_section(&body, section);
+        section_count++;
+    }
+
+    // The string section goes first so a reader has it before anything that
+    // refers to it, but it is only complete now.
+    ByteBuffer out = {0};
+    put_bytes(&out, SAVE_STATE_MAGIC, 4);
+    put_u16(&out, SAVE_STATE_VERSION);
+    put_u16(&out, (uint16_t)section_count);
+    put_u32(&out, 0); // File size, patched below
+    section = begin_section(&out, TAG_STRINGS);
+    put_u16(&out, (uint16_t)in.count);
+    for (int i = 0; i < in.count; i++) {
+        put_bytes(&out, in.strings[i], strlen(in.strings[i]) + 1);
+    }
+    end_section(&out, section);
+    put_bytes(&out, body.data, body.size);
+
+    bool failed = in.failed || body.failed || out.failed;
+    interner_free(&in);
+    free(body.data);
+    if (failed) {
+        free(out.data);
+        return SAVE_STATE_ERROR_MEMORY;
+    }
+    store_u32(out.data + 8, (uint32_t)out.size);
+    *data_out = out.data;
+    *size_out = out.size;
+    return SAVE_STATE_OK;
+}
+
+SaveStateStatus save_state_encode(const GameState* game_state, unsigned char** data_out, size_t* size_out) {
+    return encode_state(game_state, NULL, data_out, size_out);
+}
+
+SaveStateStatus save_state_encode_delta(const GameState* game_state, SaveStateShadow* shadow,
+                                        unsigned char** data_out, size_t* size_out) {
+    if (shadow == NULL) return SAVE_STATE_ERROR_FORMAT;
+    return encode_state(game_state, shadow, data_out, size_out);
+}
+
+SaveStateStatus save_state_write(const char* path, const GameState* game_state) {
+    if (path == NULL) return SAVE_STATE_ERROR_IO;
+    unsigned char* data = NULL;
+    size_t size = 0;
+    SaveStateStatus status = save_state_encode(game_state, &data, &size);
+    if (status != SAVE_STATE_OK) return status;
+
+    bool written = write_file_atomic(path, data, size);
+    free(data);
+    LOG_DEBUG("Saved %zu bytes to %s", size, path);
+    return written ? SAVE_STATE_OK : SAVE_STATE_ERROR_IO;
+}
+
+// --- Reading ---
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+    bool ok;
+} Reader;
+
+static Reader reader_for(const unsigned char* data, size_t size) {
+    Reader r = { data, size, 0, data != NULL };
+    return r;
+}
+
+static const unsigned char* take(Reader* r, size_t n) {
+    if (!r->ok || r->size - r->pos < n) {
+        r->ok = false;
+        return NULL;
+    }
+    const unsigned char* p = r->data + r->pos;
+    r->pos += n;
+    return p;
+}
+
+static uint8_t get_u8(Reader* r) {
+    const unsigned char* p = take(r, 1);
+    return p ? p[0] : 0;
+}
+
+static uint16_t get_u16(Reader* r) {
+    const unsigned char* p = take(r, 2);
+    return p ? load_u16(p) : 0;
+}
+
+static uint32_t get_u32(Reader* r) {
+    const unsigned char* p = take(r, 4);
+    return p ? load_u32(p) : 0;
+}
+
+typedef struct {
+    const char** strings; // Point into the save buffer
+    int count;
+} StringSection;
+
+static const char* get_string(Reader* r, const StringSection* strings) {
+    uint16_t index = get_u16(r);
+    if (index >= strings->count) {
+        r->ok = false;
+        return "";
+    }
+    return strings->strings[index];
+}
+
+// Strings in fixed-size fields must fit; the writer never produces longer ones.
+static void get_field(Reader* r, const StringSection* strings, char* dest, size_t dest_size) {
+    const char* s = get_string(r, strings);
+    size_t len = strlen(s);
+    if (len >= dest_size) {
+        r->ok = false;
+        return;
+    }
+    memcpy(dest, s, len + 1);
+}
+
+static bool parse_strings(const unsigned char* payload, size_t size, StringSection* out) {
+    Reader r = reader_for(payload, size);
+    out->count = get_u16(&r);
+    out->strings = malloc(sizeof(*out->strings) * (out->count ? out->count : 1));
+    if (!r.ok || out->strings == NULL) return false;
+    for (int i = 0; i < out->count; i++) {
+        const unsigned char* start = r.data + r.pos;
+        const unsigned char* end = memchr(start, '\0', r.size - r.pos);
+        if (end == NULL) return false;
+        out->strings[i] = (const char*)start;
+        r.pos += (size_t)(end - start) + 1;
+    }
+    return true;
+}
+
+typedef struct {
+    char location[MAX_NAME_LENGTH];
+    int state;
+    bool is_manual;
+    bool present;
+} NpcRecord;
+
+// Everything a save restores, parsed before any of it is applied.
+typedef struct {
+    PlayerState player;
+    char location[MAX_NAME_LENGTH]; // The player's, as saved
+    char current_story_file[MAX_PATH_LENGTH];
+    uint32_t time_of_day;
+    float typewriter_delay;
+    int8_t doll_state_lain_room;
+    int8_t doll_state_mika_room;
+    bool has_inventory;
+    bool has_commands;
+    NpcRecord npcs[NPC_COUNT];
+    HashTable* flags;       // FLAG: replaces the store
+    HashTable* flag_delta;  // FDLT: set on top of it
+} SaveRecord;
+
+static bool parse_player(Reader* r, const StringSection* strings, SaveRecord* rec) {
+    get_field(r, strings, rec->location, sizeof(rec->location));
+    rec->player.credit_level = (int32_t)get_u32(r);
+    rec->player.persona_permissions = get_u8(r);
+    get_field(r, strings, rec->current_story_file, sizeof(rec->current_story_file));
+    rec->time_of_day = get_u32(r);
+    uint32_t delay_bits = get_u32(r);
+    memcpy(&rec->typewriter_delay, &delay_bits, sizeof(delay_bits));
+    rec->doll_state_lain_room = (int8_t)get_u8(r);
+    rec->doll_state_mika_room = (int8_t)get_u8(r);
+    return r->ok;
+}
+
+// Names the tables no longer know are dropped.
+static bool parse_inventory(Reader* r, const StringSection* strings, SaveRecord* rec) {
+    int count = get_u16(r);
+    if (count > MAX_ITEMS) return false;
+    player_clear_items(&rec->player);
+    for (int i = 0; i < count && r->ok; i++) {
+        ItemID item = item_id_from_string(get_string(r, strings));
+        int quantity = (int32_t)get_u32(r);
+        if (r->ok) player_set_item_quantity(&rec->player, item, quantity);
+    }
+    rec->has_inventory = true;
+    return r->ok;
+}
+
+static bool parse_commands(Reader* r, const StringSection* strings, SaveRecord* rec) {
+    int count = get_u16(r);
+    if (count > MAX_COMMANDS) return false;
+    rec->player.commands = 0;
+    for (int i = 0; i < count && r->ok; i++) {
+        CommandID command = command_id_from_string(get_string(r, strings));
+        if (r->ok) player_unlock_command(&rec->player, command);
+    }
+    rec->has_commands = true;
+    return r->ok;
+}
+
+static bool parse_npcs(Reader* r, const StringSection* strings, SaveRecord* rec) {
+    int count = get_u8(r);
+    for (int i = 0; i < count && r->ok; i++) {
+        NpcId npc = npc_from_key(get_string(r, strings));
+        NpcRecord scratch;
+        NpcRecord* dest = (npc < NPC_COUNT) ? &rec->npcs[npc] : &scratch; // NPCs no longer in the game are skipped
+        get_field(r, strings, dest->location, sizeof(dest->location));
+        dest->state = get_u8(r);
+        dest->is_manual = (get_u8(r) & NPC_FLAG_MANUAL) != 0;
+        dest->present = true;
+    }
+    return r->ok;
+}
+
+static bool parse_flags(Reader* r, const StringSection* strings, HashTable** out) {
+    uint32_t count = get_u32(r);
+    // Two u16 per flag; checked up front so a bad count cannot size the table.
+    if (!r->ok || count > (r->size - r->pos) / 4) return false;
+    int buckets = 128;
+    while ((uint32_t)buckets < count) buckets *= 2;
+    *out = create_hash_table(buckets);
+    if (*out == NULL) return false;
+    for (uint32_t i = 0; i < count && r->ok; i++) {
+        const char* key = get_string(r, strings);
+        const char* value = get_string(r, strings);
+        if (r->ok) hash_table_set(*out, key, value);
+    }
+    return r->ok;
+}
+
+static void apply_record(SaveRecord* rec, GameState* game_state) {
+    PlayerState* ps = &game_state->player_state;
+    ps->location = location_id_from_string(rec->location);
+    ps->credit_level = rec->player.credit_level;
+    ps->persona_permissions = rec->player.persona_permissions;
+    if (rec->has_inventory) {
+        ps->items = rec->player.items;
+        memcpy(ps->item_quantity, rec->player.item_quantity, sizeof(ps->item_quantity));
+    }
+    if (rec->has_commands) ps->commands = rec->player.commands;
+    strcpy(game_state->current_story_file, rec->current_story_file);
+    game_state->time_of_day = rec->time_of_day;
+    game_state->typewriter_delay = rec->typewriter_delay;
+    game_state->doll_state_lain_room = rec->doll_state_lain_room;
+    game_state->doll_state_mika_room = rec->doll_state_mika_room;
+
+    for (int npc = 0; npc < NPC_COUNT; npc++) {
+        const NpcRecord* n = &rec->npcs[npc];
+        if (!n->present) continue;
+        if (npc == NPC_MIKA) {
+            strcpy(game_state->mika_location_storage, n->location);
+            restore_mika_state(game_state->mika_location_storage, n->is_manual, n->state);
+        } else {
+            npc_restore((NpcId)npc, n->location, n->is_manual, n->state);
+        }
+    }
+
+    if (rec->flags != NULL) {
+        free_hash_table(game_state->flags);
+        game_state->flags = rec->flags;
+        rec->flags = NULL;
+    }
+    hash_table_foreach(rec->flag_delta, copy_flag, game_state->flags);
+    // The codeword is authoritative, as when loading character.json.
+    DecodedTimeResult time_check = decode_time_with_ecc(game_state->time_of_day);
+    hash_table_set(game_state->flags, "TIME_GLITCH_ACTIVE", time_check.status == DOUBLE_BIT_ERROR_DETECTED ? "1" : "0");
+}
+
+SaveStateStatus save_state_decode(const unsigned char* data, size_t size, GameState* game_state) {
+    if (data == NULL || game_state == NULL || size < FILE_HEADER_SIZE) return SAVE_STATE_ERROR_FORMAT;
+    if (memcmp(data, SAVE_STATE_MAGIC, 4) != 0) return SAVE_STATE_ERROR_FORMAT;
+    Reader r = reader_for(data, size);
+    take(&r, 4);
+    uint16_t version = get_u16(&r);
+    uint16_t section_count = get_u16(&r);
+    if (version == 0) return SAVE_STATE_ERROR_FORMAT;
+    if (version > SAVE_STATE_VERSION) return SAVE_STATE_ERROR_VERSION;
+    if (get_u32(&r) != size) return SAVE_STATE_ERROR_FORMAT;
+
+    // Locate and check every section before parsing any of them.
+    Reader sections[SECTION_COUNT];
+    bool found[SECTION_COUNT] = { false };
+    for (int i = 0; i < section_count; i++) {
+        uint32_t tag = get_u32(&r);
+        uint32_t length = get_u32(&r);
+        uint32_t crc = get_u32(&r);
+        const unsigned char* payload = take(&r, length);
+        if (!r.ok) return SAVE_STATE_ERROR_FORMAT;
+        if ((uint32_t)crc32(crc32(0L, Z_NULL, 0), payload, length) != crc) return SAVE_STATE_ERROR_CHECKSUM;
+        for (int t = 0; t < SECTION_COUNT; t++) {
+            if (tag == g_section_tags[t] && !found[t]) {
+                sections[t] = reader_for(payload, length);
+                found[t] = true;
+            }
+        }
+    }
+    if (r.pos != size || !found[SECTION_STRINGS] || !found[SECTION_PLAYER]) return SAVE_STATE_ERROR_FORMAT;
+
+    StringSection strings = { NULL, 0 };
+    SaveRecord* rec = calloc(1, sizeof(SaveRecord));
+    if (rec == NULL) return SAVE_STATE_ERROR_MEMORY;
+    bool ok = parse_strings(sections[SECTION_STRINGS].data, sections[SECTION_STRINGS].size, &strings)
+        && parse_player(&sections[SECTION_PLAYER], &strings, rec)
+        && (!found[SECTION_INVENTORY] || parse_inventory(&sections[SECTION_INVENTORY], &strings, rec))
+        && (!found[SECTION_COMMANDS] || parse_commands(&sections[SECTION_COMMANDS], &strings, rec))
+        && (!found[SECTION_NPCS] || parse_npcs(&sections[SECTION_NPCS], &strings, rec))
+        && (!found[SECTION_FLAGS] || parse_flags(&sections[SECTION_FLAGS], &strings, &rec->flags))
+        && (!found[SECTION_FLAG_DELTA] || parse_flags(&sections[SECTION_FLAG_DELTA], &strings, &rec->flag_delta));
+    if (ok && rec->flags == NULL && game_state->flags == NULL) {
+        rec->flags = create_hash_table(128);
+        ok = rec->flags != NULL;
+    }
+    if (ok) apply_record(rec, game_state);
+
+    free_hash_table(rec->flags);
+    free_hash_table(rec->flag_delta);
+    free(rec);
+    free(strings.strings);
+    return ok ? SAVE_STATE_OK : SAVE_STATE_ERROR_FORMAT;
+}
+
+SaveStateStatus save_state_read(const char* path, GameState* game_state) {
+    char* data = NULL;
+    long length = 0;
+    DataLoaderStatus io = read_entire_file(path, &data, &length);
+    if (io != DATA_LOADER_SUCCESS) return io == DATA_LOADER_ERROR_MEMORY_ALLOC ? SAVE_STATE_ERROR_MEMORY : SAVE_STATE_ERROR_IO;
+    SaveStateStatus status = save_state_decode((const unsigned char*)data, (size_t)length, game_state);
+    free(data);
+    LOG_DEBUG("Loading %s: %s", path, save_state_status_string(status));
+    return status;
+}
+
+void save_state_sibling_path(const char* path, const char* extension, char* out, size_t out_size) {
+    if (out == NULL || out_size == 0) return;
+    snprintf(out, out_size, "%s", path ? path : "");
+    char* slash = strrchr(out, '/');
+    char* dot = strrchr(out, '.');
+    if (dot != NULL && (slash == NULL || dot > slash)) *dot = '\0';
+    size_t len = strlen(out);
+    snprintf(out + len, out_size - len, "%s", extension);
+}
@@ -0,0 +1,267 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // For SCHED_IDLE
+#endif
+
+#include "scene_prefetch.h"
+#include "scenes.h"
+#include "executor.h"
+#include "render_utils.h"
+#include "map_loader.h"
+#include "logger.h"
+#include "string_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+// Enough for every choice action, connection and auto event of one scene.
+#define PREFETCH_SLOT_COUNT 16
+#define PREFETCH_MAX_CANDIDATES (MAX_CHOICES_PER_SCENE * 2 + MAX_CONNECTIONS + MAX_AUTO_EVENTS)
+
+typedef enum {
+    SLOT_EMPTY,
+    SLOT_PENDING,   // Queued, waiting for the worker
+    SLOT_BUILDING,  // Worker is preparing it outside the lock
+    SLOT_READY
+} PrefetchSlotState;
+
+typedef struct {
+    char scene_id[MAX_NAME_LENGTH];
+    PrefetchSlotState state;
+    StoryScene* scene;
+    char* frame;
+    size_t frame_len;
+} PrefetchSlot;
+
+static PrefetchSlot g_slots[PREFETCH_SLOT_COUNT];
+static pthread_mutex_t g_prefetch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_prefetch_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t g_worker_thread;
+static bool g_worker_running = false;
+static ScenePrefetchStats g_stats;
+
+// Frame of the scene taken last. Only touched from the thread driving transitions.
+static char g_current_frame_id[MAX_NAME_LENGTH];
+static char* g_current_frame = NULL;
+static size_t g_current_frame_len = 0;
+
+// --- Slot Helpers (g_prefetch_mutex held) ---
+
+static void release_slot(PrefetchSlot* slot) {
+    free(slot->scene);
+    free(slot->frame);
+    memset(slot, 0, sizeof(*slot));
+}
+
+static PrefetchSlot* find_slot(const char* scene_id) {
+    for (int i = 0; i < PREFETCH_SLOT_COUNT; i++) {
+        if (g_slots[i].state != SLOT_EMPTY && strcmp(g_slots[i].scene_id, scene_id) == 0) {
+            return &g_slots[i];
+        }
+    }
+    return NULL;
+}
+
+static PrefetchSlot* find_pending_slot(void) {
+    for (int i = 0; i < PREFETCH_SLOT_COUNT; i++) {
+        if (g_slots[i].state == SLOT_PENDING) return &g_slots[i];
+    }
+    return NULL;
+}
+
+static void set_current_frame(const char* scene_id, char* frame, size_t frame_len) {
+    free(g_current_frame);
+    g_current_frame = frame;
+    g_current_frame_len = frame_len;
+    strncpy(g_current_frame_id, scene_id, MAX_NAME_LENGTH - 1);
+    g_current_frame_id[MAX_NAME_LENGTH - 1] = '\0';
+}
+
+// --- Worker ---
+
+static void* prefetch_worker_func(void* arg) {
+    (void)arg;
+
+    // Prepared scenes are pure speculation; never compete with input or rendering.
+#ifdef SCHED_IDLE
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+
+    pthread_mutex_lock(&g_prefetch_mutex);
+    while (g_worker_running) {
+        PrefetchSlot* slot = find_pending_slot();
+        if (slot == NULL) {
+            pthread_cond_wait(&g_prefetch_cond, &g_prefetch_mutex);
+            continue;
+        }
+
+        char scene_id[MAX_NAME_LENGTH];
+        strncpy(scene_id, slot->scene_id, MAX_NAME_LENGTH);
+        slot->state = SLOT_BUILDING;
+        pthread_mutex_unlock(&g_prefetch_mutex);
+
+        // Scene data and the string table are read-only here, so no game lock is needed;
+        // the read bracket only keeps string blocks from being trimmed under us.
+        string_table_begin_read();
+        StoryScene* scene = malloc(sizeof(StoryScene));
+        char* frame = NULL;
+        size_t frame_len = 0;
+        bool ok = (scene != NULL) && load_scene_data(scene_id, scene);
+        if (ok && !scene->is_takeover) {
+            // Takeover scenes stream line by line, so only their struct is cached.
+            frame = render_dialogue_block(scene, &frame_len);
+        }
+        string_table_end_read();
+
+        pthread_mutex_lock(&g_prefetch_mutex);
+        // The slot may have been evicted or reassigned while we were building.
+        if (ok && slot->state == SLOT_BUILDING && strcmp(slot->scene_id, scene_id) == 0) {
+            slot->scene = scene;
+            slot->frame = frame;
+            slot->frame_len = frame_len;
+            slot->state = SLOT_READY;
+            g_stats.prepared++;
+        } else {
+            free(scene);
+            free(frame);
+            if (slot->state == SLOT_BUILDING && strcmp(slot->scene_id, scene_id) == 0) {
+                release_slot(slot); // Unknown scene ID; drop it.
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_prefetch_mutex);
+    return NULL;
+}
+
+// --- Public API ---
+
+void scene_prefetch_init(void) {
+    if (g_worker_running) return;
+    memset(g_slots, 0, sizeof(g_slots));
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_worker_running = true;
+    if (pthread_create(&g_worker_thread, NULL, prefetch_worker_func, NULL) != 0) {
+        fprintf(stderr, "WARNING: Failed to start scene prefetch worker. Continuing without prefetch.\n");
+        g_worker_running = false;
+    }
+}
+
+void scene_prefetch_shutdown(void) {
+    pthread_mutex_lock(&g_prefetch_mutex);
+    if (!g_worker_running) {
+        pthread_mutex_unlock(&g_prefetch_mutex);
+        return;
+    }
+    g_worker_running = false;
+    pthread_cond_signal(&g_prefetch_cond);
+    pthread_mutex_unlock(&g_prefetch_mutex);
+    pthread_join(g_worker_thread, NULL);
+
+    for (int i = 0; i < PREFETCH_SLOT_COUNT; i++) release_slot(&g_slots[i]);
+    set_current_frame("", NULL, 0);
+
+    unsigned long total = g_stats.hits + g_stats.misses;
+    logger_log("Scene prefetch: %lu hits, %lu misses (%.1f%% hit rate), %lu scenes prepared.",
+               g_stats.hits, g_stats.misses, total ? 100.0 * g_stats.hits / total : 0.0, g_stats.prepared);
+}
+
+// Appends scene_id unless it is empty, already listed or the list is full.
+static int add_candidate(const char** candidates, int count, const char* scene_id) {
+    if (scene_id == NULL || scene_id[0] == '\0' || count >= PREFETCH_MAX_CANDIDATES) return count;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(candidates[i], scene_id) == 0) return count;
+    }
+    candidates[count] = scene_id;
+    return count + 1;
+}
+
+void scene_prefetch_schedule(const StoryScene* scene, const GameState* game_state) {
+    if (!g_worker_running || scene == NULL || game_state == NULL) return;
+
+    const char* candidates[PREFETCH_MAX_CANDIDATES];
+    int count = 0;
+
+    // 1. Choice targets, resolved through the action and connection tables.
+    for (int i = 0; i < scene->choice_count; i++) {
+        const char* targets[4];
+        int n = get_action_scene_candidates(scene->choices[i].action_id, game_state, targets, 4);
+        for (int j = 0; j < n; j++) count = add_candidate(candidates, count, targets[j]);
+    }
+    // 2. Auto events.
+    for (int i = 0; i < scene->auto_event_count; i++) {
+        count = add_candidate(candidates, count, scene->auto_events[i].target_scene_id);
+    }
+    // 3. Connections reachable with 'move' from the current location.
+    const Location* loc = map_location_at(game_state->player_state.location);
+    if (loc != NULL) {
+        for (int i = 0; i < loc->connection_count; i++) {
+            count = add_candidate(candidates, count, location_connections(loc)[i].target_scene_id);
+        }
+    }
+    if (count > PREFETCH_SLOT_COUNT) count = PREFETCH_SLOT_COUNT;
+
+    pthread_mutex_lock(&g_prefetch_mutex);
+    // Evict everything that is no longer reachable in one step.
+    for (int i = 0; i < PREFETCH_SLOT_COUNT; i++) {
+        if (g_slots[i].state == SLOT_EMPTY) continue;
+        bool wanted = false;
+        for (int j = 0; j < count; j++) {
+            if (strcmp(g_slots[i].scene_id, candidates[j]) == 0) { wanted = true; break; }
+        }
+        if (!wanted) release_slot(&g_slots[i]);
+    }
+    // Queue new candidates into free slots.
+    bool queued = false;
+    for (int j = 0; j < count; j++) {
+        if (find_slot(candidates[j]) != NULL) continue;
+        for (int i = 0; i < PREFETCH_SLOT_COUNT; i++) {
+            if (g_slots[i].state == SLOT_EMPTY) {
+                strncpy(g_slots[i].scene_id, candidates[j], MAX_NAME_LENGTH - 1);
+                g_slots[i].state = SLOT_PENDING;
+                queued = true;
+                break;
+            }
+        }
+    }
+    if (queued) pthread_cond_signal(&g_prefetch_cond);
+    pthread_mutex_unlock(&g_prefetch_mutex);
+
+    LOG_DEBUG("Scene prefetch: %d candidate(s) after '%s'.", count, scene->scene_id);
+}
+
+bool scene_prefetch_take(const char* scene_id, StoryScene* out_scene) {
+    if (!g_worker_running || scene_id == NULL || out_scene == NULL) return false;
+
+    bool hit = false;
+    pthread_mutex_lock(&g_prefetch_mutex);
+    PrefetchSlot* slot = find_slot(scene_id);
+    if (slot != NULL && slot->state == SLOT_READY) {
+        memcpy(out_scene, slot->scene, sizeof(StoryScene));
+        set_current_frame(scene_id, slot->frame, slot->frame_len);
+        slot->frame = NULL; // Ownership moved to the current frame
+        release_slot(slot);
+        g_stats.hits++;
+        hit = true;
+    } else {
+        set_current_frame(scene_id, NULL, 0);
+        g_stats.misses++;
+    }
+    pthread_mutex_unlock(&g_prefetch_mutex);
+    return hit;
+}
+
+const char* scene_prefetch_current_frame(const char* scene_id, size_t* out_len) {
+    if (g_current_frame == NULL || scene_id == NULL || strcmp(g_current_frame_id, scene_id) != 0) return NULL;
+    if (out_len) *out_len = g_current_frame_len;
+    return g_current_frame;
+}
+
+void scene_prefetch_get_stats(ScenePrefetchStats* out_stats) {
+    if (out_stats == NULL) return;
+    pthread_mutex_lock(&g_prefetch_mutex);
+    *out_stats = g_stats;
+    pthread_mutex_unlock(&g_prefetch_mutex);
+}
@@ -6,6 +6,11 @@
 #include "flag_system.h"
 #include "time_utils.h" // Added for get_current_time_ms
 #include "logger.h"
+#include "scene_prefetch.h"
+#include "game_timers.h"
+#include "executor.h" // For arm_scene_auto_events
+#include "state_snapshot.h"
+#include "map_loader.h"
 #include <stdlib.h> // For atoi
 
 // All scene init functions are declared here. They are defined in their respective data.c files.
@@ -50,6 +55,37 @@
 #include "SCENE_IWAKURA_STUDY_data.h"
 #include "SCENE_IWAKURA_LAINS_ROOM_data.h"
 #include "SCENE_IWAKURA_MIKAS_ROOM_data.h"
+// Yamanote loop stations, in loop order (train_system.h)
+#include "SCENE_SHINAGAWA_data.h"
+#include "SCENE_OSAKI_data.h"
+#include "SCENE_GOTANDA_data.h"
+#include "SCENE_MEGURO_data.h"
+#include "SCENE_EBISU_data.h"
+#include "SCENE_SHIBUYA_data.h"
+#include "SCENE_HARAJUKU_data.h"
+#include "SCENE_YOYOGI_data.h"
+#include "SCENE_SHINJUKU_data.h"
+#include "SCENE_SHIN_OKUBO_data.h"
+#include "SCENE_TAKADANOBABA_data.h"
+#include "SCENE_MEJIRO_data.h"
+#include "SCENE_IKEBUKURO_data.h"
+#include "SCENE_OTSUKA_data.h"
+#include "SCENE_SUGAMO_data.h"
+#include "SCENE_KOMAGOME_data.h"
+#include "SCENE_TABATA_data.h"
+#include "SCENE_NISHI_NIPPORI_data.h"
+#include "SCENE_NIPPORI_data.h"
+#include "SCENE_UGUISUDANI_data.h"
+#include "SCENE_UENO_data.h"
+#include "SCENE_OKACHIMACHI_data.h"
+#include "SCENE_AKIHABARA_data.h"
+#include "SCENE_KANDA_data.h"
+#include "SCENE_TOKYO_data.h"
+#include "SCENE_YURAKUCHO_data.h"
+#include "SCENE_SHIMBASHI_data.h"
+#include "SCENE_HAMAMATSUCHO_data.h"
+#include "SCENE_TAMACHI_data.h"
+#include "SCENE_TAKANAWA_GATEWAY_data.h"
 
 // A function pointer type for scene initializers
 typedef void (*SceneInitFunc)(StoryScene*);
@@ -103,10 +139,81 @@ static const struct {
     {"SCENE_IWAKURA_STUDY", init_scene_scene_iwakura_study_from_data},
     {"SCENE_IWAKURA_LAINS_ROOM", init_scene_scene_iwakura_lains_room_from_data},
     {"SCENE_IWAKURA_MIKAS_ROOM", init_scene_scene_iwakura_mikas_room_from_data},
+    // Yamanote loop stations
+    {"SCENE_SHINAGAWA", init_scene_scene_shinagawa_from_data},
+    {"SCENE_OSAKI", init_scene_scene_osaki_from_data},
+    {"SCENE_GOTANDA", init_scene_scene_gotanda_from_data},
+    {"SCENE_MEGURO", init_scene_scene_meguro_from_data},
+    {"SCENE_EBISU", init_scene_scene_ebisu_from_data},
+    {"SCENE_SHIBUYA", init_scene_scene_shibuya_from_data},
+    {"SCENE_HARAJUKU", init_scene_scene_harajuku_from_data},
+    {"SCENE_YOYOGI", init_scene_scene_yoyogi_from_data},
+    {"SCENE_SHINJUKU", init_scene_scene_shinjuku_from_data},
+    {"SCENE_SHIN_OKUBO", init_scene_scene_shin_okubo_from_data},
+    {"SCENE_TAKADANOBABA", init_scene_scene_takadanobaba_from_data},
+    {"SCENE_MEJIRO", init_scene_scene_mejiro_from_data},
+    {"SCENE_IKEBUKURO", init_scene_scene_ikebukuro_from_data},
+    {"SCENE_OTSUKA", init_scene_scene_otsuka_from_data},
+    {"SCENE_SUGAMO", init_scene_scene_sugamo_from_data},
+    {"SCENE_KOMAGOME", init_scene_scene_komagome_from_data},
+    {"SCENE_TABATA", init_scene_scene_tabata_from_data},
+    {"SCENE_NISHI_NIPPORI", init_scene_scene_nishi_nippori_from_data},
+    {"SCENE_NIPPORI", init_scene_scene_nippori_from_data},
+    {"SCENE_UGUISUDANI", init_scene_scene_uguisudani_from_data},
+    {"SCENE_UENO", init_scene_scene_ueno_from_data},
+    {"SCENE_OKACHIMACHI", init_scene_scene_okachimachi_from_data},
+    {"SCENE_AKIHABARA", init_scene_scene_akihabara_from_data},
+    {"SCENE_KANDA", init_scene_scene_kanda_from_data},
+    {"SCENE_TOKYO", init_scene_scene_tokyo_from_data},
+    {"SCENE_YURAKUCHO", init_scene_scene_yurakucho_from_data},
+    {"SCENE_SHIMBASHI", init_scene_scene_shimbashi_from_data},
+    {"SCENE_HAMAMATSUCHO", init_scene_scene_hamamatsucho_from_data},
+    {"SCENE_TAMACHI", init_scene_scene_tamachi_from_data},
+    {"SCENE_TAKANAWA_GATEWAY", init_scene_scene_takanawa_gateway_from_data},
 };
 
 static const int num_scene_registrations = sizeof(scene_registrations) / sizeof(scene_registrations[0]);
 
+bool load_scene_data(const char* scene_id, StoryScene* scene) {
+    if (scene_id == NULL || scene == NULL) return false;
+
+    for (int i = 0; i < num_scene_registrations; ++i) {
+        if (strcmp(scene_registrations[i].id, scene_id) == 0) {
+            scene_registrations[i].func(scene);
+            scene->location = location_id_from_string(scene->location_id);
+            return true;
+        }
+    }
+    return false;
+}
+
+// A delayed dialogue line or choice changes the screen exactly once, when its
+// delay has passed, so it asks for a single redraw then instead of every render
+// re-checking it.
+static bool scene_reveal_timer_fired(void* context, int arg) {
+    (void)context;
+    (void)arg;
+    return true;
+}
+
+static void arm_scene_timers(StoryScene* scene, GameState* game_state) {
+    game_timers_cancel_group(TIMER_GROUP_SCENE);
+    // Only takeover scenes stream their lines; normal scenes print them at once.
+    if (scene->is_takeover) {
+        for (int i = 0; i < scene->dialogue_line_count; i++) {
+            if (scene->dialogue_lines[i].delay_ms > 0) {
+                realtime_timer_after_ms(scene->dialogue_lines[i].delay_ms, scene_reveal_timer_fired, NULL, i, TIMER_GROUP_SCENE);
+            }
+        }
+    }
+    for (int i = 0; i < scene->choice_count; i++) {
+        if (scene->choices[i].delay_ms > 0) {
+            realtime_timer_after_ms(scene->choices[i].delay_ms, scene_reveal_timer_fired, NULL, i, TIMER_GROUP_SCENE);
+        }
+    }
+    arm_scene_auto_events(game_state, scene);
+}
+
 bool transition_to_scene(const char* target_story_file, StoryScene* scene, GameState* game_state) {
     const char* scene_id_str = (target_story_file != NULL) ? target_story_file : "NULL";
     LOG_DEBUG("Attempting to transition to scene: %s", scene_id_str);
@@ -114,20 +221,25 @@ bool transition_to_scene(const char* target_story_file, StoryScene* scene, GameS
 
     if (target_story_file == NULL || scene == NULL) return false;
     
-    for (int i = 0; i < num_scene_registrations; ++i) {
-        if (strcmp(scene_registrations[i].id, target_story_file) == 0) {
-            LOG_DEBUG("Scene '%s' found in dispatch table. Initializing...", target_story_file);
-            scene_registrations[i].func(scene);
-            game_state->scene_start_ms = get_current_time_ms(); // Record scene start time
-            game_state->last_printed_line_idx = -1; // Reset rendering progress
-            game_state->current_dialogue_rows = 0;
-            LOG_DEBUG("Successfully initialized scene '%s'.", target_story_file);
-            return true;
-        }
+    if (scene_prefetch_take(target_story_file, scene)) {
+        LOG_DEBUG("Scene '%s' served from prefetch cache.", target_story_file);
+    } else if (load_scene_data(target_story_file, scene)) {
+        LOG_DEBUG("Scene '%s' found in dispatch table. Initialized.", target_story_file);
+    } else {
+        fprintf(stderr, "ERROR: Scene ID '%s' not found in scene registration table.\n", target_story_file);
+        return false;
     }
-    
-    fprintf(stderr, "ERROR: Scene ID '%s' not found in scene registration table.\n", target_story_file);
-    return false;
+
+    snprintf(game_state->current_scene_id, sizeof(game_state->current_scene_id), "%s", target_story_file);
+    game_state->scene_start_ms = get_current_time_ms(); // Record scene start time
+    game_state->last_printed_line_idx = -1; // Reset rendering progress
+    game_state->current_dialogue_rows = 0;
+    LOG_DEBUG("Successfully initialized scene '%s'.", target_story_file);
+
+    arm_scene_timers(scene, game_state);
+    scene_prefetch_schedule(scene, game_state);
+    state_history_record(game_state);
+    return true;
 }
 
 #include "conditions.h"
@@ -0,0 +1,148 @@
+#include "state_snapshot.h"
+#include "flag_system.h"
+#include "npc_schedule.h"
+#include "characters/mika.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct StateSnapshot {
+    char scene_id[MAX_NAME_LENGTH];
+    PlayerState player; // Location, credit, persona, item and command bitsets
+    uint32_t time_of_day; // Raw codeword, noise bits included
+    int8_t doll_state_lain_room;
+    int8_t doll_state_mika_room;
+    struct {
+        char location[MAX_NAME_LENGTH];
+        int state;
+        bool is_manual;
+    } npcs[NPC_COUNT];
+    HashTable* flags;
+    size_t size;
+};
+
+StateSnapshot* state_snapshot_take(const GameState* game_state) {
+    if (game_state == NULL) return NULL;
+    StateSnapshot* s = calloc(1, sizeof(StateSnapshot));
+    if (s == NULL) return NULL;
+    s->size = sizeof(StateSnapshot);
+
+    snprintf(s->scene_id, sizeof(s->scene_id), "%s", game_state->current_scene_id);
+    s->player = game_state->player_state;
+    s->time_of_day = game_state->time_of_day;
+    s->doll_state_lain_room = game_state->doll_state_lain_room;
+    s->doll_state_mika_room = game_state->doll_state_mika_room;
+    for (int npc = 0; npc < NPC_COUNT; npc++) {
+        snprintf(s->npcs[npc].location, MAX_NAME_LENGTH, "%s", npc_current_location((NpcId)npc));
+        s->npcs[npc].state = npc_get_state((NpcId)npc);
+        s->npcs[npc].is_manual = npc_is_manually_positioned((NpcId)npc);
+    }
+
+    s->flags = hash_table_share(game_state->flags);
+    if (s->flags == NULL && game_state->flags != NULL) {
+        state_snapshot_free(s);
+        return NULL;
+    }
+    if (s->flags) s->size += sizeof(HashTable) + s->flags->size * sizeof(FlagNode*);
+    return s;
+}
+
+bool state_snapshot_restore(const StateSnapshot* s, GameState* game_state) {
+    if (s == NULL || game_state == NULL) return false;
+    // The live store shares the snapshot's chains; its next writes copy them.
+    HashTable* flags = s->flags ? hash_table_share(s->flags) : create_hash_table(128);
+    if (flags == NULL) return false;
+    free_hash_table(game_state->flags);
+    game_state->flags = flags;
+
+    game_state->player_state = s->player;
+    // Game timers see the clock jump and re-arm themselves.
+    game_state->time_of_day = s->time_of_day;
+    game_state->doll_state_lain_room = s->doll_state_lain_room;
+    game_state->doll_state_mika_room = s->doll_state_mika_room;
+
+    for (int npc = 0; npc < NPC_COUNT; npc++) {
+        if (npc == NPC_MIKA) {
+            snprintf(game_state->mika_location_storage, MAX_NAME_LENGTH, "%s", s->npcs[npc].location);
+            restore_mika_state(game_state->mika_location_storage, s->npcs[npc].is_manual, s->npcs[npc].state);
+        } else {
+            npc_restore((NpcId)npc, s->npcs[npc].location, s->npcs[npc].is_manual, s->npcs[npc].state);
+        }
+    }
+
+    snprintf(game_state->current_story_file, sizeof(game_state->current_story_file), "%s", s->scene_id);
+    return true;
+}
+
+void state_snapshot_free(StateSnapshot* s) {
+    if (s == NULL) return;
+    free_hash_table(s->flags);
+    free(s);
+}
+
+const char* state_snapshot_scene(const StateSnapshot* s) {
+    return s ? s->scene_id : NULL;
+}
+
+uint32_t state_snapshot_time(const StateSnapshot* s) {
+    return s ? s->time_of_day : 0;
+}
+
+size_t state_snapshot_size(const StateSnapshot* s) {
+    return s ? s->size : 0;
+}
+
+// --- Scene History ---
+
+static StateSnapshot* g_history[STATE_HISTORY_CAPACITY];
+static int g_history_start = 0; // Slot of the oldest entry
+static int g_history_count = 0;
+
+static int history_slot(int index) {
+    return (g_history_start + index) % STATE_HISTORY_CAPACITY;
+}
+
+void state_history_record(const GameState* game_state) {
+    StateSnapshot* s = state_snapshot_take(game_state);
+    if (s == NULL) {
+        LOG_DEBUG("Could not snapshot scene '%s' for the history.", game_state->current_scene_id);
+        return;
+    }
+    if (g_history_count == STATE_HISTORY_CAPACITY) {
+        state_snapshot_free(g_history[g_history_start]);
+        g_history_start = history_slot(1);
+        g_history_count--;
+    }
+    g_history[history_slot(g_history_count++)] = s;
+}
+
+int state_history_count(void) {
+    return g_history_count;
+}
+
+const StateSnapshot* state_history_get(int index) {
+    if (index < 0 || index >= g_history_count) return NULL;
+    return g_history[history_slot(index)];
+}
+
+// Forgets entries 'index' and after.
+static void truncate_history(int index) {
+    while (g_history_count > index) {
+        g_history_count--;
+        state_snapshot_free(g_history[history_slot(g_history_count)]);
+        g_history[history_slot(g_history_count)] = NULL;
+    }
+}
+
+bool state_history_rewind(int index, GameState* game_state) {
+    if (index < 0 || index >= g_history_count) return false;
+    if (!state_snapshot_restore(g_history[history_slot(index)], game_state)) return false;
+    truncate_history(index);
+    return true;
+}
+
+void state_history_clear(void) {
+    truncate_history(0);
+    g_history_start = 0;
+}
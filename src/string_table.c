@@ -1,47 +1,236 @@
 #include "../include/string_ids.h"
+#include "../include/string_table.h"
+#include "compression_util.h"
+#include "logger.h"
+#include "task_scheduler.h" // For task_in_task
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h> // For malloc, free
 #include <string.h> // For strdup
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-// Global pointer to store the loaded strings
-const char* g_string_table[TEXT_COUNT];
+#define MAX_POOL_BLOCKS 255
 
-// Function to initialize the string table
-// This function will be called by the data loader
-void init_string_table(const char** strings, int count) {
-    // Check if table is already initialized (first element is not NULL)
-    if (g_string_table[0] != NULL) {
-        // Free existing data if re-initializing
-        for (int i = 0; i < TEXT_COUNT; ++i) { // Use TEXT_COUNT as the fixed size
-            if (g_string_table[i] != NULL) {
-                free((void*)g_string_table[i]);
-                g_string_table[i] = NULL;
-            }
-        }
+static const char* const g_builtin_strings[] = {
+    "ERROR: Invalid Text ID (Embedded Fallback)", // TEXT_INVALID
+    ""                                            // TEXT_EMPTY_LINE
+};
+
+static bool g_initialized = false;
+
+// Strings set through set_string_by_id(); NULL means "use the pool".
+static const char* g_overrides[TEXT_COUNT];
+
+// Mapped locale pack; NULL offsets means none.
+static void* g_locale_map = NULL;
+static size_t g_locale_map_size = 0;
+static const uint32_t* g_locale_offsets = NULL;
+static const char* g_locale_blob = NULL;
+static char g_locale_name[sizeof(((LocalePackHeader*)0)->locale) + 1];
+
+// Inflated blocks, indexed by block. Guarded by g_pool_mutex.
+static pthread_mutex_t g_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char* g_block_text[MAX_POOL_BLOCKS];
+static uint64_t g_block_last_used[MAX_POOL_BLOCKS];
+static uint64_t g_use_clock = 0;
+static size_t g_resident_bytes = 0;
+static atomic_int g_readers = 0;
+
+#ifdef USE_STRING_DEBUG_LOGGING
+// Evicted text, poisoned and kept until the next trim. Guarded by g_pool_mutex.
+static char* g_stale_text[2 * MAX_POOL_BLOCKS]; // One trim's evictions, then release_pool()'s
+static int g_stale_count = 0;
+
+static void free_stale_text(void) {
+    for (int i = 0; i < g_stale_count; i++) free(g_stale_text[i]);
+    g_stale_count = 0;
+}
+#endif
+
+static void evict_block(int block) {
+#ifdef USE_STRING_DEBUG_LOGGING
+    // The final NUL stays, so a stale string reads as '~' up to the block's end.
+    memset(g_block_text[block], '~', g_string_pool_blocks[block].size - 1);
+    g_stale_text[g_stale_count++] = g_block_text[block];
+#else
+    free(g_block_text[block]);
+#endif
+    g_block_text[block] = NULL;
+    g_resident_bytes -= g_string_pool_blocks[block].size;
+    LOG_DEBUG("String pool: evicted '%s' (%zu bytes resident)", g_string_pool_blocks[block].module, g_resident_bytes);
+}
+
+static void release_pool(void) {
+    pthread_mutex_lock(&g_pool_mutex);
+    for (int i = 0; i < g_string_pool_block_count && i < MAX_POOL_BLOCKS; i++) {
+        if (g_block_text[i] != NULL) evict_block(i);
     }
+#ifdef USE_STRING_DEBUG_LOGGING
+    free_stale_text(); // Nothing is left to catch once the table is torn down
+#endif
+    pthread_mutex_unlock(&g_pool_mutex);
+}
 
-    // Assign new strings
-    for (int i = 0; i < count; ++i) {
-        if (i < TEXT_COUNT) { // Ensure we don't go out of bounds of g_string_table
-            g_string_table[i] = strdup(strings[i]); // Duplicate string to own memory
+// Returns the inflated text of 'block', inflating it if needed. Call with g_pool_mutex held.
+static const char* resident_block(int block) {
+    if (g_block_text[block] == NULL) {
+        const StringPoolBlock* b = &g_string_pool_blocks[block];
+        char* text = malloc(b->size);
+        if (text == NULL) return NULL;
+        if (decompress_with_dictionary(b->data, b->compressed_size, g_string_pool_dictionary,
+                                       g_string_pool_dictionary_size, (unsigned char*)text, b->size) != 0) {
+            LOG_DEBUG("String pool: failed to inflate '%s'", b->module);
+            free(text);
+            return NULL;
         }
+        g_block_text[block] = text;
+        g_resident_bytes += b->size;
+        LOG_DEBUG("String pool: inflated '%s' (%u -> %u bytes, %zu resident)", b->module, b->compressed_size, b->size, g_resident_bytes);
+    }
+    g_block_last_used[block] = ++g_use_clock;
+    return g_block_text[block];
+}
+
+// --- Locale Packs ---
+
+static bool locale_pack_valid(const unsigned char* map, size_t size) {
+    if (size < sizeof(LocalePackHeader)) return false;
+    LocalePackHeader header;
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, LOCALE_PACK_MAGIC, sizeof(header.magic)) != 0) return false;
+    if (header.version != LOCALE_PACK_VERSION) return false; // Also catches a byte-swapped pack
+    if (header.string_count != TEXT_COUNT || header.ids_hash != STRING_IDS_HASH) return false;
+
+    size_t offsets_end = sizeof(LocalePackHeader) + (size_t)TEXT_COUNT * sizeof(uint32_t);
+    if (header.blob_size == 0 || size != offsets_end + header.blob_size) return false;
+    if (map[size - 1] != '\0') return false; // Every string terminates inside the blob
+
+    const uint32_t* offsets = (const uint32_t*)(map + sizeof(LocalePackHeader));
+    for (int i = 0; i < TEXT_COUNT; i++) {
+        if (offsets[i] != LOCALE_PACK_MISSING && offsets[i] >= header.blob_size) return false;
     }
+    return true;
+}
+
+bool string_table_load_locale(const char* path) {
+    if (path == NULL) return false;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd); // The mapping keeps the file alive
+    if (map == MAP_FAILED) return false;
+
+    if (!locale_pack_valid(map, (size_t)st.st_size)) {
+        LOG_DEBUG("Locale pack '%s' is invalid or stale; keeping the current strings.", path);
+        munmap(map, (size_t)st.st_size);
+        return false;
+    }
+
+    string_table_unload_locale();
+    const LocalePackHeader* header = map;
+    g_locale_map = map;
+    g_locale_map_size = (size_t)st.st_size;
+    g_locale_offsets = (const uint32_t*)((const unsigned char*)map + sizeof(LocalePackHeader));
+    g_locale_blob = (const char*)(g_locale_offsets + TEXT_COUNT);
+    memcpy(g_locale_name, header->locale, sizeof(header->locale));
+    g_locale_name[sizeof(header->locale)] = '\0';
+    LOG_DEBUG("Locale pack '%s' (%s) mapped, %zu bytes.", path, g_locale_name, g_locale_map_size);
+    return true;
+}
+
+void string_table_unload_locale(void) {
+    if (g_locale_map == NULL) return;
+    g_locale_offsets = NULL;
+    g_locale_blob = NULL;
+    munmap(g_locale_map, g_locale_map_size);
+    g_locale_map = NULL;
+    g_locale_map_size = 0;
+    g_locale_name[0] = '\0';
+}
+
+const char* string_table_locale(void) {
+    return g_locale_map != NULL ? g_locale_name : NULL;
+}
+
+// Function to initialize the string table
+// This function will be called by the data loader
+void init_string_table(void) {
+    // Re-initializing drops any overrides and inflated blocks from the previous table.
+    cleanup_string_table();
+    g_initialized = true;
+}
+
+int set_string_by_id(StringID id, const char* text) {
+    if (id < 0 || id >= TEXT_COUNT || text == NULL) return 0;
+    char* copy = strdup(text);
+    if (copy == NULL) return 0;
+    free((void*)g_overrides[id]);
+    g_overrides[id] = copy;
+    return 1;
 }
 
 // Function to clean up the string table
 void cleanup_string_table() {
-    if (g_string_table[0] != NULL) { // Check if table was initialized
-        for (int i = 0; i < TEXT_COUNT; ++i) { // Use TEXT_COUNT as the fixed size
-            if (g_string_table[i] != NULL) {
-                free((void*)g_string_table[i]);
-                g_string_table[i] = NULL;
+    for (int i = 0; i < TEXT_COUNT; ++i) { // Use TEXT_COUNT as the fixed size
+        free((void*)g_overrides[i]);
+        g_overrides[i] = NULL;
+    }
+    string_table_unload_locale();
+    release_pool();
+    g_initialized = false;
+}
+
+void string_table_trim(void) {
+#ifdef USE_STRING_DEBUG_LOGGING
+    // A task resumes after its yield with whatever pointers it held then.
+    if (task_in_task()) {
+        fprintf(stderr, "ERROR: string_table_trim() called from a task; skipped.\n");
+        return;
+    }
+#endif
+    pthread_mutex_lock(&g_pool_mutex);
+    // Checked under the lock: a reader that registers later can only see
+    // blocks inflated after this trim.
+    if (atomic_load(&g_readers) == 0) {
+#ifdef USE_STRING_DEBUG_LOGGING
+        free_stale_text();
+#endif
+        while (g_resident_bytes > STRING_POOL_BUDGET_BYTES) {
+            int oldest = -1;
+            for (int i = 0; i < g_string_pool_block_count && i < MAX_POOL_BLOCKS; i++) {
+                if (g_block_text[i] != NULL && (oldest < 0 || g_block_last_used[i] < g_block_last_used[oldest])) {
+                    oldest = i;
+                }
             }
+            if (oldest < 0 || g_block_last_used[oldest] == g_use_clock) break; // Keep the most recent block
+            evict_block(oldest);
         }
     }
+    pthread_mutex_unlock(&g_pool_mutex);
+}
+
+void string_table_begin_read(void) {
+    atomic_fetch_add(&g_readers, 1);
+}
+
+void string_table_end_read(void) {
+    atomic_fetch_sub(&g_readers, 1);
 }
 
 
 const char* get_string_by_id(StringID id) {
-    if (g_string_table[0] == NULL || id < 0 || id >= TEXT_COUNT) {
+    if (!g_initialized || id < 0 || id >= TEXT_COUNT) {
         // Fallback for uninitialized table or invalid ID
         // For TEXT_INVALID, we can hardcode a fallback if table is not loaded yet
         if (id == TEXT_INVALID) {
@@ -49,5 +238,16 @@ const char* get_string_by_id(StringID id) {
         }
         return "ERROR: String not found (ID out of bounds or table not loaded)";
     }
-    return g_string_table[id];
+    if (g_overrides[id] != NULL) return g_overrides[id];
+    if (g_locale_offsets != NULL && g_locale_offsets[id] != LOCALE_PACK_MISSING) {
+        return g_locale_blob + g_locale_offsets[id];
+    }
+
+    const StringPoolEntry* entry = &g_string_pool_entries[id];
+    if (entry->block == STRING_POOL_BUILTIN) return g_builtin_strings[entry->offset];
+
+    pthread_mutex_lock(&g_pool_mutex);
+    const char* text = (entry->block < MAX_POOL_BLOCKS) ? resident_block(entry->block) : NULL;
+    pthread_mutex_unlock(&g_pool_mutex);
+    return text != NULL ? text + entry->offset : "ERROR: String pool block could not be inflated";
 }
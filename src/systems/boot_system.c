@@ -2,7 +2,6 @@
 #include "render_utils.h"
 #include "string_table.h"
 #include "logo_raw_data.h"
-#include "character_data.h"
 #include "ansi_colors.h"
 #include "linenoise.h"
 #include "data_loader.h"
@@ -25,6 +24,15 @@ bool is_valid_session_name(const char* name) {
     return true;
 }
 
+// Maps the pack for the chosen language; without one the embedded strings stay in use.
+static void load_locale_pack(GameState* gs, int lang_choice) {
+    char pack_path[MAX_PATH_LENGTH];
+    snprintf(pack_path, sizeof(pack_path), "%s/%s.lpk", gs->paths.locale_dir, (lang_choice == 1) ? "en" : "zh");
+    if (!string_table_load_locale(pack_path)) {
+        LOG_DEBUG("Locale pack %s unavailable; using embedded strings.", pack_path);
+    }
+}
+
 bool perform_boot_sequence(GameState* gs, int argc, char** argv, int* arg_index, char* session_file_path_out) {
     bool is_test_mode = false;
     bool fast_boot = false;
@@ -48,8 +56,9 @@ bool perform_boot_sequence(GameState* gs, int argc, char** argv, int* arg_index,
         strcpy(session_file_path_out, "debug_char.json");
         // Create debug character file if not exists
         if (access(session_file_path_out, F_OK) == -1) {
-            write_string_to_file(CHARACTER_JSON_DATA, session_file_path_out);
+            write_string_to_file(character_template_json(), session_file_path_out);
         }
+        load_locale_pack(gs, lang_choice);
         return true; 
     }
 
@@ -138,12 +147,13 @@ bool perform_boot_sequence(GameState* gs, int argc, char** argv, int* arg_index,
                (lang_choice == 1) ? "ENGLISH" : "CHINESE");
         usleep(500000);
     }
+    load_locale_pack(gs, lang_choice);
 
     // 3. 会话初始化 (确保输入环境纯净)
     if (is_test_mode) {
         strncpy(gs->session_name, "test_user", MAX_NAME_LENGTH - 1);
         strcpy(session_file_path_out, "test_char.json");
-        write_string_to_file(CHARACTER_JSON_DATA, session_file_path_out);
+        write_string_to_file(character_template_json(), session_file_path_out);
     } else {
         if (is_mouse_supported()) linenoiseSetMouseSupport(1); 
         tcflush(STDIN_FILENO, TCIFLUSH); 
@@ -193,7 +203,7 @@ bool perform_boot_sequence(GameState* gs, int argc, char** argv, int* arg_index,
         if (stat(session_dir, &st) == -1) {
             LOG_DEBUG("New session detected. Creating workspace...");
             if (ensure_directory_exists_recursive(session_dir, 0700)) {
-                if (write_string_to_file(CHARACTER_JSON_DATA, session_file_path_out)) {
+                if (write_string_to_file(character_template_json(), session_file_path_out)) {
                     LOG_DEBUG("Session initialization successful.");
                 } else {
                     LOG_DEBUG("CRITICAL ERROR: Failed to write initial character data!");
@@ -7,40 +7,33 @@
 #include "../include/systems/navi_shell.h" // Shell include
 #include "string_table.h"
 #include "render_utils.h"
-#include "linenoise.h"
+#include "task_scheduler.h"
+#include "command_registry.h"
 #include "flag_system.h"
 #include "ansi_colors.h" // Include ANSI color definitions
 #include "logger.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <unistd.h> // for sleep/usleep
 
 // --- Constants ---
 #define NAVI_PROMPT "NAVI> "
 #define COLOR_NAVI_SYSTEM ANSI_COLOR_CYAN
+#define MAIL_PROMPT COLOR_NAVI_SYSTEM "MAIL> " ANSI_COLOR_RESET
 #define COLOR_NAVI_ERROR ANSI_COLOR_RED
 #define COLOR_NAVI_SUCCESS ANSI_COLOR_GREEN
+#define LAIN_MAILDIR "/home/lain/Maildir" // In the world image
 
 // --- Helper Functions ---
 
-static void get_next_navi_input(char* buffer, int buffer_size) {
+static void get_next_navi_input(const char* prompt, const CommandRegistry* commands, void* context, char* buffer, int buffer_size) {
     memset(buffer, 0, buffer_size);
 
     if (g_argc > *g_arg_index_ptr) {
         strncpy(buffer, g_argv[*g_arg_index_ptr], buffer_size - 1);
         (*g_arg_index_ptr)++;
-    } else {
-        char *line = linenoise(NAVI_PROMPT);
-        if (line != NULL) {
-            if (strlen(line) > 0) {
-                // linenoiseHistoryAdd(line);
-            }
-            strncpy(buffer, line, buffer_size - 1);
-            free(line);
-        } else {
-            strncpy(buffer, "exit", buffer_size - 1);
-        }
+    } else if (!task_read_command(prompt, commands, context, buffer, buffer_size)) {
+        strncpy(buffer, "exit", buffer_size - 1);
     }
 }
 
@@ -86,68 +79,116 @@ static void print_menu() {
     printf("\n");
 }
 
+// --- Mail ---
+
+typedef struct {
+    GameState* game_state;
+    Mailbox* mailbox;
+    bool running;
+} MailSession;
+
+static bool mail_list(void* context, const char* arg) {
+    (void)context;
+    (void)arg;
+    // Already displayed by mail_system_display_list, just wait
+    printf("%s(Already showing list. Type 'read <id>', 'delete <id>', or 'back')\n%s", COLOR_NAVI_SYSTEM, ANSI_COLOR_RESET);
+    task_sleep_ms(800);
+    return false;
+}
+
+static bool mail_read(void* context, const char* arg) {
+    MailSession* session = context;
+    Mailbox* mailbox = session->mailbox;
+    int email_id_to_read = atoi(arg);
+    int email_index_to_read = -1;
+    for (int i = 0; i < mailbox->email_count; ++i) {
+        if (mailbox->emails[i].id == email_id_to_read && !mailbox->emails[i].is_deleted) { // Only read non-deleted
+            email_index_to_read = i;
+            break;
+        }
+    }
+
+    if (email_index_to_read != -1) {
+        clear_screen();
+        print_header(session->game_state);
+        mail_system_display_email(mailbox, email_index_to_read);
+        mail_system_mark_as_read(mailbox, email_id_to_read);
+        printf("\n");
+        task_wait_enter("(Press ENTER to return to mail list)");
+    } else {
+        printf("%sERROR: Invalid or deleted email ID. Type 'list' to see available IDs.\n%s", COLOR_NAVI_ERROR, ANSI_COLOR_RESET);
+        task_sleep_ms(800);
+    }
+    return false;
+}
+
+static bool mail_delete(void* context, const char* arg) {
+    MailSession* session = context;
+    int email_id_to_delete = atoi(arg);
+    mail_system_delete_email(session->mailbox, email_id_to_delete);
+    task_sleep_ms(800); // Give user time to read output
+    return false;
+}
+
+static bool mail_back(void* context, const char* arg) {
+    (void)arg;
+    ((MailSession*)context)->running = false;
+    return false;
+}
+
+static const CommandSpec g_mail_commands[] = {
+    { "list",   COMMAND_ARG_NONE, mail_list,   false },
+    { "read",   COMMAND_ARG_NONE, mail_read,   false },
+    { "delete", COMMAND_ARG_NONE, mail_delete, false },
+    { "back",   COMMAND_ARG_NONE, mail_back,   false },
+    { "exit",   COMMAND_ARG_NONE, mail_back,   false },
+    { "0",      COMMAND_ARG_NONE, mail_back,   true },
+};
+
+// Kept between visits: reopening mail only looks at what changed since.
+static Mailbox g_mailbox;
+
+bool embedded_navi_world_changed(GameState* game_state, const WorldFileChange* change, char* notice, size_t notice_size) {
+    if (change == NULL || strncmp(change->path, LAIN_MAILDIR "/", sizeof(LAIN_MAILDIR)) != 0) return false;
+    g_mailbox.marks = &game_state->flags;
+    // Not opened yet this run: it is listed on this first change.
+    if (g_mailbox.maildir_path[0] == '\0') snprintf(g_mailbox.maildir_path, sizeof(g_mailbox.maildir_path), "%s", LAIN_MAILDIR);
+    const Email* email = mail_system_apply_change(&g_mailbox, change);
+    if (email == NULL || email->is_read || notice == NULL) return false;
+    snprintf(notice, notice_size, "%s[NAVI] New mail from %s: %s%s", COLOR_NAVI_SYSTEM, email->sender, email->subject, ANSI_COLOR_RESET);
+    return true;
+}
+
 static void handle_mail(GameState* game_state) {
-    Mailbox mailbox;
-    mail_system_init(&mailbox);
-    mail_system_load_emails(&mailbox, "world/home/lain/Maildir"); // Use relative path
+    Mailbox* mailbox = &g_mailbox;
+    mailbox->marks = &game_state->flags;
+    mail_system_load_emails(mailbox, LAIN_MAILDIR);
 
     char mail_cmd_line[MAX_LINE_LENGTH];
-    int mail_running = 1;
+    MailSession session = { game_state, mailbox, true };
+    CommandRegistry* commands = command_registry_create(g_mail_commands, (int)(sizeof(g_mail_commands) / sizeof(g_mail_commands[0])), NULL);
+    if (commands == NULL) session.running = false;
 
-    while (mail_running) {
+    while (session.running) {
         clear_screen();
         print_header(game_state);
-        mail_system_display_list(&mailbox);
-
-        printf("%sMAIL> %s", COLOR_NAVI_SYSTEM, ANSI_COLOR_RESET);
-        get_next_navi_input(mail_cmd_line, sizeof(mail_cmd_line));
-
-        if (strcmp(mail_cmd_line, "list") == 0) {
-            // Already displayed by mail_system_display_list, just wait
-            printf("%s(Already showing list. Type 'read <id>', 'delete <id>', or 'back')\n%s", COLOR_NAVI_SYSTEM, ANSI_COLOR_RESET);
-            usleep(800000);
-        } else if (strncmp(mail_cmd_line, "read ", 5) == 0) {
-            int email_id_to_read = atoi(mail_cmd_line + 5);
-            int email_index_to_read = -1;
-            for (int i = 0; i < mailbox.email_count; ++i) {
-                if (mailbox.emails[i].id == email_id_to_read && !mailbox.emails[i].is_deleted) { // Only read non-deleted
-                    email_index_to_read = i;
-                    break;
-                }
-            }
-
-            if (email_index_to_read != -1) {
-                clear_screen();
-                print_header(game_state);
-                mail_system_display_email(&mailbox, email_index_to_read);
-                mail_system_mark_as_read(&mailbox, email_id_to_read);
-                printf("\n(Press ENTER to return to mail list)");
-                (void)getchar();
-            } else {
-                printf("%sERROR: Invalid or deleted email ID. Type 'list' to see available IDs.\n%s", COLOR_NAVI_ERROR, ANSI_COLOR_RESET);
-                usleep(800000);
-            }
-        } else if (strncmp(mail_cmd_line, "delete ", 7) == 0) { // New delete command
-            int email_id_to_delete = atoi(mail_cmd_line + 7);
-            mail_system_delete_email(&mailbox, "world/home/lain/Maildir", email_id_to_delete);
-            // After deletion, reload emails to reflect the change in the list
-            mail_system_load_emails(&mailbox, "world/home/lain/Maildir");
-            usleep(800000); // Give user time to read output
-        } else if (strcmp(mail_cmd_line, "back") == 0 || strcmp(mail_cmd_line, "exit") == 0 || strcmp(mail_cmd_line, "0") == 0) {
-            mail_running = 0;
-        } else if (strlen(mail_cmd_line) > 0) {
+        mail_system_display_list(mailbox);
+
+        get_next_navi_input(MAIL_PROMPT, commands, &session, mail_cmd_line, sizeof(mail_cmd_line));
+
+        if (!command_registry_dispatch(commands, mail_cmd_line, &session, NULL) && strlen(mail_cmd_line) > 0) {
             printf("%sUnknown mail command: '%s'. Try 'list', 'read <id>', 'delete <id>', or 'back'.\n%s", COLOR_NAVI_ERROR, mail_cmd_line, ANSI_COLOR_RESET);
-            usleep(800000);
+            task_sleep_ms(800);
         }
     }
 
-    mail_system_cleanup(&mailbox); // Clean up after exiting mail system
+    command_registry_free(commands);
 }
 
 static void handle_network(GameState* game_state) {
     printf("%s\nChecking connection to The Wired...\n%s", COLOR_NAVI_SYSTEM, ANSI_COLOR_RESET);
     // TODO: Check actual game flag like FLAG_NAVI_ONLINE
-    sleep(1);
+    task_sleep_ms(1000);
 
     // Simulate connection progress
     const char* progress_frames[] = {"", "！", "！-", "！-=", "！-=≡"};
@@ -155,7 +196,7 @@ static void handle_network(GameState* game_state) {
     for (int i = 0; i < 5; ++i) {
         printf("\rConnecting... %s", progress_frames[i]); // \r returns cursor to start of line
         fflush(stdout); // Ensure it prints immediately
-        usleep(200000); // 0.2 seconds delay
+        task_sleep_ms(200); // 0.2 seconds delay
     }
     printf("\n"); // Newline after progress
 
@@ -180,8 +221,7 @@ static void handle_network(GameState* game_state) {
     }
 
     printf("Gateway not found.\n"); 
-    printf("(Press ENTER to return)");
-    (void)getchar();
+    task_wait_enter("(Press ENTER to return)");
 }
 
 static void handle_system_info() {
@@ -190,53 +230,103 @@ static void handle_system_info() {
     printf("Kernel:   Copland OS (Patched)\n");
     printf("User:     Iwakura Lain\n");
     printf("Uptime:   00:04:21\n");
-    printf("(Press ENTER to return)");
-    (void)getchar();
+    task_wait_enter("(Press ENTER to return)");
+}
+
+// --- Menu ---
+
+typedef struct {
+    GameState* game_state;
+    bool running;
+} NaviSession;
+
+static bool menu_exit(void* context, const char* arg) {
+    (void)arg;
+    LOG_DEBUG("NAVI command recognized: exit");
+    ((NaviSession*)context)->running = false;
+    return false;
+}
+
+static bool menu_mail(void* context, const char* arg) {
+    (void)arg;
+    LOG_DEBUG("NAVI command recognized: mail");
+    handle_mail(((NaviSession*)context)->game_state);
+    return false;
 }
 
+static bool menu_net(void* context, const char* arg) {
+    (void)arg;
+    LOG_DEBUG("NAVI command recognized: net");
+    handle_network(((NaviSession*)context)->game_state);
+    return false;
+}
+
+static bool menu_sys(void* context, const char* arg) {
+    (void)context;
+    (void)arg;
+    LOG_DEBUG("NAVI command recognized: sys");
+    handle_system_info();
+    return false;
+}
+
+static bool menu_mystery(void* context, const char* arg) {
+    (void)arg;
+    enter_mystery_app(((NaviSession*)context)->game_state);
+    return false;
+}
+
+static bool menu_shell(void* context, const char* arg) {
+    (void)arg;
+    enter_navi_shell(((NaviSession*)context)->game_state);
+    return false;
+}
+
+// Menu numbers work as well as names; only the names are completed.
+static const CommandSpec g_menu_commands[] = {
+    { "mail",    COMMAND_ARG_NONE, menu_mail,    false },
+    { "net",     COMMAND_ARG_NONE, menu_net,     false },
+    { "sys",     COMMAND_ARG_NONE, menu_sys,     false },
+    { "mystery", COMMAND_ARG_NONE, menu_mystery, false },
+    { "shell",   COMMAND_ARG_NONE, menu_shell,   false },
+    { "exit",    COMMAND_ARG_NONE, menu_exit,    false },
+    { "quit",    COMMAND_ARG_NONE, menu_exit,    true },
+    { "1",       COMMAND_ARG_NONE, menu_mail,    true },
+    { "2",       COMMAND_ARG_NONE, menu_net,     true },
+    { "3",       COMMAND_ARG_NONE, menu_sys,     true },
+    { "4",       COMMAND_ARG_NONE, menu_mystery, true },
+    { "5",       COMMAND_ARG_NONE, menu_shell,   true },
+    { "0",       COMMAND_ARG_NONE, menu_exit,    true },
+};
+
 // --- Main Interface Loop ---
 
 void enter_embedded_navi(GameState* game_state) {
     LOG_DEBUG("Entering Embedded NAVI interface.");
     char line[MAX_LINE_LENGTH];
-    int running = 1;
+    NaviSession session = { game_state, true };
+    CommandRegistry* commands = command_registry_create(g_menu_commands, (int)(sizeof(g_menu_commands) / sizeof(g_menu_commands[0])), NULL);
+    if (commands == NULL) return;
 
     // Boot animation
     clear_screen();
     printf("%sBooting Embedded Interface...\n%s", COLOR_NAVI_SYSTEM, ANSI_COLOR_RESET);
-    usleep(500000); // 0.5s
+    task_sleep_ms(500); // 0.5s
     
-    while (running) {
+    while (session.running) {
         print_header(game_state);
         print_menu();
 
-        get_next_navi_input(line, sizeof(line));
-
-        // Parse command
-        if (strcmp(line, "exit") == 0 || strcmp(line, "0") == 0 || strcmp(line, "quit") == 0) {
-            LOG_DEBUG("NAVI command recognized: %s", line);
-            running = 0;
-        } else if (strcmp(line, "mail") == 0 || strcmp(line, "1") == 0) {
-            LOG_DEBUG("NAVI command recognized: %s", line);
-            handle_mail(game_state);
-        } else if (strcmp(line, "net") == 0 || strcmp(line, "2") == 0) {
-            LOG_DEBUG("NAVI command recognized: %s", line);
-            handle_network(game_state);
-        } else if (strcmp(line, "sys") == 0 || strcmp(line, "3") == 0) {
-            LOG_DEBUG("NAVI command recognized: %s", line);
-            handle_system_info();
-        } else if (strcmp(line, "mystery") == 0 || strcmp(line, "4") == 0) {
-            enter_mystery_app(game_state);
-        } else if (strcmp(line, "shell") == 0 || strcmp(line, "5") == 0) {
-            enter_navi_shell(game_state);
-        } else if (strlen(line) > 0) {
+        get_next_navi_input(NAVI_PROMPT, commands, &session, line, sizeof(line));
+
+        if (!command_registry_dispatch(commands, line, &session, NULL) && strlen(line) > 0) {
             printf("%sUnknown command: '%s'\n%s", COLOR_NAVI_ERROR, line, ANSI_COLOR_RESET);
-            usleep(800000); // Wait a bit so user sees error
+            task_sleep_ms(800); // Wait a bit so user sees error
         }
     }
+    command_registry_free(commands);
     
     printf("%sShutting down interface...\n%s", COLOR_NAVI_SYSTEM, ANSI_COLOR_RESET);
-    usleep(300000);
+    task_sleep_ms(300);
     clear_screen();
     LOG_DEBUG("Exiting Embedded NAVI interface.");
 }
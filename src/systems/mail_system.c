@@ -2,13 +2,11 @@
 
 #include "../../include/systems/mail_system.h"
 #include "../../include/ansi_colors.h" // For coloring output
+#include "../../include/logger.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <dirent.h> // For directory operations
 #include <ctype.h>  // For isspace
-#include <sys/stat.h> // For stat
-#include <unistd.h> // For rename
 
 // --- Static Helper Functions ---
 static void trim_whitespace(char *s) {
@@ -28,6 +26,19 @@ static void trim_whitespace(char *s) {
     *(end+1) = 0;
 }
 
+// Status from the ",U" / ",R" / ",D" suffix; unread if there is none.
+static void parse_email_status(const char* filename, Email* email) {
+    const char* status_ptr = strrchr(filename, ',');
+    if (status_ptr && *(status_ptr + 1)) {
+        char status_char = *(status_ptr + 1);
+        email->is_read = (status_char == 'R');
+        email->is_deleted = (status_char == 'D');
+    } else {
+        email->is_read = false;
+        email->is_deleted = false;
+    }
+}
+
 static void parse_email_filename(const char* filename, Email* email) {
     // Expected format: NNN_sender.eml,U or NNN_sender.eml,R or NNN_sender.eml,D
     // Example: "001_chisa.eml,U" -> id=1, sender="chisa"
@@ -36,12 +47,13 @@ static void parse_email_filename(const char* filename, Email* email) {
     strncpy(email->filename, filename, sizeof(email->filename) - 1);
     email->filename[sizeof(email->filename) - 1] = '\0';
 
-    char temp_filename[MAX_PATH_LENGTH];
+    char temp_filename[VFS_NAME_MAX];
     strncpy(temp_filename, filename, sizeof(temp_filename) - 1);
     temp_filename[sizeof(temp_filename) - 1] = '\0';
 
     // Extract ID
-    char* id_part = strtok(temp_filename, "_");
+    char* save = NULL;
+    char* id_part = strtok_r(temp_filename, "_", &save);
     if (id_part) {
         email->id = atoi(id_part);
     } else {
@@ -49,162 +61,292 @@ static void parse_email_filename(const char* filename, Email* email) {
     }
 
     // Extract Sender
-    char* sender_part = strtok(NULL, "."); // Get part before .eml
+    char* sender_part = strtok_r(NULL, ".", &save); // Get part before .eml
     if (sender_part) {
         strncpy(email->sender, sender_part, sizeof(email->sender) - 1);
         email->sender[sizeof(email->sender) - 1] = '\0';
     } else {
         strcpy(email->sender, "Unknown");
     }
-    
-    // Check for status (,U or ,R or ,D)
-    const char* status_ptr = strrchr(filename, ',');
-    if (status_ptr && *(status_ptr + 1)) {
-        char status_char = *(status_ptr + 1);
-        email->is_read = (status_char == 'R');
-        email->is_deleted = (status_char == 'D'); // New: Check for deleted status
-    } else {
-        email->is_read = false; // Default to unread if no status found
-        email->is_deleted = false; // Default to not deleted
-    }
+
+    parse_email_status(filename, email);
 
     // Default subject, will be overwritten if found in email body
     strcpy(email->subject, "(No Subject)");
 }
 
+// Length of the name without its status suffix: what stays the same when
+// a message is delivered again under another status.
+static size_t email_key_length(const char* filename) {
+    const char* comma = strrchr(filename, ',');
+    return comma ? (size_t)(comma - filename) : strlen(filename);
+}
+
+#define MARK_KEY_MAX (sizeof(MAIL_STATUS_FLAG_PREFIX) + VFS_PATH_MAX + VFS_NAME_MAX)
+
+static const char* mark_key(const Mailbox* mailbox, const char* filename, char* key, size_t size) {
+    if (mailbox->marks == NULL || *mailbox->marks == NULL) return NULL;
+    snprintf(key, size, "%s%s/%.*s", MAIL_STATUS_FLAG_PREFIX, mailbox->maildir_path, (int)email_key_length(filename), filename);
+    return key;
+}
+
+// The status from the name, unless the player has marked the message since.
+static void apply_mark(const Mailbox* mailbox, Email* email) {
+    parse_email_status(email->filename, email);
+    char key[MARK_KEY_MAX];
+    const char* mark = mark_key(mailbox, email->filename, key, sizeof(key)) ? hash_table_get(*mailbox->marks, key) : NULL;
+    if (mark == NULL) return;
+    email->is_read = mark[0] == 'R';
+    email->is_deleted = mark[0] == 'D';
+}
+
+// Copies the line at *cursor (without its newline) into 'out' and advances
+// past it; false once the buffer is exhausted.
+static bool next_line(const char** cursor, char* out, size_t size) {
+    const char* p = *cursor;
+    if (*p == '\0') return false;
+    size_t len = strcspn(p, "\n");
+    size_t copy = len < size - 1 ? len : size - 1;
+    memcpy(out, p, copy);
+    out[copy] = '\0';
+    *cursor = p + len + (p[len] == '\n');
+    return true;
+}
+
+// Fills in the subject (and sender, if the name had none) from the headers
+// and notes where the body starts; the body itself is not kept.
+static bool parse_email_headers(const char* filepath, Email* email) {
+    char* contents = NULL;
+    size_t size = 0;
+    if (!vfs_read(filepath, &contents, &size)) {
+        fprintf(stderr, "ERROR: Could not open email file: %s\n", filepath);
+        return false;
+    }
+
+    char line_buffer[MAX_LINE_LENGTH];
+    const char* cursor = contents;
+    email->subject[0] = '\0'; // Prefer the header subject
+    email->body_offset = size;
+    while (next_line(&cursor, line_buffer, sizeof(line_buffer))) {
+        trim_whitespace(line_buffer);
+        // An empty line separates headers from body
+        if (line_buffer[0] == '\0') {
+            email->body_offset = (size_t)(cursor - contents);
+            break;
+        }
+        if (email->subject[0] == '\0' && strncmp(line_buffer, "Subject:", 8) == 0) {
+            const char* value = line_buffer + 8;
+            while (isspace((unsigned char)*value)) value++;
+            strncpy(email->subject, value, sizeof(email->subject) - 1);
+            email->subject[sizeof(email->subject) - 1] = '\0';
+        } else if (email->sender[0] == '\0' && strncmp(line_buffer, "From:", 5) == 0) {
+            const char* value = line_buffer + 5;
+            while (isspace((unsigned char)*value)) value++;
+            strncpy(email->sender, value, sizeof(email->sender) - 1);
+            email->sender[sizeof(email->sender) - 1] = '\0';
+        }
+    }
+    free(contents);
+
+    // Final fallback for subject if not found in headers
+    if (email->subject[0] == '\0') {
+        // Extract from filename: NNN_sender_subject.eml,U
+        const char* start = strchr(email->filename, '_'); // After ID
+        if (start) start = strchr(start + 1, '_');         // After sender
+        const char* end = start ? strstr(start + 1, ".eml") : NULL;
+        size_t len = end ? (size_t)(end - start - 1) : 0;
+        if (len > 0 && len < sizeof(email->subject)) {
+            memcpy(email->subject, start + 1, len);
+            email->subject[len] = '\0';
+        } else {
+            strcpy(email->subject, "(No Subject)");
+        }
+    }
+    return true;
+}
+
+static int compare_emails(const void* a, const void* b) {
+    const Email* x = a;
+    const Email* y = b;
+    if (x->id != y->id) return x->id < y->id ? -1 : 1;
+    return strcmp(x->filename, y->filename);
+}
+
+// The listing being built by mail_system_load_emails().
+typedef struct {
+    Mailbox* mailbox;
+    Email* emails;
+    int count;
+    int capacity;
+    int parsed;
+} MailScan;
+
+static void scan_email(const VfsEntry* ent, void* context) {
+    MailScan* scan = context;
+    Mailbox* mailbox = scan->mailbox;
+
+    // Check for files ending with .eml,U or .eml,R or .eml,D
+    if (ent->is_dir || strstr(ent->name, ".eml") == NULL || strchr(ent->name, ',') == NULL) return;
+
+    Email email;
+    int known = command_trie_find(mailbox->by_name, ent->name, email_key_length(ent->name));
+    if (known >= 0) {
+        // Seen before: only the status in the name can have changed.
+        email = mailbox->emails[known];
+        snprintf(email.filename, sizeof(email.filename), "%s", ent->name);
+        apply_mark(mailbox, &email);
+        if (email.is_deleted) return;
+    } else {
+        parse_email_filename(ent->name, &email);
+        apply_mark(mailbox, &email);
+        if (email.is_deleted) return; // Only load emails that are NOT deleted
+        char filepath[VFS_PATH_MAX];
+        snprintf(filepath, sizeof(filepath), "%s/%s", mailbox->maildir_path, ent->name);
+        if (!parse_email_headers(filepath, &email)) return;
+        scan->parsed++;
+    }
+
+    if (scan->count == scan->capacity) {
+        int capacity = scan->capacity ? scan->capacity * 2 : 16;
+        Email* grown = realloc(scan->emails, sizeof(Email) * capacity);
+        if (grown == NULL) return;
+        scan->emails = grown;
+        scan->capacity = capacity;
+    }
+    scan->emails[scan->count++] = email;
+}
+
+
+// Maps the name (without status) of the message at 'from' and those after
+// it to their places in 'emails'.
+static void index_names_from(Mailbox* mailbox, int from) {
+    char key[VFS_NAME_MAX];
+    for (int i = from; i < mailbox->email_count; ++i) {
+        const char* filename = mailbox->emails[i].filename;
+        snprintf(key, sizeof(key), "%.*s", (int)email_key_length(filename), filename);
+        command_trie_insert(mailbox->by_name, key, i);
+    }
+}
+
+static void index_names(Mailbox* mailbox) {
+    command_trie_clear(mailbox->by_name);
+    index_names_from(mailbox, 0);
+}
+
+// Puts 'email' in its place by ID and indexes its name; only messages it
+// moves up are indexed again (none for the usual newest message). Returns
+// its index, or -1 without memory.
+static int insert_email(Mailbox* mailbox, const Email* email) {
+    if (mailbox->email_count == mailbox->capacity) {
+        int capacity = mailbox->capacity ? mailbox->capacity * 2 : 16;
+        Email* grown = realloc(mailbox->emails, sizeof(Email) * capacity);
+        if (grown == NULL) return -1;
+        mailbox->emails = grown;
+        mailbox->capacity = capacity;
+    }
+    int at = mailbox->email_count;
+    while (at > 0 && compare_emails(&mailbox->emails[at - 1], email) > 0) at--;
+    memmove(&mailbox->emails[at + 1], &mailbox->emails[at], sizeof(Email) * (mailbox->email_count - at));
+    mailbox->emails[at] = *email;
+    mailbox->email_count++;
+    index_names_from(mailbox, at);
+    return at;
+}
+
+static void remove_email(Mailbox* mailbox, int at) {
+    char key[VFS_NAME_MAX];
+    const char* filename = mailbox->emails[at].filename;
+    snprintf(key, sizeof(key), "%.*s", (int)email_key_length(filename), filename);
+    command_trie_remove(mailbox->by_name, key);
+    memmove(&mailbox->emails[at], &mailbox->emails[at + 1], sizeof(Email) * (mailbox->email_count - at - 1));
+    mailbox->email_count--;
+    index_names_from(mailbox, at);
+}
+
 
 // --- Public Functions ---
 
 void mail_system_init(Mailbox* mailbox) {
     if (mailbox) {
-        mailbox->email_count = 0;
-        for (int i = 0; i < MAX_EMAILS; ++i) {
-            mailbox->emails[i].id = 0;
-            mailbox->emails[i].is_read = false;
-            mailbox->emails[i].is_deleted = false; // Initialize new field
-            mailbox->emails[i].body_line_count = 0;
-            mailbox->emails[i].sender[0] = '\0';
-            mailbox->emails[i].subject[0] = '\0';
-            mailbox->emails[i].filename[0] = '\0';
-        }
+        memset(mailbox, 0, sizeof(*mailbox));
     }
 }
 
 void mail_system_load_emails(Mailbox* mailbox, const char* maildir_path) {
     if (!mailbox || !maildir_path) return;
 
-    DIR *dir;
-    struct dirent *ent;
-    char filepath[MAX_PATH_LENGTH];
-    FILE *fp;
-    char line_buffer[MAX_LINE_LENGTH];
-    Email current_email;
-
-    mail_system_init(mailbox); // Clear existing emails
+    if (strcmp(mailbox->maildir_path, maildir_path) != 0) {
+        HashTable** marks = mailbox->marks;
+        mail_system_cleanup(mailbox); // Another Maildir: only where marks are kept carries over
+        mailbox->marks = marks;
+        snprintf(mailbox->maildir_path, sizeof(mailbox->maildir_path), "%s", maildir_path);
+    } else if (mailbox->by_name != NULL && mailbox->generation == vfs_generation()) {
+        return; // Nothing in the world has changed
+    }
+    if (mailbox->by_name == NULL && (mailbox->by_name = command_trie_create()) == NULL) return;
 
-    // Check if maildir_path exists and is a directory
-    struct stat st;
-    if (stat(maildir_path, &st) == -1 || !S_ISDIR(st.st_mode)) {
+    MailScan scan = { mailbox, NULL, 0, 0, 0 };
+    if (vfs_list(maildir_path, scan_email, &scan) < 0) {
         fprintf(stderr, "ERROR: Maildir directory not found or not a directory: %s\n", maildir_path);
-        return;
     }
+    qsort(scan.emails, scan.count, sizeof(Email), compare_emails);
+
+    free(mailbox->emails);
+    mailbox->emails = scan.emails;
+    mailbox->email_count = scan.count;
+    mailbox->capacity = scan.capacity;
+    mailbox->generation = vfs_generation();
+    index_names(mailbox);
+    LOG_DEBUG("Mailbox %s: %d messages, %d headers parsed.", maildir_path, mailbox->email_count, scan.parsed);
+}
 
+const Email* mail_system_apply_change(Mailbox* mailbox, const WorldFileChange* change) {
+    if (!mailbox || !change || mailbox->maildir_path[0] == '\0') return NULL;
+    size_t dir_len = strlen(mailbox->maildir_path);
+    if (strncmp(change->path, mailbox->maildir_path, dir_len) != 0 || change->path[dir_len] != '/') return NULL;
+    const char* name = change->path + dir_len + 1;
+    if (strchr(name, '/') != NULL || strstr(name, ".eml") == NULL || strchr(name, ',') == NULL) return NULL;
+
+    size_t key_length = email_key_length(name);
+    int known = mailbox->by_name ? command_trie_find(mailbox->by_name, name, key_length) : -1;
+    bool current = mailbox->by_name != NULL && mailbox->generation == change->generation_before;
+    if (current && change->removed && known >= 0 && strcmp(mailbox->emails[known].filename, name) != 0) {
+        current = false; // Another copy of a message we list under a different status
+    }
+    if (!current) {
+        // Never listed, or other changes came first: list the Maildir again.
+        mail_system_load_emails(mailbox, mailbox->maildir_path);
+        if (change->removed || mailbox->by_name == NULL) return NULL;
+        int index = command_trie_find(mailbox->by_name, name, key_length);
+        if (index < 0 || strcmp(mailbox->emails[index].filename, name) != 0) return NULL;
+        return &mailbox->emails[index];
+    }
 
-    if ((dir = opendir(maildir_path)) != NULL) {
-        while ((ent = readdir(dir)) != NULL) {
-            // Check for regular files ending with .eml,U or .eml,R or .eml,D
-            if (ent->d_type == DT_REG && strstr(ent->d_name, ".eml") != NULL && strchr(ent->d_name, ',') != NULL) {
-                if (mailbox->email_count >= MAX_EMAILS) {
-                    fprintf(stderr, "WARNING: Max emails reached, skipping %s\n", ent->d_name);
-                    break;
-                }
-
-                snprintf(filepath, sizeof(filepath), "%s/%s", maildir_path, ent->d_name);
-
-                parse_email_filename(ent->d_name, &current_email);
-
-                // New: Only load emails that are NOT deleted
-                if (current_email.is_deleted) {
-                    continue; 
-                }
-                
-                fp = fopen(filepath, "r");
-                if (fp != NULL) {
-                    bool in_body = false;
-                    current_email.body_line_count = 0;
-
-                    // Ensure current_email.subject is cleared if parse_email_filename set a default
-                    // as we prefer the header subject.
-                    current_email.subject[0] = '\0'; 
-
-                    while (fgets(line_buffer, sizeof(line_buffer), fp) != NULL) {
-                        char trimmed_line[MAX_LINE_LENGTH];
-                        strncpy(trimmed_line, line_buffer, sizeof(trimmed_line) -1);
-                        trimmed_line[sizeof(trimmed_line)-1] = '\0';
-                        trim_whitespace(trimmed_line);
-
-                        if (!in_body) {
-                            if (current_email.subject[0] == '\0' && strncmp(trimmed_line, "Subject:", 8) == 0) {
-                                strncpy(current_email.subject, trimmed_line + 8, sizeof(current_email.subject) - 1);
-                                trim_whitespace(current_email.subject);
-                            } else if (current_email.sender[0] == '\0' && strncmp(trimmed_line, "From:", 5) == 0) {
-                                // Prefer sender from From: header if available and not set by filename
-                                strncpy(current_email.sender, trimmed_line + 5, sizeof(current_email.sender) - 1);
-                                trim_whitespace(current_email.sender);
-                            }
-                            // An empty line usually separates headers from body
-                            if (strlen(trimmed_line) == 0) {
-                                in_body = true;
-                                continue;
-                            }
-                        } else {
-                            if (current_email.body_line_count < MAX_EMAIL_BODY_LINES) {
-                                strncpy(current_email.body[current_email.body_line_count], trimmed_line, sizeof(current_email.body[0]) - 1);
-                                current_email.body[current_email.body_line_count][sizeof(current_email.body[0]) - 1] = '\0';
-                                current_email.body_line_count++;
-                            } else {
-                                // Body too long, skip rest
-                                break; 
-                            }
-                        }
-                    }
-                    fclose(fp);
-
-                    // Final fallback for subject if not found in headers
-                    if (current_email.subject[0] == '\0') {
-                        // Extract from filename: NNN_sender_subject.eml,U
-                        // This parsing is less robust, assuming sender part is clean
-                        char* start = strchr(ent->d_name, '_'); // After ID
-                        if (start) {
-                            start = strchr(start + 1, '_'); // After sender
-                            if (start) {
-                                start++; // Skip second '_'
-                                char* end = strstr(start, ".eml");
-                                if (end) {
-                                    size_t len = end - start;
-                                    if (len > 0 && len < sizeof(current_email.subject)) {
-                                        strncpy(current_email.subject, start, len);
-                                        current_email.subject[len] = '\0';
-                                    }
-                                }
-                            }
-                        }
-                        if (current_email.subject[0] == '\0') {
-                            strcpy(current_email.subject, "(No Subject)");
-                        }
-                    }
-
-                    mailbox->emails[mailbox->email_count++] = current_email;
-
-                } else {
-                    fprintf(stderr, "ERROR: Could not open email file: %s\n", filepath);
-                }
-            }
+    const Email* delivered = NULL;
+    if (known >= 0) {
+        Email* email = &mailbox->emails[known];
+        if (!change->removed) { // Same message, replaced or under a new status
+            snprintf(email->filename, sizeof(email->filename), "%s", name);
+            apply_mark(mailbox, email);
+            if (!email->is_deleted) parse_email_headers(change->path, email); // Its text may be new too
+            delivered = email;
+        }
+        if (change->removed || email->is_deleted) {
+            remove_email(mailbox, known);
+            delivered = NULL;
+        }
+    } else if (!change->removed) {
+        Email email;
+        parse_email_filename(name, &email);
+        apply_mark(mailbox, &email);
+        if (!email.is_deleted && parse_email_headers(change->path, &email)) {
+            int index = insert_email(mailbox, &email);
+            if (index >= 0) delivered = &mailbox->emails[index];
         }
-        closedir(dir);
-    } else {
-        // Error already reported by stat check
     }
+    mailbox->generation = change->generation_after;
+    LOG_DEBUG("Mailbox %s: %s %s.", mailbox->maildir_path, change->removed ? "removed" : "took", name);
+    return delivered;
 }
 
 void mail_system_display_list(const Mailbox* mailbox) {
@@ -212,37 +354,14 @@ void mail_system_display_list(const Mailbox* mailbox) {
 
     printf("%s--- INBOX (%d messages) ---\n%s", ANSI_COLOR_CYAN, mailbox->email_count, ANSI_COLOR_RESET);
     if (mailbox->email_count == 0) {
-        printf("No messages.\n");
-        return;
-    }
-
-    // Sort emails by ID for consistent display
-    Email sorted_emails[MAX_EMAILS];
-    int display_count = 0;
-    for(int i = 0; i < mailbox->email_count; ++i) {
-        if (!mailbox->emails[i].is_deleted) { // Only add non-deleted emails to the display list
-            sorted_emails[display_count++] = mailbox->emails[i];
-        }
-    }
-    
-    // Simple bubble sort for demonstration; a qsort would be better for larger arrays
-    for (int i = 0; i < display_count - 1; ++i) {
-        for (int j = i + 1; j < display_count; ++j) {
-            if (sorted_emails[i].id > sorted_emails[j].id) {
-                Email temp = sorted_emails[i];
-                sorted_emails[i] = sorted_emails[j];
-                sorted_emails[j] = temp;
-            }
-        }
-    }
-
-    if (display_count == 0) {
         printf("No messages in your inbox.\n");
         return;
     }
 
-    for (int i = 0; i < display_count; ++i) {
-        const Email* email = &sorted_emails[i];
+    // Kept sorted by ID
+    for (int i = 0; i < mailbox->email_count; ++i) {
+        const Email* email = &mailbox->emails[i];
+        if (email->is_deleted) continue;
         printf("%s[%2d] %s%-15s %s\n",
                email->is_read ? "" : ANSI_COLOR_YELLOW, // Color unread emails
                email->id,
@@ -267,97 +386,96 @@ void mail_system_display_email(const Mailbox* mailbox, int email_index) {
         return;
     }
 
+    // The body is read only now, and not kept.
+    char filepath[VFS_PATH_MAX];
+    char* contents = NULL;
+    size_t size = 0;
+    snprintf(filepath, sizeof(filepath), "%s/%s", mailbox->maildir_path, email->filename);
+    if (!vfs_read(filepath, &contents, &size)) {
+        printf("%sERROR: Could not open email #%d.\n%s", ANSI_COLOR_RED, email->id, ANSI_COLOR_RESET);
+        return;
+    }
+
     printf("%s--- EMAIL #%d ---\n%s", ANSI_COLOR_CYAN, email->id, ANSI_COLOR_RESET);
     printf("From: %s\n", email->sender);
     printf("Subject: %s\n", email->subject);
     printf("Status: %s\n", email->is_read ? "Read" : "Unread");
     printf("-------------------------------\n");
-    if (email->body_line_count == 0) {
+    const char* cursor = contents + (email->body_offset < size ? email->body_offset : size);
+    char line_buffer[MAX_LINE_LENGTH];
+    int lines = 0;
+    while (next_line(&cursor, line_buffer, sizeof(line_buffer))) {
+        trim_whitespace(line_buffer);
+        printf("%s\n", line_buffer);
+        lines++;
+    }
+    if (lines == 0) {
         printf("(No body content)\n");
-    } else {
-        for (int i = 0; i < email->body_line_count; ++i) {
-            printf("%s\n", email->body[i]);
-        }
     }
     printf("-------------------------------\n%s", ANSI_COLOR_RESET);
+    free(contents);
+}
+
+// Marks the message 'status' (R or D) in the flag store; the file is left as it is.
+static void set_email_mark(Mailbox* mailbox, const Email* email, char status) {
+    char key[MARK_KEY_MAX];
+    char value[2] = { status, '\0' };
+    if (mark_key(mailbox, email->filename, key, sizeof(key))) {
+        hash_table_set(*mailbox->marks, key, value);
+    } else {
+        LOG_DEBUG("No flag store for %s; its status lasts until exit.", email->filename);
+    }
+}
+
+static Email* find_email(Mailbox* mailbox, int email_id) {
+    for (int i = 0; i < mailbox->email_count; ++i) {
+        if (mailbox->emails[i].id == email_id) return &mailbox->emails[i];
+    }
+    return NULL;
 }
 
 void mail_system_mark_as_read(Mailbox* mailbox, int email_id) {
     if (!mailbox) return;
 
-    for (int i = 0; i < mailbox->email_count; ++i) {
-        if (mailbox->emails[i].id == email_id) {
-            if (mailbox->emails[i].is_deleted) {
-                printf("%sEmail #%d is deleted and cannot be marked as read.\n%s", ANSI_COLOR_RED, email_id, ANSI_COLOR_RESET);
-                return;
-            }
-            if (!mailbox->emails[i].is_read) {
-                mailbox->emails[i].is_read = true;
-                printf("%sEmail #%d marked as read.\n%s", ANSI_COLOR_GREEN, email_id, ANSI_COLOR_RESET);
-            } else {
-                 printf("%sEmail #%d was already read.\n%s", ANSI_COLOR_YELLOW, email_id, ANSI_COLOR_RESET);
-            }
-            return;
-        }
+    Email* email = find_email(mailbox, email_id);
+    if (email == NULL) {
+        printf("%sEmail with ID %d not found to mark as read.\n%s", ANSI_COLOR_RED, email_id, ANSI_COLOR_RESET);
+        return;
     }
-    printf("%sEmail with ID %d not found to mark as read.\n%s", ANSI_COLOR_RED, email_id, ANSI_COLOR_RESET);
+    if (email->is_deleted) {
+        printf("%sEmail #%d is deleted and cannot be marked as read.\n%s", ANSI_COLOR_RED, email_id, ANSI_COLOR_RESET);
+        return;
+    }
+    if (email->is_read) {
+        printf("%sEmail #%d was already read.\n%s", ANSI_COLOR_YELLOW, email_id, ANSI_COLOR_RESET);
+        return;
+    }
+    set_email_mark(mailbox, email, 'R');
+    email->is_read = true;
+    printf("%sEmail #%d marked as read.\n%s", ANSI_COLOR_GREEN, email_id, ANSI_COLOR_RESET);
 }
 
-void mail_system_delete_email(Mailbox* mailbox, const char* maildir_path, int email_id) {
-    if (!mailbox || !maildir_path) return;
+void mail_system_delete_email(Mailbox* mailbox, int email_id) {
+    if (!mailbox) return;
 
-    for (int i = 0; i < mailbox->email_count; ++i) {
-        if (mailbox->emails[i].id == email_id) {
-            if (mailbox->emails[i].is_deleted) {
-                printf("%sEmail #%d is already deleted.\n%s", ANSI_COLOR_YELLOW, email_id, ANSI_COLOR_RESET);
-                return;
-            }
-
-            // Mark in memory
-            mailbox->emails[i].is_deleted = true;
-
-            // Rename file for persistence: change suffix to ,D
-            char old_filepath[MAX_PATH_LENGTH];
-            char new_filepath_suffix[MAX_PATH_LENGTH]; // to hold filename before , and then ,D
-            char* comma_pos = strrchr(mailbox->emails[i].filename, ',');
-
-            if (comma_pos) {
-                // Construct old path
-                snprintf(old_filepath, sizeof(old_filepath), "%s/%s", maildir_path, mailbox->emails[i].filename);
-                
-                // Construct new filename with ',D'
-                strncpy(new_filepath_suffix, mailbox->emails[i].filename, comma_pos - mailbox->emails[i].filename);
-                new_filepath_suffix[comma_pos - mailbox->emails[i].filename] = '\0'; // Null terminate
-                strcat(new_filepath_suffix, ",D"); // Append deleted status
-
-                // Construct new full path
-                char final_new_filepath[MAX_PATH_LENGTH];
-                snprintf(final_new_filepath, sizeof(final_new_filepath), "%s/%s", maildir_path, new_filepath_suffix);
-
-                if (rename(old_filepath, final_new_filepath) == 0) {
-                    printf("%sEmail #%d deleted successfully (file renamed to %s).\n%s", ANSI_COLOR_GREEN, email_id, new_filepath_suffix, ANSI_COLOR_RESET);
-                    // Update filename in memory to reflect the change
-                    strncpy(mailbox->emails[i].filename, new_filepath_suffix, sizeof(mailbox->emails[i].filename) - 1);
-                    mailbox->emails[i].filename[sizeof(mailbox->emails[i].filename) - 1] = '\0';
-                } else {
-                    fprintf(stderr, "%sERROR: Could not rename file for email #%d for deletion.\n%s", ANSI_COLOR_RED, email_id, ANSI_COLOR_RESET);
-                    // If rename fails, revert in-memory status
-                    mailbox->emails[i].is_deleted = false;
-                }
-            } else {
-                fprintf(stderr, "%sERROR: Invalid filename format for email #%d, cannot delete.\n%s", ANSI_COLOR_RED, email_id, ANSI_COLOR_RESET);
-                mailbox->emails[i].is_deleted = false;
-            }
-            return;
-        }
+    Email* email = find_email(mailbox, email_id);
+    if (email == NULL) {
+        printf("%sEmail with ID %d not found to delete.\n%s", ANSI_COLOR_RED, email_id, ANSI_COLOR_RESET);
+        return;
     }
-    printf("%sEmail with ID %d not found to delete.\n%s", ANSI_COLOR_RED, email_id, ANSI_COLOR_RESET);
+    if (email->is_deleted) {
+        printf("%sEmail #%d is already deleted.\n%s", ANSI_COLOR_YELLOW, email_id, ANSI_COLOR_RESET);
+        return;
+    }
+    set_email_mark(mailbox, email, 'D');
+    remove_email(mailbox, (int)(email - mailbox->emails)); // Listed only while not deleted
+    printf("%sEmail #%d deleted successfully.\n%s", ANSI_COLOR_GREEN, email_id, ANSI_COLOR_RESET);
 }
 
 void mail_system_cleanup(Mailbox* mailbox) {
-    // For this simple implementation, nothing to free dynamically.
-    // Just reset count.
     if (mailbox) {
-        mailbox->email_count = 0;
+        free(mailbox->emails);
+        command_trie_free(mailbox->by_name);
+        mail_system_init(mailbox);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,315 @@
+#include "systems/mystery_case.h"
+#include "world_vfs.h"
+#include "logger.h"
+#include "cJSON.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// --- Helpers ---
+
+static void set_error(char* error, size_t error_size, const char* fmt, ...) {
+    if (error == NULL || error_size == 0) return;
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(error, error_size, fmt, args);
+    va_end(args);
+}
+
+static char* copy_string(const cJSON* item) {
+    return strdup(cJSON_IsString(item) ? item->valuestring : "");
+}
+
+// Lowercased (ASCII) copy, the form keywords are looked up in.
+static char* fold_case(const char* s) {
+    char* folded = strdup(s);
+    if (folded == NULL) return NULL;
+    for (char* p = folded; *p; p++) *p = (char)tolower((unsigned char)*p);
+    return folded;
+}
+
+// Both IDs of a pair in one key, smaller first, so either order finds it.
+static uint64_t pair_key(uint32_t a, uint32_t b) {
+    uint32_t lo = a < b ? a : b;
+    uint32_t hi = a < b ? b : a;
+    return ((uint64_t)lo << 32) | hi;
+}
+
+static uint32_t pair_slot(const MysteryCase* mystery, uint64_t key) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mystery->pair_mask;
+}
+
+static uint32_t find_pair(const MysteryCase* mystery, uint64_t key) {
+    if (mystery->pair_slots == NULL) return 0;
+    for (uint32_t slot = pair_slot(mystery, key);; slot = (slot + 1) & mystery->pair_mask) {
+        uint32_t entry = mystery->pair_slots[slot];
+        if (entry == 0) return 0;
+        const MysteryCombination* comb = &mystery->combinations[entry - 1];
+        if (pair_key(comb->first, comb->second) == key) return entry;
+    }
+}
+
+// --- Compilation ---
+
+static bool add_name(MysteryCase* mystery, const char* name, int keyword, char* error, size_t error_size) {
+    char* folded = fold_case(name);
+    if (folded == NULL) return false;
+    int known = command_trie_find(mystery->names, folded, strlen(folded));
+    bool ok = (known < 0 || known == keyword) && command_trie_insert(mystery->names, folded, keyword);
+    if (!ok && known >= 0) set_error(error, error_size, "keyword name \"%s\" is used twice", name);
+    free(folded);
+    return ok;
+}
+
+static bool compile_keywords(MysteryCase* mystery, const cJSON* keywords, char* error, size_t error_size) {
+    int count = cJSON_GetArraySize(keywords);
+    if (!cJSON_IsArray(keywords) || count == 0) {
+        set_error(error, error_size, "\"keywords\" must be a non-empty array");
+        return false;
+    }
+    mystery->keywords = calloc((size_t)count, sizeof(MysteryKeyword));
+    if (mystery->keywords == NULL) return false;
+    const cJSON* item;
+    cJSON_ArrayForEach(item, keywords) {
+        const cJSON* id = cJSON_GetObjectItemCaseSensitive(item, "id");
+        const cJSON* name = cJSON_GetObjectItemCaseSensitive(item, "name");
+        if (!cJSON_IsString(id) || id->valuestring[0] == '\0') {
+            set_error(error, error_size, "keyword %d has no \"id\"", mystery->keyword_count + 1);
+            return false;
+        }
+        int index = mystery->keyword_count++;
+        MysteryKeyword* keyword = &mystery->keywords[index];
+        keyword->id = copy_string(id);
+        keyword->name = copy_string(cJSON_IsString(name) && name->valuestring[0] ? name : id);
+        keyword->hidden = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(item, "hidden"));
+        if (keyword->id == NULL || keyword->name == NULL) return false;
+        if (!add_name(mystery, keyword->id, index, error, error_size) ||
+            !add_name(mystery, keyword->name, index, error, error_size)) return false;
+    }
+    return true;
+}
+
+// Resolves a keyword reference by its id (names are for the player).
+static uint32_t keyword_ref(const MysteryCase* mystery, const cJSON* item) {
+    if (!cJSON_IsString(item)) return MYSTERY_NO_KEYWORD;
+    uint32_t keyword = mystery_case_find_keyword(mystery, item->valuestring);
+    if (keyword == MYSTERY_NO_KEYWORD || strcasecmp(mystery->keywords[keyword].id, item->valuestring) != 0) return MYSTERY_NO_KEYWORD;
+    return keyword;
+}
+
+static bool compile_combinations(MysteryCase* mystery, const cJSON* combinations, char* error, size_t error_size) {
+    int count = cJSON_GetArraySize(combinations);
+    if (combinations != NULL && !cJSON_IsArray(combinations)) {
+        set_error(error, error_size, "\"combinations\" must be an array");
+        return false;
+    }
+    uint32_t capacity = 8;
+    while (capacity < (uint32_t)count * 2) capacity <<= 1; // Kept at most half full
+    mystery->combinations = calloc((size_t)count + 1, sizeof(MysteryCombination));
+    mystery->pair_slots = calloc(capacity, sizeof(uint32_t));
+    if (mystery->combinations == NULL || mystery->pair_slots == NULL) return false;
+    mystery->pair_mask = capacity - 1;
+
+    const cJSON* item;
+    cJSON_ArrayForEach(item, combinations) {
+        int index = mystery->combination_count;
+        const cJSON* keywords = cJSON_GetObjectItemCaseSensitive(item, "keywords");
+        int arity = cJSON_GetArraySize(keywords);
+        if (!cJSON_IsArray(keywords) || arity < 1 || arity > 2) {
+            set_error(error, error_size, "combination %d must name one or two keywords", index + 1);
+            return false;
+        }
+        const cJSON* first_ref = cJSON_GetArrayItem(keywords, 0);
+        const cJSON* second_ref = cJSON_GetArrayItem(keywords, arity - 1);
+        uint32_t first = keyword_ref(mystery, first_ref);
+        uint32_t second = keyword_ref(mystery, second_ref);
+        if (first == MYSTERY_NO_KEYWORD || second == MYSTERY_NO_KEYWORD) {
+            const cJSON* bad = first == MYSTERY_NO_KEYWORD ? first_ref : second_ref;
+            set_error(error, error_size, "combination %d names unknown keyword \"%s\"", index + 1, cJSON_IsString(bad) ? bad->valuestring : "?");
+            return false;
+        }
+        if (arity == 2 && first == second) {
+            set_error(error, error_size, "combination %d pairs \"%s\" with itself", index + 1, mystery->keywords[first].id);
+            return false;
+        }
+        uint64_t key = pair_key(first, second);
+        uint32_t duplicate = find_pair(mystery, key);
+        if (duplicate != 0) {
+            set_error(error, error_size, "combinations %u and %d ask about the same keywords", duplicate, index + 1);
+            return false;
+        }
+
+        MysteryCombination* comb = &mystery->combinations[index];
+        comb->first = first < second ? first : second;
+        comb->second = first < second ? second : first;
+        comb->question = copy_string(cJSON_GetObjectItemCaseSensitive(item, "question"));
+        comb->answer = copy_string(cJSON_GetObjectItemCaseSensitive(item, "answer"));
+        mystery->combination_count++;
+        if (comb->question == NULL || comb->answer == NULL) return false;
+
+        const cJSON* reveals = cJSON_GetObjectItemCaseSensitive(item, "reveals");
+        int reveal_count = cJSON_GetArraySize(reveals);
+        if (reveal_count > 0) {
+            comb->reveals = malloc(sizeof(uint32_t) * (size_t)reveal_count);
+            if (comb->reveals == NULL) return false;
+            const cJSON* ref;
+            cJSON_ArrayForEach(ref, reveals) {
+                uint32_t keyword = keyword_ref(mystery, ref);
+                if (keyword == MYSTERY_NO_KEYWORD) {
+                    set_error(error, error_size, "combination %d reveals unknown keyword \"%s\"", index + 1, cJSON_IsString(ref) ? ref->valuestring : "?");
+                    return false;
+                }
+                comb->reveals[comb->reveal_count++] = keyword;
+            }
+        }
+
+        uint32_t slot = pair_slot(mystery, key);
+        while (mystery->pair_slots[slot] != 0) slot = (slot + 1) & mystery->pair_mask;
+        mystery->pair_slots[slot] = (uint32_t)index + 1;
+    }
+    return true;
+}
+
+static bool compile_quiz(MysteryCase* mystery, const cJSON* quiz, char* error, size_t error_size) {
+    int count = cJSON_GetArraySize(quiz);
+    if (!cJSON_IsArray(quiz) || count == 0) {
+        set_error(error, error_size, "\"quiz\" must be a non-empty array");
+        return false;
+    }
+    mystery->quiz = calloc((size_t)count, sizeof(MysteryQuizQuestion));
+    if (mystery->quiz == NULL) return false;
+    const cJSON* item;
+    cJSON_ArrayForEach(item, quiz) {
+        int index = mystery->quiz_count++;
+        MysteryQuizQuestion* q = &mystery->quiz[index];
+        const cJSON* options = cJSON_GetObjectItemCaseSensitive(item, "options");
+        const cJSON* correct = cJSON_GetObjectItemCaseSensitive(item, "correct");
+        int option_count = cJSON_GetArraySize(options);
+        if (!cJSON_IsArray(options) || option_count < 2) {
+            set_error(error, error_size, "quiz question %d needs at least two options", index + 1);
+            return false;
+        }
+        if (!cJSON_IsNumber(correct) || correct->valueint < 0 || correct->valueint >= option_count) {
+            set_error(error, error_size, "quiz question %d: \"correct\" must be an option index from 0 to %d", index + 1, option_count - 1);
+            return false;
+        }
+        q->question = copy_string(cJSON_GetObjectItemCaseSensitive(item, "question"));
+        q->options = calloc((size_t)option_count, sizeof(char*));
+        if (q->question == NULL || q->options == NULL) return false;
+        q->correct = correct->valueint;
+        const cJSON* option;
+        cJSON_ArrayForEach(option, options) {
+            if ((q->options[q->option_count++] = copy_string(option)) == NULL) return false;
+        }
+    }
+    return true;
+}
+
+// --- Public Functions ---
+
+MysteryCase* mystery_case_parse(const char* json, char* error, size_t error_size) {
+    set_error(error, error_size, "out of memory");
+    cJSON* root = json ? cJSON_Parse(json) : NULL;
+    if (root == NULL) {
+        set_error(error, error_size, "not valid JSON");
+        return NULL;
+    }
+    MysteryCase* mystery = calloc(1, sizeof(MysteryCase));
+    bool ok = mystery != NULL && (mystery->names = command_trie_create()) != NULL;
+    if (ok) {
+        mystery->title = copy_string(cJSON_GetObjectItemCaseSensitive(root, "title"));
+        mystery->story = copy_string(cJSON_GetObjectItemCaseSensitive(root, "story"));
+        ok = mystery->title != NULL && mystery->story != NULL &&
+             compile_keywords(mystery, cJSON_GetObjectItemCaseSensitive(root, "keywords"), error, error_size) &&
+             compile_combinations(mystery, cJSON_GetObjectItemCaseSensitive(root, "combinations"), error, error_size) &&
+             compile_quiz(mystery, cJSON_GetObjectItemCaseSensitive(root, "quiz"), error, error_size);
+    }
+    cJSON_Delete(root);
+    if (!ok) {
+        mystery_case_free(mystery);
+        return NULL;
+    }
+    LOG_DEBUG("Mystery case '%s': %d keywords, %d combinations in %u slots, %d quiz questions.",
+              mystery->title, mystery->keyword_count, mystery->combination_count, mystery->pair_mask + 1, mystery->quiz_count);
+    return mystery;
+}
+
+MysteryCase* mystery_case_load(const char* path, char* error, size_t error_size) {
+    char* json = NULL;
+    size_t size = 0;
+    if (!vfs_read(path, &json, &size)) {
+        set_error(error, error_size, "cannot read %s", path);
+        return NULL;
+    }
+    MysteryCase* mystery = mystery_case_parse(json, error, error_size);
+    free(json);
+    return mystery;
+}
+
+void mystery_case_free(MysteryCase* mystery) {
+    if (mystery == NULL) return;
+    for (int i = 0; i < mystery->keyword_count; i++) {
+        free(mystery->keywords[i].id);
+        free(mystery->keywords[i].name);
+    }
+    for (int i = 0; i < mystery->combination_count; i++) {
+        free(mystery->combinations[i].question);
+        free(mystery->combinations[i].answer);
+        free(mystery->combinations[i].reveals);
+    }
+    for (int i = 0; i < mystery->quiz_count; i++) {
+        for (int j = 0; j < mystery->quiz[i].option_count; j++) free(mystery->quiz[i].options[j]);
+        free(mystery->quiz[i].options);
+        free(mystery->quiz[i].question);
+    }
+    free(mystery->keywords);
+    free(mystery->combinations);
+    free(mystery->quiz);
+    free(mystery->pair_slots);
+    command_trie_free(mystery->names);
+    free(mystery->title);
+    free(mystery->story);
+    free(mystery);
+}
+
+void mystery_case_reset(MysteryCase* mystery) {
+    for (int i = 0; mystery && i < mystery->keyword_count; i++) mystery->keywords[i].revealed = false;
+}
+
+uint32_t mystery_case_find_keyword(const MysteryCase* mystery, const char* word) {
+    if (mystery == NULL || word == NULL || word[0] == '\0') return MYSTERY_NO_KEYWORD;
+    char* folded = fold_case(word);
+    if (folded == NULL) return MYSTERY_NO_KEYWORD;
+    int keyword = command_trie_find(mystery->names, folded, strlen(folded));
+    free(folded);
+    return keyword < 0 ? MYSTERY_NO_KEYWORD : (uint32_t)keyword;
+}
+
+bool mystery_case_keyword_visible(const MysteryCase* mystery, uint32_t keyword) {
+    if (mystery == NULL || keyword >= (uint32_t)mystery->keyword_count) return false;
+    return !mystery->keywords[keyword].hidden || mystery->keywords[keyword].revealed;
+}
+
+const MysteryCombination* mystery_case_lookup(const MysteryCase* mystery, uint32_t a, uint32_t b) {
+    if (mystery == NULL || a >= (uint32_t)mystery->keyword_count) return NULL;
+    if (b == MYSTERY_NO_KEYWORD) b = a;
+    else if (b >= (uint32_t)mystery->keyword_count) return NULL;
+    uint32_t entry = find_pair(mystery, pair_key(a, b));
+    return entry ? &mystery->combinations[entry - 1] : NULL;
+}
+
+int mystery_case_reveal(MysteryCase* mystery, const MysteryCombination* comb, uint32_t* revealed, int max) {
+    if (mystery == NULL || comb == NULL) return 0;
+    int count = 0;
+    for (int i = 0; i < comb->reveal_count; i++) {
+        MysteryKeyword* keyword = &mystery->keywords[comb->reveals[i]];
+        if (mystery_case_keyword_visible(mystery, comb->reveals[i])) continue;
+        keyword->revealed = true;
+        if (count < max && revealed) revealed[count] = comb->reveals[i];
+        count++;
+    }
+    return count;
+}
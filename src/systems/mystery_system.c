@@ -1,7 +1,10 @@
 #include "../include/systems/mystery_system.h"
+#include "systems/mystery_case.h"
 #include "render_utils.h"
-#include "linenoise.h"
+#include "task_scheduler.h"
+#include "world_vfs.h"
 #include "ansi_colors.h"
+#include "logger.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -9,199 +12,132 @@
 
 // --- Data Structures ---
 
-#define MAX_KEYWORDS 10
-#define MAX_COMBINATIONS 20
-#define MAX_KEYWORD_LEN 32
 #define MAX_TEXT_LEN 256
 
+// A case file under MYSTERY_CASE_DIR.
 typedef struct {
-    char id[MAX_KEYWORD_LEN];
-    char display_name[MAX_KEYWORD_LEN];
-    bool is_visible;
-} MysteryKeyword;
-
-typedef struct {
-    char keyword1_id[MAX_KEYWORD_LEN];
-    char keyword2_id[MAX_KEYWORD_LEN]; // Can be empty for single-keyword queries
-    char question[MAX_TEXT_LEN];
-    char answer[MAX_TEXT_LEN]; // "YES", "NO", "IRRELEVANT", or custom text
-} MysteryCombination;
-
-typedef struct {
-    char question[MAX_TEXT_LEN];
-    char options[3][MAX_TEXT_LEN];
-    int correct_option_index; // 0, 1, or 2
-} QuizQuestion;
-
-typedef struct {
-    char title[64];
-    char story_text[1024];
-    MysteryKeyword keywords[MAX_KEYWORDS];
-    int keyword_count;
-    MysteryCombination combinations[MAX_COMBINATIONS];
-    int combination_count;
-    QuizQuestion final_quiz[3]; // Fixed 3 questions for now
-    int quiz_count;
-} MysteryCase;
+    char filename[VFS_NAME_MAX];
+    MysteryCase* mystery;       // NULL if it could not be loaded
+    char error[MAX_TEXT_LEN];   // Why not, for whoever wrote it
+} CaseFile;
 
 // --- State ---
 
-static char selected_slot_1[MAX_KEYWORD_LEN] = {0};
-static char selected_slot_2[MAX_KEYWORD_LEN] = {0};
+static uint32_t selected_slot_1 = MYSTERY_NO_KEYWORD;
+static uint32_t selected_slot_2 = MYSTERY_NO_KEYWORD;
 static char last_response[MAX_TEXT_LEN] = {0};
 static char last_question[MAX_TEXT_LEN] = {0};
+static char last_reveal[MAX_TEXT_LEN] = {0};
 
-// --- Content (Hardcoded for Prototype) ---
+// Loaded on first use and again only after the world has changed.
+static CaseFile* g_cases = NULL;
+static int g_case_count = 0;
+static int g_case_capacity = 0;
+static uint32_t g_cases_generation = 0;
+static bool g_cases_listed = false;
 
-static MysteryCase g_case_01 = {
-    .title = "The Barman's Gun",
-    .story_text = "A man walks into a bar and asks for a glass of [water].\n"
-                  "The [bartender] pulls out a [gun] and points it at the [man].\n"
-                  "The man says '[thank_you]' and leaves.\n"
-                  "Why?",
-    .keywords = {
-        {"man", "Man", true},
-        {"water", "Water", true},
-        {"bartender", "Bartender", true},
-        {"gun", "Gun", true},
-        {"thank_you", "Thank You", true},
-        {"hiccups", "Hiccups", false} // Hidden keyword, revealed later?
-    },
-    .keyword_count = 6,
-    .combinations = {
-        // Simple 1-word queries (optional, but good for "What is this?")
-        {"water", "", "Did he want water to drink?", "NO"},
-        
-        // Combinations
-        {"man", "water", "Was the man thirsty?", "NO"},
-        {"man", "gun", "Was the man afraid of the gun?", "YES (Initially)"},
-        {"bartender", "gun", "Did the bartender want to kill the man?", "NO"},
-        {"bartender", "water", "Did the bartender refuse to give water?", "NO (He helped in another way)"},
-        {"gun", "water", "Was it a water gun?", "NO"},
-        {"man", "thank_you", "Was the man grateful for the gun?", "YES"},
-        {"gun", "thank_you", "Did the gun help the man?", "YES"},
-        
-        // The "Solution" combinations
-        {"gun", "shock", "Did the gun shock the man?", "YES (It cured him)"}, // "shock" isn't a keyword yet, assume implicit logic or add it
-    },
-    .combination_count = 8,
-    .final_quiz = {
-        {
-            "Why did the man ask for water?",
-            {"He was thirsty", "He had hiccups", "He wanted to clean a stain"},
-            1
-        },
-        {
-            "Why did the bartender pull a gun?",
-            {"To rob the man", "To scare the man", "To clean the gun"},
-            1
-        },
-        {
-            "Why did the man say thank you?",
-            {"He likes guns", "He was suicidal", "His hiccups were cured"},
-            2
-        }
-    },
-    .quiz_count = 3
-};
+// --- Case Files ---
+
+static void add_case_file(const VfsEntry* ent, void* context) {
+    (void)context;
+    size_t len = strlen(ent->name);
+    size_t ext_len = strlen(MYSTERY_CASE_EXTENSION);
+    if (ent->is_dir || len <= ext_len || strcmp(ent->name + len - ext_len, MYSTERY_CASE_EXTENSION) != 0) return;
+
+    if (g_case_count == g_case_capacity) {
+        int capacity = g_case_capacity ? g_case_capacity * 2 : 4;
+        CaseFile* grown = realloc(g_cases, sizeof(CaseFile) * capacity);
+        if (grown == NULL) return;
+        g_cases = grown;
+        g_case_capacity = capacity;
+    }
+    CaseFile* file = &g_cases[g_case_count++];
+    snprintf(file->filename, sizeof(file->filename), "%s", ent->name);
+    file->error[0] = '\0';
+    char path[VFS_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", MYSTERY_CASE_DIR, ent->name);
+    file->mystery = mystery_case_load(path, file->error, sizeof(file->error));
+    if (file->mystery == NULL) logger_log("Mystery case %s: %s", path, file->error);
+}
+
+static void refresh_cases() {
+    if (g_cases_listed && g_cases_generation == vfs_generation()) return;
+    for (int i = 0; i < g_case_count; i++) mystery_case_free(g_cases[i].mystery);
+    g_case_count = 0;
+    vfs_list(MYSTERY_CASE_DIR, add_case_file, NULL); // In name order
+    g_cases_generation = vfs_generation();
+    g_cases_listed = true;
+}
 
 // --- Helper Functions ---
 
 static void clear_slots() {
-    memset(selected_slot_1, 0, sizeof(selected_slot_1));
-    memset(selected_slot_2, 0, sizeof(selected_slot_2));
+    selected_slot_1 = MYSTERY_NO_KEYWORD;
+    selected_slot_2 = MYSTERY_NO_KEYWORD;
 }
 
-static MysteryKeyword* find_keyword(const char* name) {
-    for (int i = 0; i < g_case_01.keyword_count; i++) {
-        // Check both ID and Display Name (case insensitive)
-        if (strcasecmp(g_case_01.keywords[i].id, name) == 0 || 
-            strcasecmp(g_case_01.keywords[i].display_name, name) == 0) {
-            return &g_case_01.keywords[i];
-        }
-    }
-    return NULL;
+static void clear_interaction() {
+    memset(last_response, 0, sizeof(last_response));
+    memset(last_question, 0, sizeof(last_question));
+    memset(last_reveal, 0, sizeof(last_reveal));
 }
 
-static void check_combination() {
-    if (strlen(selected_slot_1) == 0) return;
+static void check_combination(MysteryCase* mystery) {
+    if (selected_slot_1 == MYSTERY_NO_KEYWORD) return;
+    const char* k1 = mystery->keywords[selected_slot_1].name;
+    const char* k2 = selected_slot_2 != MYSTERY_NO_KEYWORD ? mystery->keywords[selected_slot_2].name : NULL;
 
-    // Normalize order: Alphabetical sort to ensure "man + water" == "water + man"
-    char* k1 = selected_slot_1;
-    char* k2 = selected_slot_2;
-    if (strlen(k2) > 0 && strcmp(k1, k2) > 0) {
-        char* temp = k1;
-        k1 = k2;
-        k2 = temp;
-    }
-
-    // Search combinations
-    for (int i = 0; i < g_case_01.combination_count; i++) {
-        MysteryCombination* comb = &g_case_01.combinations[i];
-        
-        bool match = false;
-        if (strlen(k2) == 0) {
-            // Single keyword match
-            if (strcmp(comb->keyword1_id, k1) == 0 && strlen(comb->keyword2_id) == 0) match = true;
-        } else {
-            // Double keyword match
-            // The database must store them in a consistent order or we check both ways.
-            // Since we sorted k1/k2, we assume database is unordered or we check both.
-            // Let's check both directions to be safe.
-            if ((strcmp(comb->keyword1_id, k1) == 0 && strcmp(comb->keyword2_id, k2) == 0) ||
-                (strcmp(comb->keyword1_id, k2) == 0 && strcmp(comb->keyword2_id, k1) == 0)) {
-                match = true;
-            }
-        }
+    last_reveal[0] = '\0';
+    const MysteryCombination* comb = mystery_case_lookup(mystery, selected_slot_1, selected_slot_2);
+    if (comb) {
+        snprintf(last_question, MAX_TEXT_LEN, "%s", comb->question);
+        snprintf(last_response, MAX_TEXT_LEN, "%s", comb->answer);
 
-        if (match) {
-            strncpy(last_question, comb->question, MAX_TEXT_LEN - 1);
-            strncpy(last_response, comb->answer, MAX_TEXT_LEN - 1);
-            
-            // Special logic for revealing info (prototype hacking)
-            if (strcmp(comb->answer, "YES (It cured him)") == 0) {
-                // Unlock hint?
-            }
-            return;
+        uint32_t revealed[8];
+        int count = mystery_case_reveal(mystery, comb, revealed, 8);
+        size_t used = (size_t)snprintf(last_reveal, MAX_TEXT_LEN, "%s", count > 0 ? "NEW KEYWORD:" : "");
+        for (int i = 0; i < count && i < 8 && used < MAX_TEXT_LEN; i++) {
+            used += (size_t)snprintf(last_reveal + used, MAX_TEXT_LEN - used, " [%s]", mystery->keywords[revealed[i]].name);
         }
+        return;
     }
 
     // No match found
-    if (strlen(k2) > 0) {
+    if (k2) {
         snprintf(last_question, MAX_TEXT_LEN, "Is there a connection between %s and %s?", k1, k2);
+        snprintf(last_response, MAX_TEXT_LEN, "The connection is unclear... (Try a different pair)");
     } else {
-        snprintf(last_question, MAX_TEXT_LEN, "Is %s relevant?", k1);
+        clear_interaction(); // One word alone says nothing yet
     }
-    strncpy(last_response, "The connection is unclear... (Try a different pair)", MAX_TEXT_LEN - 1);
 }
 
-static void render_mystery_screen() {
+static void render_mystery_screen(const MysteryCase* mystery, int case_number) {
     clear_screen();
-    printf(ANSI_COLOR_CYAN "=== MYSTERY APP: CASE 001 ===\n" ANSI_COLOR_RESET);
-    printf(ANSI_COLOR_YELLOW "%s\n\n" ANSI_COLOR_RESET, g_case_01.title);
+    printf(ANSI_COLOR_CYAN "=== MYSTERY APP: CASE %03d ===\n" ANSI_COLOR_RESET, case_number);
+    printf(ANSI_COLOR_YELLOW "%s\n\n" ANSI_COLOR_RESET, mystery->title);
     
     // Render Story with highlighted keywords
     // For prototype, just print raw text. A real version would parse [] and colorize.
-    printf("%s\n", g_case_01.story_text);
+    printf("%s\n", mystery->story);
     printf("----------------------------------------\n");
     
     // Render Keywords "Toolbar"
     printf("KEYWORDS: ");
-    for (int i = 0; i < g_case_01.keyword_count; i++) {
-        if (g_case_01.keywords[i].is_visible) {
-            printf("[%s] ", g_case_01.keywords[i].display_name);
+    for (int i = 0; i < mystery->keyword_count; i++) {
+        if (mystery_case_keyword_visible(mystery, (uint32_t)i)) {
+            printf("[%s] ", mystery->keywords[i].name);
         }
     }
     printf("\n----------------------------------------\n");
 
     // Render "Thinking Slot"
     printf("THINKING: ");
-    if (strlen(selected_slot_1) > 0) printf("[%s] ", selected_slot_1); 
+    if (selected_slot_1 != MYSTERY_NO_KEYWORD) printf("[%s] ", mystery->keywords[selected_slot_1].name);
     else printf("[   ] ");
     
     printf("+ ");
     
-    if (strlen(selected_slot_2) > 0) printf("[%s] ", selected_slot_2); 
+    if (selected_slot_2 != MYSTERY_NO_KEYWORD) printf("[%s] ", mystery->keywords[selected_slot_2].name);
     else printf("[   ] ");
     
     printf("\n");
@@ -210,37 +146,40 @@ static void render_mystery_screen() {
     // Render Last Interaction
     if (strlen(last_question) > 0) {
         printf("Q: %s\n", last_question);
+    }
+    if (strlen(last_response) > 0) {
         printf("A: %s%s%s\n", ANSI_COLOR_GREEN, last_response, ANSI_COLOR_RESET);
     }
+    if (strlen(last_reveal) > 0) {
+        printf("%s%s%s\n", ANSI_COLOR_YELLOW, last_reveal, ANSI_COLOR_RESET);
+    }
     
     printf("\nCommands: 'touch <word>', 'clear', 'solve', 'exit'\n");
 }
 
-static bool run_quiz() {
+static bool run_quiz(const MysteryCase* mystery) {
     clear_screen();
     printf(ANSI_COLOR_CYAN "=== FINAL DEDUCTION ===\n\n" ANSI_COLOR_RESET);
     
-    for (int i = 0; i < g_case_01.quiz_count; i++) {
-        QuizQuestion* q = &g_case_01.final_quiz[i];
+    for (int i = 0; i < mystery->quiz_count; i++) {
+        const MysteryQuizQuestion* q = &mystery->quiz[i];
         printf("Q%d: %s\n", i + 1, q->question);
-        for (int j = 0; j < 3; j++) {
+        for (int j = 0; j < q->option_count; j++) {
             printf("  %d) %s\n", j + 1, q->options[j]);
         }
         
-        char buf[16];
+        char prompt[32];
+        snprintf(prompt, sizeof(prompt), "Choice (1-%d): ", q->option_count);
+        char line[16];
         int choice = 0;
         do {
-            printf("Choice (1-3): ");
-            char* line = linenoise("");
-            if (line) {
-                choice = atoi(line);
-                free(line);
-            }
-        } while (choice < 1 || choice > 3);
+            if (!task_read_line(prompt, line, sizeof(line))) return false; // EOF
+            choice = atoi(line);
+        } while (choice < 1 || choice > q->option_count);
         
-        if (choice - 1 != q->correct_option_index) {
+        if (choice - 1 != q->correct) {
             printf(ANSI_COLOR_RED "\nINCORRECT! The truth is still lost in the Wired...\n" ANSI_COLOR_RESET);
-            usleep(2000000);
+            task_sleep_ms(2000);
             return false;
         }
         printf(ANSI_COLOR_GREEN "CORRECT!\n\n" ANSI_COLOR_RESET);
@@ -249,72 +188,59 @@ static bool run_quiz() {
     return true;
 }
 
-// --- Main Loop ---
-
-void enter_mystery_app(GameState* game_state) {
+// Plays one case until it is solved or left. Returns false on EOF.
+static bool play_case(MysteryCase* mystery, int case_number) {
     char input[MAX_LINE_LENGTH];
     bool running = true;
     
     // Reset state
     clear_slots();
-    memset(last_response, 0, sizeof(last_response));
-    memset(last_question, 0, sizeof(last_question));
+    clear_interaction();
+    mystery_case_reset(mystery);
     
     while (running) {
-        render_mystery_screen();
+        render_mystery_screen(mystery, case_number);
         
-        char* line = linenoise("MYSTERY> ");
-        if (line == NULL) break;
-        strncpy(input, line, sizeof(input) - 1);
-        free(line);
+        if (!task_read_line("MYSTERY> ", input, sizeof(input))) return false;
         
         if (strcmp(input, "exit") == 0 || strcmp(input, "quit") == 0) {
             running = false;
         } 
         else if (strcmp(input, "clear") == 0) {
             clear_slots();
-            memset(last_response, 0, sizeof(last_response));
-            memset(last_question, 0, sizeof(last_question));
+            clear_interaction();
         }
         else if (strcmp(input, "solve") == 0) {
-            if (run_quiz()) {
+            if (run_quiz(mystery)) {
                 clear_screen();
                 printf(ANSI_COLOR_GREEN "\n=== CASE SOLVED ===\n" ANSI_COLOR_RESET);
                 printf("Congratulations, Lain. You have uncovered the truth.\n");
-                printf("(Press ENTER to return)");
-                (void)getchar();
+                task_wait_enter("(Press ENTER to return)");
                 running = false;
             }
         }
         else if (strncmp(input, "touch ", 6) == 0) {
             char* word = input + 6;
-            MysteryKeyword* kw = find_keyword(word);
-            if (kw) {
-                if (strlen(selected_slot_1) == 0) {
-                    strncpy(selected_slot_1, kw->id, MAX_KEYWORD_LEN - 1);
-                } else if (strlen(selected_slot_2) == 0) {
-                    // Prevent adding same word twice? No, maybe useful for self-reference?
-                    // Let's prevent for now to avoid confusion
-                    if (strcmp(selected_slot_1, kw->id) != 0) {
-                        strncpy(selected_slot_2, kw->id, MAX_KEYWORD_LEN - 1);
-                        check_combination();
-                        // Auto-clear after checking? Or let user clear?
-                        // Let's auto-clear so they can try next pair immediately
-                        // But wait, they need to see the result.
-                        // We render result in next frame.
-                        // We should probably NOT clear automatically so they see what they asked.
-                        // But then they have to type 'clear'.
-                        // Better UX: Wait for a keypress or "touch" again clears it?
-                        // Let's keep it simple: It stays filled. If they 'touch' again, we shift?
-                        // "FIFO": If full, clear slot 1, move slot 2 to 1, add new to 2.
+            uint32_t kw = mystery_case_find_keyword(mystery, word);
+            // Hidden keywords do not exist for the player until revealed.
+            if (kw != MYSTERY_NO_KEYWORD && mystery_case_keyword_visible(mystery, kw)) {
+                if (selected_slot_1 == MYSTERY_NO_KEYWORD) {
+                    selected_slot_1 = kw;
+                    check_combination(mystery);
+                } else if (selected_slot_2 == MYSTERY_NO_KEYWORD) {
+                    // Pairing a word with itself asks nothing new.
+                    if (selected_slot_1 != kw) {
+                        selected_slot_2 = kw;
+                        check_combination(mystery);
                     } else {
                          snprintf(last_response, MAX_TEXT_LEN, "(You already selected that)");
                     }
                 } else {
                     // Slots full, FIFO shift
-                    strncpy(selected_slot_1, selected_slot_2, MAX_KEYWORD_LEN - 1);
-                    strncpy(selected_slot_2, kw->id, MAX_KEYWORD_LEN - 1);
-                    check_combination();
+                    selected_slot_1 = selected_slot_2;
+                    selected_slot_2 = kw;
+                    if (selected_slot_1 == selected_slot_2) selected_slot_2 = MYSTERY_NO_KEYWORD;
+                    check_combination(mystery);
                 }
             } else {
                 snprintf(last_response, MAX_TEXT_LEN, "Keyword '%s' not found.", word);
@@ -324,4 +250,46 @@ void enter_mystery_app(GameState* game_state) {
              snprintf(last_response, MAX_TEXT_LEN, "Unknown command. Try 'touch <word>'");
         }
     }
+    return true;
+}
+
+// Lists the installed cases; returns the index picked, or -1 to leave.
+static int pick_case() {
+    char input[MAX_LINE_LENGTH];
+    for (;;) {
+        clear_screen();
+        printf(ANSI_COLOR_CYAN "=== MYSTERY APP ===\n\n" ANSI_COLOR_RESET);
+        for (int i = 0; i < g_case_count; i++) {
+            if (g_cases[i].mystery) printf("  %d) %s\n", i + 1, g_cases[i].mystery->title);
+            else printf(ANSI_COLOR_RED "  %d) %s: %s\n" ANSI_COLOR_RESET, i + 1, g_cases[i].filename, g_cases[i].error);
+        }
+        printf("\nCommands: '<number>', 'exit'\n");
+
+        if (!task_read_line("CASE> ", input, sizeof(input))) return -1;
+        if (strcmp(input, "exit") == 0 || strcmp(input, "quit") == 0) return -1;
+        int choice = atoi(input);
+        if (choice >= 1 && choice <= g_case_count && g_cases[choice - 1].mystery) return choice - 1;
+    }
+}
+
+// --- Main Loop ---
+
+void enter_mystery_app(GameState* game_state) {
+    (void)game_state;
+    refresh_cases();
+
+    if (g_case_count == 1 && g_cases[0].mystery) {
+        play_case(g_cases[0].mystery, 1);
+        return;
+    }
+    if (g_case_count == 0) {
+        clear_screen();
+        printf(ANSI_COLOR_YELLOW "No cases installed in %s.\n" ANSI_COLOR_RESET, MYSTERY_CASE_DIR);
+        task_wait_enter("(Press ENTER to return)");
+        return;
+    }
+    int chosen;
+    while ((chosen = pick_case()) >= 0) {
+        if (!play_case(g_cases[chosen].mystery, chosen + 1)) break;
+    }
 }
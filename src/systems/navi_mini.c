@@ -5,7 +5,7 @@
 #include "string_table.h"
 #include "string_ids.h"      // Required for string IDs
 #include "render_utils.h"
-#include "linenoise.h"
+#include "task_scheduler.h"
 #include "flag_system.h"
 #include "ansi_colors.h"
 #include "executor.h"       // Required to call execute_action
@@ -13,7 +13,6 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <unistd.h>
 
 // --- Constants ---
 #define NAVI_PROMPT "NAVI> "
@@ -23,23 +22,14 @@
 
 // --- Helper Functions ---
 
-static void get_next_navi_input(char* buffer, int buffer_size) {
+static void get_next_navi_input(const char* prompt, char* buffer, int buffer_size) {
     memset(buffer, 0, buffer_size);
 
     if (g_argc > *g_arg_index_ptr) {
         strncpy(buffer, g_argv[*g_arg_index_ptr], buffer_size - 1);
         (*g_arg_index_ptr)++;
-    } else {
-        char *line = linenoise(NAVI_PROMPT);
-        if (line != NULL) {
-            if (strlen(line) > 0) {
-                // linenoiseHistoryAdd(line);
-            }
-            strncpy(buffer, line, buffer_size - 1);
-            free(line);
-        } else {
-            strncpy(buffer, "exit", buffer_size - 1);
-        }
+    } else if (!task_read_line(prompt, buffer, buffer_size)) {
+        strncpy(buffer, "exit", buffer_size - 1);
     }
 }
 
@@ -93,13 +83,13 @@ void enter_navi_mini(GameState* game_state) {
     // Boot animation
     clear_screen();
     printf("%sBooting NAVI mini...\n%s", COLOR_NAVI_SYSTEM, ANSI_COLOR_RESET);
-    usleep(500000); // 0.5s
+    task_sleep_ms(500); // 0.5s
     
     while (running) {
         print_header(game_state);
         print_menu();
 
-        get_next_navi_input(line, sizeof(line));
+        get_next_navi_input(NAVI_PROMPT, line, sizeof(line));
 
         // Parse command
         if (strcmp(line, "exit") == 0 || strcmp(line, "0") == 0 || strcmp(line, "quit") == 0) {
@@ -115,12 +105,12 @@ void enter_navi_mini(GameState* game_state) {
             running = 0; // Exit after executing action
         } else if (strlen(line) > 0) {
             printf("%sUnknown command: '%s'\n%s", COLOR_NAVI_ERROR, line, ANSI_COLOR_RESET);
-            usleep(800000); // Wait a bit so user sees error
+            task_sleep_ms(800); // Wait a bit so user sees error
         }
     }
     
     printf("%sShutting down interface...\n%s", COLOR_NAVI_SYSTEM, ANSI_COLOR_RESET);
-    usleep(300000);
+    task_sleep_ms(300);
     // Do not clear screen, so the main game can re-render over it.
     LOG_DEBUG("Exiting NAVI mini interface.");
 }
@@ -1,265 +1,590 @@
 #include "systems/navi_shell.h"
 #include "render_utils.h"
-#include "game_paths.h" // For ensure_directory_exists
 #include "ansi_colors.h"
-#include "linenoise.h"
+#include "task_scheduler.h"
+#include "command_registry.h"
+#include "world_vfs.h"
+#include "text_index.h"
+#include "logger.h"
+#include "cJSON.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <unistd.h>
-#include <dirent.h>
-#include <sys/stat.h>
-#include <errno.h>
-#include <limits.h>
+#include <fnmatch.h>
 
 #define SHELL_PROMPT_COLOR ANSI_COLOR_GREEN
 #define SHELL_PATH_COLOR ANSI_COLOR_BLUE
 #define SHELL_ERROR_COLOR ANSI_COLOR_RED
 
-// Virtual root path inside the project
-#define VIRTUAL_ROOT "world"
+// Directories the NAVI needs a higher credit level to list or read under.
+#define FS_ACCESS_FILE "/etc/fs_access.json"
+#define FS_ACCESS_MAX_RULES 32
 
-// Maximum path length for virtual paths
-#define MAX_VIRTUAL_PATH 256
+#define SEARCH_MAX_SHOWN 20
+#define SEARCH_LINE_MAX 160 // Bytes of a matching line shown
 
 typedef struct {
-    char current_virtual_path[MAX_VIRTUAL_PATH]; // e.g., "/home/lain"
-    char physical_root_path[MAX_PATH_LENGTH];    // Absolute path to project root/world
+    char path[VFS_PATH_MAX];
+    int list_level;
+    int read_level;
+} AccessRule;
+
+// Paths are virtual and resolved by the world image alone (world_vfs.h), so
+// nothing typed here can reach the host filesystem.
+typedef struct {
+    char current_virtual_path[VFS_PATH_MAX]; // e.g., "/home/lain"
+    bool running;
+
+    // Entries of the directory last completed in ("name" or "name/"), for Tab.
+    CommandTrie* entries;
+    char entries_path[VFS_PATH_MAX];
+
+    int level; // The player's credit level
+    AccessRule rules[FS_ACCESS_MAX_RULES];
+    int rule_count;
+
+    // Readable files, indexed on the first grep or search and again once the
+    // world has changed; a document's ID is its place in 'doc_paths'.
+    TextIndex* index;
+    char (*doc_paths)[VFS_PATH_MAX];
+    int doc_count;
+    uint32_t index_generation; // vfs_generation() the index was built at
 } ShellState;
 
-static void get_absolute_path(const ShellState* state, const char* virtual_path, char* out_path, size_t size) {
-    // Construct absolute physical path: physical_root_path + virtual_path
-    // Remove leading slash from virtual_path if present to avoid double slash
-    const char* vpath = virtual_path;
-    if (vpath[0] == '/') vpath++;
-    
-    snprintf(out_path, size, "%s/%s", state->physical_root_path, vpath);
+static bool resolve_arg(const ShellState* state, const char* arg, char* out) {
+    return vfs_resolve(state->current_virtual_path, arg ? arg : ".", out, VFS_PATH_MAX);
 }
 
-static void normalize_path(char* path) {
-    // Basic path normalization (handling .. and .)
-    // This is a simple implementation for the shell simulation.
-    // For a real shell, realpath() would be used on the physical path, 
-    // but here we want to maintain the illusion of the virtual path.
-    // ... Actually, resolving the physical path with realpath is safer 
-    // to prevent breaking out of the sandbox.
+static bool join_path(const char* dir, const char* name, char* out) {
+    int n = snprintf(out, VFS_PATH_MAX, "%s/%s", strcmp(dir, "/") == 0 ? "" : dir, name);
+    return n > 0 && n < VFS_PATH_MAX;
 }
 
-static void cmd_ls(ShellState* state, const char* arg) {
-    char target_vpath[MAX_VIRTUAL_PATH];
-    char physical_path[MAX_PATH_LENGTH];
+// 'path' is 'dir' or somewhere below it.
+static bool path_within(const char* path, const char* dir) {
+    size_t len = strlen(dir);
+    if (strcmp(dir, "/") == 0) return true;
+    return strncmp(path, dir, len) == 0 && (path[len] == '\0' || path[len] == '/');
+}
+
+// --- Access ---
+
+static void load_access_rules(ShellState* state) {
+    state->rule_count = 0;
+    char* json = NULL;
+    if (!vfs_read(FS_ACCESS_FILE, &json, NULL)) return;
+    cJSON* root = cJSON_Parse(json);
+    free(json);
+    if (!cJSON_IsObject(root)) {
+        LOG_DEBUG("%s is not a JSON object; no access rules.", FS_ACCESS_FILE);
+        cJSON_Delete(root);
+        return;
+    }
+    const cJSON* item;
+    cJSON_ArrayForEach(item, root) {
+        if (state->rule_count == FS_ACCESS_MAX_RULES) break;
+        AccessRule* rule = &state->rules[state->rule_count];
+        if (item->string == NULL || item->string[0] != '/' || !vfs_resolve("/", item->string, rule->path, sizeof(rule->path))) continue;
+        const cJSON* list_level = cJSON_GetObjectItemCaseSensitive(item, "list_level");
+        const cJSON* read_level = cJSON_GetObjectItemCaseSensitive(item, "read_level");
+        rule->list_level = cJSON_IsNumber(list_level) ? list_level->valueint : 0;
+        rule->read_level = cJSON_IsNumber(read_level) ? read_level->valueint : 0;
+        state->rule_count++;
+    }
+    cJSON_Delete(root);
+}
+
+// The rule for the deepest directory holding 'path', or NULL.
+static const AccessRule* access_rule(const ShellState* state, const char* path) {
+    const AccessRule* best = NULL;
+    for (int i = 0; i < state->rule_count; i++) {
+        const AccessRule* rule = &state->rules[i];
+        if (path_within(path, rule->path) && (best == NULL || strlen(rule->path) > strlen(best->path))) best = rule;
+    }
+    return best;
+}
+
+static bool can_list(const ShellState* state, const char* dir) {
+    const AccessRule* rule = access_rule(state, dir);
+    return rule == NULL || state->level >= rule->list_level;
+}
 
-    // Determine target path
-    if (arg == NULL || strlen(arg) == 0) {
-        strncpy(target_vpath, state->current_virtual_path, MAX_VIRTUAL_PATH - 1);
+static bool can_read(const ShellState* state, const char* file) {
+    const AccessRule* rule = access_rule(state, file);
+    return rule == NULL || state->level >= rule->read_level;
+}
+
+// Calls 'fn' for everything below 'dir' the player may see, depth first in
+// name order, skipping directories they may not list.
+typedef void (*WalkFunc)(const char* path, const VfsEntry* entry, void* context);
+
+typedef struct {
+    const ShellState* state;
+    const char* dir;
+    WalkFunc fn;
+    void* context;
+} Walk;
+
+static void walk_entry(const VfsEntry* entry, void* context) {
+    const Walk* walk = context;
+    char path[VFS_PATH_MAX];
+    if (!join_path(walk->dir, entry->name, path)) return;
+    walk->fn(path, entry, walk->context);
+    if (entry->is_dir && can_list(walk->state, path)) {
+        Walk child = *walk;
+        child.dir = path;
+        vfs_list(path, walk_entry, &child);
+    }
+}
+
+static void walk_tree(const ShellState* state, const char* dir, WalkFunc fn, void* context) {
+    if (!can_list(state, dir)) return;
+    Walk walk = { state, dir, fn, context };
+    vfs_list(dir, walk_entry, &walk);
+}
+
+static void print_entry(const VfsEntry* entry, void* context) {
+    (void)context;
+    if (entry->is_dir) {
+        printf(ANSI_COLOR_BLUE "%s/  " ANSI_COLOR_RESET, entry->name);
+    } else if (entry->is_exec) {
+        printf(ANSI_COLOR_GREEN "%s*  " ANSI_COLOR_RESET, entry->name);
     } else {
-        // Handle absolute vs relative path
-        if (arg[0] == '/') {
-            strncpy(target_vpath, arg, MAX_VIRTUAL_PATH - 1);
-        } else {
-            snprintf(target_vpath, MAX_VIRTUAL_PATH, "%s/%s", state->current_virtual_path, arg);
-        }
+        printf("%s  ", entry->name);
     }
+}
 
-    get_absolute_path(state, target_vpath, physical_path, MAX_PATH_LENGTH);
-
-    DIR* dir = opendir(physical_path);
-    if (dir) {
-        struct dirent* entry;
-        while ((dir && (entry = readdir(dir)) != NULL)) {
-            // Skip . and ..
-            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
-
-            // Check if it's a directory
-            char full_entry_path[MAX_PATH_LENGTH];
-            snprintf(full_entry_path, MAX_PATH_LENGTH, "%s/%s", physical_path, entry->d_name);
-            
-            struct stat st;
-            if (stat(full_entry_path, &st) == 0) {
-                if (S_ISDIR(st.st_mode)) {
-                    printf(ANSI_COLOR_BLUE "%s/  " ANSI_COLOR_RESET, entry->d_name);
-                } else if (st.st_mode & S_IXUSR) {
-                    printf(ANSI_COLOR_GREEN "%s*  " ANSI_COLOR_RESET, entry->d_name);
-                } else {
-                    printf("%s  ", entry->d_name);
-                }
-            } else {
-                printf("%s  ", entry->d_name);
-            }
+static void cmd_ls(ShellState* state, const char* arg) {
+    char target_vpath[VFS_PATH_MAX];
+    VfsEntry target;
+    if (!resolve_arg(state, arg, target_vpath) || !vfs_stat(target_vpath, &target)) {
+        printf(SHELL_ERROR_COLOR "ls: cannot access '%s': No such file or directory\n" ANSI_COLOR_RESET, arg ? arg : ".");
+        return;
+    }
+    if (target.is_dir) {
+        if (!can_list(state, target_vpath)) {
+            printf(SHELL_ERROR_COLOR "ls: cannot open directory '%s': Permission denied\n" ANSI_COLOR_RESET, arg ? arg : ".");
+            return;
         }
-        printf("\n");
-        closedir(dir);
+        vfs_list(target_vpath, print_entry, NULL);
     } else {
-        printf(SHELL_ERROR_COLOR "ls: cannot access '%s': No such file or directory\n" ANSI_COLOR_RESET, arg ? arg : ".");
+        print_entry(&target, NULL);
     }
+    printf("\n");
 }
 
 static void cmd_cd(ShellState* state, const char* arg) {
     if (arg == NULL) {
         // cd with no args goes to home? default to /home
-        strncpy(state->current_virtual_path, "/home", MAX_VIRTUAL_PATH - 1);
+        strncpy(state->current_virtual_path, "/home", VFS_PATH_MAX - 1);
         return;
     }
 
-    char new_vpath[MAX_VIRTUAL_PATH];
-    if (arg[0] == '/') {
-        strncpy(new_vpath, arg, MAX_VIRTUAL_PATH - 1);
+    char new_vpath[VFS_PATH_MAX];
+    VfsEntry target;
+    if (!resolve_arg(state, arg, new_vpath) || !vfs_stat(new_vpath, &target)) {
+        printf(SHELL_ERROR_COLOR "cd: %s: No such file or directory\n" ANSI_COLOR_RESET, arg);
+    } else if (!target.is_dir) {
+        printf(SHELL_ERROR_COLOR "cd: %s: Not a directory\n" ANSI_COLOR_RESET, arg);
+    } else if (!can_list(state, new_vpath)) {
+        printf(SHELL_ERROR_COLOR "cd: %s: Permission denied\n" ANSI_COLOR_RESET, arg);
     } else {
-        // Handle ".."
-        if (strcmp(arg, "..") == 0) {
-            // Find last slash
-            char* last_slash = strrchr(state->current_virtual_path, '/');
-            if (last_slash != NULL && last_slash != state->current_virtual_path) {
-                *last_slash = '\0';
-                strncpy(new_vpath, state->current_virtual_path, MAX_VIRTUAL_PATH - 1);
-                *last_slash = '/'; // Restore just in case
-            } else {
-                // Root
-                strncpy(new_vpath, "/", MAX_VIRTUAL_PATH - 1);
-            }
-        } else if (strcmp(arg, ".") == 0) {
-            return;
-        } else {
-            if (strcmp(state->current_virtual_path, "/") == 0) {
-                 snprintf(new_vpath, MAX_VIRTUAL_PATH, "/%s", arg);
-            } else {
-                 snprintf(new_vpath, MAX_VIRTUAL_PATH, "%s/%s", state->current_virtual_path, arg);
-            }
-        }
+        snprintf(state->current_virtual_path, sizeof(state->current_virtual_path), "%s", new_vpath);
     }
+}
 
-    // Verify existence and ensure it is inside root
-    char physical_path[MAX_PATH_LENGTH];
-    get_absolute_path(state, new_vpath, physical_path, MAX_PATH_LENGTH);
-    
-    // Resolve ".." in physical path to check for jailbreak attempt
-    char resolved_path[MAX_PATH_LENGTH];
-    if (realpath(physical_path, resolved_path) == NULL) {
-         printf(SHELL_ERROR_COLOR "cd: %s: No such file or directory\n" ANSI_COLOR_RESET, arg);
-         return;
+static void cmd_cat(ShellState* state, const char* arg) {
+    if (arg == NULL) {
+        printf("cat: missing operand\n");
+        return;
     }
 
-    // Security check: ensure resolved path starts with physical_root_path
-    // Note: realpath might resolve symlinks, so we must compare against resolved root
-    char resolved_root[MAX_PATH_LENGTH];
-    if (realpath(state->physical_root_path, resolved_root) == NULL) {
-        printf(SHELL_ERROR_COLOR "Error resolving root path\n" ANSI_COLOR_RESET);
+    char target_vpath[VFS_PATH_MAX];
+    VfsEntry target;
+    if (!resolve_arg(state, arg, target_vpath) || !vfs_stat(target_vpath, &target)) {
+        printf(SHELL_ERROR_COLOR "cat: %s: No such file or directory\n" ANSI_COLOR_RESET, arg);
         return;
     }
-
-    if (strncmp(resolved_path, resolved_root, strlen(resolved_root)) != 0) {
-        printf(SHELL_ERROR_COLOR "cd: Access denied (Outside of world)\n" ANSI_COLOR_RESET);
+    if (!target.is_dir && !can_read(state, target_vpath)) {
+        printf(SHELL_ERROR_COLOR "cat: %s: Permission denied\n" ANSI_COLOR_RESET, arg);
+        return;
+    }
+    char* data = NULL;
+    size_t size = 0;
+    if (target.is_dir || !vfs_read(target_vpath, &data, &size)) {
+        printf(SHELL_ERROR_COLOR "cat: %s: %s\n" ANSI_COLOR_RESET, arg, target.is_dir ? "Is a directory" : "Read error");
         return;
     }
+    fwrite(data, 1, size, stdout);
+    printf("\n");
+    free(data);
+}
 
-    struct stat st;
-    if (stat(resolved_path, &st) == 0 && S_ISDIR(st.st_mode)) {
-        // Update virtual path (simplified, doesn't perfectly handle complex relative paths like a/b/../c)
-        // ideally we should reconstruct virtual path from resolved path relative to root
-        char* relative_part = resolved_path + strlen(resolved_root);
-        if (strlen(relative_part) == 0) {
-            strncpy(state->current_virtual_path, "/", MAX_VIRTUAL_PATH - 1);
-        } else {
-            strncpy(state->current_virtual_path, relative_part, MAX_VIRTUAL_PATH - 1);
+// --- Search ---
+
+static void collect_document(const char* path, const VfsEntry* entry, void* context) {
+    ShellState* state = context;
+    if (entry->is_dir || !can_read(state, path)) return;
+    char (*grown)[VFS_PATH_MAX] = realloc(state->doc_paths, sizeof(*grown) * (state->doc_count + 1));
+    if (grown == NULL) return;
+    state->doc_paths = grown;
+    snprintf(state->doc_paths[state->doc_count++], VFS_PATH_MAX, "%s", path);
+}
+
+// Builds the index when it is first needed, and rebuilds it once files have
+// been written, renamed or removed since (mail, drops, the overlay).
+static bool ensure_index(ShellState* state) {
+    if (state->index != NULL && state->index_generation == vfs_generation()) return true;
+    text_index_free(state->index);
+    state->doc_count = 0;
+    state->index = text_index_create();
+    if (state->index == NULL) return false;
+    state->index_generation = vfs_generation();
+    walk_tree(state, "/", collect_document, state);
+
+    size_t bytes = 0;
+    for (int i = 0; i < state->doc_count; i++) {
+        char* data = NULL;
+        size_t size = 0;
+        if (!vfs_read(state->doc_paths[i], &data, &size)) continue;
+        if (memchr(data, '\0', size) == NULL) { // Text only
+            text_index_add(state->index, i, data, size);
+            bytes += size;
         }
-    } else {
-        printf(SHELL_ERROR_COLOR "cd: %s: Not a directory\n" ANSI_COLOR_RESET, arg);
+        free(data);
     }
+    LOG_DEBUG("NAVI shell: indexed %d files, %zu bytes.", state->doc_count, bytes);
+    return true;
 }
 
-static void cmd_cat(ShellState* state, const char* arg) {
+// Prints the line of 'data' holding byte 'offset' as "path:line: text".
+static void print_match(const char* path, const char* data, size_t offset) {
+    size_t start = offset, line = 1;
+    while (start > 0 && data[start - 1] != '\n') start--;
+    for (size_t i = 0; i < start; i++) line += data[i] == '\n';
+    size_t len = strcspn(data + start, "\r\n");
+    bool cut = len > SEARCH_LINE_MAX;
+    if (cut) {
+        len = SEARCH_LINE_MAX;
+        while (len > 0 && ((unsigned char)data[start + len] & 0xC0) == 0x80) len--; // Whole characters
+    }
+    printf(SHELL_PATH_COLOR "%s" ANSI_COLOR_RESET ":%zu: %.*s%s\n", path, line, (int)len, data + start, cut ? "..." : "");
+}
+
+static int compare_hits(const void* a, const void* b) {
+    const TextIndexHit* x = a;
+    const TextIndexHit* y = b;
+    if (x->occurrences != y->occurrences) return y->occurrences - x->occurrences;
+    return x->doc - y->doc;
+}
+
+static void cmd_search(ShellState* state, const char* arg) {
     if (arg == NULL) {
-        printf("cat: missing operand\n");
+        printf("search: missing query\n");
         return;
     }
+    if (!ensure_index(state)) return;
+    TextIndexHit* hits = malloc(sizeof(TextIndexHit) * (state->doc_count + 1));
+    if (hits == NULL) return;
+    int count = text_index_search(state->index, arg, hits, state->doc_count);
+    qsort(hits, count, sizeof(TextIndexHit), compare_hits);
+
+    for (int i = 0; i < count && i < SEARCH_MAX_SHOWN; i++) {
+        char* data = NULL;
+        if (!vfs_read(state->doc_paths[hits[i].doc], &data, NULL)) continue;
+        print_match(state->doc_paths[hits[i].doc], data, hits[i].offset);
+        free(data);
+    }
+    if (count > SEARCH_MAX_SHOWN) printf("... and %d more\n", count - SEARCH_MAX_SHOWN);
+    printf("%d file%s matched.\n", count, count == 1 ? "" : "s");
+    free(hits);
+}
 
-    char target_vpath[MAX_VIRTUAL_PATH];
-    if (arg[0] == '/') {
-        strncpy(target_vpath, arg, MAX_VIRTUAL_PATH - 1);
+// ASCII case-insensitive strstr over 'len' bytes.
+static const char* find_folded(const char* text, size_t len, const char* needle) {
+    size_t needle_len = strlen(needle);
+    for (size_t i = 0; i + needle_len <= len; i++) {
+        size_t k = 0;
+        while (k < needle_len) {
+            unsigned char a = text[i + k], b = needle[k];
+            if (a >= 'A' && a <= 'Z') a += 'a' - 'A';
+            if (b >= 'A' && b <= 'Z') b += 'a' - 'A';
+            if (a != b) break;
+            k++;
+        }
+        if (k == needle_len) return text + i;
+    }
+    return NULL;
+}
+
+// grep <pattern> [path]: every line holding the pattern (case-insensitive),
+// in the readable files at or below 'path'. A pattern with spaces is quoted.
+static void cmd_grep(ShellState* state, const char* arg) {
+    if (arg == NULL) {
+        printf("usage: grep <pattern> [path]\n");
+        return;
+    }
+    char pattern[MAX_LINE_LENGTH];
+    const char* rest;
+    if (arg[0] == '"') {
+        const char* end = strchr(arg + 1, '"');
+        size_t len = end ? (size_t)(end - arg - 1) : strlen(arg + 1);
+        snprintf(pattern, sizeof(pattern), "%.*s", (int)len, arg + 1);
+        rest = end ? end + 1 : arg + 1 + len;
     } else {
-        if (strcmp(state->current_virtual_path, "/") == 0) {
-             snprintf(target_vpath, MAX_VIRTUAL_PATH, "/%s", arg);
-        } else {
-             snprintf(target_vpath, MAX_VIRTUAL_PATH, "%s/%s", state->current_virtual_path, arg);
+        size_t len = strcspn(arg, " ");
+        snprintf(pattern, sizeof(pattern), "%.*s", (int)len, arg);
+        rest = arg + len;
+    }
+    while (*rest == ' ') rest++;
+    if (pattern[0] == '\0') {
+        printf("usage: grep <pattern> [path]\n");
+        return;
+    }
+
+    char target[VFS_PATH_MAX];
+    VfsEntry entry;
+    if (!resolve_arg(state, rest[0] != '\0' ? rest : NULL, target) || !vfs_stat(target, &entry)) {
+        printf(SHELL_ERROR_COLOR "grep: %s: No such file or directory\n" ANSI_COLOR_RESET, rest);
+        return;
+    }
+    if (!entry.is_dir && !can_read(state, target)) {
+        printf(SHELL_ERROR_COLOR "grep: %s: Permission denied\n" ANSI_COLOR_RESET, rest);
+        return;
+    }
+    if (!ensure_index(state)) return;
+
+    // The index narrows the files to scan to those holding the pattern's whole words.
+    int* docs = malloc(sizeof(int) * (state->doc_count + 1));
+    if (docs == NULL) return;
+    int count = text_index_candidates(state->index, pattern, docs, state->doc_count);
+    if (count < 0) {
+        for (count = 0; count < state->doc_count; count++) docs[count] = count;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const char* path = state->doc_paths[docs[i]];
+        if (!path_within(path, target)) continue;
+        char* data = NULL;
+        size_t size = 0;
+        if (!vfs_read(path, &data, &size)) continue;
+        const char* match = data;
+        while ((match = find_folded(match, size - (size_t)(match - data), pattern)) != NULL) {
+            print_match(path, data, (size_t)(match - data));
+            match += strcspn(match, "\n"); // On to the next line
         }
+        free(data);
     }
+    free(docs);
+}
 
-    char physical_path[MAX_PATH_LENGTH];
-    get_absolute_path(state, target_vpath, physical_path, MAX_PATH_LENGTH);
+typedef struct {
+    const char* name_pattern; // NULL: everything
+} FindQuery;
 
-    FILE* f = fopen(physical_path, "r");
-    if (f) {
-        char buffer[1024];
-        while (fgets(buffer, sizeof(buffer), f)) {
-            printf("%s", buffer);
+static void print_found(const char* path, const VfsEntry* entry, void* context) {
+    const FindQuery* query = context;
+    if (query->name_pattern != NULL && fnmatch(query->name_pattern, entry->name, 0) != 0) return;
+    if (entry->is_dir) printf(SHELL_PATH_COLOR "%s" ANSI_COLOR_RESET "\n", path);
+    else printf("%s\n", path);
+}
+
+// find [path] [-name <glob>]
+static void cmd_find(ShellState* state, const char* arg) {
+    char args[MAX_LINE_LENGTH];
+    snprintf(args, sizeof(args), "%s", arg ? arg : "");
+    const char* start = NULL;
+    FindQuery query = { NULL };
+    char* save = NULL;
+    for (char* word = strtok_r(args, " ", &save); word != NULL; word = strtok_r(NULL, " ", &save)) {
+        if (strcmp(word, "-name") == 0) {
+            query.name_pattern = strtok_r(NULL, " ", &save);
+            if (query.name_pattern == NULL) {
+                printf("find: missing argument to '-name'\n");
+                return;
+            }
+        } else if (start == NULL) {
+            start = word;
+        } else {
+            printf("usage: find [path] [-name <pattern>]\n");
+            return;
         }
-        printf("\n");
-        fclose(f);
-    } else {
-        printf(SHELL_ERROR_COLOR "cat: %s: No such file or directory\n" ANSI_COLOR_RESET, arg);
     }
+
+    char target[VFS_PATH_MAX];
+    VfsEntry entry;
+    if (!resolve_arg(state, start, target) || !vfs_stat(target, &entry)) {
+        printf(SHELL_ERROR_COLOR "find: '%s': No such file or directory\n" ANSI_COLOR_RESET, start ? start : ".");
+        return;
+    }
+    snprintf(entry.name, sizeof(entry.name), "%s", strcmp(target, "/") == 0 ? "/" : strrchr(target, '/') + 1);
+    print_found(target, &entry, &query);
+    if (!entry.is_dir) return;
+    if (!can_list(state, target)) {
+        printf(SHELL_ERROR_COLOR "find: '%s': Permission denied\n" ANSI_COLOR_RESET, target);
+        return;
+    }
+    walk_tree(state, target, print_found, &query);
+}
+
+// --- Command Table ---
+
+static bool shell_ls(void* context, const char* arg) {
+    cmd_ls(context, arg[0] != '\0' ? arg : NULL);
+    return false;
+}
+
+static bool shell_cd(void* context, const char* arg) {
+    cmd_cd(context, arg[0] != '\0' ? arg : NULL);
+    return false;
+}
+
+static bool shell_pwd(void* context, const char* arg) {
+    (void)arg;
+    printf("%s\n", ((ShellState*)context)->current_virtual_path);
+    return false;
+}
+
+static bool shell_cat(void* context, const char* arg) {
+    cmd_cat(context, arg[0] != '\0' ? arg : NULL);
+    return false;
+}
+
+static bool shell_grep(void* context, const char* arg) {
+    cmd_grep(context, arg[0] != '\0' ? arg : NULL);
+    return false;
+}
+
+static bool shell_find(void* context, const char* arg) {
+    cmd_find(context, arg[0] != '\0' ? arg : NULL);
+    return false;
+}
+
+static bool shell_search(void* context, const char* arg) {
+    cmd_search(context, arg[0] != '\0' ? arg : NULL);
+    return false;
+}
+
+static bool shell_whoami(void* context, const char* arg) {
+    (void)context;
+    (void)arg;
+    printf("lain\n");
+    return false;
+}
+
+static bool shell_clear(void* context, const char* arg) {
+    (void)context;
+    (void)arg;
+    clear_screen();
+    return false;
+}
+
+static bool shell_help(void* context, const char* arg) {
+    (void)context;
+    (void)arg;
+    printf("Available commands: ls, cd, pwd, cat, grep, find, search, whoami, clear, exit\n");
+    printf("  grep <pattern> [path]       lines containing the pattern\n");
+    printf("  find [path] [-name <glob>]  files and directories by name\n");
+    printf("  search <words|\"phrase\">    files containing all of them\n");
+    return false;
+}
+
+static bool shell_exit(void* context, const char* arg) {
+    (void)arg;
+    ((ShellState*)context)->running = false;
+    return false;
+}
+
+static const CommandSpec g_shell_commands[] = {
+    { "ls",     COMMAND_ARG_PATH, shell_ls,     false },
+    { "cd",     COMMAND_ARG_PATH, shell_cd,     false },
+    { "pwd",    COMMAND_ARG_NONE, shell_pwd,    false },
+    { "cat",    COMMAND_ARG_PATH, shell_cat,    false },
+    { "grep",   COMMAND_ARG_PATH, shell_grep,   false },
+    { "find",   COMMAND_ARG_PATH, shell_find,   false },
+    { "search", COMMAND_ARG_NONE, shell_search, false },
+    { "whoami", COMMAND_ARG_NONE, shell_whoami, false },
+    { "clear",  COMMAND_ARG_NONE, shell_clear,  false },
+    { "help",   COMMAND_ARG_NONE, shell_help,   false },
+    { "exit",   COMMAND_ARG_NONE, shell_exit,   false },
+};
+
+static void add_entry(const VfsEntry* entry, void* context) {
+    char name[VFS_NAME_MAX + 1];
+    snprintf(name, sizeof(name), "%s%s", entry->name, entry->is_dir ? "/" : "");
+    command_trie_insert(context, name, 0);
+}
+
+// Completes the last component of a path against its directory's entries;
+// the directory is only re-listed when completion moves to another one.
+static const CommandTrie* shell_path_trie(void* context, CommandArgKind kind, const char* arg, size_t* word_start) {
+    ShellState* state = context;
+    if (kind != COMMAND_ARG_PATH || state->entries == NULL) return NULL;
+
+    // The path is the last word ("grep pattern /ho").
+    const char* space = strrchr(arg, ' ');
+    const char* word = space ? space + 1 : arg;
+    const char* slash = strrchr(word, '/');
+    size_t dir_len = slash ? (size_t)(slash - word) + 1 : 0;
+    *word_start = (size_t)(word - arg) + dir_len;
+    char dir_arg[VFS_PATH_MAX];
+    char dir_vpath[VFS_PATH_MAX];
+    snprintf(dir_arg, sizeof(dir_arg), "%.*s", (int)dir_len, word);
+    if (!resolve_arg(state, dir_arg[0] != '\0' ? dir_arg : NULL, dir_vpath)) return NULL;
+    if (strcmp(dir_vpath, state->entries_path) == 0) return state->entries;
+
+    command_trie_clear(state->entries);
+    snprintf(state->entries_path, sizeof(state->entries_path), "%s", dir_vpath);
+    if (can_list(state, dir_vpath)) vfs_list(dir_vpath, add_entry, state->entries);
+    return state->entries;
 }
 
 void enter_navi_shell(GameState* game_state) {
     ShellState state;
-    // Set root to <project_root>/world
-    snprintf(state.physical_root_path, MAX_PATH_LENGTH, "%s/%s", game_state->paths.base_path, VIRTUAL_ROOT);
-    
-    // Ensure world directory exists
-    struct stat st;
-    if (stat(state.physical_root_path, &st) == -1) {
-        printf(SHELL_ERROR_COLOR "Error: World directory not found at %s\n" ANSI_COLOR_RESET, state.physical_root_path);
+    if (!vfs_is_mounted()) {
+        printf(SHELL_ERROR_COLOR "Error: World image not mounted (%s)\n" ANSI_COLOR_RESET, game_state->paths.world_pack);
         return;
     }
 
     // Default start path
-    strncpy(state.current_virtual_path, "/home", MAX_VIRTUAL_PATH - 1);
+    snprintf(state.current_virtual_path, sizeof(state.current_virtual_path), "/home");
+    state.level = game_state->player_state.credit_level;
+    load_access_rules(&state);
+    state.index = NULL;
+    state.doc_paths = NULL;
+    state.doc_count = 0;
+    state.index_generation = 0;
 
     clear_screen();
     printf("NAVI Shell v1.0\n");
     printf("Type 'help' for commands.\n\n");
 
-    char* line;
-    char prompt[MAX_VIRTUAL_PATH + 32];
+    char line[MAX_LINE_LENGTH];
+    char prompt[VFS_PATH_MAX + 32];
+    CommandRegistry* commands = command_registry_create(g_shell_commands, (int)(sizeof(g_shell_commands) / sizeof(g_shell_commands[0])), shell_path_trie);
+    state.entries = command_trie_create();
+    state.entries_path[0] = '\0';
+    state.running = commands != NULL;
 
-    while (1) {
+    while (state.running) {
         snprintf(prompt, sizeof(prompt), "%snv@wired%s:%s%s$ ", 
                  SHELL_PROMPT_COLOR, ANSI_COLOR_RESET, 
                  SHELL_PATH_COLOR, state.current_virtual_path);
         
-        line = linenoise(prompt);
-        if (line == NULL) break; // EOF
-
-        if (strlen(line) > 0) {
-            linenoiseHistoryAdd(line);
-            
-            // Tokenize
-            char* cmd = strtok(line, " ");
-            char* arg = strtok(NULL, " ");
-
-            if (cmd) {
-                if (strcmp(cmd, "exit") == 0) {
-                    free(line);
-                    break;
-                } else if (strcmp(cmd, "ls") == 0) {
-                    cmd_ls(&state, arg);
-                } else if (strcmp(cmd, "cd") == 0) {
-                    cmd_cd(&state, arg);
-                } else if (strcmp(cmd, "pwd") == 0) {
-                    printf("%s\n", state.current_virtual_path);
-                } else if (strcmp(cmd, "cat") == 0) {
-                    cmd_cat(&state, arg);
-                } else if (strcmp(cmd, "whoami") == 0) {
-                    printf("lain\n");
-                } else if (strcmp(cmd, "clear") == 0) {
-                    clear_screen();
-                } else if (strcmp(cmd, "help") == 0) {
-                    printf("Available commands: ls, cd, pwd, cat, whoami, clear, exit\n");
-                } else {
-                    printf("%s: command not found\n", cmd);
-                }
-            }
+        if (!task_read_command(prompt, commands, &state, line, sizeof(line))) break; // EOF
+        // Files may have come and gone since the last completion.
+        state.entries_path[0] = '\0';
+
+        char* cmd = line;
+        while (*cmd == ' ') cmd++;
+        if (*cmd != '\0' && !command_registry_dispatch(commands, cmd, &state, NULL)) {
+            cmd[strcspn(cmd, " ")] = '\0';
+            printf("%s: command not found\n", cmd);
         }
-        free(line);
     }
+
+    text_index_free(state.index);
+    free(state.doc_paths);
+    command_trie_free(state.entries);
+    command_registry_free(commands);
 }
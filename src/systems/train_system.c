@@ -1,213 +1,178 @@
 #include "train_system.h"
 #include "game_types.h"
-#include "data_loader.h"
-#include "cJSON.h"
-#include "linenoise.h" // For input
+#include "task_scheduler.h" // For input
 #include "string_table.h" // For get_string_by_id
 #include "ansi_colors.h" // For rendering
 #include "render_utils.h" // For render_clear_screen
-#include "game_paths.h" // For GamePaths struct and global game_state
-#include "station_coordinates_data.h" // For embedded station_coordinates.json data
+#include "time_utils.h" // For GAME_TIME_UNITS_PER_SECOND
+#include "ecc_time.h"
+#include "byte_util.h"
+#include "logger.h"
+#include "station_table.h" // Generated from station_coordinates.json
+#include "map_loader.h" // For location_id_from_string
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Helper struct for train station data, mirroring station_coordinates.json
-typedef struct {
-    char id[MAX_NAME_LENGTH];
-    char name[MAX_NAME_LENGTH];
-    // We don't need x, y for this initial implementation of the interface
-} TrainStationData;
-
-// Global array to store parsed station data
-static TrainStationData* g_stations = NULL;
-static int g_station_count = 0;
-
-/**
- * @brief Loads train station data from station_coordinates.json.
- * @return 1 on success, 0 on failure.
- */
-static int load_station_data() {
-    const char *json_string = STATION_COORDINATES_JSON_DATA;
-
-    // No need for file path or read_entire_file anymore
-    // No need for length since it's a static string
-    // DataLoaderStatus status; // No longer needed
-    // length = strlen(json_string); // No longer needed
-    // json_string will be valid as it's embedded
-
-    cJSON *root = cJSON_Parse(json_string);
-    if (root == NULL) {
-        const char *error_ptr = cJSON_GetErrorPtr();
-        if (error_ptr != NULL) {
-            fprintf(stderr, "Error: Failed to parse embedded station_coordinates.json before: %s\n", error_ptr);
-        } else {
-            fprintf(stderr, "Error: Failed to parse embedded station_coordinates.json (unknown cJSON error).\n");
-        }
-        return 0;
-    }
+// --- Station Table Queries ---
 
-    if (!cJSON_IsArray(root)) {
-        fprintf(stderr, "Error: station_coordinates.json is not a JSON array.\n");
-        cJSON_Delete(root);
-        return 0;
-    }
+static bool valid_pair(int from, int to) {
+    return from >= 0 && from < YAMANOTE_STATION_COUNT && to >= 0 && to < YAMANOTE_STATION_COUNT;
+}
 
-    g_station_count = cJSON_GetArraySize(root);
-    if (g_station_count == 0) {
-        fprintf(stderr, "Warning: No stations found in station_coordinates.json.\n");
-        cJSON_Delete(root);
-        return 0;
-    }
+int train_station_count(void) {
+    return YAMANOTE_STATION_COUNT;
+}
 
-    g_stations = (TrainStationData*)malloc(sizeof(TrainStationData) * g_station_count);
-    if (g_stations == NULL) {
-        fprintf(stderr, "Error: Failed to allocate memory for station data.\n");
-        cJSON_Delete(root);
-        return 0;
-    }
+const char* train_station_id(int index) {
+    return (index >= 0 && index < YAMANOTE_STATION_COUNT) ? YAMANOTE_STATION_IDS[index] : NULL;
+}
 
-    for (int i = 0; i < g_station_count; i++) {
-        cJSON *station_json = cJSON_GetArrayItem(root, i);
-        if (!cJSON_IsObject(station_json)) {
-            fprintf(stderr, "Error: Invalid station entry in station_coordinates.json at index %d.\n", i);
-            cJSON_Delete(root);
-            free(g_stations);
-            g_stations = NULL;
-            g_station_count = 0;
-            return 0;
-        }
+const char* train_station_name(int index) {
+    return (index >= 0 && index < YAMANOTE_STATION_COUNT) ? YAMANOTE_STATION_NAMES[index] : NULL;
+}
 
-        cJSON *id_json = cJSON_GetObjectItemCaseSensitive(station_json, "id");
-        cJSON *name_json = cJSON_GetObjectItemCaseSensitive(station_json, "name");
-
-        if (cJSON_IsString(id_json) && cJSON_IsString(name_json)) {
-            strncpy(g_stations[i].id, id_json->valuestring, MAX_NAME_LENGTH - 1);
-            strncpy(g_stations[i].name, name_json->valuestring, MAX_NAME_LENGTH - 1);
-        } else {
-            fprintf(stderr, "Error: Missing 'id' or 'name' in station entry at index %d.\n", i);
-            cJSON_Delete(root);
-            free(g_stations);
-            g_stations = NULL;
-            g_station_count = 0;
-            return 0;
-        }
+int train_station_index(const char* location_id) {
+    if (location_id == NULL) return -1;
+    // Same FNV-1a hash and probing as the generator.
+    uint32_t h = fnv1a(location_id);
+    for (int i = 0; i < YAMANOTE_ID_HASH_SIZE; i++) {
+        int entry = YAMANOTE_ID_HASH[(h + i) & (YAMANOTE_ID_HASH_SIZE - 1)];
+        if (entry == 0) return -1;
+        if (strcmp(YAMANOTE_STATION_IDS[entry - 1], location_id) == 0) return entry - 1;
     }
-
-    cJSON_Delete(root);
-    return 1;
+    return -1;
 }
 
-void enter_ticket_machine_interface(GameState* passed_game_state) {
-
-    if (passed_game_state == NULL) return;
-
-
-
-    if (g_stations == NULL && !load_station_data()) {
+// Each station's map location, resolved from its ID on first use; the player's
+// position is then matched by index.
+static LocationID g_station_locations[YAMANOTE_STATION_COUNT];
+static bool g_station_locations_resolved = false;
 
-        fprintf(stderr, "ERROR: Could not load train station data for ticket machine.\n");
+int train_station_at(LocationID location) {
+    if (location == LOCATION_NONE) return -1;
+    if (!g_station_locations_resolved) {
+        for (int i = 0; i < YAMANOTE_STATION_COUNT; i++) {
+            g_station_locations[i] = location_id_from_string(YAMANOTE_STATION_IDS[i]);
+        }
+        g_station_locations_resolved = true;
+    }
+    for (int i = 0; i < YAMANOTE_STATION_COUNT; i++) {
+        if (g_station_locations[i] == location) return i;
+    }
+    return -1;
+}
 
-        return;
+int train_distance_hm(int from, int to, YamanoteDirection direction) {
+    return valid_pair(from, to) ? YAMANOTE_DISTANCE_HM[direction != YAMANOTE_OUTER][from][to] : -1;
+}
 
-    }
+int train_travel_minutes(int from, int to, YamanoteDirection direction) {
+    return valid_pair(from, to) ? YAMANOTE_MINUTES[direction != YAMANOTE_OUTER][from][to] : -1;
+}
 
+int train_fare_yen(int from, int to) {
+    return valid_pair(from, to) ? YAMANOTE_FARE_YEN[from][to] : -1;
+}
 
+YamanoteDirection train_fastest_direction(int from, int to) {
+    if (!valid_pair(from, to)) return YAMANOTE_OUTER;
+    return YAMANOTE_MINUTES[YAMANOTE_INNER][from][to] < YAMANOTE_MINUTES[YAMANOTE_OUTER][from][to]
+        ? YAMANOTE_INNER : YAMANOTE_OUTER;
+}
 
-    int running = 1;
+// --- Travel ---
 
-    char* input = NULL;
+int train_travel(GameState* game_state, int to, YamanoteDirection direction) {
+    if (game_state == NULL) return 0;
+    int from = train_station_at(game_state->player_state.location);
+    if (!valid_pair(from, to) || from == to) return 0;
 
+    int minutes = train_travel_minutes(from, to, direction);
+    DecodedTimeResult decoded = decode_time_with_ecc(game_state->time_of_day);
+    uint32_t new_time = decoded.data + (uint32_t)minutes * 60 * GAME_TIME_UNITS_PER_SECOND;
+    // Keep the noise bits above the codeword, as the time thread does.
+    game_state->time_of_day = (game_state->time_of_day & 0xC0000000) | (encode_time_with_ecc(new_time) & 0x3FFFFFFF);
 
+    game_state->player_state.location = g_station_locations[to]; // Resolved by train_station_at() above
+    strncpy(game_state->current_story_file, YAMANOTE_STATION_SCENES[to], MAX_PATH_LENGTH - 1);
+    LOG_DEBUG("Train: %s -> %s (%s loop, %d min)", YAMANOTE_STATION_IDS[from], YAMANOTE_STATION_IDS[to],
+              direction == YAMANOTE_INNER ? "inner" : "outer", minutes);
+    return 1;
+}
 
-        clear_screen();
+// --- Ticket Machine ---
 
+static void print_departures(int from) {
+    clear_screen();
     printf("         东京电车购票机\n");
-
     printf("========================================\n");
-
+    printf("当前车站: %s\n", YAMANOTE_STATION_NAMES[from]);
     printf("请选择您的目的地：\n");
-
-    for (int i = 0; i < g_station_count; i++) {
-
-        printf("  %d. %s (%s)\n", i + 1, g_stations[i].name, g_stations[i].id);
-
+    for (int i = 0; i < YAMANOTE_STATION_COUNT; i++) {
+        if (i == from) continue;
+        YamanoteDirection direction = train_fastest_direction(from, i);
+        printf("  %2d. %s  %d円  %d分 (%s)\n", i + 1, YAMANOTE_STATION_NAMES[i], train_fare_yen(from, i),
+               train_travel_minutes(from, i, direction), direction == YAMANOTE_INNER ? "内回り" : "外回り");
     }
-
     printf("----------------------------------------\n");
-
+    printf("  输入编号乘坐最快方向，编号后加 i/o 指定内回り/外回り\n");
     printf("  e. 退出\n");
-
     printf("========================================\n");
+}
 
+void enter_ticket_machine_interface(GameState* passed_game_state) {
+    if (passed_game_state == NULL) return;
 
+    int from = train_station_at(passed_game_state->player_state.location);
+    if (from < 0) {
+        printf("这台购票机没有响应。（当前位置不在山手线上）\n");
+        task_wait_enter("(Press ENTER to return)");
+        return;
+    }
 
-    while (running) {
-
-        input = linenoise(get_string_by_id(TEXT_PROMPT_INPUT_ARROW));
-
-        if (input == NULL) { // Ctrl+D
+    print_departures(from);
 
+    int running = 1;
+    char input[MAX_LINE_LENGTH];
+    while (running) {
+        if (!task_read_line(get_string_by_id(TEXT_PROMPT_INPUT_ARROW), input, sizeof(input))) { // Ctrl+D
             running = 0;
-
             continue;
-
         }
 
-
-
         if (strlen(input) == 0) {
-
-            free(input);
-
             continue;
-
         }
 
-
-
         if (strcmp(input, "e") == 0) {
-
             running = 0;
+            continue;
+        }
 
-        } else {
-
-            // Placeholder: In a real implementation, we'd validate input,
-
-            // process ticket purchase/travel, and update game state.
-
-            printf("您选择了: %s。当前功能开发中，请选择 'e' 退出。\n", input);
-
+        char* end = NULL;
+        long choice = strtol(input, &end, 10);
+        int to = (int)choice - 1;
+        if (end == input || to < 0 || to >= YAMANOTE_STATION_COUNT || to == from) {
+            printf("无效的目的地: %s\n", input);
+            continue;
         }
 
-        free(input);
+        YamanoteDirection direction = train_fastest_direction(from, to);
+        if (*end == 'i') direction = YAMANOTE_INNER;
+        else if (*end == 'o') direction = YAMANOTE_OUTER;
 
-        input = NULL; // Reset input pointer
+        int minutes = train_travel_minutes(from, to, direction);
+        int distance_hm = train_distance_hm(from, to, direction);
+        printf("%s -> %s  %d円  %d.%dkm  %d分\n", YAMANOTE_STATION_NAMES[from], YAMANOTE_STATION_NAMES[to],
+               train_fare_yen(from, to), distance_hm / 10, distance_hm % 10, minutes);
 
+        if (train_travel(passed_game_state, to, direction)) {
+            printf("电车到站: %s。\n", YAMANOTE_STATION_NAMES[to]);
+            task_wait_enter("(Press ENTER to return)");
+            running = 0;
+        }
     }
 
-    if (input) free(input); // Free if loop exited without input being freed
-
-    
-
-    // Cleanup station data when exiting the interface, or manage it globally
-
-    // For now, keep it loaded as it might be used by train_station/scene.c too.
-
-    // if (g_stations) {
-
-    //     free(g_stations);
-
-    //     g_stations = NULL;
-
-    //     g_station_count = 0;
-
-    // }
-
     clear_screen();
-
 }
-
-
-
-
@@ -0,0 +1,282 @@
+#include "task_scheduler.h"
+#include "command_registry.h"
+#include "time_utils.h"
+#include "linenoise.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// Subsystems keep whole mailboxes and path buffers on the stack.
+#define TASK_STACK_SIZE (1024 * 1024)
+// Resumes granted to each task during shutdown before it is abandoned.
+#define TASK_SHUTDOWN_MAX_RESUMES 64
+
+typedef enum {
+    TASK_WAIT_NONE,
+    TASK_WAIT_INPUT,
+    TASK_WAIT_TIMER
+} TaskWaitKind;
+
+typedef struct {
+    bool used;
+    char name[32];
+    pthread_t thread;
+    TaskEntry entry;
+    GameState* game_state;
+
+    TaskWaitKind wait;
+    uint64_t wake_ms;
+    char prompt[TASK_PROMPT_MAX];
+    char line[MAX_LINE_LENGTH];
+    bool line_eof;
+    const CommandRegistry* commands; // Completes the line being read; may be NULL
+    void* commands_context;
+
+    bool running;    // Holds the baton
+    bool finished;
+    bool cancelled;  // Shutdown: every wait returns immediately
+} Task;
+
+static Task g_tasks[TASK_MAX_COUNT];
+static pthread_mutex_t g_task_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_task_cond = PTHREAD_COND_INITIALIZER;
+static int g_spawn_order[TASK_MAX_COUNT]; // Slot indices, oldest first
+static int g_live_count = 0;
+
+// The task whose stack the calling thread runs on (NULL on the main thread).
+static _Thread_local Task* g_self = NULL;
+
+// --- Baton Passing ---
+
+// Hands control to 'task' and waits until it yields or returns.
+// Returns true if the task finished; its slot is released then.
+static bool resume_task(Task* task) {
+    pthread_mutex_lock(&g_task_mutex);
+    task->wait = TASK_WAIT_NONE;
+    task->running = true;
+    pthread_cond_broadcast(&g_task_cond);
+    while (task->running) pthread_cond_wait(&g_task_cond, &g_task_mutex);
+    bool finished = task->finished;
+    pthread_mutex_unlock(&g_task_mutex);
+
+    if (finished) {
+        pthread_join(task->thread, NULL);
+        LOG_DEBUG("Task '%s' finished.", task->name);
+        int slot = (int)(task - g_tasks);
+        for (int i = 0, j = 0; i < g_live_count; i++) {
+            if (g_spawn_order[i] != slot) g_spawn_order[j++] = g_spawn_order[i];
+        }
+        g_live_count--;
+        memset(task, 0, sizeof(*task));
+    }
+    return finished;
+}
+
+// Gives the baton back to the main loop and sleeps until resumed.
+static void yield_task(Task* task, TaskWaitKind wait) {
+    pthread_mutex_lock(&g_task_mutex);
+    task->wait = wait;
+    task->running = false;
+    pthread_cond_broadcast(&g_task_cond);
+    while (!task->running) pthread_cond_wait(&g_task_cond, &g_task_mutex);
+    pthread_mutex_unlock(&g_task_mutex);
+}
+
+static void* task_thread_func(void* arg) {
+    Task* task = (Task*)arg;
+    g_self = task;
+
+    pthread_mutex_lock(&g_task_mutex);
+    while (!task->running) pthread_cond_wait(&g_task_cond, &g_task_mutex);
+    pthread_mutex_unlock(&g_task_mutex);
+
+    task->entry(task->game_state);
+    fflush(stdout);
+
+    pthread_mutex_lock(&g_task_mutex);
+    task->finished = true;
+    task->running = false;
+    pthread_cond_broadcast(&g_task_cond);
+    pthread_mutex_unlock(&g_task_mutex);
+    return NULL;
+}
+
+static Task* foreground_task(void) {
+    return g_live_count > 0 ? &g_tasks[g_spawn_order[g_live_count - 1]] : NULL;
+}
+
+// --- Public API ---
+
+bool task_spawn(const char* name, TaskEntry entry, GameState* game_state) {
+    if (entry == NULL) return false;
+    if (g_self != NULL) {
+        entry(game_state);
+        return true;
+    }
+
+    Task* task = NULL;
+    for (int i = 0; i < TASK_MAX_COUNT; i++) {
+        if (!g_tasks[i].used) { task = &g_tasks[i]; break; }
+    }
+    if (task == NULL) {
+        fprintf(stderr, "WARNING: No free task slot for '%s'.\n", name);
+        return false;
+    }
+
+    memset(task, 0, sizeof(*task));
+    task->used = true;
+    strncpy(task->name, name ? name : "task", sizeof(task->name) - 1);
+    task->entry = entry;
+    task->game_state = game_state;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, TASK_STACK_SIZE);
+    int rc = pthread_create(&task->thread, &attr, task_thread_func, task);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        fprintf(stderr, "WARNING: Failed to start task '%s'.\n", task->name);
+        memset(task, 0, sizeof(*task));
+        return false;
+    }
+
+    g_spawn_order[g_live_count++] = (int)(task - g_tasks);
+    LOG_DEBUG("Task '%s' spawned.", task->name);
+    resume_task(task);
+    return true;
+}
+
+bool task_in_task(void) {
+    return g_self != NULL;
+}
+
+bool task_scheduler_has_foreground(void) {
+    return g_live_count > 0;
+}
+
+bool task_scheduler_wants_input(void) {
+    Task* task = foreground_task();
+    return task != NULL && task->wait == TASK_WAIT_INPUT;
+}
+
+const char* task_scheduler_prompt(void) {
+    Task* task = foreground_task();
+    return task != NULL ? task->prompt : "";
+}
+
+bool task_scheduler_complete(const char* line, size_t cursor, LineEditorCompletion* out) {
+    Task* task = foreground_task();
+    if (task == NULL || task->wait != TASK_WAIT_INPUT || task->commands == NULL) return false;
+    // The task is parked, so its context (often on its own stack) holds still.
+    command_registry_complete(task->commands, line, cursor, task->commands_context, out);
+    return true;
+}
+
+bool task_scheduler_deliver_line(const char* line) {
+    Task* task = foreground_task();
+    if (task == NULL || task->wait != TASK_WAIT_INPUT) return false;
+
+    task->line_eof = (line == NULL);
+    strncpy(task->line, line ? line : "", sizeof(task->line) - 1);
+    task->line[sizeof(task->line) - 1] = '\0';
+    resume_task(task);
+    return true;
+}
+
+bool task_scheduler_run_due(void) {
+    bool ran = false;
+    uint64_t now = get_current_time_ms();
+    for (int i = 0; i < TASK_MAX_COUNT; i++) {
+        Task* task = &g_tasks[i];
+        if (task->used && task->wait == TASK_WAIT_TIMER && task->wake_ms <= now) {
+            resume_task(task);
+            ran = true;
+        }
+    }
+    return ran;
+}
+
+long task_scheduler_next_timeout_ms(void) {
+    long timeout = -1;
+    uint64_t now = get_current_time_ms();
+    for (int i = 0; i < TASK_MAX_COUNT; i++) {
+        const Task* task = &g_tasks[i];
+        if (!task->used || task->wait != TASK_WAIT_TIMER) continue;
+        long remaining = task->wake_ms > now ? (long)(task->wake_ms - now) : 0;
+        if (timeout < 0 || remaining < timeout) timeout = remaining;
+    }
+    return timeout;
+}
+
+void task_scheduler_shutdown(void) {
+    for (int i = 0; i < TASK_MAX_COUNT; i++) {
+        Task* task = &g_tasks[i];
+        if (!task->used) continue;
+        task->cancelled = true;
+        int resumes = 0;
+        while (!resume_task(task)) {
+            if (++resumes >= TASK_SHUTDOWN_MAX_RESUMES) {
+                // A loop that ignores EOF; leave its thread parked until exit.
+                logger_log("Task '%s' did not unwind on shutdown.", task->name);
+                pthread_detach(task->thread);
+                break;
+            }
+        }
+    }
+}
+
+bool task_read_line(const char* prompt, char* buf, size_t size) {
+    return task_read_command(prompt, NULL, NULL, buf, size);
+}
+
+bool task_read_command(const char* prompt, const CommandRegistry* commands, void* context, char* buf, size_t size) {
+    if (buf == NULL || size == 0) return false;
+    buf[0] = '\0';
+
+    if (g_self == NULL) {
+        char* line = linenoise(prompt ? prompt : "");
+        if (line == NULL) return false;
+        strncpy(buf, line, size - 1);
+        buf[size - 1] = '\0';
+        free(line);
+        return true;
+    }
+
+    if (g_self->cancelled) return false;
+    strncpy(g_self->prompt, prompt ? prompt : "", sizeof(g_self->prompt) - 1);
+    g_self->prompt[sizeof(g_self->prompt) - 1] = '\0';
+    g_self->commands = commands;
+    g_self->commands_context = context;
+    fflush(stdout);
+    yield_task(g_self, TASK_WAIT_INPUT);
+    g_self->commands = NULL;
+
+    if (g_self->cancelled || g_self->line_eof) return false;
+    strncpy(buf, g_self->line, size - 1);
+    buf[size - 1] = '\0';
+    return true;
+}
+
+void task_sleep_ms(unsigned int ms) {
+    if (g_self == NULL) {
+        usleep((useconds_t)ms * 1000);
+        return;
+    }
+    if (g_self->cancelled) return;
+    g_self->wake_ms = get_current_time_ms() + ms;
+    fflush(stdout);
+    yield_task(g_self, TASK_WAIT_TIMER);
+}
+
+void task_wait_enter(const char* prompt) {
+    if (g_self == NULL) {
+        printf("%s", prompt ? prompt : "");
+        (void)getchar();
+        return;
+    }
+    char discard[MAX_LINE_LENGTH];
+    (void)task_read_line(prompt, discard, sizeof(discard));
+}
@@ -0,0 +1,385 @@
+#include "text_index.h"
+#include "command_trie.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define QUERY_TOKEN_MAX 64 // Tokens looked at per word or phrase of a query
+
+typedef struct {
+    uint32_t doc;
+    uint32_t pos;    // Token position in the document
+    uint32_t offset; // Byte offset in the document
+} Posting;
+
+// Sorted by (doc, pos): documents arrive in order and positions only grow.
+typedef struct {
+    Posting* items;
+    int count;
+    int capacity;
+} PostingList;
+
+struct TextIndex {
+    CommandTrie* terms; // Token -> index into 'lists'
+    PostingList* lists;
+    int term_count;
+    int term_capacity;
+    int last_doc;
+};
+
+// --- Tokenizer ---
+
+typedef enum {
+    CHAR_SEPARATOR,
+    CHAR_WORD,
+    CHAR_CJK
+} CharClass;
+
+typedef enum {
+    TOKENIZE_DOCUMENT, // Every CJK character and every adjacent pair
+    TOKENIZE_QUERY     // Only the pairs, unless a CJK run is a single character
+} TokenizeMode;
+
+// 'bounded' says the token is whole in the text: a word with something other
+// than a word character on both sides, or any CJK token.
+typedef void (*TokenFunc)(void* context, const char* token, size_t len, uint32_t pos, uint32_t offset, bool bounded);
+
+// Decodes one character; an invalid byte decodes as U+FFFD on its own.
+static size_t decode_utf8(const unsigned char* s, size_t len, uint32_t* cp) {
+    size_t n;
+    uint32_t c = s[0];
+    if (c < 0x80) { *cp = c; return 1; }
+    else if ((c & 0xE0) == 0xC0) { n = 2; c &= 0x1F; }
+    else if ((c & 0xF0) == 0xE0) { n = 3; c &= 0x0F; }
+    else if ((c & 0xF8) == 0xF0) { n = 4; c &= 0x07; }
+    else { *cp = 0xFFFD; return 1; }
+    if (n > len) { *cp = 0xFFFD; return 1; }
+    for (size_t i = 1; i < n; i++) {
+        if ((s[i] & 0xC0) != 0x80) { *cp = 0xFFFD; return 1; }
+        c = (c << 6) | (s[i] & 0x3F);
+    }
+    *cp = c;
+    return n;
+}
+
+static CharClass classify(uint32_t cp) {
+    if (cp < 0x80) {
+        bool alnum = (cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z') || cp == '_';
+        return alnum ? CHAR_WORD : CHAR_SEPARATOR;
+    }
+    if ((cp >= 0x3040 && cp <= 0x30FF) ||   // Kana
+        (cp >= 0x3400 && cp <= 0x4DBF) ||   // CJK extension A
+        (cp >= 0x4E00 && cp <= 0x9FFF) ||   // CJK unified ideographs
+        (cp >= 0xAC00 && cp <= 0xD7AF) ||   // Hangul syllables
+        (cp >= 0xF900 && cp <= 0xFAFF) ||   // CJK compatibility ideographs
+        (cp >= 0x20000 && cp <= 0x2FFFF)) { // Supplementary ideographs
+        return CHAR_CJK;
+    }
+    if ((cp >= 0xC0 && cp <= 0x24F && cp != 0xD7 && cp != 0xF7) || // Latin letters
+        (cp >= 0x370 && cp <= 0x52F)) {                            // Greek, Cyrillic
+        return CHAR_WORD;
+    }
+    return CHAR_SEPARATOR;
+}
+
+static void tokenize(const char* text, size_t len, TokenizeMode mode, TokenFunc fn, void* context) {
+    const unsigned char* s = (const unsigned char*)text;
+    uint32_t pos = 0;
+    size_t i = 0;
+    while (i < len) {
+        uint32_t cp;
+        size_t n = decode_utf8(s + i, len - i, &cp);
+        CharClass cls = classify(cp);
+        if (cls == CHAR_SEPARATOR) {
+            i += n;
+            continue;
+        }
+
+        if (cls == CHAR_WORD) {
+            char token[TEXT_INDEX_TOKEN_MAX];
+            size_t token_len = 0;
+            size_t start = i;
+            while (i < len) {
+                n = decode_utf8(s + i, len - i, &cp);
+                if (classify(cp) != CHAR_WORD) break;
+                if (token_len + n < sizeof(token)) {
+                    for (size_t k = 0; k < n; k++) {
+                        unsigned char b = s[i + k];
+                        token[token_len++] = (b >= 'A' && b <= 'Z') ? (char)(b - 'A' + 'a') : (char)b;
+                    }
+                }
+                i += n;
+            }
+            token[token_len] = '\0';
+            fn(context, token, token_len, pos++, (uint32_t)start, start > 0 && i < len);
+            continue;
+        }
+
+        // A CJK run: each character takes a position; a pair sits at its first one.
+        char pair[9];
+        size_t prev_len = 0;
+        uint32_t prev_offset = 0;
+        int run = 0;
+        while (i < len) {
+            n = decode_utf8(s + i, len - i, &cp);
+            if (classify(cp) != CHAR_CJK) break;
+            if (mode == TOKENIZE_DOCUMENT) {
+                char single[5];
+                memcpy(single, s + i, n);
+                single[n] = '\0';
+                fn(context, single, n, pos, (uint32_t)i, true);
+            }
+            if (run > 0) {
+                memcpy(pair + prev_len, s + i, n);
+                pair[prev_len + n] = '\0';
+                fn(context, pair, prev_len + n, pos - 1, prev_offset, true);
+            }
+            memcpy(pair, s + i, n);
+            prev_len = n;
+            prev_offset = (uint32_t)i;
+            run++;
+            pos++;
+            i += n;
+        }
+        if (mode == TOKENIZE_QUERY && run == 1) {
+            pair[prev_len] = '\0';
+            fn(context, pair, prev_len, pos - 1, prev_offset, true);
+        }
+    }
+}
+
+// --- Building ---
+
+TextIndex* text_index_create(void) {
+    TextIndex* index = calloc(1, sizeof(TextIndex));
+    if (index == NULL) return NULL;
+    index->terms = command_trie_create();
+    if (index->terms == NULL) {
+        free(index);
+        return NULL;
+    }
+    index->last_doc = -1;
+    return index;
+}
+
+void text_index_free(TextIndex* index) {
+    if (index == NULL) return;
+    for (int i = 0; i < index->term_count; i++) free(index->lists[i].items);
+    free(index->lists);
+    command_trie_free(index->terms);
+    free(index);
+}
+
+typedef struct {
+    TextIndex* index;
+    uint32_t doc;
+    bool ok;
+} AddContext;
+
+static void add_token(void* context, const char* token, size_t len, uint32_t pos, uint32_t offset, bool bounded) {
+    (void)bounded;
+    AddContext* add = context;
+    TextIndex* index = add->index;
+    if (!add->ok || len == 0) return;
+
+    int term = command_trie_find(index->terms, token, len);
+    if (term < 0) {
+        if (index->term_count == index->term_capacity) {
+            int capacity = index->term_capacity ? index->term_capacity * 2 : 256;
+            PostingList* grown = realloc(index->lists, sizeof(PostingList) * capacity);
+            if (grown == NULL) { add->ok = false; return; }
+            index->lists = grown;
+            index->term_capacity = capacity;
+        }
+        term = index->term_count;
+        if (!command_trie_insert(index->terms, token, term)) { add->ok = false; return; }
+        memset(&index->lists[term], 0, sizeof(PostingList));
+        index->term_count++;
+    }
+
+    PostingList* list = &index->lists[term];
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 4;
+        Posting* grown = realloc(list->items, sizeof(Posting) * capacity);
+        if (grown == NULL) { add->ok = false; return; }
+        list->items = grown;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = (Posting){ add->doc, pos, offset };
+}
+
+bool text_index_add(TextIndex* index, int doc, const char* text, size_t len) {
+    if (index == NULL || doc <= index->last_doc || text == NULL) return false;
+    index->last_doc = doc;
+    AddContext add = { index, (uint32_t)doc, true };
+    tokenize(text, len, TOKENIZE_DOCUMENT, add_token, &add);
+    return add.ok;
+}
+
+// --- Queries ---
+
+typedef struct {
+    const TextIndex* index;
+    int terms[QUERY_TOKEN_MAX];
+    uint32_t pos[QUERY_TOKEN_MAX];
+    int count;
+    bool missing;      // A token no document has
+    bool bounded_only; // Keep whole tokens only (substring candidates)
+} QueryTokens;
+
+static void query_token(void* context, const char* token, size_t len, uint32_t pos, uint32_t offset, bool bounded) {
+    (void)offset;
+    QueryTokens* q = context;
+    if (len == 0 || (q->bounded_only && !bounded) || q->count == QUERY_TOKEN_MAX) return;
+    int term = command_trie_find(q->index->terms, token, len);
+    if (term < 0) q->missing = true;
+    q->terms[q->count] = term;
+    q->pos[q->count] = pos;
+    q->count++;
+}
+
+// Finds (doc, pos) in 'list'; with pos == UINT32_MAX, any position in doc.
+static const Posting* find_posting(const PostingList* list, uint32_t doc, uint32_t pos) {
+    int lo = 0, hi = list->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        const Posting* p = &list->items[mid];
+        if (p->doc < doc || (p->doc == doc && pos != UINT32_MAX && p->pos < pos)) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == list->count) return NULL;
+    const Posting* p = &list->items[lo];
+    if (p->doc != doc || (pos != UINT32_MAX && p->pos != pos)) return NULL;
+    return p;
+}
+
+typedef struct {
+    TextIndexHit* items;
+    int count;
+    int capacity;
+} HitList;
+
+static bool push_hit(HitList* hits, TextIndexHit hit) {
+    if (hits->count == hits->capacity) {
+        int capacity = hits->capacity ? hits->capacity * 2 : 16;
+        TextIndexHit* grown = realloc(hits->items, sizeof(TextIndexHit) * capacity);
+        if (grown == NULL) return false;
+        hits->items = grown;
+        hits->capacity = capacity;
+    }
+    hits->items[hits->count++] = hit;
+    return true;
+}
+
+// Documents where the tokens of 'q' occur at their relative positions.
+// Walks the rarest token's postings and looks the others up around each.
+static bool match_phrase(const TextIndex* index, const QueryTokens* q, HitList* out) {
+    int anchor = 0;
+    for (int t = 1; t < q->count; t++) {
+        if (index->lists[q->terms[t]].count < index->lists[q->terms[anchor]].count) anchor = t;
+    }
+    uint32_t lead = q->pos[anchor] - q->pos[0]; // Tokens come in position order
+    const PostingList* anchor_list = &index->lists[q->terms[anchor]];
+    for (int i = 0; i < anchor_list->count; i++) {
+        const Posting* p = &anchor_list->items[i];
+        if (p->pos < lead) continue;
+        uint32_t start = p->pos - lead;
+        uint32_t offset = p->offset;
+        bool all = true;
+        for (int t = 0; t < q->count && all; t++) {
+            if (t == anchor) continue;
+            const Posting* other = find_posting(&index->lists[q->terms[t]], p->doc, start + q->pos[t] - q->pos[0]);
+            if (other == NULL) all = false;
+            else if (t == 0) offset = other->offset;
+        }
+        if (!all) continue;
+        if (out->count > 0 && out->items[out->count - 1].doc == (int)p->doc) {
+            out->items[out->count - 1].occurrences++;
+        } else if (!push_hit(out, (TextIndexHit){ (int)p->doc, offset, 1 })) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Keeps the hits of 'result' whose document is also in 'other'.
+static void intersect_hits(HitList* result, const HitList* other) {
+    int kept = 0, j = 0;
+    for (int i = 0; i < result->count; i++) {
+        while (j < other->count && other->items[j].doc < result->items[i].doc) j++;
+        if (j < other->count && other->items[j].doc == result->items[i].doc) result->items[kept++] = result->items[i];
+    }
+    result->count = kept;
+}
+
+int text_index_search(const TextIndex* index, const char* query, TextIndexHit* hits, int max_hits) {
+    if (index == NULL || query == NULL) return 0;
+    HitList result = { NULL, 0, 0 };
+    bool first = true;
+
+    const char* p = query;
+    while (*p != '\0') {
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0') break;
+        const char* start;
+        size_t len;
+        if (*p == '"') {
+            start = ++p;
+            const char* end = strchr(start, '"');
+            len = end ? (size_t)(end - start) : strlen(start);
+            p = end ? end + 1 : start + len;
+        } else {
+            start = p;
+            len = strcspn(p, " \t");
+            p += len;
+        }
+
+        QueryTokens q = { .index = index };
+        tokenize(start, len, TOKENIZE_QUERY, query_token, &q);
+        if (q.count == 0) continue; // Punctuation only
+        HitList unit = { NULL, 0, 0 };
+        bool ok = !q.missing && match_phrase(index, &q, &unit);
+        if (first) {
+            result = unit;
+            first = false;
+        } else {
+            intersect_hits(&result, &unit);
+            free(unit.items);
+        }
+        if (!ok || result.count == 0) {
+            result.count = 0;
+            break;
+        }
+    }
+
+    int count = result.count;
+    for (int i = 0; i < count && i < max_hits; i++) hits[i] = result.items[i];
+    free(result.items);
+    return count;
+}
+
+int text_index_candidates(const TextIndex* index, const char* text, int* docs, int max_docs) {
+    if (index == NULL || text == NULL) return 0;
+    QueryTokens q = { .index = index, .bounded_only = true };
+    tokenize(text, strlen(text), TOKENIZE_QUERY, query_token, &q);
+    if (q.count == 0) return -1;
+    if (q.missing) return 0;
+
+    int rarest = 0;
+    for (int t = 1; t < q.count; t++) {
+        if (index->lists[q.terms[t]].count < index->lists[q.terms[rarest]].count) rarest = t;
+    }
+    const PostingList* list = &index->lists[q.terms[rarest]];
+    int count = 0;
+    for (int i = 0; i < list->count; i++) {
+        uint32_t doc = list->items[i].doc;
+        if (i > 0 && list->items[i - 1].doc == doc) continue;
+        bool all = true;
+        for (int t = 0; t < q.count && all; t++) {
+            all = t == rarest || find_posting(&index->lists[q.terms[t]], doc, UINT32_MAX) != NULL;
+        }
+        if (!all) continue;
+        if (count < max_docs) docs[count] = (int)doc;
+        count++;
+    }
+    return count;
+}
@@ -13,7 +13,7 @@ pthread_mutex_t time_mutex;
 // Flag to signal the time thread to stop
 volatile bool game_is_running = true;
 
-#define TIME_INCREMENT_PER_SECOND (1 * 16)
+#define TIME_INCREMENT_PER_SECOND (1 * GAME_TIME_UNITS_PER_SECOND)
 
 // --- Real-time Functions ---
 
@@ -52,12 +52,11 @@ void* time_thread_func(void* arg) {
         // intentionally preserved. We only update the lower 30 bits used by ECC.
         uint32_t preserved_noise = game_state->time_of_day & 0xC0000000; // Mask for top 2 bits
         game_state->time_of_day = preserved_noise | (new_encoded_data & 0x3FFFFFFF); // Combine noise and new 30-bit codeword
-        
-        pthread_mutex_unlock(&time_mutex);
 
-        Event time_event;
-        time_event.type = TIME_TICK_EVENT;
-        push_event(time_event);
+        // Published under the lock so the main loop never sees the clock ahead of its ticks.
+        push_tick_event();
+
+        pthread_mutex_unlock(&time_mutex);
     }
     return NULL;
 }
@@ -0,0 +1,192 @@
+#include "timer_wheel.h"
+#include <string.h>
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define FIRING_LIST (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS)
+// Delays beyond the top level are parked in its farthest slot and re-hashed
+// when that slot cascades.
+#define MAX_SPAN ((uint64_t)1 << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS))
+
+// IDs are (generation << 16) | (index + 1), so 0 is never issued.
+#define ID_INDEX(id) ((int)((id) & 0xFFFF) - 1)
+#define ID_GENERATION(id) ((uint16_t)((id) >> 16))
+
+// --- List Helpers ---
+
+static void list_append(TimerWheel* wheel, int list, int index) {
+    TimerNode* node = &wheel->nodes[index];
+    node->list = (int16_t)list;
+    node->next = -1;
+    node->prev = wheel->tails[list];
+    if (node->prev >= 0) wheel->nodes[node->prev].next = index;
+    else wheel->heads[list] = index;
+    wheel->tails[list] = index;
+}
+
+static void list_remove(TimerWheel* wheel, int index) {
+    TimerNode* node = &wheel->nodes[index];
+    int list = node->list;
+    if (node->prev >= 0) wheel->nodes[node->prev].next = node->next;
+    else wheel->heads[list] = node->next;
+    if (node->next >= 0) wheel->nodes[node->next].prev = node->prev;
+    else wheel->tails[list] = node->prev;
+    node->prev = node->next = -1;
+    node->list = -1;
+}
+
+static void release_node(TimerWheel* wheel, int index) {
+    TimerNode* node = &wheel->nodes[index];
+    node->generation++;
+    node->callback = NULL;
+    node->next = wheel->free_head;
+    wheel->free_head = index;
+    wheel->active_count--;
+}
+
+// Hashes a node into the level whose span covers its remaining delay.
+static void place_node(TimerWheel* wheel, int index) {
+    TimerNode* node = &wheel->nodes[index];
+    uint64_t due = node->due;
+    uint64_t delta = due > wheel->now ? due - wheel->now : 0;
+    if (delta >= MAX_SPAN) {
+        delta = MAX_SPAN - 1;
+        due = wheel->now + delta;
+    }
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           delta >= ((uint64_t)1 << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    // A delta of 0 lands in the current level-0 slot, which is processed next.
+    if (delta == 0) due = wheel->now;
+    int slot = (int)((due >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK);
+    list_append(wheel, level * TIMER_WHEEL_SLOTS + slot, index);
+}
+
+// Re-hashes every timer of one higher-level slot into the levels below.
+static void cascade(TimerWheel* wheel, int level) {
+    int list = level * TIMER_WHEEL_SLOTS + (int)((wheel->now >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK);
+    int index = wheel->heads[list];
+    wheel->heads[list] = wheel->tails[list] = -1;
+    while (index >= 0) {
+        int next = wheel->nodes[index].next;
+        wheel->nodes[index].prev = wheel->nodes[index].next = -1;
+        place_node(wheel, index);
+        wheel->cascaded++;
+        index = next;
+    }
+}
+
+// Fires everything in the current level-0 slot. The slot is first moved to the
+// firing list so callbacks can cancel any of its timers safely.
+static bool fire_current_slot(TimerWheel* wheel) {
+    int list = (int)(wheel->now & SLOT_MASK);
+    if (wheel->heads[list] < 0) return false;
+
+    wheel->heads[FIRING_LIST] = wheel->heads[list];
+    wheel->tails[FIRING_LIST] = wheel->tails[list];
+    wheel->heads[list] = wheel->tails[list] = -1;
+    for (int i = wheel->heads[FIRING_LIST]; i >= 0; i = wheel->nodes[i].next) {
+        wheel->nodes[i].list = FIRING_LIST;
+    }
+
+    bool redraw = false;
+    int index;
+    while ((index = wheel->heads[FIRING_LIST]) >= 0) {
+        TimerNode node = wheel->nodes[index];
+        list_remove(wheel, index);
+        release_node(wheel, index);
+        wheel->fired++;
+        if (node.callback(node.context, node.arg)) redraw = true;
+    }
+    return redraw;
+}
+
+// --- Public API ---
+
+void timer_wheel_init(TimerWheel* wheel, uint64_t now) {
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->now = now;
+    for (int i = 0; i <= FIRING_LIST; i++) wheel->heads[i] = wheel->tails[i] = -1;
+    for (int i = 0; i < TIMER_WHEEL_MAX_TIMERS; i++) {
+        wheel->nodes[i].list = -1;
+        wheel->nodes[i].prev = -1;
+        wheel->nodes[i].next = (i + 1 < TIMER_WHEEL_MAX_TIMERS) ? i + 1 : -1;
+    }
+    wheel->free_head = 0;
+    wheel->initialized = true;
+}
+
+TimerId timer_wheel_add(TimerWheel* wheel, uint64_t delay, TimerCallback callback,
+                        void* context, int arg, uint32_t group) {
+    if (callback == NULL) return 0;
+    if (!wheel->initialized) timer_wheel_init(wheel, 0);
+    if (wheel->free_head < 0) return 0;
+
+    int index = wheel->free_head;
+    TimerNode* node = &wheel->nodes[index];
+    wheel->free_head = node->next;
+    wheel->active_count++;
+
+    node->due = wheel->now + (delay > 0 ? delay : 1);
+    node->callback = callback;
+    node->context = context;
+    node->arg = arg;
+    node->group = group;
+    node->prev = node->next = -1;
+    place_node(wheel, index);
+    return ((TimerId)node->generation << 16) | (TimerId)(index + 1);
+}
+
+bool timer_wheel_cancel(TimerWheel* wheel, TimerId id) {
+    int index = ID_INDEX(id);
+    if (!wheel->initialized || index < 0 || index >= TIMER_WHEEL_MAX_TIMERS) return false;
+    TimerNode* node = &wheel->nodes[index];
+    if (node->list < 0 || node->generation != ID_GENERATION(id)) return false;
+    list_remove(wheel, index);
+    release_node(wheel, index);
+    return true;
+}
+
+void timer_wheel_cancel_group(TimerWheel* wheel, uint32_t group) {
+    if (!wheel->initialized) return;
+    for (int i = 0; i < TIMER_WHEEL_MAX_TIMERS; i++) {
+        if (wheel->nodes[i].list >= 0 && wheel->nodes[i].group == group) {
+            list_remove(wheel, i);
+            release_node(wheel, i);
+        }
+    }
+}
+
+bool timer_wheel_advance(TimerWheel* wheel, uint64_t now) {
+    if (!wheel->initialized) timer_wheel_init(wheel, now);
+    bool redraw = false;
+    while (wheel->now < now) {
+        if (wheel->active_count == 0) {
+            wheel->now = now; // Nothing can fire; skip the walk
+            break;
+        }
+        wheel->now++;
+        // When a level wraps, pull the next slot of the level above down.
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if ((wheel->now & (((uint64_t)1 << (TIMER_WHEEL_SLOT_BITS * level)) - 1)) != 0) break;
+            cascade(wheel, level);
+        }
+        if (fire_current_slot(wheel)) redraw = true;
+    }
+    return redraw;
+}
+
+int64_t timer_wheel_next_due(const TimerWheel* wheel) {
+    if (!wheel->initialized || wheel->active_count == 0) return -1;
+    for (int64_t step = 1; step < TIMER_WHEEL_SLOTS; step++) {
+        int list = (int)((wheel->now + step) & SLOT_MASK);
+        if (wheel->heads[list] >= 0) {
+            // Only valid if no level wrap (and thus cascade) comes first.
+            uint64_t wrap = TIMER_WHEEL_SLOTS - (wheel->now & SLOT_MASK);
+            return step < (int64_t)wrap ? step : (int64_t)wrap;
+        }
+    }
+    return (int64_t)(TIMER_WHEEL_SLOTS - (wheel->now & SLOT_MASK));
+}
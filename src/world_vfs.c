@@ -0,0 +1,755 @@
+#include "world_vfs.h"
+#include "game_paths.h"
+#include "byte_util.h"
+#include "data_loader.h"
+#include "autosave.h"
+#include "logger.h"
+#include <zlib.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define OVERLAY_MAGIC "LWOV"
+#define OVERLAY_VERSION 2
+#define OVERLAY_HEADER_SIZE 8
+#define OVERLAY_RECORD_HEADER_SIZE 11
+#define OVERLAY_COMPACT_SLACK (64 * 1024) // Journal bytes allowed beyond twice the live ones
+
+// The mapped image.
+static void* g_map = NULL;
+static size_t g_map_size = 0;
+static const WorldPackEntry* g_entries = NULL;
+static uint32_t g_entry_count = 0;
+static const char* g_names = NULL;
+static const unsigned char* g_data = NULL;
+
+static uint32_t g_generation = 0;
+
+typedef enum {
+    OVERLAY_DATA,     // 'data' holds the file's contents
+    OVERLAY_WHITEOUT, // Hides the packed file at 'path'
+    OVERLAY_ALIAS,    // The packed file at path 'data', renamed to 'path'
+    OVERLAY_REVERT    // Journal only: 'path' shows the image again
+} OverlayKind;
+
+// The session overlay: one record per path it changes, indexed by a hash of
+// the path and by a hash of its directory.
+typedef struct {
+    char path[VFS_PATH_MAX];
+    OverlayKind kind;
+    char* data;
+    size_t size;          // Contents' size, for an alias too
+    uint32_t hash;        // fnv1a(path)
+    uint32_t parent_hash; // fnv1a() of its directory
+    int next;             // Next record in the same path bucket; -1 ends
+    int sibling;          // Next record in the same directory bucket
+} OverlayFile;
+
+static OverlayFile* g_overlay = NULL;
+static int g_overlay_count = 0;
+static int g_overlay_capacity = 0; // A power of two; also the bucket count
+static int* g_path_buckets = NULL;
+static int* g_dir_buckets = NULL;
+static char g_overlay_path[MAX_PATH_LENGTH] = "";
+
+// The overlay file is a journal: the records of every change, appended by
+// the autosave writer and compacted to the live records once it has grown
+// past twice their size.
+static size_t g_live_bytes = 0;     // Compacted size
+static size_t g_journal_bytes = 0;  // Size on disk, once queued writes land; 0 = no file
+static atomic_bool g_write_failed = false;
+static unsigned char* g_pending = NULL; // Records not yet handed to the writer
+static size_t g_pending_size = 0;
+static size_t g_pending_capacity = 0;
+static bool g_pending_failed = false;
+static int g_batch_depth = 0; // Commits wait for the outermost vfs_batch_end()
+
+// --- Image ---
+
+static bool pack_valid(const unsigned char* map, size_t size) {
+    if (size < sizeof(WorldPackHeader)) return false;
+    WorldPackHeader header;
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, WORLD_PACK_MAGIC, sizeof(header.magic)) != 0) return false;
+    if (header.version != WORLD_PACK_VERSION) return false; // Also catches a byte-swapped pack
+    if (header.entry_count == 0 || header.names_size == 0) return false;
+    if (header.entry_count > (size - sizeof(header)) / sizeof(WorldPackEntry)) return false;
+    size_t names_at = sizeof(header) + (size_t)header.entry_count * sizeof(WorldPackEntry);
+    if (size - names_at < header.names_size || size - names_at - header.names_size != header.data_size) return false;
+
+    const WorldPackEntry* entries = (const WorldPackEntry*)(map + sizeof(header));
+    const char* names = (const char*)map + names_at;
+    if (names[header.names_size - 1] != '\0') return false;
+    if (!(entries[0].flags & WORLD_PACK_DIR) || entries[0].parent != 0) return false;
+
+    for (uint32_t i = 0; i < header.entry_count; i++) {
+        const WorldPackEntry* e = &entries[i];
+        if (e->name >= header.names_size || e->parent >= header.entry_count) return false;
+        if (strlen(names + e->name) >= VFS_NAME_MAX || (i > 0 && names[e->name] == '\0')) return false;
+        if (strchr(names + e->name, '/') != NULL) return false;
+        if (e->flags & WORLD_PACK_DIR) {
+            // Children come after their parent, so the tree has no cycles.
+            if (e->count > 0 && (e->first <= i || e->first > header.entry_count || e->count > header.entry_count - e->first)) return false;
+            for (uint32_t c = 0; c < e->count; c++) {
+                if (entries[e->first + c].parent != i) return false;
+            }
+        } else {
+            if (e->first > header.data_size || e->count > header.data_size - e->first) return false;
+            if (!(e->flags & WORLD_PACK_COMPRESSED) && e->count != e->size) return false;
+        }
+    }
+    return true;
+}
+
+bool vfs_mount(const char* pack_path) {
+    if (pack_path == NULL) return false;
+    int fd = open(pack_path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd); // The mapping keeps the file alive
+    if (map == MAP_FAILED) return false;
+
+    if (!pack_valid(map, (size_t)st.st_size)) {
+        LOG_DEBUG("World image '%s' is malformed; not mounted.", pack_path);
+        munmap(map, (size_t)st.st_size);
+        return false;
+    }
+
+    vfs_unmount();
+    WorldPackHeader header;
+    memcpy(&header, map, sizeof(header));
+    g_map = map;
+    g_map_size = (size_t)st.st_size;
+    g_entries = (const WorldPackEntry*)((const unsigned char*)map + sizeof(header));
+    g_entry_count = header.entry_count;
+    g_names = (const char*)(g_entries + header.entry_count);
+    g_data = (const unsigned char*)g_names + header.names_size;
+    g_generation++;
+    LOG_DEBUG("World image '%s' mapped: %u entries, %zu bytes.", pack_path, g_entry_count, g_map_size);
+    return true;
+}
+
+void vfs_unmount(void) {
+    if (g_map == NULL) return;
+    munmap(g_map, g_map_size);
+    g_map = NULL;
+    g_map_size = 0;
+    g_entries = NULL;
+    g_entry_count = 0;
+    g_names = NULL;
+    g_data = NULL;
+    g_generation++;
+}
+
+bool vfs_is_mounted(void) {
+    return g_map != NULL;
+}
+
+uint32_t vfs_generation(void) {
+    return g_generation;
+}
+
+// Compares an entry's name with the first 'len' bytes of 'name'.
+static int compare_name(const WorldPackEntry* e, const char* name, size_t len) {
+    int c = strncmp(g_names + e->name, name, len);
+    return c != 0 ? c : (g_names[e->name + len] != '\0');
+}
+
+// Entry index of 'path' in the image, or -1.
+static int packed_lookup(const char* path) {
+    if (g_map == NULL || path == NULL || path[0] != '/') return -1;
+    uint32_t index = 0;
+    const char* p = path;
+    while (*p == '/') p++;
+    while (*p != '\0') {
+        const WorldPackEntry* dir = &g_entries[index];
+        if (!(dir->flags & WORLD_PACK_DIR)) return -1;
+        size_t len = strcspn(p, "/");
+        uint32_t lo = 0, hi = dir->count;
+        bool found = false;
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            int c = compare_name(&g_entries[dir->first + mid], p, len);
+            if (c == 0) {
+                index = dir->first + mid;
+                found = true;
+                break;
+            }
+            if (c < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        if (!found) return -1;
+        p += len;
+        while (*p == '/') p++;
+    }
+    return (int)index;
+}
+
+static bool packed_is_file(const char* path) {
+    int index = packed_lookup(path);
+    return index >= 0 && !(g_entries[index].flags & WORLD_PACK_DIR);
+}
+
+static bool packed_is_dir(const char* path) {
+    int index = packed_lookup(path);
+    return index >= 0 && (g_entries[index].flags & WORLD_PACK_DIR);
+}
+
+// --- Paths ---
+
+bool vfs_resolve(const char* cwd, const char* path, char* out, size_t out_size) {
+    if (path == NULL || out == NULL || out_size < 2) return false;
+    char joined[VFS_PATH_MAX * 2];
+    int n = (path[0] == '/') ? snprintf(joined, sizeof(joined), "%s", path)
+                             : snprintf(joined, sizeof(joined), "%s/%s", cwd ? cwd : "/", path);
+    if (n < 0 || (size_t)n >= sizeof(joined)) return false;
+
+    size_t len = 0;
+    out[0] = '\0';
+    char* save = NULL;
+    for (char* part = strtok_r(joined, "/", &save); part != NULL; part = strtok_r(NULL, "/", &save)) {
+        if (strcmp(part, ".") == 0) continue;
+        if (strcmp(part, "..") == 0) {
+            while (len > 0 && out[len - 1] != '/') len--;
+            if (len > 0) len--; // The slash itself
+            out[len] = '\0';
+            continue;
+        }
+        size_t part_len = strlen(part);
+        if (len + 1 + part_len >= out_size) return false;
+        out[len++] = '/';
+        memcpy(out + len, part, part_len + 1);
+        len += part_len;
+    }
+    if (len == 0) {
+        out[0] = '/';
+        out[1] = '\0';
+    }
+    return true;
+}
+
+// Directory part of a resolved path ("/a/b" -> "/a", "/a" -> "/").
+static void parent_path(const char* path, char* out, size_t out_size) {
+    snprintf(out, out_size, "%s", path);
+    char* slash = strrchr(out, '/');
+    if (slash == NULL || slash == out) snprintf(out, out_size, "/");
+    else *slash = '\0';
+}
+
+static const char* base_name(const char* path) {
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+// --- Overlay ---
+
+static size_t payload_of(const OverlayFile* file, const char** payload) {
+    *payload = file->kind == OVERLAY_WHITEOUT ? NULL : file->data;
+    if (file->kind == OVERLAY_DATA) return file->size;
+    return file->kind == OVERLAY_ALIAS ? strlen(file->data) : 0;
+}
+
+// Bytes the record takes in a compacted overlay file.
+static size_t record_size(const OverlayFile* file) {
+    const char* payload;
+    return OVERLAY_RECORD_HEADER_SIZE + strlen(file->path) + payload_of(file, &payload);
+}
+
+static OverlayFile* overlay_find(const char* path) {
+    if (g_overlay_count == 0) return NULL;
+    uint32_t hash = fnv1a(path);
+    for (int i = g_path_buckets[hash & (g_overlay_capacity - 1)]; i >= 0; i = g_overlay[i].next) {
+        if (g_overlay[i].hash == hash && strcmp(g_overlay[i].path, path) == 0) return &g_overlay[i];
+    }
+    return NULL;
+}
+
+static void index_link(int i) {
+    OverlayFile* file = &g_overlay[i];
+    uint32_t mask = (uint32_t)g_overlay_capacity - 1;
+    file->next = g_path_buckets[file->hash & mask];
+    g_path_buckets[file->hash & mask] = i;
+    file->sibling = g_dir_buckets[file->parent_hash & mask];
+    g_dir_buckets[file->parent_hash & mask] = i;
+}
+
+static void index_unlink(int i) {
+    const OverlayFile* file = &g_overlay[i];
+    uint32_t mask = (uint32_t)g_overlay_capacity - 1;
+    int* link = &g_path_buckets[file->hash & mask];
+    while (*link != i) link = &g_overlay[*link].next;
+    *link = file->next;
+    link = &g_dir_buckets[file->parent_hash & mask];
+    while (*link != i) link = &g_overlay[*link].sibling;
+    *link = file->sibling;
+}
+
+// Makes room for 'count' records, so adding up to that many cannot fail.
+static bool overlay_reserve(int count) {
+    if (count <= g_overlay_capacity) return true;
+    int capacity = g_overlay_capacity ? g_overlay_capacity : 8;
+    while (capacity < count) capacity *= 2;
+    OverlayFile* grown = realloc(g_overlay, sizeof(OverlayFile) * capacity);
+    if (grown == NULL) return false;
+    g_overlay = grown;
+    int* path_buckets = malloc(sizeof(int) * capacity);
+    int* dir_buckets = malloc(sizeof(int) * capacity);
+    if (path_buckets == NULL || dir_buckets == NULL) {
+        free(path_buckets);
+        free(dir_buckets);
+        return false;
+    }
+    free(g_path_buckets);
+    free(g_dir_buckets);
+    g_path_buckets = path_buckets;
+    g_dir_buckets = dir_buckets;
+    g_overlay_capacity = capacity;
+    for (int i = 0; i < capacity; i++) path_buckets[i] = dir_buckets[i] = -1;
+    for (int i = 0; i < g_overlay_count; i++) index_link(i);
+    return true;
+}
+
+// Sets what 'path' shows. Takes ownership of 'data' (NULL for a whiteout),
+// even when it fails.
+static OverlayFile* overlay_put(const char* path, OverlayKind kind, char* data, size_t size) {
+    OverlayFile* file = overlay_find(path);
+    if (file == NULL) {
+        if (strlen(path) >= VFS_PATH_MAX || !overlay_reserve(g_overlay_count + 1)) {
+            free(data);
+            return NULL;
+        }
+        char parent[VFS_PATH_MAX];
+        parent_path(path, parent, sizeof(parent));
+        file = &g_overlay[g_overlay_count];
+        memset(file, 0, sizeof(*file));
+        snprintf(file->path, sizeof(file->path), "%s", path);
+        file->hash = fnv1a(path);
+        file->parent_hash = fnv1a(parent);
+        index_link(g_overlay_count++);
+    } else {
+        g_live_bytes -= record_size(file);
+        free(file->data);
+    }
+    file->kind = kind;
+    file->data = data;
+    file->size = kind == OVERLAY_DATA ? size : 0;
+    g_live_bytes += record_size(file);
+    g_generation++;
+    return file;
+}
+
+// Returns 'file's path to the image. Moves the last record into its place.
+static void overlay_drop(OverlayFile* file) {
+    int i = (int)(file - g_overlay);
+    int last = g_overlay_count - 1;
+    g_generation++;
+    g_live_bytes -= record_size(file);
+    index_unlink(i);
+    free(file->data);
+    if (i != last) {
+        index_unlink(last);
+        g_overlay[i] = g_overlay[last];
+        index_link(i);
+    }
+    g_overlay_count--;
+}
+
+// Whether 'file' is directly in the directory 'dir'.
+static bool in_directory(const OverlayFile* file, const char* dir, size_t dir_len) {
+    if (dir_len == 1) return strchr(file->path + 1, '/') == NULL; // "/"
+    return strncmp(file->path, dir, dir_len) == 0 && file->path[dir_len] == '/' &&
+           strchr(file->path + dir_len + 1, '/') == NULL;
+}
+
+// The packed file 'path' shows through its overlay record 'file' (NULL if
+// it has none): its own, or the one an alias names. -1 if there is none.
+static int packed_file_of(const char* path, const OverlayFile* file) {
+    int index;
+    if (file == NULL) index = packed_lookup(path);
+    else if (file->kind == OVERLAY_ALIAS) index = packed_lookup(file->data);
+    else return -1;
+    return index >= 0 && !(g_entries[index].flags & WORLD_PACK_DIR) ? index : -1;
+}
+
+// --- Overlay File ---
+
+// Record, little-endian: kind (u8), path length (u16), payload size (u32),
+// CRC-32 of all but itself (u32), path, payload. The payload is the file's
+// contents, or the packed path an alias names.
+static size_t encode_record(unsigned char* out, OverlayKind kind, const char* path, const char* payload, size_t payload_size) {
+    size_t path_len = strlen(path);
+    out[0] = (unsigned char)kind;
+    store_u16(out + 1, (uint16_t)path_len);
+    store_u32(out + 3, (uint32_t)payload_size);
+    memcpy(out + OVERLAY_RECORD_HEADER_SIZE, path, path_len);
+    if (payload_size > 0) memcpy(out + OVERLAY_RECORD_HEADER_SIZE + path_len, payload, payload_size);
+    uLong crc = crc32(crc32(0L, Z_NULL, 0), out, 7);
+    crc = crc32(crc, out + OVERLAY_RECORD_HEADER_SIZE, (uInt)(path_len + payload_size));
+    store_u32(out + 7, (uint32_t)crc);
+    return OVERLAY_RECORD_HEADER_SIZE + path_len + payload_size;
+}
+
+// Queues the record of what 'path' shows now for the next overlay_commit().
+static void journal_path(const char* path) {
+    const OverlayFile* file = overlay_find(path);
+    const char* payload = NULL;
+    size_t payload_size = file ? payload_of(file, &payload) : 0;
+    size_t size = OVERLAY_RECORD_HEADER_SIZE + strlen(path) + payload_size;
+    if (g_pending_size + size > g_pending_capacity) {
+        size_t capacity = g_pending_capacity ? g_pending_capacity * 2 : 4096;
+        while (capacity < g_pending_size + size) capacity *= 2;
+        unsigned char* grown = realloc(g_pending, capacity);
+        if (grown == NULL) {
+            g_pending_failed = true; // The commit compacts instead
+            return;
+        }
+        g_pending = grown;
+        g_pending_capacity = capacity;
+    }
+    g_pending_size += encode_record(g_pending + g_pending_size, file ? file->kind : OVERLAY_REVERT, path, payload, payload_size);
+}
+
+// Queues a rewrite of the overlay file as its live records alone.
+static bool overlay_compact(void) {
+    size_t size = OVERLAY_HEADER_SIZE + g_live_bytes;
+    unsigned char* buf = malloc(size);
+    if (buf == NULL) {
+        atomic_store(&g_write_failed, true); // Try again on the next change
+        return false;
+    }
+    memcpy(buf, OVERLAY_MAGIC, 4);
+    store_u32(buf + 4, OVERLAY_VERSION);
+    size_t pos = OVERLAY_HEADER_SIZE;
+    for (int i = 0; i < g_overlay_count; i++) {
+        const char* payload;
+        size_t payload_size = payload_of(&g_overlay[i], &payload);
+        pos += encode_record(buf + pos, g_overlay[i].kind, g_overlay[i].path, payload, payload_size);
+    }
+    atomic_store(&g_write_failed, false);
+    autosave_write_file(g_overlay_path, AUTOSAVE_FILE_REPLACE, buf, size, &g_write_failed);
+    g_journal_bytes = size;
+    return true;
+}
+
+// Hands the queued records to the autosave writer as one append, or a
+// compacted file when the journal has outgrown the live records (or a write
+// was lost).
+static bool overlay_commit(void) {
+    if (g_batch_depth > 0 || (g_pending_size == 0 && !g_pending_failed)) return true;
+    bool compact = g_pending_failed || g_journal_bytes == 0 || atomic_exchange(&g_write_failed, false) ||
+                   g_journal_bytes + g_pending_size > 2 * (OVERLAY_HEADER_SIZE + g_live_bytes) + OVERLAY_COMPACT_SLACK;
+    bool ok = true;
+    if (g_overlay_path[0] == '\0') {
+        // Kept in memory only
+    } else if (compact) {
+        ok = overlay_compact();
+    } else if (g_pending_size > 0) {
+        autosave_write_file(g_overlay_path, AUTOSAVE_FILE_APPEND, g_pending, g_pending_size, &g_write_failed);
+        g_journal_bytes += g_pending_size;
+        g_pending = NULL; // Now the writer's
+        g_pending_capacity = 0;
+    }
+    g_pending_size = 0;
+    g_pending_failed = false;
+    return ok;
+}
+
+// Replays one record.
+static bool overlay_apply(OverlayKind kind, const char* path, const char* payload, size_t payload_size) {
+    if (kind == OVERLAY_REVERT) {
+        OverlayFile* file = overlay_find(path);
+        if (file != NULL) overlay_drop(file);
+        return true;
+    }
+    if (kind == OVERLAY_ALIAS && (payload_size == 0 || payload_size >= VFS_PATH_MAX || memchr(payload, '\0', payload_size))) return false;
+    char* data = NULL;
+    if (kind != OVERLAY_WHITEOUT) {
+        data = malloc(payload_size + 1);
+        if (data == NULL) return false;
+        memcpy(data, payload, payload_size);
+        data[payload_size] = '\0';
+    }
+    return overlay_put(path, kind, data, payload_size) != NULL;
+}
+
+// Replays the records of an overlay file up to the first that is torn or
+// damaged; '*used' receives how many bytes were good.
+static bool overlay_load(const unsigned char* p, size_t size, size_t* used) {
+    if (size < OVERLAY_HEADER_SIZE || memcmp(p, OVERLAY_MAGIC, 4) != 0 || load_u32(p + 4) != OVERLAY_VERSION) return false;
+    size_t pos = OVERLAY_HEADER_SIZE;
+    while (size - pos >= OVERLAY_RECORD_HEADER_SIZE) {
+        const unsigned char* record = p + pos;
+        OverlayKind kind = (OverlayKind)record[0];
+        size_t path_len = load_u16(record + 1);
+        size_t payload_size = load_u32(record + 3);
+        size_t room = size - pos - OVERLAY_RECORD_HEADER_SIZE;
+        if (kind > OVERLAY_REVERT || path_len == 0 || path_len >= VFS_PATH_MAX || room < path_len || room - path_len < payload_size) break;
+        const unsigned char* body = record + OVERLAY_RECORD_HEADER_SIZE;
+        uLong crc = crc32(crc32(0L, Z_NULL, 0), record, 7);
+        if ((uint32_t)crc32(crc, body, (uInt)(path_len + payload_size)) != load_u32(record + 7)) break;
+        char path[VFS_PATH_MAX];
+        memcpy(path, body, path_len);
+        path[path_len] = '\0';
+        if (memchr(body, '\0', path_len) != NULL) return false;
+        if (!overlay_apply(kind, path, (const char*)body + path_len, payload_size)) return false;
+        pos += OVERLAY_RECORD_HEADER_SIZE + path_len + payload_size;
+    }
+    *used = pos;
+    return true;
+}
+
+bool vfs_overlay_open(const char* overlay_path) {
+    vfs_overlay_close();
+    if (overlay_path == NULL) return false;
+    snprintf(g_overlay_path, sizeof(g_overlay_path), "%s", overlay_path);
+
+    char* data = NULL;
+    long size = 0;
+    if (read_entire_file(overlay_path, &data, &size) != DATA_LOADER_SUCCESS) return true; // Nothing changed yet
+    size_t used = 0;
+    bool ok = overlay_load((const unsigned char*)data, (size_t)size, &used);
+    free(data);
+    if (!ok) {
+        LOG_DEBUG("World overlay %s is malformed; starting from the image.", overlay_path);
+        while (g_overlay_count > 0) overlay_drop(&g_overlay[g_overlay_count - 1]);
+        return false; // The first change replaces it
+    }
+    g_journal_bytes = used;
+    if (used != (size_t)size) {
+        // Appends after a torn record would never be read back.
+        LOG_DEBUG("World overlay %s: dropped %zu bytes of torn tail.", overlay_path, (size_t)size - used);
+        overlay_compact();
+    }
+    LOG_DEBUG("World overlay %s: %d changed paths.", overlay_path, g_overlay_count);
+    return true;
+}
+
+void vfs_overlay_close(void) {
+    for (int i = 0; i < g_overlay_count; i++) free(g_overlay[i].data);
+    free(g_overlay);
+    free(g_path_buckets);
+    free(g_dir_buckets);
+    free(g_pending);
+    g_overlay = NULL;
+    g_path_buckets = g_dir_buckets = NULL;
+    g_pending = NULL;
+    g_overlay_count = 0;
+    g_overlay_capacity = 0;
+    g_pending_size = g_pending_capacity = 0;
+    g_pending_failed = false;
+    g_live_bytes = g_journal_bytes = 0;
+    atomic_store(&g_write_failed, false);
+    g_overlay_path[0] = '\0';
+    g_generation++;
+}
+
+// --- Reading ---
+
+bool vfs_stat(const char* path, VfsEntry* out) {
+    if (path == NULL) return false;
+    const OverlayFile* file = overlay_find(path);
+    if (file != NULL && file->kind == OVERLAY_WHITEOUT) return false;
+
+    VfsEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    snprintf(entry.name, sizeof(entry.name), "%s", base_name(path));
+    if (file != NULL && file->kind == OVERLAY_DATA) {
+        entry.size = file->size;
+    } else {
+        int index = file != NULL ? packed_file_of(path, file) : packed_lookup(path);
+        if (index < 0) return false;
+        const WorldPackEntry* e = &g_entries[index];
+        entry.is_dir = (e->flags & WORLD_PACK_DIR) != 0;
+        entry.is_exec = (e->flags & WORLD_PACK_EXEC) != 0;
+        entry.size = entry.is_dir ? 0 : e->size;
+    }
+    if (out) *out = entry;
+    return true;
+}
+
+static int compare_entries(const void* a, const void* b) {
+    return strcmp(((const VfsEntry*)a)->name, ((const VfsEntry*)b)->name);
+}
+
+int vfs_list(const char* path, VfsListFunc fn, void* context) {
+    int index = packed_lookup(path);
+    if (index < 0 || !(g_entries[index].flags & WORLD_PACK_DIR)) return -1;
+    const WorldPackEntry* dir = &g_entries[index];
+
+    // The overlay's records in this directory share a bucket.
+    size_t dir_len = strlen(path);
+    uint32_t dir_hash = fnv1a(path);
+    int first = g_overlay_count > 0 ? g_dir_buckets[dir_hash & (g_overlay_capacity - 1)] : -1;
+    uint32_t overlay_children = 0;
+    for (int i = first; i >= 0; i = g_overlay[i].sibling) overlay_children++;
+
+    VfsEntry* entries = malloc(sizeof(VfsEntry) * (dir->count + overlay_children + 1));
+    if (entries == NULL) return -1;
+    int count = 0;
+    char child_path[VFS_PATH_MAX];
+    for (uint32_t i = 0; i < dir->count; i++) {
+        const WorldPackEntry* e = &g_entries[dir->first + i];
+        snprintf(child_path, sizeof(child_path), "%s/%s", dir_len == 1 ? "" : path, g_names + e->name);
+        if (overlay_find(child_path) != NULL) continue; // Listed from the overlay below, if still there
+        VfsEntry* entry = &entries[count++];
+        snprintf(entry->name, sizeof(entry->name), "%s", g_names + e->name);
+        entry->is_dir = (e->flags & WORLD_PACK_DIR) != 0;
+        entry->is_exec = (e->flags & WORLD_PACK_EXEC) != 0;
+        entry->size = entry->is_dir ? 0 : e->size;
+    }
+    for (int i = first; i >= 0; i = g_overlay[i].sibling) {
+        const OverlayFile* file = &g_overlay[i];
+        if (file->parent_hash != dir_hash || !in_directory(file, path, dir_len)) continue;
+        if (file->kind == OVERLAY_WHITEOUT) continue;
+        int packed = file->kind == OVERLAY_ALIAS ? packed_file_of(file->path, file) : -1;
+        if (file->kind == OVERLAY_ALIAS && packed < 0) continue; // Gone from this image
+        VfsEntry* entry = &entries[count++];
+        memset(entry, 0, sizeof(*entry));
+        snprintf(entry->name, sizeof(entry->name), "%s", base_name(file->path));
+        entry->is_exec = packed >= 0 && (g_entries[packed].flags & WORLD_PACK_EXEC) != 0;
+        entry->size = packed >= 0 ? g_entries[packed].size : file->size;
+    }
+
+    qsort(entries, count, sizeof(VfsEntry), compare_entries);
+    if (fn) {
+        for (int i = 0; i < count; i++) fn(&entries[i], context);
+    }
+    free(entries);
+    return count;
+}
+
+bool vfs_read(const char* path, char** out_data, size_t* out_size) {
+    if (path == NULL || out_data == NULL) return false;
+    *out_data = NULL;
+    const OverlayFile* file = overlay_find(path);
+    if (file != NULL && file->kind == OVERLAY_WHITEOUT) return false;
+
+    const unsigned char* source;
+    size_t size, stored;
+    bool compressed;
+    if (file != NULL && file->kind == OVERLAY_DATA) {
+        source = (const unsigned char*)file->data;
+        size = stored = file->size;
+        compressed = false;
+    } else {
+        int index = packed_file_of(path, file);
+        if (index < 0) return false;
+        const WorldPackEntry* e = &g_entries[index];
+        source = g_data + e->first;
+        size = e->size;
+        stored = e->count;
+        compressed = (e->flags & WORLD_PACK_COMPRESSED) != 0;
+    }
+
+    char* data = malloc(size + 1);
+    if (data == NULL) return false;
+    if (compressed) {
+        uLongf inflated = (uLongf)size;
+        if (uncompress((Bytef*)data, &inflated, source, (uLong)stored) != Z_OK || inflated != size) {
+            LOG_DEBUG("World image: could not inflate %s.", path);
+            free(data);
+            return false;
+        }
+    } else if (size > 0) {
+        memcpy(data, source, size);
+    }
+    data[size] = '\0';
+    *out_data = data;
+    if (out_size) *out_size = size;
+    return true;
+}
+
+// --- Changes ---
+
+// A file can be created at 'path' if its directory is in the image and it
+// does not name a directory itself.
+static bool can_hold_file(const char* path) {
+    char parent[VFS_PATH_MAX];
+    parent_path(path, parent, sizeof(parent));
+    return strcmp(path, "/") != 0 && strlen(path) < VFS_PATH_MAX && packed_is_dir(parent) && !packed_is_dir(path);
+}
+
+static bool write_unsaved(const char* path, const void* data, size_t size) {
+    if (!can_hold_file(path)) return false;
+    char* copy = malloc(size + 1);
+    if (copy == NULL) return false;
+    if (size > 0) memcpy(copy, data, size);
+    copy[size] = '\0';
+    if (overlay_put(path, OVERLAY_DATA, copy, size) == NULL) return false;
+    journal_path(path);
+    return true;
+}
+
+static bool remove_unsaved(const char* path) {
+    OverlayFile* file = overlay_find(path);
+    if (file != NULL && file->kind == OVERLAY_WHITEOUT) return false;
+    if (file == NULL && !packed_is_file(path)) return false;
+
+    if (!packed_is_file(path)) {
+        overlay_drop(file); // Only ever existed in the overlay
+    } else if (overlay_put(path, OVERLAY_WHITEOUT, NULL, 0) == NULL) {
+        return false;
+    }
+    journal_path(path);
+    return true;
+}
+
+bool vfs_write(const char* path, const void* data, size_t size) {
+    if (path == NULL || (data == NULL && size > 0)) return false;
+    return write_unsaved(path, data, size) && overlay_commit();
+}
+
+bool vfs_rename(const char* from, const char* to) {
+    if (from == NULL || to == NULL) return false;
+    if (strcmp(from, to) == 0) return vfs_stat(from, NULL);
+    // Room for both records up front: once the contents have moved, nothing
+    // can fail. Reserving may move the records, so look 'from' up after.
+    if (!can_hold_file(to) || !overlay_reserve(g_overlay_count + 2)) return false;
+    OverlayFile* source = overlay_find(from);
+    if (source != NULL ? source->kind == OVERLAY_WHITEOUT : !packed_is_file(from)) return false;
+
+    // Contents in the overlay move with their record; a packed file is only
+    // named again, by an alias.
+    if (source != NULL && source->kind == OVERLAY_DATA) {
+        char* data = source->data;
+        size_t size = source->size;
+        source->data = NULL;
+        overlay_put(to, OVERLAY_DATA, data, size);
+    } else {
+        char* alias = strdup(source != NULL ? source->data : from);
+        if (alias == NULL) return false;
+        if (strcmp(alias, to) == 0) { // Back where the image has it
+            free(alias);
+            OverlayFile* target = overlay_find(to);
+            if (target != NULL) overlay_drop(target);
+        } else {
+            overlay_put(to, OVERLAY_ALIAS, alias, 0);
+        }
+    }
+    journal_path(to);
+    remove_unsaved(from);
+    return overlay_commit();
+}
+
+bool vfs_remove(const char* path) {
+    if (path == NULL) return false;
+    return remove_unsaved(path) && overlay_commit();
+}
+
+void vfs_batch_begin(void) {
+    g_batch_depth++;
+}
+
+void vfs_batch_end(void) {
+    if (g_batch_depth > 0 && --g_batch_depth == 0) overlay_commit();
+}
@@ -0,0 +1,307 @@
+#include "world_watch.h"
+#include "game_paths.h"
+#include "event_system.h"
+#include "logger.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WATCH_MAX 256
+#define WATCH_BATCH 4096   // Bytes of inotify events read per poll
+#define WATCH_HISTORY WORLD_WATCH_BATCH_MAX // Changes world_watch_change() can still name: a batch's worth
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DONT_FOLLOW | IN_ONLYDIR)
+
+// One watched directory of the drop tree.
+typedef struct {
+    int wd;
+    char path[VFS_PATH_MAX]; // Virtual path it mirrors; "" for the drop directory itself
+} Watch;
+
+static int g_fd = -1;
+static char g_root[PATH_MAX];
+static Watch g_watches[WATCH_MAX];
+static int g_watch_count = 0;
+
+static WorldFileChange g_changes[WATCH_HISTORY];
+static uint32_t g_change_count = 0;
+static int g_budget = 0;        // Changes the current batch may still record
+static bool g_rescan = false;   // Files were left in the drop tree for a later batch
+
+static Watch* find_watch(int wd) {
+    for (int i = 0; i < g_watch_count; i++) {
+        if (g_watches[i].wd == wd) return &g_watches[i];
+    }
+    return NULL;
+}
+
+static void forget_watch(int wd) {
+    for (int i = 0; i < g_watch_count; i++) {
+        if (g_watches[i].wd == wd) {
+            g_watches[i] = g_watches[--g_watch_count];
+            return;
+        }
+    }
+}
+
+// Stops watching 'dir' and everything below it (moved out of the drop tree;
+// if it was moved within, its new place is watched afresh).
+static void unwatch_tree(const char* dir) {
+    size_t len = strlen(dir);
+    for (int i = g_watch_count - 1; i >= 0; i--) {
+        const char* path = g_watches[i].path;
+        if (strncmp(path, dir, len) == 0 && (path[len] == '\0' || path[len] == '/')) {
+            inotify_rm_watch(g_fd, g_watches[i].wd);
+            g_watches[i] = g_watches[--g_watch_count];
+        }
+    }
+}
+
+static bool host_path(const char* dir, const char* name, char* out, size_t size) {
+    int n = name ? snprintf(out, size, "%s%s/%s", g_root, dir, name) : snprintf(out, size, "%s%s", g_root, dir);
+    return n > 0 && (size_t)n < size;
+}
+
+static void record_change(const char* path, bool removed, uint32_t before) {
+    g_budget--;
+    WorldFileChange* change = &g_changes[g_change_count % WATCH_HISTORY];
+    snprintf(change->path, sizeof(change->path), "%s", path);
+    change->removed = removed;
+    change->generation_before = before;
+    change->generation_after = vfs_generation();
+
+    Event e;
+    memset(&e, 0, sizeof(e));
+    e.type = WORLD_FILE_EVENT;
+    e.data.world_file.change_id = g_change_count++;
+    // If the ring is full the change still stands; listings catch up by generation.
+    (void)push_event(e);
+}
+
+static bool read_file(int fd, size_t size, char** out) {
+    char* data = malloc(size + 1);
+    if (data == NULL) return false;
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read(fd, data + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += (size_t)n;
+    }
+    if (done != size) { // Changed under us; its close will bring it back
+        free(data);
+        return false;
+    }
+    *out = data;
+    return true;
+}
+
+// Delivers the drop file 'name' in 'dir' (a virtual directory path) and
+// deletes it. A file that cannot be delivered is left where it is, as is
+// every file once the batch is full, for the sweep of a later one.
+static bool take_file(const char* dir, const char* name) {
+    if (g_budget <= 0) {
+        g_rescan = true;
+        return false;
+    }
+    bool removed = strncmp(name, WORLD_WATCH_WHITEOUT, strlen(WORLD_WATCH_WHITEOUT)) == 0;
+    const char* target = removed ? name + strlen(WORLD_WATCH_WHITEOUT) : name;
+    if (target[0] == '\0' || target[0] == '.') return false; // Temporary files, or nothing to name
+
+    char source[PATH_MAX];
+    char path[VFS_PATH_MAX];
+    int n = snprintf(path, sizeof(path), "%s/%s", dir, target);
+    if (!host_path(dir, name, source, sizeof(source)) || n <= 0 || (size_t)n >= sizeof(path)) return false;
+
+    int fd = open(source, O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    if ((size_t)st.st_size > WORLD_WATCH_FILE_MAX) {
+        close(fd);
+        logger_log("Not delivering %s: larger than %u bytes.", source, WORLD_WATCH_FILE_MAX);
+        return false;
+    }
+
+    uint32_t before = vfs_generation();
+    bool ok;
+    bool changed = true;
+    if (removed) {
+        changed = vfs_stat(path, NULL);
+        ok = !changed || vfs_remove(path);
+    } else {
+        char* data = NULL;
+        ok = read_file(fd, (size_t)st.st_size, &data) && vfs_write(path, data, (size_t)st.st_size);
+        free(data);
+    }
+    close(fd);
+    if (!ok) {
+        logger_log("Could not deliver %s to %s; leaving it in place.", source, path);
+        return false;
+    }
+    if (unlink(source) != 0) logger_log("Delivered %s but could not remove it: %s", source, strerror(errno));
+    if (!changed) return false;
+    LOG_DEBUG("World %s %s from the drop directory.", path, removed ? "removed" : "delivered");
+    record_change(path, removed, before);
+    return true;
+}
+
+static int watch_tree(const char* dir);
+
+// Takes every file under 'dir' and watches its subdirectories.
+static int sweep(const char* dir) {
+    char host[PATH_MAX];
+    if (!host_path(dir, NULL, host, sizeof(host))) return 0;
+    DIR* d = opendir(host);
+    if (d == NULL) return 0;
+    int applied = 0;
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+        char child[PATH_MAX];
+        struct stat st;
+        if (!host_path(dir, ent->d_name, child, sizeof(child)) || lstat(child, &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            char path[VFS_PATH_MAX];
+            int n = snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+            if (n > 0 && (size_t)n < sizeof(path)) applied += watch_tree(path);
+        } else if (S_ISREG(st.st_mode) && take_file(dir, ent->d_name)) {
+            applied++;
+        }
+    }
+    closedir(d);
+    return applied;
+}
+
+// Watches 'dir' before sweeping it, so nothing lands in between unseen.
+static int watch_tree(const char* dir) {
+    char host[PATH_MAX];
+    if (!host_path(dir, NULL, host, sizeof(host))) return 0;
+    int wd = inotify_add_watch(g_fd, host, WATCH_EVENTS);
+    if (wd < 0) {
+        logger_log("Cannot watch %s: %s", host, strerror(errno));
+        return 0;
+    }
+    Watch* watch = find_watch(wd);
+    if (watch == NULL) {
+        if (g_watch_count == WATCH_MAX) {
+            inotify_rm_watch(g_fd, wd);
+            logger_log("Not watching %s: more than %d directories.", host, WATCH_MAX);
+            return 0;
+        }
+        watch = &g_watches[g_watch_count++];
+        watch->wd = wd;
+    }
+    snprintf(watch->path, sizeof(watch->path), "%s", dir);
+    return sweep(dir);
+}
+
+// --- Public Functions ---
+
+bool world_watch_start(const char* drop_dir) {
+    world_watch_stop();
+    if (drop_dir == NULL || strlen(drop_dir) >= sizeof(g_root)) return false;
+    if (!ensure_directory_exists_recursive(drop_dir, 0700)) return false;
+    g_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_fd < 0) {
+        logger_log("inotify unavailable: %s", strerror(errno));
+        return false;
+    }
+    snprintf(g_root, sizeof(g_root), "%s", drop_dir);
+    size_t len = strlen(g_root);
+    while (len > 1 && g_root[len - 1] == '/') g_root[--len] = '\0';
+
+    // Only the watches are set up here. What is already there is left for
+    // the first poll, whose events the main loop reads before the next poll
+    // can overwrite their changes.
+    g_budget = 0;
+    watch_tree("");
+    if (g_watch_count == 0) { // The drop directory itself could not be watched
+        world_watch_stop();
+        return false;
+    }
+    LOG_DEBUG("Watching %s%s.", g_root, g_rescan ? "; files already there are taken on the first poll" : "");
+    return true;
+}
+
+void world_watch_stop(void) {
+    if (g_fd >= 0) close(g_fd); // Drops every watch with it
+    g_fd = -1;
+    g_watch_count = 0;
+    g_root[0] = '\0';
+    g_rescan = false;
+}
+
+int world_watch_fd(void) {
+    return g_fd;
+}
+
+bool world_watch_pending(void) {
+    return g_fd >= 0 && g_rescan;
+}
+
+int world_watch_poll(void) {
+    if (g_fd < 0) return 0;
+    // One batch per call, of at most WATCH_HISTORY changes, so each change's
+    // event can still name it: further events stay queued, and files past the
+    // budget stay in the drop tree for the next call's sweep.
+    g_budget = WATCH_HISTORY;
+    vfs_batch_begin();
+    int applied = 0;
+    if (g_rescan) {
+        g_rescan = false;
+        applied += sweep("");
+    }
+    char buf[WATCH_BATCH] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len = 0;
+    if (g_budget > 0) {
+        do {
+            len = read(g_fd, buf, sizeof(buf));
+        } while (len < 0 && errno == EINTR);
+    }
+    for (char* p = buf; len > 0 && p < buf + len; ) { // len <= 0: EAGAIN, nothing pending
+        const struct inotify_event* ev = (const struct inotify_event*)p;
+        p += sizeof(struct inotify_event) + ev->len;
+
+        if (ev->mask & IN_Q_OVERFLOW) { // Events were lost: look at everything
+            applied += sweep("");
+            continue;
+        }
+        if (ev->mask & IN_IGNORED) {
+            forget_watch(ev->wd);
+            continue;
+        }
+        Watch* watch = find_watch(ev->wd);
+        if (watch == NULL || ev->len == 0) continue;
+        // 'watch' may move when watching a subdirectory; keep its path.
+        char dir[VFS_PATH_MAX];
+        snprintf(dir, sizeof(dir), "%s", watch->path);
+        if (ev->mask & IN_ISDIR) {
+            char path[VFS_PATH_MAX];
+            int n = snprintf(path, sizeof(path), "%s/%s", dir, ev->name);
+            if (n <= 0 || (size_t)n >= sizeof(path)) continue;
+            if (ev->mask & IN_MOVED_FROM) unwatch_tree(path);
+            else if (ev->mask & (IN_CREATE | IN_MOVED_TO)) applied += watch_tree(path);
+        } else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+            // A plain create is followed by its close once written.
+            if (take_file(dir, ev->name)) applied++;
+        }
+    }
+    vfs_batch_end();
+    return applied;
+}
+
+bool world_watch_change(uint32_t change_id, WorldFileChange* out) {
+    if (change_id >= g_change_count || g_change_count - change_id > WATCH_HISTORY) return false;
+    if (out) *out = g_changes[change_id % WATCH_HISTORY];
+    return true;
+}
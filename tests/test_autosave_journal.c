@@ -0,0 +1,185 @@
+// Unit tests for autosave recovery (autosave.c): a journal's records replay
+// over its snapshot, a torn or damaged tail ends the replay cleanly, and a
+// journal that does not extend the snapshot on disk is ignored.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "game_types.h"
+#include "autosave.h"
+#include "data_loader.h"
+#include "flag_system.h"
+#include "player_items.h"
+#include "characters/mika.h"
+#include "map_loader.h"
+#include "byte_util.h"
+#include "test_util.h"
+
+#define SAVE_PATH "test_autosave_journal.sav"
+#define JOURNAL_PATH "test_autosave_journal" AUTOSAVE_JOURNAL_EXTENSION
+#define RECORD_COUNT 3
+
+static GameState* new_state(void) {
+    GameState* gs = calloc(1, sizeof(GameState));
+    gs->flags = create_hash_table(MAX_FLAGS);
+    return gs;
+}
+
+static void free_state(GameState* gs) {
+    free_hash_table(gs->flags);
+    free(gs);
+}
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t record_end[RECORD_COUNT]; // Offset just past each record
+} Journal;
+
+static void append(Journal* j, const void* bytes, size_t n) {
+    j->data = realloc(j->data, j->size + n);
+    memcpy(j->data + j->size, bytes, n);
+    j->size += n;
+}
+
+// The change each record carries, applied to 'gs'.
+static void make_change(GameState* gs, int record) {
+    switch (record) {
+        case 0:
+            gs->player_state.location = location_id_from_string("iwakura_study");
+            hash_table_set(gs->flags, "met_dad", "1");
+            break;
+        case 1:
+            player_add_item(&gs->player_state, ITEM_MOBILE_PHONE, 1);
+            break;
+        default:
+            gs->player_state.credit_level = 4;
+            hash_table_set(gs->flags, "met_dad", "2");
+            break;
+    }
+}
+
+// Writes the snapshot and builds, in memory, the journal the writer thread
+// would append after it.
+static Journal write_session(void) {
+    GameState* gs = new_state();
+    gs->player_state.location = location_id_from_string("iwakura_upper_hallway");
+    gs->player_state.credit_level = 1;
+    strcpy(gs->current_scene_id, "SCENE_IWAKURA_UPPER_HALLWAY");
+    CHECK(save_state_write(SAVE_PATH, gs) == SAVE_STATE_OK);
+
+    char* snapshot = NULL;
+    long snapshot_size = 0;
+    CHECK(read_entire_file(SAVE_PATH, &snapshot, &snapshot_size) == DATA_LOADER_SUCCESS);
+    Journal j = {0};
+    unsigned char header[12];
+    memcpy(header, AUTOSAVE_JOURNAL_MAGIC, 4);
+    store_u32(header + 4, AUTOSAVE_JOURNAL_VERSION);
+    store_u32(header + 8, (uint32_t)crc32(crc32(0L, Z_NULL, 0), (const Bytef*)snapshot, (uInt)snapshot_size));
+    append(&j, header, sizeof(header));
+    free(snapshot);
+
+    SaveStateShadow* shadow = save_state_shadow_create(gs);
+    for (int i = 0; i < RECORD_COUNT; i++) {
+        make_change(gs, i);
+        unsigned char* record = NULL;
+        size_t record_size = 0;
+        CHECK(save_state_encode_delta(gs, shadow, &record, &record_size) == SAVE_STATE_OK);
+        unsigned char prefix[4];
+        store_u32(prefix, (uint32_t)record_size);
+        append(&j, prefix, 4);
+        append(&j, record, record_size);
+        j.record_end[i] = j.size;
+        free(record);
+    }
+    save_state_shadow_free(shadow);
+    free_state(gs);
+    return j;
+}
+
+static void write_journal(const unsigned char* data, size_t size) {
+    FILE* f = fopen(JOURNAL_PATH, "wb");
+    CHECK(f != NULL);
+    if (f == NULL) return;
+    CHECK(fwrite(data, 1, size, f) == size);
+    fclose(f);
+}
+
+// Recovers the session and checks it holds exactly the first 'records'.
+static void check_recovery(int records) {
+    GameState* gs = new_state();
+    int replayed = -1;
+    CHECK(autosave_recover(SAVE_PATH, gs, &replayed) == SAVE_STATE_OK);
+    CHECK(replayed == records);
+
+    const PlayerState* ps = &gs->player_state;
+    CHECK(strcmp(location_id_to_string(ps->location), records >= 1 ? "iwakura_study" : "iwakura_upper_hallway") == 0);
+    CHECK(player_item_quantity(ps, ITEM_MOBILE_PHONE) == (records >= 2 ? 1 : 0));
+    CHECK(ps->credit_level == (records >= 3 ? 4 : 1));
+    const char* met = hash_table_get(gs->flags, "met_dad");
+    const char* expected = records >= 3 ? "2" : records >= 1 ? "1" : NULL;
+    CHECK(expected ? met && strcmp(met, expected) == 0 : met == NULL);
+    free_state(gs);
+}
+
+static void test_replay(const Journal* j) {
+    write_journal(j->data, j->size);
+    check_recovery(RECORD_COUNT);
+
+    // No journal at all: the snapshot alone.
+    unlink(JOURNAL_PATH);
+    check_recovery(0);
+}
+
+static void test_torn_tail(const Journal* j) {
+    // Cut at every byte of the last record: its size prefix, then its body.
+    for (size_t cut = j->record_end[RECORD_COUNT - 2] + 1; cut < j->size; cut++) {
+        write_journal(j->data, cut);
+        check_recovery(RECORD_COUNT - 1);
+    }
+
+    // A complete record with a flipped bit fails its CRC; replay stops there.
+    unsigned char* copy = malloc(j->size);
+    memcpy(copy, j->data, j->size);
+    copy[j->size - 2] ^= 0x01;
+    write_journal(copy, j->size);
+    check_recovery(RECORD_COUNT - 1);
+
+    // Garbage after the last record is dropped.
+    memcpy(copy, j->data, j->size);
+    write_journal(copy, j->size);
+    FILE* f = fopen(JOURNAL_PATH, "ab");
+    fwrite("\x05\x00\x00\x00garbage", 1, 11, f);
+    fclose(f);
+    check_recovery(RECORD_COUNT);
+    free(copy);
+}
+
+static void test_foreign_journal(const Journal* j) {
+    // The snapshot's CRC does not match: left over from an older snapshot.
+    unsigned char* copy = malloc(j->size);
+    memcpy(copy, j->data, j->size);
+    copy[8] ^= 0xFF;
+    write_journal(copy, j->size);
+    check_recovery(0);
+
+    memcpy(copy, j->data, j->size);
+    copy[0] = 'X';
+    write_journal(copy, j->size);
+    check_recovery(0);
+    free(copy);
+}
+
+int main(void) {
+    init_mika_module();
+    Journal j = write_session();
+    test_replay(&j);
+    test_torn_tail(&j);
+    test_foreign_journal(&j);
+    free(j.data);
+    unlink(JOURNAL_PATH);
+    unlink(SAVE_PATH);
+    return test_finish("test_autosave_journal");
+}
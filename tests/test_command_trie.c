@@ -0,0 +1,185 @@
+// Unit tests for the radix trie (command_trie.c), checked against a plain
+// array of keys: lookups of keys and of prefixes, splits on insert, merges on
+// remove, and completion (matches in byte order, the common continuation).
+
+#include <stdlib.h>
+#include <string.h>
+#include "command_trie.h"
+#include "test_util.h"
+
+#define MODEL_MAX 512
+#define KEY_MAX 8
+
+// The brute-force model: every key present, unsorted.
+typedef struct {
+    char keys[MODEL_MAX][KEY_MAX];
+    int values[MODEL_MAX];
+    int count;
+} Model;
+
+static int model_find(const Model* m, const char* key) {
+    for (int i = 0; i < m->count; i++) {
+        if (strcmp(m->keys[i], key) == 0) return i;
+    }
+    return -1;
+}
+
+static void model_set(Model* m, const char* key, int value) {
+    int i = model_find(m, key);
+    if (i < 0) {
+        i = m->count++;
+        strcpy(m->keys[i], key);
+    }
+    m->values[i] = value;
+}
+
+static bool model_remove(Model* m, const char* key) {
+    int i = model_find(m, key);
+    if (i < 0) return false;
+    m->count--;
+    memcpy(m->keys[i], m->keys[m->count], KEY_MAX);
+    m->values[i] = m->values[m->count];
+    return true;
+}
+
+static int compare_keys(const void* a, const void* b) {
+    return strcmp(a, b);
+}
+
+static void check_completion(const CommandTrie* trie, const Model* m, const char* prefix) {
+    size_t len = strlen(prefix);
+    char sorted[MODEL_MAX][KEY_MAX];
+    int n = 0;
+    for (int i = 0; i < m->count; i++) {
+        if (strncmp(m->keys[i], prefix, len) == 0) strcpy(sorted[n++], m->keys[i]);
+    }
+    qsort(sorted, (size_t)n, KEY_MAX, compare_keys);
+
+    LineEditorCompletion out;
+    command_trie_complete(trie, prefix, len, &out);
+    CHECK(out.match_count == n);
+    for (int i = 0; i < n && i < LINE_EDITOR_COMPLETION_MAX; i++) CHECK(strcmp(out.matches[i], sorted[i]) == 0);
+
+    // What every match continues with: their common prefix, past 'prefix'.
+    size_t common = n > 0 ? strlen(sorted[0]) : len;
+    for (int i = 1; i < n; i++) {
+        size_t j = 0;
+        while (j < common && sorted[i][j] == sorted[0][j]) j++;
+        common = j;
+    }
+    char expected[KEY_MAX] = "";
+    if (n > 0) memcpy(expected, sorted[0] + len, common - len);
+    expected[n > 0 ? common - len : 0] = '\0';
+    CHECK(strcmp(out.insert, expected) == 0);
+}
+
+// Every key, and every string of up to three letters, as a lookup and as a
+// completion prefix.
+static void check_against_model(const CommandTrie* trie, const Model* m) {
+    CHECK(command_trie_count(trie) == m->count);
+    for (int i = 0; i < m->count; i++) {
+        CHECK(command_trie_find(trie, m->keys[i], strlen(m->keys[i])) == m->values[i]);
+    }
+    static const char letters[] = "abc";
+    char probe[4];
+    check_completion(trie, m, "");
+    for (int a = 0; a < 3; a++) {
+        for (int b = -1; b < 3; b++) {
+            for (int c = -1; c < 3; c++) {
+                if (b < 0 && c >= 0) continue;
+                int len = 0;
+                probe[len++] = letters[a];
+                if (b >= 0) probe[len++] = letters[b];
+                if (c >= 0) probe[len++] = letters[c];
+                probe[len] = '\0';
+                int i = model_find(m, probe);
+                CHECK(command_trie_find(trie, probe, (size_t)len) == (i >= 0 ? m->values[i] : -1));
+                check_completion(trie, m, probe);
+            }
+        }
+    }
+}
+
+static uint32_t g_rand_state = 42;
+
+static uint32_t next_rand(void) {
+    g_rand_state = g_rand_state * 1103515245u + 12345u;
+    return g_rand_state >> 8;
+}
+
+// Keys over three letters share prefixes often, so edges keep splitting and
+// merging.
+static void random_key(char* key) {
+    int len = 1 + (int)(next_rand() % (KEY_MAX - 3));
+    for (int i = 0; i < len; i++) key[i] = "abc"[next_rand() % 3];
+    key[len] = '\0';
+}
+
+static void test_random(void) {
+    CommandTrie* trie = command_trie_create();
+    static Model model;
+    model.count = 0;
+    for (int step = 0; step < 4000; step++) {
+        char key[KEY_MAX];
+        random_key(key);
+        if (next_rand() % 3 != 0) {
+            int value = (int)(next_rand() % 1000);
+            CHECK(command_trie_insert(trie, key, value));
+            model_set(&model, key, value);
+        } else {
+            CHECK(command_trie_remove(trie, key) == model_remove(&model, key));
+        }
+        if (step % 200 == 0) check_against_model(trie, &model);
+    }
+    check_against_model(trie, &model);
+
+    // Emptying it removes every node again.
+    while (model.count > 0) {
+        char key[KEY_MAX];
+        strcpy(key, model.keys[0]);
+        CHECK(command_trie_remove(trie, key));
+        CHECK(!command_trie_remove(trie, key));
+        model_remove(&model, key);
+    }
+    check_against_model(trie, &model);
+    command_trie_free(trie);
+}
+
+static void test_split_and_merge(void) {
+    CommandTrie* trie = command_trie_create();
+    CHECK(command_trie_insert(trie, "inventory", 1));
+    CHECK(command_trie_insert(trie, "inv", 2));      // Splits the edge
+    CHECK(command_trie_insert(trie, "invite", 3));   // Splits it again
+    CHECK(command_trie_find(trie, "inventory", 9) == 1);
+    CHECK(command_trie_find(trie, "inve", 4) == -1);
+    CHECK(command_trie_find(trie, "invitex", 6) == 3); // Only 'len' bytes count
+
+    LineEditorCompletion out;
+    command_trie_complete(trie, "i", 1, &out);
+    CHECK(out.match_count == 3 && strcmp(out.insert, "nv") == 0);
+    CHECK(strcmp(out.matches[0], "inv") == 0 && strcmp(out.matches[2], "invite") == 0);
+
+    // Removing "inv" leaves a keyless node with two children; removing
+    // "invite" too merges it with "entory" into one edge.
+    CHECK(command_trie_remove(trie, "inv"));
+    CHECK(command_trie_remove(trie, "invite"));
+    command_trie_complete(trie, "in", 2, &out);
+    CHECK(out.match_count == 1 && strcmp(out.insert, "ventory") == 0);
+    CHECK(command_trie_find(trie, "inventory", 9) == 1);
+
+    CHECK(command_trie_insert(trie, "inventory", 4)); // Replaces
+    CHECK(command_trie_count(trie) == 1);
+    CHECK(command_trie_find(trie, "inventory", 9) == 4);
+
+    command_trie_clear(trie);
+    CHECK(command_trie_count(trie) == 0);
+    CHECK(command_trie_find(trie, "inventory", 9) == -1);
+    CHECK(!command_trie_insert(trie, "", 1));
+    command_trie_free(trie);
+}
+
+int main(void) {
+    test_split_and_merge();
+    test_random();
+    return test_finish("test_command_trie");
+}
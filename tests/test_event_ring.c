@@ -0,0 +1,103 @@
+// Unit tests for the event ring (event_system.c): full and empty, FIFO order
+// across many wrap-arounds, drop counters, and tick coalescing.
+
+#include <string.h>
+#include "event_system.h"
+#include "test_util.h"
+
+static Event worker_event(int id) {
+    Event e;
+    memset(&e, 0, sizeof(e));
+    e.type = WORKER_DONE_EVENT;
+    e.data.worker.worker_id = id;
+    return e;
+}
+
+static void test_full_and_empty(void) {
+    init_event_queue();
+    Event e;
+    CHECK(!poll_event(&e));
+
+    for (int i = 0; i < MAX_EVENTS; i++) CHECK(push_event(worker_event(i)));
+    CHECK(!push_event(worker_event(MAX_EVENTS)));
+    CHECK(!push_event(worker_event(MAX_EVENTS + 1)));
+
+    for (int i = 0; i < MAX_EVENTS; i++) {
+        CHECK(poll_event(&e));
+        CHECK(e.type == WORKER_DONE_EVENT && e.data.worker.worker_id == i);
+    }
+    CHECK(!poll_event(&e));
+
+    EventQueueStats stats;
+    get_event_queue_stats(&stats);
+    CHECK(stats.pushed == MAX_EVENTS);
+    CHECK(stats.polled == MAX_EVENTS);
+    CHECK(stats.dropped[WORKER_DONE_EVENT] == 2);
+    CHECK(stats.dropped[INPUT_EVENT] == 0);
+}
+
+// Fill levels that vary from lap to lap, so the head and tail cross the end
+// of the ring at every offset.
+static void test_wrap_around(void) {
+    init_event_queue();
+    int next_push = 0, next_poll = 0;
+    for (int round = 0; round < 4 * MAX_EVENTS; round++) {
+        int burst = 1 + (round * 37) % MAX_EVENTS;
+        for (int i = 0; i < burst; i++) {
+            if (!push_event(worker_event(next_push))) break;
+            next_push++;
+        }
+        int drain = 1 + (round * 53) % MAX_EVENTS;
+        Event e;
+        for (int i = 0; i < drain && poll_event(&e); i++) {
+            CHECK(e.data.worker.worker_id == next_poll);
+            next_poll++;
+        }
+        CHECK(next_push - next_poll >= 0 && next_push - next_poll <= MAX_EVENTS);
+    }
+    Event e;
+    while (poll_event(&e)) {
+        CHECK(e.data.worker.worker_id == next_poll);
+        next_poll++;
+    }
+    CHECK(next_poll == next_push);
+    CHECK(next_push > 4 * MAX_EVENTS);
+}
+
+static void test_tick_coalescing(void) {
+    init_event_queue();
+    for (int i = 0; i < 5; i++) push_tick_event();
+    CHECK(push_event(worker_event(1)));
+    push_tick_event(); // Folded into the marker already queued
+
+    Event e;
+    CHECK(poll_event(&e));
+    CHECK(e.type == TIME_TICK_EVENT && e.data.tick.count == 6);
+    CHECK(poll_event(&e));
+    CHECK(e.type == WORKER_DONE_EVENT);
+    CHECK(!poll_event(&e));
+
+    // A tick that finds the ring full is delivered once it has drained.
+    for (int i = 0; i < MAX_EVENTS; i++) CHECK(push_event(worker_event(i)));
+    push_tick_event();
+    push_tick_event();
+    int workers = 0, ticks = 0;
+    while (poll_event(&e)) {
+        if (e.type == WORKER_DONE_EVENT) workers++;
+        if (e.type == TIME_TICK_EVENT) ticks += (int)e.data.tick.count;
+    }
+    CHECK(workers == MAX_EVENTS);
+    CHECK(ticks == 2);
+
+    EventQueueStats stats;
+    get_event_queue_stats(&stats);
+    CHECK(stats.ticks_produced == 8);
+    CHECK(stats.tick_events == 2);
+}
+
+int main(void) {
+    test_full_and_empty();
+    test_wrap_around();
+    test_tick_coalescing();
+    return test_finish("test_event_ring");
+}
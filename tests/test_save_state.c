@@ -0,0 +1,154 @@
+// Unit tests for binary saves (save_state.c): a state survives an encode and
+// decode, and a damaged buffer is rejected without touching the state.
+
+#include <stdlib.h>
+#include <string.h>
+#include "game_types.h"
+#include "save_state.h"
+#include "flag_system.h"
+#include "player_items.h"
+#include "npc_schedule.h"
+#include "characters/mika.h"
+#include "map_loader.h"
+#include "test_util.h"
+
+#define HEADER_SIZE 12
+#define SECTION_HEADER_SIZE 12
+
+static GameState* new_state(void) {
+    GameState* gs = calloc(1, sizeof(GameState));
+    gs->flags = create_hash_table(MAX_FLAGS);
+    return gs;
+}
+
+static void free_state(GameState* gs) {
+    free_hash_table(gs->flags);
+    free(gs);
+}
+
+static void fill_state(GameState* gs) {
+    PlayerState* ps = &gs->player_state;
+    ps->location = location_id_from_string("iwakura_upper_hallway");
+    ps->credit_level = 3;
+    ps->persona_permissions = PERM_LAIN_READ | PERM_LAIN_EXEC;
+    player_add_item(ps, ITEM_SCREWDRIVER, 1);
+    player_add_item(ps, ITEM_BUS_PASS, 4);
+    player_unlock_command(ps, COMMAND_HELP);
+    player_unlock_command(ps, COMMAND_NAVI);
+    strcpy(gs->current_scene_id, "SCENE_IWAKURA_UPPER_HALLWAY");
+    gs->time_of_day = 125353995;
+    gs->typewriter_delay = 0.25f;
+    gs->doll_state_lain_room = 2;
+    gs->doll_state_mika_room = -1;
+    hash_table_set(gs->flags, "met_dad", "1");
+    hash_table_set(gs->flags, "mail_read", "ccc_003");
+    npc_move_to(NPC_DAD, "iwakura_study");
+}
+
+static void check_state(const GameState* gs) {
+    const PlayerState* ps = &gs->player_state;
+    CHECK(strcmp(location_id_to_string(ps->location), "iwakura_upper_hallway") == 0);
+    CHECK(ps->credit_level == 3);
+    CHECK(ps->persona_permissions == (PERM_LAIN_READ | PERM_LAIN_EXEC));
+    CHECK(player_item_count(ps) == 2);
+    CHECK(player_item_quantity(ps, ITEM_SCREWDRIVER) == 1);
+    CHECK(player_item_quantity(ps, ITEM_BUS_PASS) == 4);
+    CHECK(player_command_count(ps) == 2);
+    CHECK(player_command_unlocked(ps, COMMAND_HELP) && player_command_unlocked(ps, COMMAND_NAVI));
+    CHECK(strcmp(gs->current_story_file, "SCENE_IWAKURA_UPPER_HALLWAY") == 0);
+    CHECK(gs->time_of_day == 125353995);
+    CHECK(gs->typewriter_delay == 0.25f);
+    CHECK(gs->doll_state_lain_room == 2 && gs->doll_state_mika_room == -1);
+    CHECK(hash_table_get(gs->flags, "met_dad") && strcmp(hash_table_get(gs->flags, "met_dad"), "1") == 0);
+    CHECK(hash_table_get(gs->flags, "mail_read") && strcmp(hash_table_get(gs->flags, "mail_read"), "ccc_003") == 0);
+    CHECK(npc_is_manually_positioned(NPC_DAD));
+    CHECK(strcmp(npc_current_location(NPC_DAD), "iwakura_study") == 0);
+}
+
+static void test_round_trip(void) {
+    GameState* original = new_state();
+    fill_state(original);
+    unsigned char* data = NULL;
+    size_t size = 0;
+    CHECK(save_state_encode(original, &data, &size) == SAVE_STATE_OK);
+    CHECK(size > HEADER_SIZE && memcmp(data, SAVE_STATE_MAGIC, 4) == 0);
+
+    npc_return_to_schedule(NPC_DAD);
+    GameState* loaded = new_state();
+    hash_table_set(loaded->flags, "stale", "1"); // The save's flags replace the store
+    CHECK(save_state_decode(data, size, loaded) == SAVE_STATE_OK);
+    check_state(loaded);
+    CHECK(hash_table_get(loaded->flags, "stale") == NULL);
+
+    // What was decoded encodes and decodes to the same state again.
+    unsigned char* again = NULL;
+    size_t again_size = 0;
+    CHECK(save_state_encode(loaded, &again, &again_size) == SAVE_STATE_OK);
+    GameState* reloaded = new_state();
+    CHECK(save_state_decode(again, again_size, reloaded) == SAVE_STATE_OK);
+    check_state(reloaded);
+    CHECK(hash_table_count(reloaded->flags) == hash_table_count(loaded->flags));
+
+    free_state(reloaded);
+    free(again);
+    free(data);
+    free_state(loaded);
+    free_state(original);
+}
+
+// Decodes a damaged copy into a fresh state and checks nothing was applied.
+static void check_rejected(const unsigned char* data, size_t size, SaveStateStatus expected) {
+    GameState* gs = new_state();
+    gs->player_state.location = location_id_from_string("shibuya_street");
+    hash_table_set(gs->flags, "kept", "1");
+    CHECK(save_state_decode(data, size, gs) == expected);
+    CHECK(gs->player_state.location == location_id_from_string("shibuya_street"));
+    CHECK(hash_table_get(gs->flags, "kept") != NULL);
+    CHECK(player_item_count(&gs->player_state) == 0);
+    free_state(gs);
+}
+
+static void test_damage(void) {
+    GameState* original = new_state();
+    fill_state(original);
+    unsigned char* data = NULL;
+    size_t size = 0;
+    CHECK(save_state_encode(original, &data, &size) == SAVE_STATE_OK);
+    unsigned char* copy = malloc(size);
+
+    // One flipped bit in each section's payload fails its CRC.
+    size_t pos = HEADER_SIZE;
+    int sections = 0;
+    while (pos + SECTION_HEADER_SIZE <= size) {
+        uint32_t payload = data[pos + 4] | data[pos + 5] << 8 | data[pos + 6] << 16 | (uint32_t)data[pos + 7] << 24;
+        if (payload > 0) {
+            memcpy(copy, data, size);
+            copy[pos + SECTION_HEADER_SIZE + payload / 2] ^= 0x10;
+            check_rejected(copy, size, SAVE_STATE_ERROR_CHECKSUM);
+        }
+        pos += SECTION_HEADER_SIZE + payload;
+        sections++;
+    }
+    CHECK(pos == size);
+    CHECK(sections == (data[6] | data[7] << 8));
+
+    check_rejected(data, size - 1, SAVE_STATE_ERROR_FORMAT);
+    check_rejected(data, HEADER_SIZE - 1, SAVE_STATE_ERROR_FORMAT);
+    memcpy(copy, data, size);
+    copy[0] = 'X';
+    check_rejected(copy, size, SAVE_STATE_ERROR_FORMAT);
+    memcpy(copy, data, size);
+    copy[4] = SAVE_STATE_VERSION + 1;
+    check_rejected(copy, size, SAVE_STATE_ERROR_VERSION);
+
+    free(copy);
+    free(data);
+    free_state(original);
+}
+
+int main(void) {
+    init_mika_module();
+    test_round_trip();
+    test_damage();
+    return test_finish("test_save_state");
+}
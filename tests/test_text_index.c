@@ -0,0 +1,216 @@
+// Unit tests for the search index (text_index.c), checked against scanning
+// every document: word and phrase search over ASCII text, and substring
+// candidates over mixed ASCII and CJK text, which must never leave out a
+// document that holds the substring.
+
+#include <stdlib.h>
+#include <string.h>
+#include "text_index.h"
+#include "test_util.h"
+
+#define DOC_COUNT 120
+#define DOC_MAX 512
+#define DOC_TOKENS_MAX 128
+
+static const char* const g_ascii_words[] = {
+    "lain", "Lain", "wired", "NAVI", "navi", "protocol", "knights", "cyberia",
+    "accela", "7th", "psyche", "arisu", "cyberia_club", "x", "wire"
+};
+static const char* const g_cjk_words[] = { "レイン", "ワイヤード", "東京", "岩倉", "玲音", "ナビ" };
+static const char* const g_separators[] = { " ", ", ", ". ", "-", " (", ") ", "\n" };
+
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static uint32_t g_rand_state = 7;
+
+static uint32_t next_rand(void) {
+    g_rand_state = g_rand_state * 1103515245u + 12345u;
+    return g_rand_state >> 8;
+}
+
+static void make_doc(char* doc, bool with_cjk) {
+    int words = 1 + (int)(next_rand() % 40);
+    size_t len = 0;
+    doc[0] = '\0';
+    for (int w = 0; w < words; w++) {
+        const char* word = with_cjk && next_rand() % 3 == 0 ? g_cjk_words[next_rand() % COUNT_OF(g_cjk_words)]
+                                                           : g_ascii_words[next_rand() % COUNT_OF(g_ascii_words)];
+        const char* sep = g_separators[next_rand() % COUNT_OF(g_separators)];
+        if (len + strlen(word) + strlen(sep) + 1 > DOC_MAX) break;
+        len += (size_t)sprintf(doc + len, "%s%s", word, sep);
+    }
+}
+
+// --- Brute Force ---
+
+typedef struct {
+    char text[64];
+    size_t offset;
+} DocToken;
+
+static bool is_word_byte(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static char fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+// ASCII documents only: runs of word bytes, lowercased.
+static int scan_tokens(const char* doc, DocToken* tokens) {
+    int count = 0;
+    size_t i = 0;
+    while (doc[i]) {
+        if (!is_word_byte(doc[i])) {
+            i++;
+            continue;
+        }
+        size_t start = i, len = 0;
+        while (is_word_byte(doc[i])) tokens[count].text[len++] = fold(doc[i++]);
+        tokens[count].text[len] = '\0';
+        tokens[count].offset = start;
+        count++;
+    }
+    return count;
+}
+
+// Occurrences of the lowercase words in order, side by side.
+static int scan_phrase(const DocToken* tokens, int count, const char* const* words, int word_count, size_t* first) {
+    int found = 0;
+    for (int i = 0; i + word_count <= count; i++) {
+        int k = 0;
+        while (k < word_count && strcmp(tokens[i + k].text, words[k]) == 0) k++;
+        if (k < word_count) continue;
+        if (found++ == 0) *first = tokens[i].offset;
+    }
+    return found;
+}
+
+static bool contains_folded(const char* doc, const char* text) {
+    size_t n = strlen(text);
+    for (const char* p = doc; *p; p++) {
+        size_t k = 0;
+        while (k < n && p[k] && fold(p[k]) == fold(text[k])) k++;
+        if (k == n) return true;
+    }
+    return n == 0;
+}
+
+// --- Tests ---
+
+static void check_search(const TextIndex* index, char docs[][DOC_MAX], const char* query,
+                         const char* const* first_words, int first_count, const char* const* other_words, int other_count) {
+    static DocToken tokens[DOC_TOKENS_MAX];
+    static TextIndexHit hits[DOC_COUNT];
+    int hit_count = text_index_search(index, query, hits, DOC_COUNT);
+    int expected = 0;
+    for (int d = 0; d < DOC_COUNT; d++) {
+        int count = scan_tokens(docs[d], tokens);
+        size_t first = 0, unused = 0;
+        int occurrences = scan_phrase(tokens, count, first_words, first_count, &first);
+        bool match = occurrences > 0;
+        for (int w = 0; w < other_count && match; w++) match = scan_phrase(tokens, count, &other_words[w], 1, &unused) > 0;
+        if (!match) continue;
+        CHECK(expected < hit_count);
+        if (expected < hit_count) {
+            CHECK(hits[expected].doc == d);
+            CHECK(hits[expected].offset == first);
+            CHECK(hits[expected].occurrences == occurrences);
+        }
+        expected++;
+    }
+    CHECK(hit_count == expected);
+}
+
+static void test_search(void) {
+    static char docs[DOC_COUNT][DOC_MAX];
+    TextIndex* index = text_index_create();
+    for (int d = 0; d < DOC_COUNT; d++) {
+        make_doc(docs[d], false);
+        CHECK(text_index_add(index, d, docs[d], strlen(docs[d])));
+    }
+
+    static const char* const lain[] = { "lain" };
+    static const char* const navi[] = { "navi" };
+    static const char* const wired_lain[] = { "wired", "lain" };
+    static const char* const knights_seventh[] = { "knights", "7th" };
+    check_search(index, docs, "lain", lain, 1, NULL, 0);
+    check_search(index, docs, "LAIN", lain, 1, NULL, 0);
+    check_search(index, docs, "lain navi", lain, 1, navi, 1);
+    check_search(index, docs, "\"wired lain\"", wired_lain, 2, NULL, 0);
+    check_search(index, docs, "\"knights 7th\" navi", knights_seventh, 2, navi, 1);
+
+    TextIndexHit hit;
+    CHECK(text_index_search(index, "absent", &hit, 1) == 0);
+    CHECK(text_index_search(index, "lain absent", &hit, 1) == 0);
+    text_index_free(index);
+}
+
+// A query cut from a document at character boundaries, or a word that may
+// not be anywhere.
+static void pick_text(char docs[][DOC_MAX], char* text, size_t size) {
+    if (next_rand() % 4 == 0) {
+        const char* word = next_rand() % 2 ? g_ascii_words[next_rand() % COUNT_OF(g_ascii_words)]
+                                           : g_cjk_words[next_rand() % COUNT_OF(g_cjk_words)];
+        snprintf(text, size, "%s", next_rand() % 2 ? word : "nowhere");
+        return;
+    }
+    const char* doc = docs[next_rand() % DOC_COUNT];
+    size_t len = strlen(doc);
+    size_t start = next_rand() % len;
+    while (start > 0 && (doc[start] & 0xC0) == 0x80) start--;
+    size_t end = start + 1 + next_rand() % 24;
+    if (end > len) end = len;
+    while (end < len && (doc[end] & 0xC0) == 0x80) end++;
+    if (end - start >= size) end = start + size - 1;
+    memcpy(text, doc + start, end - start);
+    text[end - start] = '\0';
+    for (char* p = text; *p; p++) {
+        if (next_rand() % 5 == 0 && *p >= 'a' && *p <= 'z') *p = (char)(*p - 'a' + 'A');
+    }
+}
+
+static void test_candidates(void) {
+    static char docs[DOC_COUNT][DOC_MAX];
+    TextIndex* index = text_index_create();
+    for (int d = 0; d < DOC_COUNT; d++) {
+        make_doc(docs[d], true);
+        CHECK(text_index_add(index, d, docs[d], strlen(docs[d])));
+    }
+
+    int narrowed = 0;
+    for (int round = 0; round < 2000; round++) {
+        char text[64];
+        pick_text(docs, text, sizeof(text));
+        int candidates[DOC_COUNT];
+        int count = text_index_candidates(index, text, candidates, DOC_COUNT);
+        if (count < 0) continue; // Every document remains a candidate
+        CHECK(count <= DOC_COUNT);
+        for (int i = 1; i < count; i++) CHECK(candidates[i - 1] < candidates[i]);
+
+        int c = 0, holding = 0;
+        for (int d = 0; d < DOC_COUNT; d++) {
+            while (c < count && candidates[c] < d) c++;
+            bool listed = c < count && candidates[c] == d;
+            if (contains_folded(docs[d], text)) {
+                holding++;
+                if (!listed) fprintf(stderr, "document %d holds \"%s\" but is not a candidate\n", d, text);
+                CHECK(listed);
+            }
+        }
+        if (count < DOC_COUNT && count >= holding) narrowed++;
+    }
+    CHECK(narrowed > 0);
+
+    int candidates[DOC_COUNT];
+    CHECK(text_index_candidates(index, " zzzz ", candidates, DOC_COUNT) == 0);
+    CHECK(text_index_candidates(index, "la", candidates, DOC_COUNT) == -1); // May be inside any word
+    CHECK(text_index_candidates(index, " , ", candidates, DOC_COUNT) == -1);
+    text_index_free(index);
+}
+
+int main(void) {
+    test_search();
+    test_candidates();
+    return test_finish("test_text_index");
+}
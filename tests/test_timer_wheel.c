@@ -0,0 +1,142 @@
+// Unit tests for the timer wheel (timer_wheel.c): timers on every level fire
+// on their exact tick after cascading down, in the order they were added;
+// cancelled and stale IDs never fire.
+
+#include <string.h>
+#include "timer_wheel.h"
+#include "test_util.h"
+
+#define TIMER_COUNT 200
+
+typedef struct {
+    TimerWheel* wheel;
+    uint64_t due[TIMER_COUNT];
+    uint64_t fired_at[TIMER_COUNT];
+    int fire_order[TIMER_COUNT];
+    int fire_count;
+} Record;
+
+static bool record_fire(void* context, int arg) {
+    Record* rec = context;
+    rec->fired_at[arg] = rec->wheel->now;
+    rec->fire_order[rec->fire_count++] = arg;
+    return arg % 2 == 0;
+}
+
+static uint32_t g_rand_state = 12345;
+
+static uint32_t next_rand(void) {
+    g_rand_state = g_rand_state * 1103515245u + 12345u;
+    return g_rand_state >> 8;
+}
+
+// Delays spread over all four levels, with the boundaries of each included.
+static uint64_t pick_delay(int i) {
+    static const uint64_t edges[] = { 1, 2, 63, 64, 65, 127, 128, 4095, 4096, 4097, 262143, 262144, 262145 };
+    int edge_count = (int)(sizeof(edges) / sizeof(edges[0]));
+    if (i < edge_count) return edges[i];
+    switch (i % 4) {
+        case 0: return 1 + next_rand() % 63;
+        case 1: return 64 + next_rand() % (4096 - 64);
+        case 2: return 4096 + next_rand() % (262144 - 4096);
+        default: return 262144 + next_rand() % 400000;
+    }
+}
+
+static void test_cascade(uint64_t start) {
+    static TimerWheel wheel;
+    static Record rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.wheel = &wheel;
+    timer_wheel_init(&wheel, start);
+
+    for (int i = 0; i < TIMER_COUNT; i++) {
+        rec.due[i] = start + pick_delay(i);
+        CHECK(timer_wheel_add(&wheel, rec.due[i] - start, record_fire, &rec, i, 0) != 0);
+    }
+
+    // Uneven steps, so some advances cross several level boundaries at once.
+    uint64_t now = start;
+    uint64_t last = start + 262144 + 400000 + 1;
+    bool redraw = false;
+    while (now < last) {
+        int64_t next = timer_wheel_next_due(&wheel);
+        CHECK(next != 0);
+        now += 1 + next_rand() % 5000;
+        if (timer_wheel_advance(&wheel, now)) redraw = true;
+    }
+
+    CHECK(rec.fire_count == TIMER_COUNT);
+    CHECK(redraw);
+    CHECK(wheel.active_count == 0);
+    CHECK(wheel.cascaded > 0);
+    CHECK(timer_wheel_next_due(&wheel) == -1);
+    for (int i = 0; i < TIMER_COUNT; i++) CHECK(rec.fired_at[i] == rec.due[i]);
+    // Firing order follows due ticks, then the order of adding.
+    for (int i = 1; i < rec.fire_count; i++) {
+        int a = rec.fire_order[i - 1], b = rec.fire_order[i];
+        CHECK(rec.due[a] < rec.due[b] || (rec.due[a] == rec.due[b] && a < b));
+    }
+}
+
+static bool add_follow_up(void* context, int arg) {
+    Record* rec = context;
+    record_fire(context, arg);
+    if (arg == 0) timer_wheel_add(rec->wheel, 1, record_fire, rec, 1, 0);
+    return false;
+}
+
+static void test_cancel(void) {
+    static TimerWheel wheel;
+    static Record rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.wheel = &wheel;
+    timer_wheel_init(&wheel, 0);
+
+    TimerId kept = timer_wheel_add(&wheel, 100, record_fire, &rec, 2, 1);
+    TimerId cancelled = timer_wheel_add(&wheel, 5000, record_fire, &rec, 3, 1);
+    timer_wheel_add(&wheel, 70, record_fire, &rec, 4, 7);
+    timer_wheel_add(&wheel, 9000, record_fire, &rec, 5, 7);
+    timer_wheel_add(&wheel, 10, add_follow_up, &rec, 0, 0);
+
+    CHECK(timer_wheel_cancel(&wheel, cancelled));
+    CHECK(!timer_wheel_cancel(&wheel, cancelled));
+    timer_wheel_cancel_group(&wheel, 7);
+    CHECK(wheel.active_count == 2);
+
+    timer_wheel_advance(&wheel, 20000);
+    CHECK(rec.fire_count == 3);
+    CHECK(rec.fire_order[0] == 0 && rec.fired_at[0] == 10);
+    CHECK(rec.fire_order[1] == 1 && rec.fired_at[1] == 11);
+    CHECK(rec.fire_order[2] == 2 && rec.fired_at[2] == 100);
+    CHECK(!timer_wheel_cancel(&wheel, kept)); // Already fired
+
+    // The freed node is reused under a new generation; the old ID misses it.
+    TimerId reused = timer_wheel_add(&wheel, 5, record_fire, &rec, 6, 0);
+    CHECK(reused != 0 && reused != kept && reused != cancelled);
+    CHECK(!timer_wheel_cancel(&wheel, kept));
+    CHECK(timer_wheel_cancel(&wheel, reused));
+}
+
+static bool noop(void* context, int arg) {
+    (void)context;
+    (void)arg;
+    return false;
+}
+
+static void test_full(void) {
+    static TimerWheel wheel;
+    timer_wheel_init(&wheel, 0);
+    for (int i = 0; i < TIMER_WHEEL_MAX_TIMERS; i++) CHECK(timer_wheel_add(&wheel, 1 + i, noop, NULL, i, 0) != 0);
+    CHECK(timer_wheel_add(&wheel, 1, noop, NULL, 0, 0) == 0);
+    timer_wheel_advance(&wheel, 1);
+    CHECK(timer_wheel_add(&wheel, 1, noop, NULL, 0, 0) != 0);
+}
+
+int main(void) {
+    test_cascade(0);
+    test_cascade(4096 * 64 - 3); // Just short of a level-3 wrap
+    test_cancel();
+    test_full();
+    return test_finish("test_timer_wheel");
+}
@@ -0,0 +1,25 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdio.h>
+
+// Shared by the unit tests under tests/, one executable per module, each
+// registered with CTest (add_test() in CMakeLists.txt). A test reports every
+// failed CHECK and exits nonzero if there was any.
+
+static int g_test_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        g_test_failures++; \
+    } \
+} while (0)
+
+static inline int test_finish(const char* name) {
+    if (g_test_failures == 0) printf("%s: passed\n", name);
+    else fprintf(stderr, "%s: %d check(s) failed\n", name, g_test_failures);
+    return g_test_failures == 0 ? 0 : 1;
+}
+
+#endif // TEST_UTIL_H
@@ -0,0 +1,227 @@
+// Unit tests for the world overlay (world_vfs.c): writes, renames (also
+// while the overlay grows) and removals (whiteouts) of packed and overlay
+// files, the journal reopened after a clean close and after a torn tail,
+// and compaction.
+// Usage: test_world_vfs <world.wpk>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "world_vfs.h"
+#include "test_util.h"
+
+#define OVERLAY_PATH "test_world_vfs" VFS_OVERLAY_EXTENSION
+#define PACKED_FILE "/etc/fs_access.json"
+#define LISTING_MAX 65536
+
+static void add_to_listing(const VfsEntry* entry, void* context) {
+    char* out = context;
+    size_t used = strlen(out);
+    snprintf(out + used, LISTING_MAX - used, "%s%s:%zu ", entry->name, entry->is_dir ? "/" : "", entry->size);
+}
+
+static void listing(const char* dir, char* out) {
+    out[0] = '\0';
+    vfs_list(dir, add_to_listing, out);
+}
+
+static bool has_contents(const char* path, const char* expected) {
+    char* data = NULL;
+    size_t size = 0;
+    if (!vfs_read(path, &data, &size)) return false;
+    bool same = size == strlen(expected) && strcmp(data, expected) == 0;
+    free(data);
+    return same;
+}
+
+static long file_size(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return -1;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+// Everything the tests below leave behind, as listings to compare after a
+// reopen.
+static char g_etc[LISTING_MAX], g_home[LISTING_MAX], g_lain[LISTING_MAX];
+
+static void snapshot_listings(void) {
+    listing("/etc", g_etc);
+    listing("/home", g_home);
+    listing("/home/lain", g_lain);
+}
+
+static void check_listings(void) {
+    static char now[LISTING_MAX];
+    listing("/etc", now);
+    CHECK(strcmp(now, g_etc) == 0);
+    listing("/home", now);
+    CHECK(strcmp(now, g_home) == 0);
+    listing("/home/lain", now);
+    CHECK(strcmp(now, g_lain) == 0);
+}
+
+// Renames made when the overlay is exactly full grow it first; the record
+// being renamed must be found again in the grown table. Every count up to a
+// few doublings, from a fresh overlay each time, lands on each boundary.
+static void test_rename_at_capacity(void) {
+    for (int count = 1; count <= 40; count++) {
+        unlink(OVERLAY_PATH);
+        CHECK(vfs_overlay_open(OVERLAY_PATH));
+        char path[64], last[64];
+        for (int i = 0; i < count; i++) {
+            snprintf(path, sizeof(path), "/home/lain/f%d", i);
+            CHECK(vfs_write(path, path, strlen(path)));
+        }
+        snprintf(last, sizeof(last), "/home/lain/f%d", count - 1);
+        CHECK(vfs_rename(last, "/home/lain/renamed"));
+        CHECK(has_contents("/home/lain/renamed", last));
+        CHECK(!vfs_stat(last, NULL));
+        // An alias of a packed file, renamed on the next boundary.
+        CHECK(vfs_rename(PACKED_FILE, "/home/fs_access.json"));
+        CHECK(vfs_rename("/home/fs_access.json", "/etc/again.json"));
+        CHECK(vfs_stat("/etc/again.json", NULL));
+        vfs_overlay_close();
+    }
+    unlink(OVERLAY_PATH);
+}
+
+static void test_write_and_rename(void) {
+    uint32_t generation = vfs_generation();
+    CHECK(vfs_write("/home/lain/note.txt", "hello", 5));
+    CHECK(vfs_generation() != generation);
+    CHECK(has_contents("/home/lain/note.txt", "hello"));
+    CHECK(vfs_write("/home/lain/note.txt", "replaced", 8));
+    CHECK(has_contents("/home/lain/note.txt", "replaced"));
+    CHECK(!vfs_write("/no/such/dir/file", "x", 1));
+    CHECK(!vfs_write("/home", "x", 1)); // A directory
+
+    // A packed file renamed and renamed back leaves the listing as it was.
+    static char before[LISTING_MAX], after[LISTING_MAX];
+    char* original = NULL;
+    size_t original_size = 0;
+    CHECK(vfs_read(PACKED_FILE, &original, &original_size));
+    listing("/etc", before);
+    CHECK(vfs_rename(PACKED_FILE, "/etc/moved.json"));
+    CHECK(!vfs_stat(PACKED_FILE, NULL));
+    CHECK(has_contents("/etc/moved.json", original));
+    CHECK(vfs_rename("/etc/moved.json", PACKED_FILE));
+    CHECK(!vfs_stat("/etc/moved.json", NULL));
+    listing("/etc", after);
+    CHECK(strcmp(before, after) == 0);
+
+    // Moved across directories, an alias keeps the packed contents.
+    CHECK(vfs_rename(PACKED_FILE, "/home/fs_access.json"));
+    CHECK(has_contents("/home/fs_access.json", original));
+    CHECK(vfs_rename("/home/lain/note.txt", "/home/note.txt"));
+    CHECK(!vfs_stat("/home/lain/note.txt", NULL));
+    CHECK(has_contents("/home/note.txt", "replaced"));
+    CHECK(!vfs_rename("/home/lain/note.txt", "/home/again.txt"));
+    free(original);
+}
+
+static void test_whiteouts(void) {
+    CHECK(vfs_write("/etc/local.json", "{}", 2));
+    CHECK(vfs_rename("/home/fs_access.json", PACKED_FILE));
+
+    VfsEntry entry;
+    CHECK(vfs_stat(PACKED_FILE, &entry) && !entry.is_dir);
+    CHECK(vfs_remove(PACKED_FILE));
+    CHECK(!vfs_stat(PACKED_FILE, NULL));
+    CHECK(!vfs_remove(PACKED_FILE));
+    char* data = NULL;
+    size_t size = 0;
+    CHECK(!vfs_read(PACKED_FILE, &data, &size));
+    static char etc[LISTING_MAX];
+    listing("/etc", etc);
+    CHECK(strstr(etc, "fs_access.json") == NULL);
+    CHECK(strstr(etc, "local.json:2 ") != NULL);
+
+    // Written again, the path shows the new contents, not the packed ones.
+    CHECK(vfs_write(PACKED_FILE, "[]", 2));
+    CHECK(has_contents(PACKED_FILE, "[]"));
+    CHECK(vfs_remove(PACKED_FILE));
+    CHECK(!vfs_stat(PACKED_FILE, NULL));
+
+    CHECK(!vfs_remove("/home/lain")); // Directories are the image's
+    CHECK(!vfs_remove("/no/such/file"));
+}
+
+static void test_many_changes(void) {
+    vfs_batch_begin();
+    for (int i = 0; i < 2000; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/home/lain/f%04d", i);
+        CHECK(vfs_write(path, path, strlen(path)));
+    }
+    vfs_batch_end();
+    for (int i = 0; i < 2000; i += 2) {
+        char from[64], to[64];
+        snprintf(from, sizeof(from), "/home/lain/f%04d", i);
+        snprintf(to, sizeof(to), "/home/g%04d", i);
+        CHECK(vfs_rename(from, to));
+    }
+    for (int i = 1; i < 2000; i += 4) {
+        char path[64];
+        snprintf(path, sizeof(path), "/home/lain/f%04d", i);
+        CHECK(vfs_remove(path));
+    }
+    CHECK(vfs_list("/home/lain", NULL, NULL) >= 500);
+    CHECK(has_contents("/home/g0100", "/home/lain/f0100"));
+}
+
+static void test_reopen(void) {
+    snapshot_listings();
+    vfs_overlay_close();
+    CHECK(vfs_overlay_open(OVERLAY_PATH));
+    check_listings();
+    CHECK(!vfs_stat(PACKED_FILE, NULL));
+    CHECK(has_contents("/home/note.txt", "replaced"));
+    CHECK(has_contents("/home/g0100", "/home/lain/f0100"));
+
+    // A torn record at the end is dropped; everything before it stays.
+    vfs_overlay_close();
+    long clean_size = file_size(OVERLAY_PATH);
+    FILE* f = fopen(OVERLAY_PATH, "ab");
+    CHECK(f != NULL);
+    if (f) {
+        fwrite("\x00\x05\x00garbage", 1, 10, f);
+        fclose(f);
+    }
+    CHECK(vfs_overlay_open(OVERLAY_PATH));
+    check_listings();
+    CHECK(vfs_write("/home/after_tear.txt", "x", 1));
+    vfs_overlay_close();
+    CHECK(file_size(OVERLAY_PATH) <= clean_size + 64);
+    CHECK(vfs_overlay_open(OVERLAY_PATH));
+    CHECK(has_contents("/home/after_tear.txt", "x"));
+    CHECK(!vfs_stat(PACKED_FILE, NULL));
+    vfs_overlay_close();
+
+    // Closed, the overlay no longer shows; the image is as it was built.
+    CHECK(vfs_stat(PACKED_FILE, NULL));
+    CHECK(!vfs_stat("/home/note.txt", NULL));
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <world.wpk>\n", argv[0]);
+        return 2;
+    }
+    if (!vfs_mount(argv[1])) {
+        fprintf(stderr, "Cannot mount %s\n", argv[1]);
+        return 1;
+    }
+    test_rename_at_capacity();
+    CHECK(vfs_overlay_open(OVERLAY_PATH));
+    test_write_and_rename();
+    test_whiteouts();
+    test_many_changes();
+    test_reopen();
+    unlink(OVERLAY_PATH);
+    vfs_unmount();
+    return test_finish("test_world_vfs");
+}
@@ -14,8 +14,6 @@
 
 // 引用全局状态
 extern struct GameState* game_state;
-extern const char* g_embedded_strings[TEXT_COUNT];
-
 void handle_signal(int sig) { (void)sig; }
 
 int main(int argc, char *argv[]) {
@@ -23,7 +21,7 @@ int main(int argc, char *argv[]) {
     init_terminal_state();
     
     // 初始化字符串表（开机文字需要）
-    init_string_table(g_embedded_strings, TEXT_COUNT);
+    init_string_table();
     
     // 分配最基础的 GameState
     game_state = malloc(sizeof(GameState));
@@ -9,9 +9,9 @@ PROJECT_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
 STRINGS_DIR = os.path.join(PROJECT_ROOT, 'data', 'strings_extra')
 MAIN_STRINGS_FILE = os.path.join(PROJECT_ROOT, 'data', 'strings.json')
 SCENES_DIR = os.path.join(PROJECT_ROOT, 'data', 'scenes')
+MAP_FILE = os.path.join(PROJECT_ROOT, 'data', 'map.json')
 SRC_DIRS = [
-    os.path.join(PROJECT_ROOT, 'src'),
-    os.path.join(PROJECT_ROOT, 'sequences')
+    os.path.join(PROJECT_ROOT, 'src')
 ]
 
 # Regex patterns
@@ -79,6 +79,26 @@ def scan_c_code():
                         for scid in sc_matches:
                             referenced_scene_ids.add(scid)
 
+def scan_map_data():
+    print("--- Scanning Map Data for References ---")
+    with open(MAP_FILE, 'r', encoding='utf-8') as f:
+        data = json.load(f)
+    entries = list(data.get('locations', []))
+    stations = data.get('stations', {})
+    entries.append(stations)
+    for entry in entries:
+        for key in ('name', 'description'):
+            if key in entry:
+                referenced_string_ids.add(entry[key])
+        for poi in entry.get('pois', []):
+            referenced_string_ids.update((poi['name'], poi['description']))
+            if 'view_scene' in poi:
+                referenced_scene_ids.add(poi['view_scene'])
+        for conn in entry.get('connections', []):
+            for key in ('scene', 'denied_scene'):
+                if key in conn:
+                    referenced_scene_ids.add(conn[key])
+
 def report():
     print("\n=== CONSISTENCY CHECK REPORT ===\n")
     
@@ -112,4 +132,5 @@ if __name__ == "__main__":
     load_string_definitions()
     load_scene_definitions()
     scan_c_code()
+    scan_map_data()
     report()
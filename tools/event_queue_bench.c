@@ -0,0 +1,192 @@
+// Producer/consumer throughput benchmark for the event ring (event_system.c).
+// Usage: event_queue_bench [producers] [events_per_producer]
+//
+// Phase 1: N producer threads push WORKER_DONE events as fast as the ring lets
+//          them (retrying while full) and one consumer drains; reports events/s
+//          and compares against a mutex-guarded circular queue of the same size.
+// Phase 2: a producer fires ticks in bursts while the consumer polls slowly;
+//          reports how many ticks were folded into each tick event.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include "event_system.h"
+
+static int g_producers = 4;
+static long g_per_producer = 1000000;
+static atomic_int g_producers_done;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// --- Reference: mutex-guarded circular queue (the previous implementation) ---
+
+static Event mutex_queue[MAX_EVENTS];
+static int mutex_head = 0, mutex_tail = 0, mutex_count = 0;
+static pthread_mutex_t mutex_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool mutex_push(Event e) {
+    pthread_mutex_lock(&mutex_lock);
+    if (mutex_count >= MAX_EVENTS) {
+        pthread_mutex_unlock(&mutex_lock);
+        return false;
+    }
+    mutex_queue[mutex_tail] = e;
+    mutex_tail = (mutex_tail + 1) % MAX_EVENTS;
+    mutex_count++;
+    pthread_mutex_unlock(&mutex_lock);
+    return true;
+}
+
+static bool mutex_poll(Event* e) {
+    pthread_mutex_lock(&mutex_lock);
+    if (mutex_count == 0) {
+        pthread_mutex_unlock(&mutex_lock);
+        return false;
+    }
+    *e = mutex_queue[mutex_head];
+    mutex_head = (mutex_head + 1) % MAX_EVENTS;
+    mutex_count--;
+    pthread_mutex_unlock(&mutex_lock);
+    return true;
+}
+
+// --- Throughput Phase ---
+
+typedef struct {
+    bool (*push)(Event);
+    int id;
+    unsigned long full_retries;
+} ProducerArgs;
+
+static void* producer_func(void* arg) {
+    ProducerArgs* args = (ProducerArgs*)arg;
+    Event e;
+    memset(&e, 0, sizeof(e));
+    e.type = WORKER_DONE_EVENT;
+    e.data.worker.worker_id = args->id;
+    for (long i = 0; i < g_per_producer; i++) {
+        e.data.worker.status = (int)i;
+        while (!args->push(e)) {
+            args->full_retries++;
+            sched_yield();
+        }
+    }
+    atomic_fetch_add(&g_producers_done, 1);
+    return NULL;
+}
+
+static void run_throughput(const char* label, bool (*push)(Event), bool (*poll)(Event*)) {
+    pthread_t threads[64];
+    ProducerArgs args[64];
+    long expected = g_producers * g_per_producer;
+    long received = 0;
+    long* last_seen = calloc(g_producers, sizeof(long));
+    long order_errors = 0;
+    for (int i = 0; i < g_producers; i++) last_seen[i] = -1;
+
+    atomic_store(&g_producers_done, 0);
+    double start = now_seconds();
+    for (int i = 0; i < g_producers; i++) {
+        args[i] = (ProducerArgs){ push, i, 0 };
+        pthread_create(&threads[i], NULL, producer_func, &args[i]);
+    }
+
+    Event e;
+    while (received < expected) {
+        if (poll(&e)) {
+            // Events of one producer must come out in the order they went in.
+            int id = e.data.worker.worker_id;
+            if (e.data.worker.status <= last_seen[id]) order_errors++;
+            last_seen[id] = e.data.worker.status;
+            received++;
+        } else {
+            sched_yield(); // Let producers run on machines with few cores
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    unsigned long retries = 0;
+    for (int i = 0; i < g_producers; i++) {
+        pthread_join(threads[i], NULL);
+        retries += args[i].full_retries;
+    }
+    free(last_seen);
+
+    printf("%-14s %ld events in %.3fs: %.2f M events/s, %lu full-ring retries, %ld ordering errors\n",
+           label, received, elapsed, received / elapsed / 1e6, retries, order_errors);
+}
+
+static bool ring_push(Event e) { return push_event(e); }
+static bool ring_poll(Event* e) { return poll_event(e); }
+
+// --- Tick Coalescing Phase ---
+
+static void* tick_producer_func(void* arg) {
+    long ticks = *(long*)arg;
+    for (long i = 0; i < ticks; i++) {
+        push_tick_event();
+        if (i % 1000 == 999) usleep(100);
+    }
+    atomic_store(&g_producers_done, 1);
+    return NULL;
+}
+
+static void run_tick_coalescing(long ticks) {
+    init_event_queue();
+    atomic_store(&g_producers_done, 0);
+    pthread_t thread;
+    pthread_create(&thread, NULL, tick_producer_func, &ticks);
+
+    long delivered = 0, events = 0;
+    Event e;
+    for (;;) {
+        bool done = atomic_load(&g_producers_done);
+        while (poll_event(&e)) {
+            if (e.type == TIME_TICK_EVENT) {
+                delivered += e.data.tick.count;
+                events++;
+            }
+        }
+        if (done) break;
+        usleep(1000); // A slow consumer, like a main loop busy rendering
+    }
+    pthread_join(thread, NULL);
+
+    EventQueueStats stats;
+    get_event_queue_stats(&stats);
+    printf("ticks          %ld produced, %ld delivered in %ld events (%.1f ticks/event), %llu dropped\n",
+           ticks, delivered, events, events ? (double)delivered / events : 0.0,
+           (unsigned long long)stats.dropped[TIME_TICK_EVENT]);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) g_producers = atoi(argv[1]);
+    if (argc > 2) g_per_producer = atol(argv[2]);
+    if (g_producers < 1) g_producers = 1;
+    if (g_producers > 64) g_producers = 64;
+    if (g_per_producer < 1) g_per_producer = 1;
+
+    printf("Event ring benchmark: %d producer(s) x %ld events, capacity %d\n\n",
+           g_producers, g_per_producer, MAX_EVENTS);
+
+    init_event_queue();
+    run_throughput("lock-free", ring_push, ring_poll);
+
+    EventQueueStats stats;
+    get_event_queue_stats(&stats);
+    printf("               pushed=%llu polled=%llu\n",
+           (unsigned long long)stats.pushed, (unsigned long long)stats.polled);
+
+    run_throughput("mutex", mutex_push, mutex_poll);
+    run_tick_coalescing(200000);
+    return 0;
+}
@@ -37,21 +37,23 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    printf("Total locations registered: %d\n\n", game_state->location_count);
+    printf("Total locations registered: %d\n\n", map_location_count());
 
-    for (int i = 0; i < game_state->location_count; i++) {
-        Location* loc = &game_state->all_locations[i];
-        if(loc == NULL || loc->id[0] == '\0') continue;
+    for (int i = 0; i < map_location_count(); i++) {
+        const Location* loc = map_location_at(i);
 
         printf("--- Location ---\n");
         printf(" ID:   %s\n", loc->id);
-        printf(" Name: %s\n", loc->name);
+        printf(" Name: %s\n", location_name(loc));
+        printf(" POIs: %d\n", loc->pois_count);
         
         if (loc->connection_count > 0) {
             printf(" Connections (%d):\n", loc->connection_count);
             for (int j = 0; j < loc->connection_count; j++) {
-                Connection* conn = &loc->connections[j];
-                printf("   - via action '%s' -> leads to '%s'\n", conn->action_id, conn->target_location_id);
+                const Connection* conn = &location_connections(loc)[j];
+                printf("   - via action '%s' -> leads to '%s'", conn->action_id, conn->target_location_id);
+                if (connection_is_gated(conn)) printf(" (gate '%s')", connection_gate_name(conn));
+                printf("\n");
             }
         } else {
             printf(" Connections: (none)\n");
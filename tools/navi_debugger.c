@@ -4,6 +4,8 @@
 #include "string_table.h"
 #include "flag_system.h"
 #include "data_loader.h"
+#include "game_paths.h"
+#include "world_vfs.h"
 #include "systems/embedded_navi.h"
 
 int main(int argc, char* argv[]) {
@@ -29,6 +31,12 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // The shell and mail read the world image built next to this tool.
+    init_paths(argv[0], &game_state.paths);
+    if (!vfs_mount(game_state.paths.world_pack)) {
+        fprintf(stderr, "WARNING: World image %s not found; shell and mail will be empty.\n", game_state.paths.world_pack);
+    }
+
     // Set a default network scope for testing
     hash_table_set(game_state.flags, "network_status.scope", "地区局域网");
 
@@ -37,6 +45,7 @@ int main(int argc, char* argv[]) {
     enter_embedded_navi(&game_state);
 
     // 4. Cleanup
+    vfs_unmount();
     free_hash_table(game_state.flags);
     cleanup_string_table();
 
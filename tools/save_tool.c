@@ -0,0 +1,194 @@
+// Inspects and converts binary session saves (save_state.h).
+// Usage: save_tool info   <save.sav>
+//        save_tool export <save.sav> <out.json>
+//        save_tool import <in.json> <save.sav>
+//        save_tool bench  <save.sav> [iterations]
+//
+// export/import go through the same JSON the game loads as character.json,
+// with "flags" and "npcs" added, so a save can be read, edited and written back.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+
+#include "game_types.h"
+#include "data_loader.h"
+#include "save_state.h"
+#include "autosave.h"
+#include "flag_system.h"
+#include "player_items.h"
+#include "characters/mika.h"
+#include "map_loader.h"
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t le32(const unsigned char* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static int usage(void) {
+    fprintf(stderr, "Usage: save_tool info <save.sav>\n"
+                    "       save_tool export <save.sav> <out.json>\n"
+                    "       save_tool import <in.json> <save.sav>\n"
+                    "       save_tool bench <save.sav> [iterations]\n");
+    return 1;
+}
+
+static GameState* new_game_state(void) {
+    GameState* gs = calloc(1, sizeof(GameState));
+    if (gs == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    return gs;
+}
+
+// The snapshot with its journal replayed, as the game would resume it.
+static int load_save(const char* path, GameState* gs) {
+    int replayed = 0;
+    SaveStateStatus status = autosave_recover(path, gs, &replayed);
+    if (status != SAVE_STATE_OK) {
+        fprintf(stderr, "%s: %s\n", path, save_state_status_string(status));
+        return 0;
+    }
+    if (replayed > 0) fprintf(stderr, "%s: replayed %d journal records\n", path, replayed);
+    return 1;
+}
+
+// Walks the raw sections, so a damaged save still shows what is in it.
+static int cmd_info(const char* path) {
+    char* data = NULL;
+    long size = 0;
+    if (read_entire_file(path, &data, &size) != DATA_LOADER_SUCCESS) {
+        fprintf(stderr, "%s: cannot read\n", path);
+        return 1;
+    }
+    const unsigned char* p = (const unsigned char*)data;
+    if (size < 12 || memcmp(p, SAVE_STATE_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: not a save file\n", path);
+        free(data);
+        return 1;
+    }
+    int section_count = p[6] | p[7] << 8;
+    printf("%s: version %d, %d sections, %ld bytes (header says %u)\n", path, p[4] | p[5] << 8,
+           section_count, size, le32(p + 8));
+    long pos = 12;
+    for (int i = 0; i < section_count && pos + 12 <= size; i++) {
+        uint32_t length = le32(p + pos + 4);
+        uint32_t crc = le32(p + pos + 8);
+        bool in_bounds = length <= (uint32_t)(size - pos - 12);
+        bool crc_ok = in_bounds && (uint32_t)crc32(crc32(0L, Z_NULL, 0), p + pos + 12, length) == crc;
+        printf("  %.4s  %6u bytes  crc %08x %s\n", (const char*)(p + pos), length, crc,
+               !in_bounds ? "OUT OF BOUNDS" : crc_ok ? "ok" : "MISMATCH");
+        if (!in_bounds) break;
+        pos += 12 + length;
+    }
+    free(data);
+
+    GameState* gs = new_game_state();
+    int ok = load_save(path, gs);
+    if (ok) {
+        printf("  location %s, scene %s, credit %d, %d items, %d commands, %d flags\n",
+               location_id_to_string(gs->player_state.location), gs->current_story_file, gs->player_state.credit_level,
+               player_item_count(&gs->player_state), player_command_count(&gs->player_state),
+               hash_table_count(gs->flags));
+    }
+    free_hash_table(gs->flags);
+    free(gs);
+    return ok ? 0 : 1;
+}
+
+static int cmd_export(const char* save_path, const char* json_path) {
+    GameState* gs = new_game_state();
+    int ok = load_save(save_path, gs) && export_game_state_json(json_path, gs);
+    if (ok) printf("Exported %s -> %s\n", save_path, json_path);
+    free_hash_table(gs->flags);
+    free(gs);
+    return ok ? 0 : 1;
+}
+
+static int cmd_import(const char* json_path, const char* save_path) {
+    GameState* gs = new_game_state();
+    int ok = load_player_state(json_path, gs);
+    if (!ok) fprintf(stderr, "%s: cannot load\n", json_path);
+    if (ok) {
+        SaveStateStatus status = save_state_write(save_path, gs);
+        ok = status == SAVE_STATE_OK;
+        if (ok) printf("Imported %s -> %s\n", json_path, save_path);
+        else fprintf(stderr, "%s: %s\n", save_path, save_state_status_string(status));
+    }
+    free_hash_table(gs->flags);
+    free(gs);
+    return ok ? 0 : 1;
+}
+
+// Encode and decode in memory, then the JSON path the binary format replaced.
+static int cmd_bench(const char* save_path, int iterations) {
+    if (iterations < 1) iterations = 1;
+    GameState* gs = new_game_state();
+    if (!load_save(save_path, gs)) {
+        free(gs);
+        return 1;
+    }
+
+    unsigned char* data = NULL;
+    size_t size = 0;
+    double start = now_seconds();
+    for (int i = 0; i < iterations; i++) {
+        free(data);
+        save_state_encode(gs, &data, &size);
+    }
+    double encode_us = (now_seconds() - start) * 1e6 / iterations;
+
+    start = now_seconds();
+    for (int i = 0; i < iterations; i++) save_state_decode(data, size, gs);
+    double decode_us = (now_seconds() - start) * 1e6 / iterations;
+    free(data);
+
+    // A journal record after one flag change, as after a typical action.
+    SaveStateShadow* shadow = save_state_shadow_create(gs);
+    size_t delta_size = 0;
+    start = now_seconds();
+    for (int i = 0; i < iterations; i++) {
+        hash_table_set(gs->flags, "SAVE_TOOL_BENCH", (i & 1) ? "1" : "0");
+        save_state_encode_delta(gs, shadow, &data, &delta_size);
+        free(data);
+    }
+    double delta_us = (now_seconds() - start) * 1e6 / iterations;
+    save_state_shadow_free(shadow);
+
+    const char* json_path = "save_tool_bench.json";
+    start = now_seconds();
+    for (int i = 0; i < iterations; i++) export_game_state_json(json_path, gs);
+    double json_save_us = (now_seconds() - start) * 1e6 / iterations;
+    start = now_seconds();
+    for (int i = 0; i < iterations; i++) {
+        free_hash_table(gs->flags);
+        load_player_state(json_path, gs);
+    }
+    double json_load_us = (now_seconds() - start) * 1e6 / iterations;
+    remove(json_path);
+
+    printf("binary: %zu bytes, encode %.2f us, decode %.2f us\n", size, encode_us, decode_us);
+    printf("journal record: %zu bytes, encode %.2f us\n", delta_size, delta_us);
+    printf("json:   export %.2f us, load %.2f us (file I/O included)\n", json_save_us, json_load_us);
+    free_hash_table(gs->flags);
+    free(gs);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) return usage();
+    init_mika_module();
+    if (strcmp(argv[1], "info") == 0) return cmd_info(argv[2]);
+    if (strcmp(argv[1], "export") == 0 && argc == 4) return cmd_export(argv[2], argv[3]);
+    if (strcmp(argv[1], "import") == 0 && argc == 4) return cmd_import(argv[2], argv[3]);
+    if (strcmp(argv[1], "bench") == 0) return cmd_bench(argv[2], argc > 3 ? atoi(argv[3]) : 10000);
+    return usage();
+}
@@ -6,7 +6,6 @@
 #include "data_loader.h"
 #include "string_table.h"
 #include "map_loader.h" // Required for map loading
-#include "cmap.h" // Required for cmap_destroy
 #include "game_paths.h"
 
 // --- Forward Declarations ---